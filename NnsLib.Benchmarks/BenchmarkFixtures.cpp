@@ -0,0 +1,82 @@
+#include "pch.h"
+
+namespace NNSLibBenchmark
+{
+	NetworkLayerMap MakeLayerMap(size_t width, size_t depth)
+	{
+		NetworkLayerMap layer_map(depth + 1, width);
+		layer_map.push_back(1);
+		return layer_map;
+	}
+
+	MultilayerPerceptron MakeMultilayerPerceptron(size_t width, size_t depth)
+	{
+		MultilayerPerceptron network{ MakeLayerMap(width, depth) };
+		InitializeWeights(network);
+		return network;
+	}
+
+	MultilayerPerceptron MakeSparseMultilayerPerceptron(size_t width, size_t depth, double density)
+	{
+		MultilayerPerceptron network{ MakeLayerMap(width, depth) };
+
+		std::mt19937 random_generator(11);
+		std::uniform_real_distribution<double> random01(0.0, 1.0);
+		for (size_t i = 1; i <= depth; ++i) /* Each hidden layer */
+		{
+			std::vector<Eigen::Triplet<WeightUnit>> connections;
+			for (size_t j = 0; j < width; ++j)
+				for (size_t k = 0; k < width; ++k)
+					if (k == j || random01(random_generator) < density)
+						connections.emplace_back(static_cast<int>(j), static_cast<int>(k), 1.0);
+
+			ConnectivityPattern pattern(static_cast<Eigen::Index>(width), static_cast<Eigen::Index>(width));
+			pattern.setFromTriplets(connections.begin(), connections.end());
+			network.SetConnectivity(static_cast<int>(i), std::move(pattern));
+		}
+
+		InitializeWeights(network);
+		return network;
+	}
+
+	ConvolutionalNetwork MakeConvolutionalNetwork(size_t size, size_t channels, size_t filters)
+	{
+		ConvolutionalNetwork network{ TensorShape{ channels, size, size }, {
+			ConvolutionalLayerConfig::Convolution(filters, 3, 3),
+			ConvolutionalLayerConfig::MaxPooling(2, 2),
+			ConvolutionalLayerConfig::Convolution(filters, 3, 3),
+			ConvolutionalLayerConfig::MaxPooling(2, 2),
+			ConvolutionalLayerConfig::FullyConnected(1) } };
+		InitializeWeights(network);
+		return network;
+	}
+
+	TrainingDataSet MakeTrainingDataSet(size_t rows, size_t inputs, size_t outputs)
+	{
+		TrainingDataSet data_set;
+		data_set.reserve(rows);
+
+		std::mt19937 random_generator(7);
+		std::uniform_real_distribution<SignalUnit> random01(0.0, 1.0);
+		for (size_t i = 0; i < rows; ++i)
+		{
+			InputLayer input(inputs);
+			for (auto& value : input)
+				value = random01(random_generator);
+
+			OutputLayer output = OutputLayer::Constant(outputs, (inputs > 1 && input[0] > input[1]) ? 1.0 : 0.0);
+			data_set.emplace_back(std::move(input), std::move(output));
+		}
+		return data_set;
+	}
+
+	void InitializeWeights(IFeedforwardNetwork& network, unsigned int seed)
+	{
+		std::mt19937 random_generator(seed);
+		std::uniform_real_distribution<WeightUnit> random_weight(-0.5, 0.5);
+		for (auto& layer : network.GetWeightMatrix()) /* Each layer, except first */
+			for (auto& neuron : layer) /* Each neuron */
+				for (auto& weight : neuron) /* Each connection + bias */
+					weight = random_weight(random_generator);
+	}
+}
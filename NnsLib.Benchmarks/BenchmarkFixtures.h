@@ -0,0 +1,25 @@
+#pragma once
+
+namespace NNSLibBenchmark
+{
+	using namespace NNS::Types;
+	using namespace NNS::Models;
+
+	/** Input layer of 'width' neurons, 'depth' hidden layers of 'width' neurons and a single output neuron. */
+	NetworkLayerMap MakeLayerMap(size_t width, size_t depth);
+
+	/** Network with fixed pseudo-random weights, so every run measures the same arithmetic. */
+	MultilayerPerceptron MakeMultilayerPerceptron(size_t width, size_t depth);
+
+	/** Same topology with every hidden layer's incoming connections kept with the given probability ( at least one per neuron ). */
+	MultilayerPerceptron MakeSparseMultilayerPerceptron(size_t width, size_t depth, double density);
+
+	/** Image classifier: two 3x3 convolutions, each followed by 2x2 max pooling, and a single output neuron. */
+	ConvolutionalNetwork MakeConvolutionalNetwork(size_t size, size_t channels, size_t filters);
+
+	/** Random samples with a learnable target ( sign of the first two inputs' difference ). */
+	TrainingDataSet MakeTrainingDataSet(size_t rows, size_t inputs, size_t outputs = 1);
+
+	/** Fill weights with values uniformly drawn from <-0.5; 0.5>, seeded so runs are comparable. */
+	void InitializeWeights(IFeedforwardNetwork& network, unsigned int seed = 42);
+}
@@ -0,0 +1,261 @@
+#include "pch.h"
+
+namespace NNSLibBenchmark
+{
+	using namespace NNS::Initialization;
+
+	static void MultilayerPerceptron_ComputeOutput(benchmark::State& state)
+	{
+		const auto width = static_cast<size_t>(state.range(0));
+		const auto depth = static_cast<size_t>(state.range(1));
+		auto network = MakeMultilayerPerceptron(width, depth);
+		const auto input = MakeTrainingDataSet(1, width).front().first;
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(network.ComputeOutput(input));
+			benchmark::DoNotOptimize(network.GetOutputActivation(0));
+		}
+
+		state.SetItemsProcessed(state.iterations());
+		state.counters["weights"] = static_cast<double>(width * (width + 1) * depth + width + 1);
+	}
+	BENCHMARK(MultilayerPerceptron_ComputeOutput)
+		->ArgNames({ "width", "depth" })
+		->ArgsProduct({ { 8, 32, 128 }, { 1, 2, 4 } });
+
+	static void Sequential_ComputeOutput(benchmark::State& state)
+	{
+		using namespace NNS::Modules;
+
+		const auto width = static_cast<size_t>(state.range(0));
+		const auto depth = static_cast<size_t>(state.range(1));
+		Sequential network{ width };
+		for (size_t i = 0; i < depth; ++i)
+			network.Add<Linear>(width, width).Add<Logistic>();
+		network.Add<Linear>(width, 1).Add<Logistic>().Build();
+		network.SetTrainingMode(state.range(2) != 0);
+		InitializeWeights(network);
+		const auto input = MakeTrainingDataSet(1, width).front().first;
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(network.ComputeOutput(input));
+			benchmark::DoNotOptimize(network.GetOutputActivation(0));
+		}
+
+		state.SetItemsProcessed(state.iterations());
+		state.counters["activations"] = static_cast<double>(network.GetActivationMemory());
+	}
+	BENCHMARK(Sequential_ComputeOutput)
+		->ArgNames({ "width", "depth", "training" })
+		->ArgsProduct({ { 8, 32, 128 }, { 1, 2, 4 }, { 0, 1 } });
+
+	/* Serving an average of independently trained networks, first member by member, then fused into one ensemble. */
+	static void MultilayerPerceptron_ComputeOutputMembers(benchmark::State& state)
+	{
+		const auto width = static_cast<size_t>(state.range(0));
+		vector<MultilayerPerceptron> members(static_cast<size_t>(state.range(1)), MakeMultilayerPerceptron(width, 2));
+		const auto input = MakeTrainingDataSet(1, width).front().first;
+
+		for (auto _ : state)
+		{
+			SignalUnit sum{};
+			for (auto& member : members)
+			{
+				benchmark::DoNotOptimize(member.ComputeOutput(input));
+				sum += member.GetOutputActivation(0);
+			}
+			benchmark::DoNotOptimize(sum / static_cast<SignalUnit>(members.size()));
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(MultilayerPerceptron_ComputeOutputMembers)
+		->ArgNames({ "width", "members" })
+		->ArgsProduct({ { 8, 32 }, { 5, 20 } });
+
+	static void MultilayerPerceptronEnsemble_ComputeOutput(benchmark::State& state)
+	{
+		const auto width = static_cast<size_t>(state.range(0));
+		const vector<MultilayerPerceptron> members(static_cast<size_t>(state.range(1)), MakeMultilayerPerceptron(width, 2));
+		vector<MultilayerPerceptron const*> pointers;
+		for (const auto& member : members)
+			pointers.push_back(&member);
+		MultilayerPerceptronEnsemble ensemble{ pointers };
+		const auto input = MakeTrainingDataSet(1, width).front().first;
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(ensemble.ComputeOutput(input));
+			benchmark::DoNotOptimize(ensemble.GetOutputActivation(0));
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(MultilayerPerceptronEnsemble_ComputeOutput)
+		->ArgNames({ "width", "members" })
+		->ArgsProduct({ { 8, 32 }, { 5, 20 } });
+
+	static void MultilayerPerceptron_ComputeOutputSparse(benchmark::State& state)
+	{
+		const auto width = static_cast<size_t>(state.range(0));
+		const auto density = static_cast<double>(state.range(1)) / 100.0;
+		auto network = MakeSparseMultilayerPerceptron(width, 2, density);
+		const auto input = MakeTrainingDataSet(1, width).front().first;
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(network.ComputeOutput(input));
+			benchmark::DoNotOptimize(network.GetOutputActivation(0));
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(MultilayerPerceptron_ComputeOutputSparse)
+		->ArgNames({ "width", "density%" })
+		->ArgsProduct({ { 128, 512 }, { 5, 10, 100 } });
+
+	static void ConvolutionalNetwork_ComputeOutput(benchmark::State& state)
+	{
+		const auto size = static_cast<size_t>(state.range(0));
+		auto network = MakeConvolutionalNetwork(size, 3, static_cast<size_t>(state.range(1)));
+		const auto input = MakeTrainingDataSet(1, size * size * 3).front().first;
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(network.ComputeOutput(input));
+			benchmark::DoNotOptimize(network.GetOutputActivation(0));
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(ConvolutionalNetwork_ComputeOutput)
+		->ArgNames({ "size", "filters" })
+		->ArgsProduct({ { 16, 32 }, { 8, 32 } });
+
+	static void KohonenNetwork_ComputeOutput(benchmark::State& state)
+	{
+		const auto inputs = static_cast<int>(state.range(0));
+		const auto neurons = static_cast<int>(state.range(1));
+		KohonenNetwork network{ inputs, neurons };
+		InitializeWeights(network);
+		const auto input = MakeTrainingDataSet(1, inputs).front().first;
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(network.ComputeOutput(input));
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(KohonenNetwork_ComputeOutput)
+		->ArgNames({ "inputs", "neurons" })
+		->ArgsProduct({ { 5, 32 }, { 100, 1000 } });
+
+	static void KohonenCodebook_FindBestMatchingUnits(benchmark::State& state)
+	{
+		const auto inputs = static_cast<int>(state.range(0));
+		const auto neurons = static_cast<int>(state.range(1));
+		const size_t samples = 1024;
+		KohonenNetwork network{ inputs, neurons };
+		InitializeWeights(network);
+		KohonenCodebook codebook{ network };
+
+		const auto data_set = MakeTrainingDataSet(samples, static_cast<size_t>(inputs));
+		RowMatrix sample_matrix(static_cast<Eigen::Index>(samples), inputs);
+		for (size_t i = 0; i < samples; ++i)
+			sample_matrix.row(static_cast<Eigen::Index>(i)) = data_set[i].first.transpose();
+		std::vector<size_t> best_units;
+
+		for (auto _ : state)
+		{
+			codebook.FindBestMatchingUnits(sample_matrix, best_units);
+			benchmark::DoNotOptimize(best_units.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * samples);
+	}
+	BENCHMARK(KohonenCodebook_FindBestMatchingUnits)
+		->ArgNames({ "inputs", "neurons" })
+		->ArgsProduct({ { 5, 32 }, { 100, 1000 } });
+
+	static void KohonenIndex_FindBestMatchingUnit(benchmark::State& state)
+	{
+		const auto inputs = static_cast<int>(state.range(0));
+		const auto neurons = static_cast<int>(state.range(1));
+		const auto max_checks = static_cast<size_t>(state.range(2));
+		KohonenNetwork network{ inputs, neurons };
+		InitializeWeights(network);
+		const KohonenCodebook codebook{ network };
+		const KohonenIndex index{ codebook, KohonenIndexConfig{ 32, max_checks } };
+		const auto data_set = MakeTrainingDataSet(256, static_cast<size_t>(inputs));
+
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(index.FindBestMatchingUnit(data_set[i++ % data_set.size()].first));
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(KohonenIndex_FindBestMatchingUnit)
+		->ArgNames({ "inputs", "neurons", "checks" })
+		->ArgsProduct({ { 4, 16 }, { 16384, 65536 }, { 0, 512 } });
+
+	static void KohonenCodebook_FindBestMatchingUnit(benchmark::State& state)
+	{
+		const auto inputs = static_cast<int>(state.range(0));
+		const auto neurons = static_cast<int>(state.range(1));
+		KohonenNetwork network{ inputs, neurons };
+		InitializeWeights(network);
+		const KohonenCodebook codebook{ network };
+		const auto data_set = MakeTrainingDataSet(256, static_cast<size_t>(inputs));
+
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(codebook.FindBestMatchingUnit(data_set[i++ % data_set.size()].first));
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(KohonenCodebook_FindBestMatchingUnit)
+		->ArgNames({ "inputs", "neurons" })
+		->ArgsProduct({ { 4, 16 }, { 16384, 65536 } });
+
+	static void RandomWeightInitializer_InitializeWeights(benchmark::State& state)
+	{
+		MultilayerPerceptron network{ MakeLayerMap(static_cast<size_t>(state.range(0)), 2) };
+		RandomWeightInitializer initializer{ 0.5 };
+
+		for (auto _ : state)
+		{
+			initializer.InitializeWeights(network);
+		}
+
+		state.counters["weights"] = static_cast<double>(state.range(0) * (state.range(0) + 1) * 2);
+	}
+	BENCHMARK(RandomWeightInitializer_InitializeWeights)
+		->ArgNames({ "width" })
+		->Arg(1024)
+		->Unit(benchmark::kMillisecond);
+
+	static void ScaledWeightInitializer_InitializeWeights(benchmark::State& state)
+	{
+		MultilayerPerceptron network{ MakeLayerMap(static_cast<size_t>(state.range(0)), 2) };
+		ScaledWeightInitializer initializer{ ScaledWeightInitializerConfig{ WeightScaling::Xavier, WeightDistribution::Uniform, 0.5, 0.0, 42, static_cast<size_t>(state.range(1)) } };
+
+		for (auto _ : state)
+		{
+			initializer.InitializeWeights(network);
+		}
+
+		state.counters["weights"] = static_cast<double>(state.range(0) * (state.range(0) + 1) * 2);
+	}
+	BENCHMARK(ScaledWeightInitializer_InitializeWeights)
+		->ArgNames({ "width", "threads" })
+		->ArgsProduct({ { 1024 }, { 1, 4 } })
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
+}
@@ -0,0 +1,117 @@
+#include "pch.h"
+
+namespace NNSLibBenchmark
+{
+	using namespace NNS::Data;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+
+	namespace
+	{
+		enum class TrainingMethod : int64_t
+		{
+			Backpropagation = 0,
+			ConjugateGradient,
+			ConjugateGradientWithAnnealing
+		};
+
+		const char* GetMethodName(TrainingMethod method)
+		{
+			switch (method)
+			{
+			case TrainingMethod::Backpropagation: return "Backpropagation";
+			case TrainingMethod::ConjugateGradient: return "ConjugateGradient";
+			default: return "ConjugateGradient+SimulatedAnnealing";
+			}
+		}
+
+		/* Every method and problem size is trained this many times, repetition n of every method from the same initial weights. */
+		constexpr int Repetitions = 5;
+
+		/** Seed of the next repetition of a method on a problem, 1 for the first repetition, 2 for the second and so on.
+		* Repetitions of one benchmark run back to back, so every method starts its n-th repetition from the same weights
+		* whatever the benchmark order or filter.
+		*/
+		unsigned int NextRepetitionSeed(NetworkLayerMap const& layerMap, size_t rows, TrainingMethod method)
+		{
+			static std::map<std::string, unsigned int> repetitions;
+
+			auto key = std::to_string(static_cast<int64_t>(method)) + "/" + std::to_string(rows);
+			for (const auto neurons : layerMap)
+				key += "/" + std::to_string(neurons);
+			return ++repetitions[key];
+		}
+
+		/** Trains a fresh network until its error drops to 'targetError' and reports wall time, epochs and passes over the data.
+		* Optimizer settings are the ones used across the test suite. 'reached' averages to the success rate over repetitions.
+		*/
+		void TrainToTarget(benchmark::State& state, TrainingDataSet const& trainingData, NetworkLayerMap const& layerMap, ErrorUnit targetError)
+		{
+			const auto method = static_cast<TrainingMethod>(state.range(1));
+			const auto seed = NextRepetitionSeed(layerMap, trainingData.size(), method);
+
+			for (auto _ : state)
+			{
+				MultilayerPerceptron network{ layerMap };
+				InitializeWeights(network, seed);
+
+				Backpropagation backpropagation{ 0.25, 0.9 };
+				ConjugateGradient conjugate_gradient{ 0.0001, 1000, 5 };
+				SimulatedAnnealing annealing{ SimulatedAnnealingConfig{ 1.0, 0.01, targetError, 5, 100, 30, RandomDistributionMethod::Normal, 0.5 } };
+				conjugate_gradient.SetSeed(seed); /* Random directions and perturbations are reproducible as well. */
+				annealing.SetSeed(seed);
+
+				IWeightOptimizer& optimizer = method == TrainingMethod::Backpropagation ? static_cast<IWeightOptimizer&>(backpropagation) : conjugate_gradient;
+				SupervisedTraining trainer{ optimizer, method == TrainingMethod::Backpropagation ? 100000u : 1000u, targetError };
+				if (method == TrainingMethod::ConjugateGradientWithAnnealing)
+				{
+					trainer.SetEludingLocalMinimaMethod(&annealing);
+				}
+
+				const auto start = std::chrono::steady_clock::now();
+				trainer.Train(network, trainingData);
+				state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+				state.counters["epochs"] = static_cast<double>(trainer.GetEpochCount());
+				state.counters["evaluations"] = static_cast<double>(trainer.GetEvaluationCount());
+				state.counters["error"] = trainer.GetBestError();
+				state.counters["reached"] = trainer.GetBestError() <= targetError ? 1.0 : 0.0;
+			}
+
+			state.SetLabel(GetMethodName(method));
+		}
+
+		void MethodArguments(benchmark::internal::Benchmark* benchmark, const char* sizeName, std::vector<int64_t> sizes)
+		{
+			benchmark->ArgNames({ sizeName, "method" })
+				->ArgsProduct({ sizes, { 0, 1, 2 } })
+				->UseManualTime()
+				->Iterations(1)
+				->Repetitions(Repetitions)
+				->ReportAggregatesOnly(true)
+				->Unit(benchmark::kMillisecond);
+		}
+	}
+
+	/* n-bit parity, generalizes xor_i2_o1 and xor_i3_o1. */
+	static void TimeToAccuracy_Parity(benchmark::State& state)
+	{
+		const auto bits = static_cast<size_t>(state.range(0));
+		TrainToTarget(state, MakeParityDataSet(bits), NetworkLayerMap{ bits, 2 * bits, 1 }, 0.01);
+	}
+	BENCHMARK(TimeToAccuracy_Parity)->Apply([](benchmark::internal::Benchmark* benchmark) { MethodArguments(benchmark, "bits", { 2, 3, 4, 5 }); });
+
+	/* Gaussian bump, generalizes gaussian_function_i1_o1_11p. */
+	static void TimeToAccuracy_Gaussian(benchmark::State& state)
+	{
+		TrainToTarget(state, MakeGaussianDataSet(static_cast<size_t>(state.range(0))), NetworkLayerMap{ 1, 6, 1 }, 0.0005);
+	}
+	BENCHMARK(TimeToAccuracy_Gaussian)->Apply([](benchmark::internal::Benchmark* benchmark) { MethodArguments(benchmark, "points", { 11, 101 }); });
+
+	static void TimeToAccuracy_Sinusoid(benchmark::State& state)
+	{
+		const auto periods = static_cast<size_t>(state.range(0));
+		TrainToTarget(state, MakeSinusoidDataSet(50 * periods, static_cast<SignalUnit>(periods)), NetworkLayerMap{ 1, 6 * periods, 1 }, 0.001);
+	}
+	BENCHMARK(TimeToAccuracy_Sinusoid)->Apply([](benchmark::internal::Benchmark* benchmark) { MethodArguments(benchmark, "periods", { 1, 2 }); });
+}
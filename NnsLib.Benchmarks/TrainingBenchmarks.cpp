@@ -0,0 +1,224 @@
+#include "pch.h"
+
+namespace NNSLibBenchmark
+{
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+
+	namespace
+	{
+		/* Width, depth and data set size shared by all training benchmarks. */
+		void TrainingArguments(benchmark::internal::Benchmark* benchmark)
+		{
+			benchmark->ArgNames({ "width", "depth", "rows" })
+				->ArgsProduct({ { 8, 32 }, { 1, 2 }, { 256, 4096 } })
+				->Unit(benchmark::kMillisecond);
+		}
+
+		/** Measures a single OptimizeWeights() call, each starting from the same weights with a freshly computed gradient. */
+		void OptimizeWeightsStep(benchmark::State& state, IWeightOptimizer& optimizer)
+		{
+			const auto width = static_cast<size_t>(state.range(0));
+			auto network = MakeMultilayerPerceptron(width, static_cast<size_t>(state.range(1)));
+			const auto training_set = MakeTrainingDataSet(static_cast<size_t>(state.range(2)), width);
+			const auto initial_weights = network.GetWeightMatrix();
+			TrainingErrorState error_state{ network, training_set };
+			optimizer.Initialize(network);
+
+			for (auto _ : state)
+			{
+				state.PauseTiming();
+				network.GetWeightMatrix() = initial_weights;
+				error_state.UpdateErrorVector(error_state.ComputeEpochGradient());
+				state.ResumeTiming();
+
+				benchmark::DoNotOptimize(optimizer.OptimizeWeights(network, error_state));
+			}
+
+			state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(training_set.size()));
+		}
+	}
+
+	static void TrainingErrorState_ComputeEpochGradient(benchmark::State& state)
+	{
+		const auto width = static_cast<size_t>(state.range(0));
+		auto network = MakeMultilayerPerceptron(width, static_cast<size_t>(state.range(1)));
+		const auto training_set = MakeTrainingDataSet(static_cast<size_t>(state.range(2)), width);
+		TrainingErrorState error_state{ network, training_set };
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(error_state.ComputeEpochGradient());
+		}
+
+		state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(training_set.size()));
+	}
+	BENCHMARK(TrainingErrorState_ComputeEpochGradient)->Apply(TrainingArguments);
+
+	static void TrainingErrorState_ComputeEpochGradientSparse(benchmark::State& state)
+	{
+		const auto width = static_cast<size_t>(state.range(0));
+		auto network = MakeSparseMultilayerPerceptron(width, 2, static_cast<double>(state.range(1)) / 100.0);
+		const auto training_set = MakeTrainingDataSet(256, width);
+		TrainingErrorState error_state{ network, training_set };
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(error_state.ComputeEpochGradient());
+		}
+
+		state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(training_set.size()));
+	}
+	BENCHMARK(TrainingErrorState_ComputeEpochGradientSparse)
+		->ArgNames({ "width", "density%" })
+		->ArgsProduct({ { 128, 512 }, { 10, 100 } });
+
+	static void TrainingErrorState_ComputeEpochGradientConvolutional(benchmark::State& state)
+	{
+		const auto size = static_cast<size_t>(state.range(0));
+		auto network = MakeConvolutionalNetwork(size, 3, static_cast<size_t>(state.range(1)));
+		const auto training_set = MakeTrainingDataSet(64, size * size * 3);
+		TrainingErrorState error_state{ network, training_set };
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(error_state.ComputeEpochGradient());
+		}
+
+		state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(training_set.size()));
+	}
+	BENCHMARK(TrainingErrorState_ComputeEpochGradientConvolutional)
+		->ArgNames({ "size", "filters" })
+		->ArgsProduct({ { 16, 32 }, { 8, 32 } })
+		->Unit(benchmark::kMillisecond);
+
+	static void TrainingErrorState_ComputeEpochGradientRecurrent(benchmark::State& state)
+	{
+		RecurrentNetworkConfig config;
+		config.cell = state.range(0) == 0 ? RecurrentCellType::LongShortTermMemory : RecurrentCellType::GatedRecurrentUnit;
+		config.output = RecurrentOutputType::EachStep;
+		config.inputs = 4;
+		config.steps = static_cast<size_t>(state.range(1));
+		config.hiddenLayers = { 32 };
+		config.truncation = 100;
+		RecurrentNetwork network{ config };
+		InitializeWeights(network);
+		const auto training_set = MakeTrainingDataSet(1, config.inputs * config.steps, config.steps);
+		TrainingErrorState error_state{ network, training_set };
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(error_state.ComputeEpochGradient());
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(1)); /* Steps */
+	}
+	BENCHMARK(TrainingErrorState_ComputeEpochGradientRecurrent)
+		->ArgNames({ "gru", "steps" })
+		->ArgsProduct({ { 0, 1 }, { 100, 5000 } })
+		->Unit(benchmark::kMillisecond);
+
+	static void Backpropagation_OptimizeWeights(benchmark::State& state)
+	{
+		Backpropagation optimizer{ 0.25, 0.9 };
+		OptimizeWeightsStep(state, optimizer);
+	}
+	BENCHMARK(Backpropagation_OptimizeWeights)->Apply(TrainingArguments);
+
+	static void ConjugateGradient_OptimizeWeights(benchmark::State& state)
+	{
+		ConjugateGradient optimizer{ 0.0001, 5 }; /* Bounded number of line minimizations, default runs until convergence. */
+		OptimizeWeightsStep(state, optimizer);
+	}
+	BENCHMARK(ConjugateGradient_OptimizeWeights)->Apply(TrainingArguments);
+
+	static void SimulatedAnnealing_OptimizeWeights(benchmark::State& state)
+	{
+		SimulatedAnnealingConfig config;
+		config.temperatureNumber = 2;
+		config.temperatureIters = 20;
+		config.setback = 0;
+		SimulatedAnnealing optimizer{ config };
+		OptimizeWeightsStep(state, optimizer);
+	}
+	BENCHMARK(SimulatedAnnealing_OptimizeWeights)->Apply(TrainingArguments);
+
+	namespace
+	{
+		/* Many small per-customer models, each with its own data, a few epochs each. */
+		void ManyModelsArguments(benchmark::internal::Benchmark* benchmark)
+		{
+			benchmark->ArgNames({ "models" })
+				->Arg(16)->Arg(256)
+				->Unit(benchmark::kMillisecond);
+		}
+
+		constexpr size_t ManyModelsRows = 32;
+		constexpr size_t ManyModelsEpochs = 10;
+
+		vector<MultilayerPerceptron> MakeManyModels(size_t count)
+		{
+			vector<MultilayerPerceptron> networks;
+			for (size_t m = 0; m < count; ++m)
+			{
+				networks.emplace_back(MultilayerPerceptron{ 3, 3, 5, 1 });
+				InitializeWeights(networks.back(), static_cast<unsigned int>(m));
+			}
+			return networks;
+		}
+	}
+
+	static void SupervisedTraining_TrainManyModels(benchmark::State& state)
+	{
+		const auto count = static_cast<size_t>(state.range(0));
+		const auto training_set = MakeTrainingDataSet(ManyModelsRows, 3);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			auto networks = MakeManyModels(count);
+			state.ResumeTiming();
+
+			for (auto& network : networks)
+			{
+				Backpropagation optimizer{ 0.25, 0.9 };
+				SupervisedTraining training{ optimizer, ManyModelsEpochs, 0.0 };
+				training.Train(network, training_set);
+			}
+			benchmark::DoNotOptimize(networks.back().GetWeightMatrix().back().back()[0]);
+		}
+
+		state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count * ManyModelsRows * ManyModelsEpochs));
+	}
+	BENCHMARK(SupervisedTraining_TrainManyModels)->Apply(ManyModelsArguments);
+
+	static void BatchedTraining_TrainManyModels(benchmark::State& state)
+	{
+		const auto count = static_cast<size_t>(state.range(0));
+		const auto training_set = MakeTrainingDataSet(ManyModelsRows, 3);
+		const vector<TrainingDataSet const*> training_data(count, &training_set);
+
+		BatchedTrainingConfig config;
+		config.maxIterations = ManyModelsEpochs;
+		config.errorThreshold = 0.0;
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			auto networks = MakeManyModels(count);
+			vector<MultilayerPerceptron*> pointers;
+			for (auto& network : networks)
+				pointers.push_back(&network);
+			state.ResumeTiming();
+
+			BatchedTraining training{ config };
+			training.Train(pointers, training_data);
+			benchmark::DoNotOptimize(networks.back().GetWeightMatrix().back().back()[0]);
+		}
+
+		state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count * ManyModelsRows * ManyModelsEpochs));
+	}
+	BENCHMARK(BatchedTraining_TrainManyModels)->Apply(ManyModelsArguments);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,36 @@
+//
+// pch.h
+// Header for standard system include files.
+//
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <Models/MultilayerPerceptron.h>
+#include <Models/MultilayerPerceptronEnsemble.h>
+#include <Models/ConvolutionalNetwork.h>
+#include <Models/RecurrentNetwork.h>
+#include <Modules/Layers.h>
+#include <Modules/Sequential.h>
+#include <Models/KohonenNetwork.h>
+#include <Models/KohonenCodebook.h>
+#include <Models/KohonenIndex.h>
+#include <Initialization/RandomWeightInitializer.h>
+#include <Initialization/ScaledWeightInitializer.h>
+#include <Optimization/Backpropagation.h>
+#include <Optimization/ConjugateGradient.h>
+#include <Optimization/SimulatedAnnealing.h>
+#include <Training/TrainingErrorState.h>
+#include <Training/SupervisedTraining.h>
+#include <Training/BatchedTraining.h>
+#include <Data/SyntheticDataSets.h>
+#include <Data/InputNormalizer.h>
+#include "BenchmarkFixtures.h"
@@ -20,7 +20,7 @@ namespace NNSLibTest
 		RandomWeightInitializer weight_init{ 0.5 };
 		IWeightOptimizer::Ptr algorithm(new Backpropagation(0.25, 0.9));
 		SupervisedTraining trainer(*algorithm, 10000, 0.001);
-		auto training_set = testHelpers::ReadTrainingDataSet("C:\\Repos\\NNSimulator\\NnsLib.Tests\\TestData\\xor_i2_o1.txt");
+		auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
 
 		// when
 		weight_init.InitializeWeights(network);
@@ -0,0 +1,127 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+
+	namespace
+	{
+		/** Per-customer data, every model learns a different threshold on a different number of samples. */
+		TrainingDataSet MakeDataSet(size_t rows, unsigned int seed)
+		{
+			std::mt19937 random_generator(seed);
+			const auto threshold = std::uniform_real_distribution<SignalUnit>(0.5, 1.0)(random_generator);
+			return testHelpers::MakeRandomDataSet(rows, 3, seed + 1, [threshold](InputLayer const& input, size_t)
+			{
+				return OutputLayer::Constant(1, input[0] + input[1] > threshold ? 1.0 : 0.0);
+			});
+		}
+
+		/** Train every network in lock-step and a copy of each alone with SupervisedTraining, then compare. */
+		void ExpectSameAsSupervisedTraining(BatchedTrainingConfig const& config, size_t count)
+		{
+			vector<MultilayerPerceptron> networks;
+			vector<TrainingDataSet> data_sets;
+			for (size_t m = 0; m < count; ++m)
+			{
+				networks.emplace_back(MultilayerPerceptron{ 3, 3, 5, 1 });
+				testHelpers::InitializeWeights(networks.back(), static_cast<unsigned int>(m));
+				data_sets.push_back(MakeDataSet(5 + 3 * m, static_cast<unsigned int>(100 + m)));
+			}
+			auto expected = networks;
+
+			vector<MultilayerPerceptron*> network_pointers;
+			vector<TrainingDataSet const*> data_pointers;
+			for (size_t m = 0; m < count; ++m)
+			{
+				network_pointers.push_back(&networks[m]);
+				data_pointers.push_back(&data_sets[m]);
+			}
+
+			// when
+			BatchedTraining batched{ config };
+			batched.Train(network_pointers, data_pointers);
+
+			// then
+			ASSERT_EQ(count, batched.GetBestErrors().size());
+			ASSERT_EQ(count, batched.GetEpochCounts().size());
+
+			size_t converged = 0;
+			for (size_t m = 0; m < count; ++m)
+			{
+				Backpropagation optimizer{ config.learningRate, config.momentumCoeff };
+				SupervisedTraining training{ optimizer, config.maxIterations, config.errorThreshold };
+				training.SetErrorCalculationMethod(config.errorMethod);
+				training.Train(expected[m], data_sets[m]);
+
+				EXPECT_EQ(training.GetEpochCount(), batched.GetEpochCounts()[m]) << "model " << m;
+				EXPECT_NEAR(training.GetBestError(), batched.GetBestErrors()[m], 1e-9) << "model " << m;
+
+				const auto& expected_weights = expected[m].GetWeightMatrix();
+				const auto& weights = networks[m].GetWeightMatrix();
+				for (size_t i = 0; i < weights.size(); ++i)
+					for (size_t j = 0; j < weights[i].size(); ++j)
+						for (Eigen::Index k = 0; k < weights[i][j].size(); ++k)
+							EXPECT_NEAR(expected_weights[i][j][k], weights[i][j][k], 1e-9) << "model " << m;
+
+				if (batched.GetEpochCounts()[m] < config.maxIterations)
+					++converged;
+			}
+
+			/* Convergence masks were exercised, some models stopped early while others ran out of iterations. */
+			EXPECT_GT(converged, 0u);
+			EXPECT_LT(converged, count);
+		}
+	}
+
+	TEST(BatchedTrainingTest, MatchesSupervisedTrainingPerModel)
+	{
+		// given
+		BatchedTrainingConfig config;
+		config.maxIterations = 300;
+		config.errorThreshold = 0.08;
+
+		ExpectSameAsSupervisedTraining(config, 6);
+	}
+
+	TEST(BatchedTrainingTest, MatchesSupervisedTrainingWithCrossEntropy)
+	{
+		// given
+		BatchedTrainingConfig config;
+		config.maxIterations = 300;
+		config.errorThreshold = 0.3;
+		config.learningRate = 0.1;
+		config.errorMethod = ErrorCalculationMethod::BinaryCrossEntropy;
+
+		ExpectSameAsSupervisedTraining(config, 6);
+	}
+
+	TEST(BatchedTrainingTest, RejectsMismatchedModels)
+	{
+		BatchedTraining training;
+		const auto data_set = MakeDataSet(4, 1);
+		MultilayerPerceptron first{ 3, 3, 5, 1 };
+		MultilayerPerceptron other_topology{ 3, 4, 1 };
+		MultilayerPerceptron other_inputs{ 2, 4, 1 };
+		MultilayerPerceptron sparse{ 3, 3, 5, 1 };
+		ConnectivityPattern pattern(3, 3);
+		for (int j = 0; j < 3; ++j)
+			pattern.insert(j, j) = 1.0;
+		sparse.SetConnectivity(1, pattern);
+
+		EXPECT_THROW(training.Train({}, {}), std::invalid_argument);
+		EXPECT_THROW(training.Train({ &first }, {}), std::invalid_argument);
+		EXPECT_THROW(training.Train({ &first, &other_topology }, { &data_set, &data_set }), std::invalid_argument);
+		EXPECT_THROW(training.Train({ &first, &sparse }, { &data_set, &data_set }), std::invalid_argument);
+		EXPECT_THROW(training.Train({ &first }, { nullptr }), std::invalid_argument);
+		EXPECT_THROW(training.Train({ &other_inputs }, { &data_set }), std::invalid_argument);
+
+		BatchedTrainingConfig config;
+		config.errorMethod = ErrorCalculationMethod::CategoricalCrossEntropy;
+		EXPECT_THROW(BatchedTraining{ config }, std::invalid_argument);
+	}
+}
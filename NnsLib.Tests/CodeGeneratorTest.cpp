@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "TestData/generated_mlp.h"
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+	using namespace NNS::Serialization;
+
+	namespace
+	{
+		/** Sparse first layer, weights are exact binary fractions so the generated text is the same on every platform. */
+		MultilayerPerceptron MakeNetwork()
+		{
+			MultilayerPerceptron network{ 3, 5, 2 };
+			ConnectivityPattern pattern(5, 3);
+			for (int j = 0; j < 5; ++j)
+			{
+				pattern.insert(j, j % 3) = 1.0;
+				if (j % 2 == 0)
+					pattern.insert(j, (j + 1) % 3) = 1.0;
+			}
+			network.SetConnectivity(1, pattern);
+
+			auto& weightMatrix = network.GetWeightMatrix();
+			for (size_t i = 0; i < weightMatrix.size(); ++i)
+				for (size_t j = 0; j < weightMatrix[i].size(); ++j)
+					for (Eigen::Index k = 0; k < weightMatrix[i][j].size(); ++k)
+						weightMatrix[i][j][k] = static_cast<WeightUnit>(static_cast<int>((i * 31 + j * 17 + static_cast<size_t>(k) * 7) % 19) - 9) / 8.0;
+			return network;
+		}
+
+		CodeGeneratorConfig MakeConfig()
+		{
+			CodeGeneratorConfig config;
+			config.name = "generated_mlp";
+			return config;
+		}
+
+		TrainingDataSet MakeSamples()
+		{
+			TrainingDataSet samples;
+			for (double x : { -1.0, 0.0, 0.5, 2.0 })
+			{
+				InputLayer input(3);
+				input << x, 1.0 - x, x * x;
+				samples.emplace_back(input, OutputLayer{});
+			}
+			return samples;
+		}
+	}
+
+	TEST(CodeGeneratorTest, GeneratedHeaderMatchesCheckedInModel)
+	{
+		// given
+		auto network = MakeNetwork();
+
+		// when
+		const auto header = GenerateInferenceHeader(network, MakeConfig());
+
+		// then
+		std::ifstream file(testHelpers::TestDataPath("generated_mlp.h"), std::ios::binary);
+		ASSERT_TRUE(file.is_open());
+		std::string expected{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+		expected.erase(std::remove(expected.begin(), expected.end(), '\r'), expected.end()); /* Checkout may convert line endings. */
+		EXPECT_EQ(expected, header);
+	}
+
+	TEST(CodeGeneratorTest, GeneratedPredictMatchesComputeOutput)
+	{
+		// given
+		auto network = MakeNetwork();
+		double input[generated_mlp::input_size];
+		double output[generated_mlp::output_size];
+
+		for (double x = -3.0; x <= 3.0; x += 0.25)
+		{
+			InputLayer inputLayer(3);
+			inputLayer << x, std::sin(x), 1.0 / (1.0 + x * x);
+			for (size_t k = 0; k < generated_mlp::input_size; ++k)
+				input[k] = inputLayer[static_cast<Eigen::Index>(k)];
+
+			// when
+			ASSERT_TRUE(network.ComputeOutput(inputLayer));
+			generated_mlp::predict(input, output);
+
+			// then
+			for (int k = 0; k < 2; ++k)
+				EXPECT_NEAR(network.GetOutputActivation(k), output[k], 1e-15);
+		}
+	}
+
+	TEST(CodeGeneratorTest, GeneratedTestHoldsLibraryOutputs)
+	{
+		// given
+		auto network = MakeNetwork();
+		const auto samples = MakeSamples();
+
+		// when
+		const auto test = GenerateInferenceTest(network, samples, MakeConfig());
+
+		// then
+		EXPECT_NE(std::string::npos, test.find("#include \"generated_mlp.h\""));
+		EXPECT_NE(std::string::npos, test.find("int main()"));
+		EXPECT_NE(std::string::npos, test.find("constexpr std::size_t sample_count = 4;"));
+
+		for (const auto& sample : samples)
+		{
+			ASSERT_TRUE(network.ComputeOutput(sample.first));
+			std::ostringstream row;
+			row << std::setprecision(std::numeric_limits<SignalUnit>::max_digits10) << "{ " << network.GetOutputActivation(0) << ", " << network.GetOutputActivation(1) << " }";
+			EXPECT_NE(std::string::npos, test.find(row.str())) << row.str();
+		}
+	}
+
+	TEST(CodeGeneratorTest, RejectsInvalidInput)
+	{
+		auto network = MakeNetwork();
+		CodeGeneratorConfig config;
+
+		config.name = "1model";
+		EXPECT_THROW(GenerateInferenceHeader(network, config), std::invalid_argument);
+		config.name = "my-model";
+		EXPECT_THROW(GenerateInferenceHeader(network, config), std::invalid_argument);
+
+		EXPECT_THROW(GenerateInferenceTest(network, TrainingDataSet{}, MakeConfig()), std::invalid_argument);
+		EXPECT_THROW(GenerateInferenceTest(network, TrainingDataSet{ { InputLayer::Zero(2), OutputLayer{} } }, MakeConfig()), std::invalid_argument);
+
+		network.Weight(2, 1, 0) = std::numeric_limits<WeightUnit>::quiet_NaN();
+		EXPECT_THROW(GenerateInferenceHeader(network, MakeConfig()), std::invalid_argument);
+	}
+}
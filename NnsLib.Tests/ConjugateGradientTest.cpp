@@ -19,7 +19,7 @@ namespace NNSLibTest
 		RandomWeightInitializer weight_init{ 0.5f };
 		ConjugateGradient algorithm{ 0.0001f, 1000, 5 };
 		SupervisedTraining trainer{ algorithm, 1000, 0.00001f };
-		TrainingDataSet training_set = testHelpers::ReadTrainingDataSet("C:\\Repos\\NNSimulator\\NnsLib.Tests\\TestData\\xor_i2_o1.txt");
+		TrainingDataSet training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
 
 		// when
 		weight_init.InitializeWeights(network);
@@ -48,7 +48,7 @@ namespace NNSLibTest
 		RandomWeightInitializer weight_init{ 0.5 };
 		ConjugateGradient algorithm{ 0.0001f, 1000, 5 };
 		SupervisedTraining trainer{ algorithm, 1000, errorThreshold };
-		TrainingDataSet training_set = testHelpers::ReadTrainingDataSet("C:\\Repos\\NNSimulator\\NnsLib.Tests\\TestData\\xor_i3_o1.txt");
+		TrainingDataSet training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i3_o1.txt"));
 		SimulatedAnnealing elm{ SimulatedAnnealingConfig{ 1.0f, 0.01f, errorThreshold, 5, 100, 30, RandomDistributionMethod::Normal, 0.5f } };
 		trainer.SetEludingLocalMinimaMethod(&elm);
 
@@ -70,4 +70,39 @@ namespace NNSLibTest
 		EXPECT_GE(network.GetOutputActivation(0), 0.9);
 	}
 
+	TEST(ConjugateGradientTest, SubsampledLineSearchNeedsFewerFullDataPasses)
+	{
+		// given
+		std::mt19937 random_generator(3);
+		std::uniform_real_distribution<double> random01(0, 1);
+		TrainingDataSet training_set;
+		for (int i = 0; i < 5000; ++i)
+		{
+			InputLayer input(2);
+			input << random01(random_generator), random01(random_generator);
+			training_set.emplace_back(input, OutputLayer::Constant(1, input[0] > input[1] ? 0.9 : 0.1));
+		}
+
+		MultilayerPerceptron full_network{ 2, 4, 1 };
+		ScaledWeightInitializer{}.InitializeWeights(full_network);
+		MultilayerPerceptron subsampled_network{ full_network };
+
+		ConjugateGradient full_algorithm{ 0.0001, 20, 5 };
+		ConjugateGradient subsampled_algorithm{ 0.0001, 20, 5 };
+		full_algorithm.SetSeed(11); /* Random restart directions and subsamples are repeatable. */
+		subsampled_algorithm.SetSeed(11);
+		subsampled_algorithm.SetLineSearchSampleSize(250);
+		SupervisedTraining full_trainer{ full_algorithm, 1, 0.0 };
+		SupervisedTraining subsampled_trainer{ subsampled_algorithm, 1, 0.0 };
+
+		// when
+		full_trainer.Train(full_network, training_set);
+		subsampled_trainer.Train(subsampled_network, training_set);
+
+		// then
+		TrainingErrorState full_error(full_network, training_set);
+		TrainingErrorState subsampled_error(subsampled_network, training_set);
+		EXPECT_LT(subsampled_trainer.GetEvaluationCount() * 2, full_trainer.GetEvaluationCount()); /* Usually ten times fewer. */
+		EXPECT_LT(subsampled_error.ComputeEpochError(), 0.025);
+	}
 }
\ No newline at end of file
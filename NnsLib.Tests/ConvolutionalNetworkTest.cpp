@@ -0,0 +1,191 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+
+	namespace
+	{
+		InputLayer MakeRandomInput(size_t size, unsigned int seed)
+		{
+			std::mt19937 random_generator(seed);
+			std::uniform_real_distribution<SignalUnit> random01(0, 1);
+			InputLayer input(size);
+			for (auto& value : input)
+				value = random01(random_generator);
+			return input;
+		}
+
+		/** Short signals with a bump placed anywhere, the class is the bump's shape. Position-independent, so a shared filter suits it. */
+		TrainingDataSet MakeBumpSignals(size_t rows, unsigned int seed)
+		{
+			std::mt19937 random_generator(seed);
+			std::uniform_int_distribution<size_t> position(0, 8);
+			std::uniform_real_distribution<SignalUnit> noise(0, 0.1);
+
+			TrainingDataSet data_set;
+			for (size_t i = 0; i < rows; ++i)
+			{
+				InputLayer input(12);
+				for (auto& value : input)
+					value = noise(random_generator);
+
+				const auto isRising = i % 2 == 0;
+				const auto start = position(random_generator);
+				for (size_t k = 0; k < 4; ++k)
+					input[start + k] += isRising ? 0.25 * (k + 1) : 1.0 - 0.25 * k;
+
+				OutputLayer output(1); output << (isRising ? 1.0 : 0.0);
+				data_set.emplace_back(std::move(input), std::move(output));
+			}
+			return data_set;
+		}
+
+	}
+
+	TEST(ConvolutionalNetworkTest, ConvolutionMatchesDirectComputation)
+	{
+		// given
+		const TensorShape input_shape{ 2, 7, 5 };
+		ConvolutionalNetwork network{ input_shape, { ConvolutionalLayerConfig::Convolution(3, 3, 2, 2) } };
+		testHelpers::InitializeWeights(network, 1);
+		const auto input = MakeRandomInput(input_shape.GetSize(), 2);
+
+		// when
+		ASSERT_TRUE(network.ComputeOutput(input));
+
+		// then
+		const auto output_shape = network.GetLayerShape(1);
+		EXPECT_EQ(3u, output_shape.channels);
+		EXPECT_EQ(3u, output_shape.width);
+		EXPECT_EQ(2u, output_shape.height);
+
+		const auto& weightMatrix = network.GetWeightMatrix();
+		ASSERT_EQ(3u, weightMatrix[0].size());
+		for (size_t y = 0; y < output_shape.height; ++y)
+			for (size_t x = 0; x < output_shape.width; ++x)
+				for (size_t f = 0; f < output_shape.channels; ++f)
+				{
+					const auto& filter = weightMatrix[0][f];
+					auto net = filter.tail(1)[0];
+					Eigen::Index k = 0;
+					for (size_t dy = 0; dy < 2; ++dy)
+						for (size_t dx = 0; dx < 3; ++dx)
+							for (size_t c = 0; c < input_shape.channels; ++c)
+								net += filter[k++] * input[((y * 2 + dy) * input_shape.width + x * 2 + dx) * input_shape.channels + c];
+
+					const auto expected = 1.0 / (1.0 + exp(-net));
+					EXPECT_NEAR(expected, network.GetActivation(1, static_cast<int>((y * output_shape.width + x) * output_shape.channels + f)), 1e-12);
+				}
+	}
+
+	TEST(ConvolutionalNetworkTest, PoolingSelectsMaximumAndAverage)
+	{
+		// given
+		const TensorShape input_shape{ 1, 4, 2 };
+		ConvolutionalNetwork max_network{ input_shape, { ConvolutionalLayerConfig::MaxPooling(2, 2) } };
+		ConvolutionalNetwork average_network{ input_shape, { ConvolutionalLayerConfig::AveragePooling(2, 2) } };
+		InputLayer input(8); input << 1, 5, 2, 0, 3, 4, 8, 6;
+
+		// when
+		max_network.ComputeOutput(input);
+		average_network.ComputeOutput(input);
+
+		// then
+		EXPECT_TRUE(max_network.GetWeightMatrix()[0].empty());
+		EXPECT_EQ(5.0, max_network.GetOutputActivation(0));
+		EXPECT_EQ(8.0, max_network.GetOutputActivation(1));
+		EXPECT_EQ(3.25, average_network.GetOutputActivation(0));
+		EXPECT_EQ(4.0, average_network.GetOutputActivation(1));
+	}
+
+	TEST(ConvolutionalNetworkTest, GradientMatchesFiniteDifference)
+	{
+		// given
+		ConvolutionalNetwork network{ TensorShape{ 2, 11, 8 }, {
+			ConvolutionalLayerConfig::Convolution(3, 3, 3),
+			ConvolutionalLayerConfig::MaxPooling(2, 2),
+			ConvolutionalLayerConfig::Convolution(2, 2, 1, 2),
+			ConvolutionalLayerConfig::AveragePooling(1, 2),
+			ConvolutionalLayerConfig::FullyConnected(3) } };
+		testHelpers::InitializeWeights(network, 3);
+
+		TrainingDataSet data_set;
+		for (unsigned int i = 0; i < 3; ++i)
+		{
+			OutputLayer output = OutputLayer::Zero(3);
+			output[i] = 1.0;
+			data_set.emplace_back(MakeRandomInput(network.GetLayerShape(0).GetSize(), 10 + i), std::move(output));
+		}
+
+		// then
+		testHelpers::ExpectGradientMatchesFiniteDifference(network, data_set, ErrorCalculationMethod::MeanSquareError);
+		testHelpers::ExpectGradientMatchesFiniteDifference(network, data_set, ErrorCalculationMethod::CategoricalCrossEntropy);
+	}
+
+	TEST(ConvolutionalNetworkTest, TrainsOnShiftedPatterns)
+	{
+		// given
+		ConvolutionalNetwork network{ TensorShape{ 1, 12 }, {
+			ConvolutionalLayerConfig::Convolution(4, 4),
+			ConvolutionalLayerConfig::MaxPooling(9),
+			ConvolutionalLayerConfig::FullyConnected(1) } };
+		testHelpers::InitializeWeights(network, 5);
+		const auto training_set = MakeBumpSignals(200, 6);
+		const auto test_set = MakeBumpSignals(100, 7);
+
+		TrainingErrorState error_state{ network, training_set };
+		ConjugateGradient optimizer{ 0.0001, 50 };
+		optimizer.Initialize(network);
+		const auto initial_error = error_state.ComputeEpochError();
+
+		// when
+		error_state.UpdateErrorVector(error_state.ComputeEpochGradient());
+		optimizer.OptimizeWeights(network, error_state);
+
+		// then
+		EXPECT_LT(error_state.ComputeEpochError(), initial_error / 4);
+
+		size_t misclassified = 0;
+		for (const auto& sample : test_set)
+		{
+			network.ComputeOutput(sample.first);
+			misclassified += (network.GetOutputActivation(0) > 0.5) != (sample.second[0] > 0.5) ? 1 : 0;
+		}
+		EXPECT_LE(misclassified, 5u);
+	}
+
+	TEST(ConvolutionalNetworkTest, RejectsInvalidLayers)
+	{
+		const TensorShape input_shape{ 1, 6, 4 };
+		EXPECT_THROW((ConvolutionalNetwork{ input_shape, {} }), std::invalid_argument);
+		EXPECT_THROW((ConvolutionalNetwork{ TensorShape{ 0, 6, 4 }, { ConvolutionalLayerConfig::FullyConnected(1) } }), std::invalid_argument);
+		EXPECT_THROW((ConvolutionalNetwork{ input_shape, { ConvolutionalLayerConfig::Convolution(1, 7, 1) } }), std::invalid_argument);
+		EXPECT_THROW((ConvolutionalNetwork{ input_shape, { ConvolutionalLayerConfig::Convolution(1, 2, 2, 0) } }), std::invalid_argument);
+		EXPECT_THROW((ConvolutionalNetwork{ input_shape, { ConvolutionalLayerConfig::MaxPooling(2, 5) } }), std::invalid_argument);
+		EXPECT_THROW((ConvolutionalNetwork{ input_shape, { ConvolutionalLayerConfig::FullyConnected(0) } }), std::invalid_argument);
+	}
+
+	TEST(ConvolutionalNetworkTest, PoolingLayerHasNoWeights)
+	{
+		// given
+		ConvolutionalNetwork network{ TensorShape{ 1, 4, 2 }, { ConvolutionalLayerConfig::MaxPooling(2, 2), ConvolutionalLayerConfig::FullyConnected(1) } };
+
+		// when
+		network.Bias(2, 0) = 0.5;
+		network.Weight(2, 0, 1) = -0.5;
+
+		// then
+		EXPECT_EQ(0.5, network.GetWeightMatrix()[1][0][2]);
+		EXPECT_EQ(-0.5, network.GetWeightMatrix()[1][0][1]);
+		EXPECT_THROW(network.Bias(1, 0), std::invalid_argument);
+		EXPECT_THROW(network.Weight(1, 0, 0), std::invalid_argument);
+		EXPECT_THROW(network.Bias(2, 1), std::invalid_argument);
+		EXPECT_THROW(network.Weight(2, 0, 3), std::invalid_argument);
+		EXPECT_THROW(network.Bias(0, 0), std::invalid_argument);
+	}
+}
@@ -0,0 +1,408 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+	using namespace NNS::Distributed;
+
+	namespace
+	{
+		enum class TransportKind { SharedMemory, Tcp };
+
+		/** Segment names and ports unique to every run, tests may run in parallel processes. */
+		std::string UniqueName()
+		{
+			static int run = 0;
+			return "nns_test_" + std::to_string(std::random_device{}() % 1000000) + "_" + std::to_string(run++);
+		}
+
+		unsigned short UniquePort()
+		{
+			return static_cast<unsigned short>(20000 + std::random_device{}() % 12000); /* Below the ephemeral range, outgoing connections never hold these. */
+		}
+
+		ITransport::Ptr MakeTransport(TransportKind kind, const std::string& name, unsigned short port, int rank, int worldSize)
+		{
+			const auto timeout = std::chrono::seconds(20);
+			if (kind == TransportKind::Tcp)
+				return ITransport::Ptr(new TcpTransport(rank, worldSize, port, "127.0.0.1", timeout));
+			return ITransport::Ptr(new SharedMemoryTransport(name, rank, worldSize, 256 /* Small, so messages stream through. */, timeout));
+		}
+
+		/** Ranks of one run as threads of this process, each with its own transport, exactly as separate processes would use them. */
+		void RunRanks(int worldSize, std::function<void(int rank)> const& rankMain)
+		{
+			vector<std::thread> ranks;
+			vector<std::exception_ptr> errors(static_cast<size_t>(worldSize));
+			for (int rank = 0; rank < worldSize; ++rank)
+			{
+				ranks.emplace_back([&rankMain, &errors, rank]()
+				{
+					try
+					{
+						rankMain(rank);
+					}
+					catch (...)
+					{
+						errors[static_cast<size_t>(rank)] = std::current_exception();
+					}
+				});
+			}
+
+			for (auto& rank : ranks)
+				rank.join();
+			for (auto& error : errors)
+				if (error)
+					std::rethrow_exception(error);
+		}
+
+		TrainingDataSet MakeDataSet(size_t rows, unsigned int seed)
+		{
+			return testHelpers::MakeRandomDataSet(rows, 2, seed, [](InputLayer const& input, size_t)
+			{
+				return OutputLayer::Constant(1, (input[0] > 0.5) != (input[1] > 0.5) ? 1.0 : 0.0);
+			});
+		}
+
+		/** Every world size-th row, shards differ in size. */
+		TrainingDataSet Shard(TrainingDataSet const& data_set, int rank, int worldSize)
+		{
+			TrainingDataSet shard;
+			for (size_t i = static_cast<size_t>(rank); i < data_set.size(); i += static_cast<size_t>(worldSize))
+				shard.push_back(data_set[i]);
+			return shard;
+		}
+
+		/** Train rank 0's starting weights with rank 0's optimizer on the whole data set in one process, then the same on shards across ranks. */
+		void ExpectSameAsSingleProcess(std::function<IWeightOptimizer::Ptr(int rank)> const& makeOptimizer, size_t epochs, AllReduceAlgorithm algorithm, ErrorUnit tolerance)
+		{
+			constexpr int world_size = 4;
+			const auto data_set = MakeDataSet(30, 1);
+			const auto name = UniqueName();
+
+			MultilayerPerceptron expected{ 2, 5, 1 };
+			testHelpers::InitializeWeights(expected, 2);
+			auto optimizer = makeOptimizer(0);
+			SupervisedTraining single{ *optimizer, epochs, 0.0 };
+			single.Train(expected, data_set);
+
+			vector<WeightMatrix> weights(world_size);
+			vector<ErrorUnit> best_errors(world_size);
+
+			// when
+			RunRanks(world_size, [&](int rank)
+			{
+				auto transport = MakeTransport(TransportKind::SharedMemory, name, 0, rank, world_size);
+				Communicator communicator{ *transport, algorithm };
+
+				MultilayerPerceptron network{ 2, 5, 1 };
+				testHelpers::InitializeWeights(network, 2 + static_cast<unsigned int>(rank)); /* Replaced by rank 0's weights. */
+				const auto shard = Shard(data_set, rank, world_size);
+
+				auto rankOptimizer = makeOptimizer(rank);
+				SupervisedTraining training{ *rankOptimizer, epochs, 0.0 };
+				training.SetCommunicator(&communicator);
+				training.Train(network, shard);
+
+				weights[static_cast<size_t>(rank)] = network.GetWeightMatrix();
+				best_errors[static_cast<size_t>(rank)] = training.GetBestError();
+			});
+
+			// then
+			for (int rank = 1; rank < world_size; ++rank)
+			{
+				EXPECT_EQ(weights[0], weights[static_cast<size_t>(rank)]) << "rank " << rank;
+				EXPECT_EQ(best_errors[0], best_errors[static_cast<size_t>(rank)]) << "rank " << rank;
+			}
+
+			EXPECT_NEAR(single.GetBestError(), best_errors[0], tolerance);
+			const auto& expected_weights = expected.GetWeightMatrix();
+			for (size_t i = 0; i < expected_weights.size(); ++i)
+				for (size_t j = 0; j < expected_weights[i].size(); ++j)
+					for (Eigen::Index k = 0; k < expected_weights[i][j].size(); ++k)
+						EXPECT_NEAR(expected_weights[i][j][k], weights[0][i][j][k], tolerance);
+		}
+	}
+
+	TEST(DistributedTrainingTest, AllReduceIsIdenticalOnEveryRank)
+	{
+		for (const auto kind : { TransportKind::SharedMemory, TransportKind::Tcp })
+		{
+			for (const auto algorithm : { AllReduceAlgorithm::Ring, AllReduceAlgorithm::Tree })
+			{
+				const int world_size = kind == TransportKind::Tcp ? 3 : 4;
+				const auto name = UniqueName();
+				const auto port = UniquePort();
+
+				for (const size_t count : { size_t{ 1 }, size_t{ 3 }, size_t{ 5000 } })
+				{
+					// given
+					vector<ErrorVector> results(static_cast<size_t>(world_size));
+					vector<ErrorVector> broadcasts(static_cast<size_t>(world_size));
+
+					// when
+					RunRanks(world_size, [&](int rank)
+					{
+						auto transport = MakeTransport(kind, name + std::to_string(count), static_cast<unsigned short>(port + 4 * (count % 7)), rank, world_size);
+						Communicator communicator{ *transport, algorithm };
+						ASSERT_EQ(rank, communicator.GetRank());
+						ASSERT_EQ(world_size, communicator.GetWorldSize());
+
+						ErrorVector data(count);
+						for (size_t i = 0; i < count; ++i)
+							data[i] = std::sin(static_cast<double>(i + 1) * (rank + 1)) / (rank + 1);
+						communicator.AllReduceSum(data.data(), data.size());
+						results[static_cast<size_t>(rank)] = data;
+
+						ErrorVector broadcast(count, static_cast<ErrorUnit>(rank));
+						communicator.Broadcast(broadcast.data(), broadcast.size(), world_size - 1);
+						broadcasts[static_cast<size_t>(rank)] = broadcast;
+					});
+
+					// then
+					for (size_t i = 0; i < count; ++i)
+					{
+						ErrorUnit expected{};
+						for (int rank = 0; rank < world_size; ++rank)
+							expected += std::sin(static_cast<double>(i + 1) * (rank + 1)) / (rank + 1);
+						ASSERT_NEAR(expected, results[0][i], 1e-12) << "element " << i;
+					}
+					for (int rank = 0; rank < world_size; ++rank)
+					{
+						EXPECT_EQ(results[0], results[static_cast<size_t>(rank)]) << "rank " << rank; /* Bitwise, not just close. */
+						EXPECT_EQ(ErrorVector(count, world_size - 1.0), broadcasts[static_cast<size_t>(rank)]) << "rank " << rank;
+					}
+				}
+			}
+		}
+	}
+
+#ifndef _WIN32
+	TEST(DistributedTrainingTest, SegmentOfCrashedRunIsNotJoined)
+	{
+		// given
+		constexpr int world_size = 2;
+		const auto name = UniqueName();
+		RunRanks(world_size, [&](int rank)
+		{
+			MakeTransport(TransportKind::SharedMemory, name, 0, rank, world_size).release(); /* Never freed, the segment stays behind as after a crash. */
+		});
+		vector<ErrorVector> results(world_size);
+
+		// when
+		RunRanks(world_size, [&](int rank)
+		{
+			if (rank == 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(200)); /* Rank 1 opens the stale segment first. */
+			auto transport = MakeTransport(TransportKind::SharedMemory, name, 0, rank, world_size);
+			Communicator communicator{ *transport };
+
+			ErrorVector data(3, static_cast<ErrorUnit>(rank + 1));
+			communicator.AllReduceSum(data.data(), data.size());
+			results[static_cast<size_t>(rank)] = data;
+		});
+
+		// then
+		EXPECT_EQ(ErrorVector(3, 3.0), results[0]);
+		EXPECT_EQ(ErrorVector(3, 3.0), results[1]);
+	}
+#endif
+
+	TEST(DistributedTrainingTest, BackpropagationOnShardsMatchesSingleProcess)
+	{
+		ExpectSameAsSingleProcess([](int) { return IWeightOptimizer::Ptr(new Backpropagation(0.25, 0.9)); }, 50, AllReduceAlgorithm::Ring, 1e-9);
+	}
+
+	TEST(DistributedTrainingTest, ConjugateGradientOnShardsMatchesSingleProcess)
+	{
+		ExpectSameAsSingleProcess([](int rank)
+		{
+			auto optimizer = new ConjugateGradient(0.0001, 20);
+			optimizer->SetSeed(7 + static_cast<unsigned int>(rank)); /* Replaced by rank 0's seed. */
+			return IWeightOptimizer::Ptr(optimizer);
+		}, 3, AllReduceAlgorithm::Tree, 1e-6);
+	}
+
+	TEST(DistributedTrainingTest, SimulatedAnnealingOnShardsMatchesSingleProcess)
+	{
+		ExpectSameAsSingleProcess([](int rank)
+		{
+			SimulatedAnnealingConfig config;
+			config.temperatureNumber = 3;
+			config.temperatureIters = 20;
+			auto optimizer = new SimulatedAnnealing(config);
+			optimizer->SetSeed(3 + static_cast<unsigned int>(rank)); /* Replaced by rank 0's seed. */
+			return IWeightOptimizer::Ptr(optimizer);
+		}, 2, AllReduceAlgorithm::Ring, 1e-9);
+	}
+
+	TEST(DistributedTrainingTest, SubsampledLineSearchAgreesAcrossRanks)
+	{
+		// given
+		constexpr int world_size = 3;
+		const auto data_set = MakeDataSet(60, 3);
+		const auto name = UniqueName();
+		vector<WeightMatrix> weights(world_size);
+		vector<size_t> evaluations(world_size);
+
+		// when
+		RunRanks(world_size, [&](int rank)
+		{
+			auto transport = MakeTransport(TransportKind::SharedMemory, name, 0, rank, world_size);
+			Communicator communicator{ *transport };
+
+			MultilayerPerceptron network{ 2, 5, 1 };
+			testHelpers::InitializeWeights(network, 4);
+			const auto shard = Shard(data_set, rank, world_size);
+
+			ConjugateGradient optimizer{ 0.0001, 20 };
+			optimizer.SetSeed(11 + static_cast<unsigned int>(rank)); /* Replaced by rank 0's seed. */
+			optimizer.SetLineSearchSampleSize(10);
+			SupervisedTraining training{ optimizer, 3, 0.0 };
+			training.SetCommunicator(&communicator);
+			training.Train(network, shard);
+
+			weights[static_cast<size_t>(rank)] = network.GetWeightMatrix();
+			evaluations[static_cast<size_t>(rank)] = training.GetEvaluationCount();
+		});
+
+		// then
+		for (int rank = 1; rank < world_size; ++rank)
+		{
+			EXPECT_EQ(weights[0], weights[static_cast<size_t>(rank)]) << "rank " << rank;
+			EXPECT_EQ(evaluations[0], evaluations[static_cast<size_t>(rank)]) << "rank " << rank;
+		}
+	}
+
+	TEST(DistributedTrainingTest, AbortOnOneRankStopsEveryRank)
+	{
+		// given
+		constexpr int world_size = 2;
+		const auto data_set = MakeDataSet(20, 5);
+		const auto name = UniqueName();
+		vector<size_t> epochs(world_size);
+		vector<WeightMatrix> weights(world_size);
+
+		// when
+		RunRanks(world_size, [&](int rank)
+		{
+			auto transport = MakeTransport(TransportKind::SharedMemory, name, 0, rank, world_size);
+			Communicator communicator{ *transport };
+
+			MultilayerPerceptron network{ 2, 5, 1 };
+			testHelpers::InitializeWeights(network, 6);
+			const auto shard = Shard(data_set, rank, world_size);
+
+			Backpropagation optimizer{ 0.25, 0.9 };
+			SupervisedTraining training{ optimizer, 100000, 0.0 };
+			training.SetCommunicator(&communicator);
+			if (rank == 1)
+			{
+				training.SetProgressCallback([&training](TrainingProgress const& progress)
+				{
+					if (progress.epoch == 5)
+						training.AbortTraining();
+				});
+			}
+			training.Train(network, shard);
+
+			epochs[static_cast<size_t>(rank)] = training.GetEpochCount();
+			weights[static_cast<size_t>(rank)] = network.GetWeightMatrix();
+		});
+
+		// then
+		EXPECT_LT(epochs[0], 10u);
+		EXPECT_EQ(epochs[0], epochs[1]);
+		EXPECT_EQ(weights[0], weights[1]);
+	}
+
+	TEST(DistributedTrainingTest, EarlyStoppingAgreesAcrossRanks)
+	{
+		// given
+		constexpr int world_size = 2;
+		const auto data_set = MakeDataSet(20, 8);
+		EarlyStoppingConfig config;
+		config.patience = 1; /* Stop requests come from each rank's validation thread at any time. */
+
+		for (int run = 0; run < 10; ++run)
+		{
+			const auto name = UniqueName();
+			vector<size_t> epochs(world_size);
+			vector<WeightMatrix> weights(world_size);
+
+			// when
+			RunRanks(world_size, [&](int rank)
+			{
+				auto transport = MakeTransport(TransportKind::SharedMemory, name, 0, rank, world_size);
+				Communicator communicator{ *transport };
+
+				MultilayerPerceptron network{ 2, 5, 1 };
+				testHelpers::InitializeWeights(network, 9);
+				const auto shard = Shard(data_set, rank, world_size);
+				const auto validation_data = MakeDataSet(10, 10 + static_cast<unsigned int>(rank)); /* Each rank validates on its own data. */
+
+				Backpropagation optimizer{ 0.9, 0.9 };
+				SupervisedTraining training{ optimizer, 2000, 0.0 };
+				training.SetCommunicator(&communicator);
+				training.SetValidationData(&validation_data, config);
+				training.Train(network, shard);
+
+				epochs[static_cast<size_t>(rank)] = training.GetEpochCount();
+				weights[static_cast<size_t>(rank)] = network.GetWeightMatrix();
+			});
+
+			// then
+			EXPECT_LT(epochs[0], 2000u);
+			EXPECT_EQ(epochs[0], epochs[1]);
+			EXPECT_EQ(weights[0], weights[1]);
+		}
+	}
+
+	TEST(DistributedTrainingTest, SubsampleIsSplitInProportionToShards)
+	{
+		// given
+		constexpr int world_size = 2;
+		const auto name = UniqueName();
+		vector<size_t> drawn(world_size);
+		vector<ErrorUnit> errors(world_size);
+
+		// when
+		RunRanks(world_size, [&](int rank)
+		{
+			auto transport = MakeTransport(TransportKind::SharedMemory, name, 0, rank, world_size);
+			Communicator communicator{ *transport };
+
+			MultilayerPerceptron network{ 1, 2, 1 };
+			for (auto& layer : network.GetWeightMatrix())
+				for (auto& weightVect : layer)
+					weightVect.setZero(); /* Every output is 0.5. */
+
+			/* Rank 0 holds 30 rows with zero error, rank 1 holds 10 rows with error 1. */
+			TrainingDataSet shard;
+			for (int i = 0; i < (rank == 0 ? 30 : 10); ++i)
+			{
+				InputLayer input(1);
+				input << i;
+				OutputLayer output(1);
+				output << (rank == 0 ? 0.5 : 1.5);
+				shard.emplace_back(std::move(input), std::move(output));
+			}
+
+			TrainingErrorState error_state{ network, shard };
+			error_state.SetCommunicator(&communicator);
+			std::mt19937 engine(5);
+			drawn[static_cast<size_t>(rank)] = error_state.DrawSubsample(8, engine);
+			errors[static_cast<size_t>(rank)] = error_state.ComputeSubsampleError();
+		});
+
+		// then
+		EXPECT_EQ(8u, drawn[0]);
+		EXPECT_EQ(8u, drawn[1]);
+		EXPECT_DOUBLE_EQ(2.0 / 8.0, errors[0]); /* Six rows from rank 0, two from rank 1. */
+		EXPECT_EQ(errors[0], errors[1]);
+	}
+}
@@ -1,39 +1,83 @@
 #include "pch.h"
 
-namespace testHelpers
+#include <atomic>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace
 {
-	TrainingDataSet ReadTrainingDataSet(const string& filePath)
-	{
-		TrainingDataSet training_set;
+	std::atomic<size_t> allocationCount{ 0 };
+}
+
+/* Counting global allocator, replaces the default one for the whole test binary. */
+void* operator new(std::size_t size)
+{
+	++allocationCount;
+	if (const auto pointer = std::malloc(size == 0 ? 1 : size))
+		return pointer;
+	throw std::bad_alloc();
+}
 
-		ifstream infile(filePath);
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
 
-		string s;
-		while (getline(infile, s))
-		{
-			istringstream ss(s);
-			vector<SignalUnit> records;
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
 
-			while (ss)
-			{
-				string s;
-				if (!getline(ss, s, '\t'))
-					break;
-				records.push_back(atof(s.c_str()));
-			}
+void operator delete[](void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
 
-			ActivationVector inputSet = Eigen::Map<ActivationVector>(records.data(), records.size()-1);
-			ActivationVector outputSet(1); outputSet << records.back();
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
 
-			training_set.emplace_back(inputSet, outputSet);
+namespace testHelpers
+{
+	// Returns path of a file from TestData, NNS_TEST_DATA_DIR environment variable overrides the directory next to this source file
+	string TestDataPath(const string& fileName)
+	{
+		if (const auto directory = std::getenv("NNS_TEST_DATA_DIR"))
+		{
+			return (std::filesystem::path(directory) / fileName).string();
 		}
+		return (std::filesystem::path(__FILE__).parent_path() / "TestData" / fileName).string();
+	}
 
-		return training_set;
+	TrainingDataSet ReadTrainingDataSet(const string& filePath)
+	{
+		return NNS::Data::TextDataSetReader{}.ReadFile(filePath);
 	}
 
-	// Returns time stamp counter
+	// Returns path of the written file, placed in the system temporary directory
+	string WriteTemporaryFile(const string& fileName, const string& content)
+	{
+		const auto filePath = (std::filesystem::temp_directory_path() / fileName).string();
+		std::ofstream outfile(filePath, std::ios::binary | std::ios::trunc);
+		outfile << content;
+		return filePath;
+	}
+
+	// Returns time stamp counter, or steady clock nanoseconds where there is none
 	long long ReadTSC() 
 	{		
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
 		int dummy[4];			// For unused returns
 		volatile int DontSkip;	// Volatile to prevent optimizing
 		long long clock;		// Time
@@ -41,6 +85,82 @@ namespace testHelpers
 		DontSkip = dummy[0];	// Prevent optimizing away cpuid
 		clock = __rdtsc();		// Read time
 		return clock;
+#elif defined(__x86_64__) || defined(__i386__)
+		_mm_lfence();			// Serialize
+		return static_cast<long long>(__rdtsc());
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	// Sets every weight and bias uniformly from [ -range, range ], same seed gives same weights
+	void InitializeWeights(IFeedforwardNetwork& network, unsigned int seed, WeightUnit range)
+	{
+		std::mt19937 random_generator(seed);
+		std::uniform_real_distribution<WeightUnit> random_weight(-range, range);
+		for (auto& layer : network.GetWeightMatrix())
+			for (auto& weightVect : layer)
+				for (auto& weight : weightVect)
+					weight = random_weight(random_generator);
 	}
 
+	// Compares ComputeEpochGradient() ( negative gradient summed over presentations ) with a central finite difference of the epoch error
+	// Mean square error's gradient is that of half the squared error summed over outputs, hence the scale
+	void ExpectGradientMatchesFiniteDifference(IFeedforwardNetwork& network, TrainingDataSet const& dataSet, ErrorCalculationMethod method)
+	{
+		TrainingErrorState error_state{ network, dataSet };
+		error_state.SetErrorComputationMethod(method);
+		error_state.ComputeEpochGradient();
+		const auto gradient = error_state.GetErrorGradient();
+
+		const auto epsilon = 1e-6;
+		const auto outputs = static_cast<double>(dataSet.front().second.size());
+		const auto scale = static_cast<double>(dataSet.size()) * (method == ErrorCalculationMethod::MeanSquareError ? outputs / 2 : 1.0);
+		auto& weightMatrix = network.GetWeightMatrix();
+		ASSERT_EQ(weightMatrix.size(), gradient.size());
+
+		for (size_t i = 0; i < weightMatrix.size(); ++i)
+		{
+			ASSERT_EQ(weightMatrix[i].size(), gradient[i].size());
+			for (size_t j = 0; j < weightMatrix[i].size(); ++j)
+			{
+				ASSERT_EQ(static_cast<size_t>(weightMatrix[i][j].size()), gradient[i][j].size());
+				for (Eigen::Index k = 0; k < weightMatrix[i][j].size(); ++k)
+				{
+					const auto weight = weightMatrix[i][j][k];
+					weightMatrix[i][j][k] = weight + epsilon;
+					const auto error_plus = error_state.ComputeEpochError();
+					weightMatrix[i][j][k] = weight - epsilon;
+					const auto error_minus = error_state.ComputeEpochError();
+					weightMatrix[i][j][k] = weight;
+
+					const auto expected = -(error_plus - error_minus) / (2 * epsilon) * scale;
+					EXPECT_NEAR(expected, gradient[i][j][static_cast<size_t>(k)], 1e-6 + 1e-4 * std::abs(expected)) << "layer " << i + 1 << ", vector " << j << ", weight " << k;
+				}
+			}
+		}
+	}
+
+	// Returns rows of inputs drawn uniformly from [ 0, 1 ), label gives each row's desired output, same seed gives same rows
+	TrainingDataSet MakeRandomDataSet(size_t rows, size_t inputs, unsigned int seed, std::function<OutputLayer(InputLayer const& input, size_t row)> const& label)
+	{
+		std::mt19937 random_generator(seed);
+		std::uniform_real_distribution<SignalUnit> random01(0, 1);
+
+		TrainingDataSet data_set;
+		for (size_t i = 0; i < rows; ++i)
+		{
+			InputLayer input(inputs);
+			for (Eigen::Index k = 0; k < input.size(); ++k)
+				input[k] = random01(random_generator);
+			auto output = label(input, i);
+			data_set.emplace_back(std::move(input), std::move(output));
+		}
+		return data_set;
+	}
+
+	size_t GetAllocationCount()
+	{
+		return allocationCount;
+	}
 }
\ No newline at end of file
@@ -1,14 +1,31 @@
 #pragma once
 
-#include <intrin.h>
 using std::ifstream;
 using std::string;
 using std::istringstream;
 
 using namespace NNS::Training;
+using NNS::Models::IFeedforwardNetwork;
+using NNS::Types::WeightUnit;
 
 namespace testHelpers
 {
+	string TestDataPath(const string& fileName);
 	TrainingDataSet ReadTrainingDataSet(const string& filePath);
+	string WriteTemporaryFile(const string& fileName, const string& content);
 	long long ReadTSC();
+	void InitializeWeights(IFeedforwardNetwork& network, unsigned int seed, WeightUnit range = 0.5);
+	void ExpectGradientMatchesFiniteDifference(IFeedforwardNetwork& network, TrainingDataSet const& dataSet, ErrorCalculationMethod method);
+	TrainingDataSet MakeRandomDataSet(size_t rows, size_t inputs, unsigned int seed, std::function<OutputLayer(InputLayer const& input, size_t row)> const& label);
+
+	// Every operator new in the test binary, counted from the start by the replacement allocator in HelperFunctions.cpp
+	size_t GetAllocationCount();
+
+	template<typename F>
+	size_t CountAllocations(F&& action)
+	{
+		const auto before = GetAllocationCount();
+		action();
+		return GetAllocationCount() - before;
+	}
 }
\ No newline at end of file
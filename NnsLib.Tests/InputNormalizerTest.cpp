@@ -0,0 +1,191 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Data;
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+	using namespace NNS::Serialization;
+
+	namespace
+	{
+		/** Inputs of wildly different scales, the last one constant. Output is 1 if the first two inputs sum above their middle. */
+		TrainingDataSet MakeRawDataSet(size_t rows, unsigned int seed)
+		{
+			auto data_set = testHelpers::MakeRandomDataSet(rows, 2, seed, [](InputLayer const& input, size_t)
+			{
+				return OutputLayer::Constant(1, input[0] + input[1] > 1.0 ? 1.0 : 0.0);
+			});
+			for (auto& sample : data_set)
+			{
+				InputLayer input(3);
+				input << 1000.0 + 500.0 * sample.first[0], 0.001 * sample.first[1], 42.0;
+				sample.first = std::move(input);
+			}
+			return data_set;
+		}
+
+		TrainingDataSet Normalized(TrainingDataSet data_set, InputNormalizer const& normalizer)
+		{
+			for (auto& sample : data_set)
+			{
+				InputLayer normalized;
+				normalizer.Normalize(sample.first, normalized);
+				sample.first = normalized;
+			}
+			return data_set;
+		}
+	}
+
+	TEST(InputNormalizerTest, FitsMinMaxAndZScore)
+	{
+		// given
+		const auto data_set = MakeRawDataSet(50, 1);
+
+		// when
+		const InputNormalizer min_max{ data_set, NormalizationMethod::MinMax };
+		const InputNormalizer z_score{ data_set, NormalizationMethod::ZScore };
+
+		// then
+		for (const auto& normalizer : { &min_max, &z_score })
+		{
+			ASSERT_EQ(3u, normalizer->GetInputCount());
+			EXPECT_DOUBLE_EQ(1.0, normalizer->GetScale()[2]); /* Constant input is only shifted. */
+		}
+
+		ActivationVector minimum = ActivationVector::Constant(3, 1e30), maximum = ActivationVector::Constant(3, -1e30);
+		ActivationVector sum = ActivationVector::Zero(3), squares = ActivationVector::Zero(3);
+		for (const auto& sample : Normalized(data_set, min_max))
+		{
+			minimum = minimum.cwiseMin(sample.first);
+			maximum = maximum.cwiseMax(sample.first);
+		}
+		for (const auto& sample : Normalized(data_set, z_score))
+		{
+			sum += sample.first;
+			squares += sample.first.cwiseProduct(sample.first);
+		}
+
+		for (Eigen::Index k = 0; k < 2; ++k)
+		{
+			EXPECT_NEAR(0.0, minimum[k], 1e-12);
+			EXPECT_NEAR(1.0, maximum[k], 1e-12);
+			EXPECT_NEAR(0.0, sum[k] / 50, 1e-9);
+			EXPECT_NEAR(1.0, squares[k] / 50, 1e-9);
+		}
+		EXPECT_DOUBLE_EQ(0.0, minimum[2]);
+		EXPECT_DOUBLE_EQ(0.0, sum[2]);
+
+		EXPECT_THROW(InputNormalizer(TrainingDataSet{}), std::invalid_argument);
+	}
+
+	TEST(InputNormalizerTest, TrainingOnTheFlyMatchesNormalizedData)
+	{
+		// given
+		MultilayerPerceptron network{ 3, 4, 1 };
+		testHelpers::InitializeWeights(network, 2);
+		const auto data_set = MakeRawDataSet(20, 3);
+		const InputNormalizer normalizer{ data_set };
+		const auto normalized_set = Normalized(data_set, normalizer);
+
+		TrainingErrorState expected_state{ network, normalized_set };
+		TrainingErrorState error_state{ network, data_set };
+
+		// when
+		error_state.SetInputNormalizer(&normalizer);
+
+		// then
+		EXPECT_DOUBLE_EQ(expected_state.ComputeEpochGradient(), error_state.ComputeEpochGradient());
+		EXPECT_EQ(expected_state.GetErrorGradient(), error_state.GetErrorGradient());
+
+		std::mt19937 first_engine(4), second_engine(4);
+		ASSERT_EQ(5u, expected_state.DrawSubsample(5, first_engine));
+		ASSERT_EQ(5u, error_state.DrawSubsample(5, second_engine));
+		EXPECT_DOUBLE_EQ(expected_state.ComputeSubsampleError(), error_state.ComputeSubsampleError());
+	}
+
+	TEST(InputNormalizerTest, FoldedNetworkTakesRawInputs)
+	{
+		// given
+		MultilayerPerceptron dense{ 3, 5, 2 };
+		MultilayerPerceptron sparse{ 3, 5, 2 };
+		ConnectivityPattern pattern(5, 3);
+		for (int j = 0; j < 5; ++j)
+		{
+			pattern.insert(j, j % 3) = 1.0;
+			if (j % 2 == 0)
+				pattern.insert(j, (j + 1) % 3) = 1.0;
+		}
+		sparse.SetConnectivity(1, pattern);
+
+		const auto data_set = MakeRawDataSet(10, 5);
+		const auto path = (std::filesystem::temp_directory_path() / "nns_folded_model.bin").string();
+
+		for (auto* network : { &dense, &sparse })
+		{
+			testHelpers::InitializeWeights(*network, 6);
+			for (const auto method : { NormalizationMethod::MinMax, NormalizationMethod::ZScore })
+			{
+				const InputNormalizer normalizer{ data_set, method };
+				MultilayerPerceptron folded{ *network };
+
+				// when
+				normalizer.FoldInto(folded);
+				SaveModel(*network, normalizer, path);
+				MappedModel model{ path };
+
+				// then
+				InputLayer normalized;
+				for (const auto& sample : data_set)
+				{
+					normalizer.Normalize(sample.first, normalized);
+					ASSERT_TRUE(network->ComputeOutput(normalized));
+					ASSERT_TRUE(folded.ComputeOutput(sample.first));
+					ASSERT_TRUE(model.ComputeOutput(sample.first));
+					for (int k = 0; k < 2; ++k)
+					{
+						EXPECT_NEAR(network->GetOutputActivation(k), folded.GetOutputActivation(k), 1e-12);
+						EXPECT_NEAR(network->GetOutputActivation(k), model.GetOutputActivation(k), 1e-12);
+					}
+				}
+			}
+		}
+
+		MultilayerPerceptron mismatched{ 4, 2 };
+		EXPECT_THROW(InputNormalizer(data_set).FoldInto(mismatched), std::invalid_argument);
+	}
+
+	TEST(InputNormalizerTest, NormalizationSpeedsUpTraining)
+	{
+		// given
+		const auto data_set = MakeRawDataSet(40, 7);
+		const InputNormalizer normalizer{ data_set };
+
+		auto train = [&data_set](InputNormalizer const* inputNormalizer)
+		{
+			MultilayerPerceptron network{ 3, 6, 1 };
+			testHelpers::InitializeWeights(network, 8);
+			TrainingErrorState error_state{ network, data_set };
+			error_state.SetInputNormalizer(inputNormalizer);
+			Backpropagation optimizer{ 0.05, 0.9 };
+			optimizer.Initialize(network);
+
+			for (int epoch = 0; epoch < 300; ++epoch)
+			{
+				error_state.ComputeEpochGradient();
+				optimizer.OptimizeWeights(network, error_state);
+			}
+			return error_state.ComputeEpochError();
+		};
+
+		// when
+		const auto raw_error = train(nullptr);
+		const auto normalized_error = train(&normalizer);
+
+		// then
+		EXPECT_LT(normalized_error, raw_error / 10);
+	}
+}
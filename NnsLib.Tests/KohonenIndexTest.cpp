@@ -0,0 +1,163 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+
+	namespace
+	{
+		RowMatrix MakeRandomRows(Eigen::Index rows, Eigen::Index columns, unsigned int seed)
+		{
+			std::mt19937 random_generator(seed);
+			std::normal_distribution<double> random_normal(0.0, 1.0);
+
+			RowMatrix matrix(rows, columns);
+			for (Eigen::Index i = 0; i < rows; ++i)
+				for (Eigen::Index j = 0; j < columns; ++j)
+					matrix(i, j) = random_normal(random_generator);
+			return matrix;
+		}
+
+		KohonenCodebook MakeCodebook(KohonenNetwork& network, unsigned int seed)
+		{
+			const auto& neurons = network.GetWeightMatrix()[0];
+			const auto weights = MakeRandomRows(static_cast<Eigen::Index>(neurons.size()), neurons.front().size(), seed);
+
+			KohonenCodebook codebook{ network };
+			for (size_t j = 0; j < neurons.size(); ++j)
+				codebook.Neuron(j) = weights.row(static_cast<Eigen::Index>(j));
+			codebook.UpdateNorms();
+			return codebook;
+		}
+
+		vector<size_t> BruteForceNearestUnits(KohonenCodebook const& codebook, ActivationVector const& input, size_t k)
+		{
+			const ActivationVector distances = (codebook.GetWeights().rowwise() - input.transpose()).rowwise().squaredNorm();
+			vector<size_t> order(static_cast<size_t>(distances.size()));
+			std::iota(order.begin(), order.end(), size_t{ 0 });
+			std::partial_sort(order.begin(), order.begin() + k, order.end(), [&](size_t a, size_t b)
+			{
+				return distances[static_cast<Eigen::Index>(a)] < distances[static_cast<Eigen::Index>(b)];
+			});
+			order.resize(k);
+			return order;
+		}
+	}
+
+	TEST(KohonenIndexTest, ExactSearchMatchesBruteForce)
+	{
+		// given
+		KohonenNetwork network{ 6, 50, 40 };
+		const auto codebook = MakeCodebook(network, 1);
+		const KohonenIndex index{ codebook, KohonenIndexConfig{ 16, 0 } };
+		const auto queries = MakeRandomRows(200, 6, 2);
+
+		for (Eigen::Index i = 0; i < queries.rows(); ++i)
+		{
+			// when
+			const ActivationVector query = queries.row(i).transpose();
+			vector<size_t> nearest;
+			vector<SignalUnit> distances;
+			index.FindNearestUnits(query, 5, nearest, &distances);
+
+			// then
+			EXPECT_EQ(BruteForceNearestUnits(codebook, query, 5), nearest);
+			EXPECT_EQ(codebook.FindBestMatchingUnit(query), index.FindBestMatchingUnit(query));
+			EXPECT_TRUE(std::is_sorted(distances.begin(), distances.end()));
+		}
+	}
+
+	TEST(KohonenIndexTest, RefreshKeepsSearchExactAfterWeightsMoved)
+	{
+		// given
+		KohonenNetwork network{ 4, 30, 30 };
+		auto codebook = MakeCodebook(network, 3);
+		KohonenIndex index{ codebook, KohonenIndexConfig{ 8, 0 } };
+
+		const auto shift = MakeRandomRows(static_cast<Eigen::Index>(codebook.GetNeuronCount()), 4, 4);
+		for (size_t j = 0; j < codebook.GetNeuronCount(); ++j)
+			codebook.Neuron(j) += 0.5 * shift.row(static_cast<Eigen::Index>(j));
+		codebook.UpdateNorms();
+
+		// when
+		index.Refresh(codebook);
+
+		// then
+		const auto queries = MakeRandomRows(200, 4, 5);
+		for (Eigen::Index i = 0; i < queries.rows(); ++i)
+		{
+			const ActivationVector query = queries.row(i).transpose();
+			EXPECT_EQ(codebook.FindBestMatchingUnit(query), index.FindBestMatchingUnit(query));
+		}
+	}
+
+	TEST(KohonenIndexTest, LimitedChecksTradeRecallForSpeed)
+	{
+		// given
+		KohonenNetwork network{ 4, 100, 100 };
+		const auto codebook = MakeCodebook(network, 6);
+		const KohonenIndex index{ codebook, KohonenIndexConfig{ 16, 256 } };
+		const auto queries = MakeRandomRows(500, 4, 7);
+
+		// when
+		size_t hits = 0;
+		for (Eigen::Index i = 0; i < queries.rows(); ++i)
+		{
+			const ActivationVector query = queries.row(i).transpose();
+			if (index.FindBestMatchingUnit(query) == codebook.FindBestMatchingUnit(query))
+				++hits;
+		}
+
+		// then
+		EXPECT_GE(hits, 450u);
+	}
+
+	TEST(KohonenIndexTest, RefreshRejectsDifferentCodebook)
+	{
+		KohonenNetwork network{ 4, 10 };
+		KohonenNetwork other{ 4, 12 };
+		KohonenIndex index{ MakeCodebook(network, 8) };
+
+		EXPECT_THROW(index.Refresh(MakeCodebook(other, 9)), std::invalid_argument);
+	}
+
+	TEST(KohonenIndexTest, LookupsDoNotAllocateAfterFirstQuery)
+	{
+		// given
+		KohonenNetwork network{ 3, 20, 20 };
+		testHelpers::InitializeWeights(network, 5);
+		const KohonenCodebook codebook{ network };
+		const KohonenIndex index{ codebook, KohonenIndexConfig{ 8, 0 } };
+		vector<size_t> nearest;
+		vector<SignalUnit> distances;
+		ActivationVector query = ActivationVector::Constant(3, 0.1);
+		index.FindNearestUnits(query, 5, nearest, &distances); /* Sizes the calling thread's buffers and the outputs. */
+
+		// when
+		const auto allocations = testHelpers::CountAllocations([&]()
+		{
+			for (int i = 0; i < 50; ++i)
+			{
+				query[i % 3] = 0.02 * i - 0.5;
+				index.FindNearestUnits(query, 5, nearest, &distances);
+				index.FindBestMatchingUnit(query);
+			}
+		});
+
+		// then
+		EXPECT_EQ(0u, allocations);
+	}
+
+	TEST(KohonenIndexTest, EmptyIndexRejectsLookups)
+	{
+		const KohonenIndex index{};
+		const ActivationVector query = ActivationVector::Zero(3);
+
+		EXPECT_THROW(index.FindBestMatchingUnit(query), std::logic_error);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "pch.h"
+#include "TestFixtures.h"
+
+namespace NNSLibTest
+{
+	using namespace NNS::Models;
+	using namespace NNS::Activation;
+	using namespace NNS::Initialization;
+	using namespace NNS::Serialization;
+
+	TEST(MappedModelTest, OutputMatchesSavedNetwork)
+	{
+		// given
+		MultilayerPerceptron network{ 3, 7, 5, 2 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		weight_init.InitializeWeights(network);
+		network.Bias(2, 3) = -0.75;
+		const auto path = (std::filesystem::temp_directory_path() / "nns_mapped_model.bin").string();
+
+		// when
+		SaveModel(network, path);
+		MappedModel model{ path };
+
+		// then
+		EXPECT_EQ(network.GetNetworkLayerMap(), model.GetNetworkLayerMap());
+		EXPECT_EQ(ActivationFunctionType::Logistic, model.GetActivationFunctionType(1));
+
+		InputLayer input(3);
+		for (double x : { -1.0, 0.0, 0.5, 2.0 })
+		{
+			input << x, 1.0 - x, x * x;
+			ASSERT_TRUE(network.ComputeOutput(input));
+			ASSERT_TRUE(model.ComputeOutput(input));
+			EXPECT_DOUBLE_EQ(network.GetOutputActivation(0), model.GetOutputActivation(0));
+			EXPECT_DOUBLE_EQ(network.GetOutputActivation(1), model.GetOutputActivation(1));
+		}
+	}
+
+	TEST(MappedModelTest, CopyWeightsToRestoresTrainableNetwork)
+	{
+		// given
+		auto original = GetMultilayerPerceptronWithPredefinedWeights();
+		const auto path = (std::filesystem::temp_directory_path() / "nns_mapped_model_copy.bin").string();
+		SaveModel(*original, path);
+		MultilayerPerceptron restored{ 2, 2, 1 };
+
+		// when
+		MappedModel{ path }.CopyWeightsTo(restored);
+
+		// then
+		EXPECT_EQ(original->GetWeightMatrix(), restored.GetWeightMatrix());
+		MultilayerPerceptron other_topology{ 2, 3, 1 };
+		EXPECT_THROW(MappedModel{ path }.CopyWeightsTo(other_topology), std::invalid_argument);
+	}
+
+	TEST(MappedModelTest, RejectsForeignOrTruncatedFiles)
+	{
+		// given
+		auto network = GetMultilayerPerceptronWithPredefinedWeights();
+		const auto path = (std::filesystem::temp_directory_path() / "nns_mapped_model_bad.bin").string();
+		SaveModel(*network, path);
+		const auto size = std::filesystem::file_size(path);
+
+		// when
+		std::filesystem::resize_file(path, size - 8);
+
+		// then
+		EXPECT_THROW(MappedModel{ path }, ModelFormatError);
+		EXPECT_THROW(MappedModel{ testHelpers::WriteTemporaryFile("nns_mapped_model_text.bin", "0.0\t1.0\t1.0\n0.0\t0.0\t0.0\n1.0\t1.0\t0.0\n") }, ModelFormatError);
+		EXPECT_THROW(MappedModel{ path + ".missing" }, std::runtime_error);
+	}
+
+	TEST(MappedModelTest, RejectsSizesThatOverflowBlockBounds)
+	{
+		// given
+		auto network = GetMultilayerPerceptronWithPredefinedWeights();
+		const auto path = (std::filesystem::temp_directory_path() / "nns_mapped_model_overflow.bin").string();
+		const auto write_at = [&path](std::streamoff offset, auto value)
+		{
+			std::fstream file{ path, std::ios::in | std::ios::out | std::ios::binary };
+			file.seekp(offset);
+			file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+		};
+
+		// when ( input size times 8 bytes per weight wraps the first weight block size to zero )
+		SaveModel(*network, path);
+		write_at(sizeof(ModelFileHeader), std::uint64_t{ 1 } << 61);
+
+		// then
+		EXPECT_THROW(MappedModel{ path }, ModelFormatError);
+
+		// when ( more layer records than the file can hold )
+		SaveModel(*network, path);
+		write_at(offsetof(ModelFileHeader, layerCount), std::numeric_limits<std::uint32_t>::max());
+
+		// then
+		EXPECT_THROW(MappedModel{ path }, ModelFormatError);
+
+		// when ( empty input layer )
+		SaveModel(*network, path);
+		write_at(sizeof(ModelFileHeader), std::uint64_t{ 0 });
+
+		// then
+		EXPECT_THROW(MappedModel{ path }, ModelFormatError);
+	}
+}
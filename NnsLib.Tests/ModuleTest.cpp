@@ -0,0 +1,173 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+	using namespace NNS::Modules;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+
+	namespace
+	{
+		TrainingDataSet MakeDataSet(size_t rows, size_t inputs, size_t outputs, unsigned int seed)
+		{
+			return testHelpers::MakeRandomDataSet(rows, inputs, seed, [outputs](InputLayer const&, size_t row)
+			{
+				OutputLayer output = OutputLayer::Zero(outputs);
+				output[row % outputs] = 1.0;
+				return output;
+			});
+		}
+
+		/** The README's torch example, activations applied through Functional. */
+		struct Model : Module
+		{
+			Model() : Module{ 8 }
+			{
+				in = Register(Linear(8, 16));
+				h = Register(Linear(16, 16));
+				out = Register(Linear(16, 3));
+			}
+
+			Tensor Forward(Tensor x) override
+			{
+				x = Functional::Relu(in(x));
+				x = Functional::HyperbolicTangent(h(x));
+				return Functional::Logistic(out(x));
+			}
+
+			ModuleHandle in, h, out;
+		};
+	}
+
+	TEST(ModuleTest, SequentialMatchesMultilayerPerceptron)
+	{
+		// given
+		MultilayerPerceptron perceptron{ 4, 8, 6, 2 };
+		testHelpers::InitializeWeights(perceptron, 1);
+
+		Sequential network{ 4 };
+		network.Add<Linear>(4, 8).Add<Logistic>().Add<Linear>(8, 6).Add<Logistic>().Add<Linear>(6, 2).Add<Logistic>().Build();
+		for (size_t i = 0; i < 3; ++i)
+			network.GetWeightMatrix()[2 * i] = perceptron.GetWeightMatrix()[i];
+
+		for (const auto isTraining : { true, false })
+		{
+			network.SetTrainingMode(isTraining);
+			for (const auto& sample : MakeDataSet(5, 4, 2, 2))
+			{
+				// when
+				ASSERT_TRUE(perceptron.ComputeOutput(sample.first));
+				ASSERT_TRUE(network.ComputeOutput(sample.first));
+
+				// then
+				EXPECT_TRUE(perceptron.GetActivationMatrix().back().isApprox(network.GetActivationMatrix().back(), 1e-12));
+				EXPECT_TRUE(perceptron.GetOutputNetInput().isApprox(network.GetOutputNetInput(), 1e-12));
+			}
+		}
+
+		EXPECT_EQ(NetworkLayerMap({ 4, 8, 8, 6, 6, 2, 2 }), network.GetNetworkLayerMap());
+		EXPECT_TRUE(network.GetWeightMatrix()[1].empty());
+	}
+
+	TEST(ModuleTest, GradientMatchesFiniteDifference)
+	{
+		// given
+		Model network;
+		network.Build();
+		testHelpers::InitializeWeights(network, 3);
+		const auto data_set = MakeDataSet(4, 8, 3, 4);
+
+		// when, then
+		testHelpers::ExpectGradientMatchesFiniteDifference(network, data_set, ErrorCalculationMethod::MeanSquareError);
+		testHelpers::ExpectGradientMatchesFiniteDifference(network, data_set, ErrorCalculationMethod::CategoricalCrossEntropy);
+	}
+
+	TEST(ModuleTest, MemoryPlanKeepsOnlyWhatBackwardNeeds)
+	{
+		// given
+		const size_t width = 128;
+		const size_t depth = 8;
+		Sequential network{ width };
+		for (size_t i = 0; i < depth; ++i)
+			network.Add<Linear>(width, width).Add<Relu>();
+		network.Build();
+		const size_t hidden_signals = (2 * depth - 1) * width;
+
+		// then
+		/* Relu outputs are kept ( inputs of the next Linear ), Linear outputs go through scratch buffers. */
+		EXPECT_EQ((depth - 1) * width + 2 * width, network.GetActivationMemory());
+		EXPECT_LT(network.GetActivationMemory(), hidden_signals);
+		EXPECT_NO_THROW(network.GetActivation(2, 0));
+		EXPECT_THROW(network.GetActivation(1, 0), std::invalid_argument);
+
+		// when
+		network.SetTrainingMode(false);
+
+		// then
+		EXPECT_EQ(2 * width, network.GetActivationMemory());
+		EXPECT_THROW(network.GetActivation(2, 0), std::invalid_argument);
+	}
+
+	TEST(ModuleTest, TrainsAndInfersWithSameWeights)
+	{
+		// given
+		Model network;
+		network.Build();
+		testHelpers::InitializeWeights(network, 5);
+		auto training_set = MakeDataSet(60, 8, 3, 6);
+		for (size_t i = 0; i < training_set.size(); ++i) /* First input tells the class. */
+			training_set[i].first[0] = static_cast<SignalUnit>(i % 3) / 2.0;
+
+		TrainingErrorState error_state{ network, training_set };
+		Backpropagation optimizer{ 0.02, 0.9 };
+		optimizer.Initialize(network);
+		const auto initial_error = error_state.ComputeEpochError();
+
+		// when
+		for (int epoch = 0; epoch < 100; ++epoch)
+		{
+			error_state.UpdateErrorVector(error_state.ComputeEpochGradient());
+			optimizer.OptimizeWeights(network, error_state);
+		}
+		const auto trained_error = error_state.ComputeEpochError();
+		const auto copy = network.Clone();
+		network.SetTrainingMode(false);
+
+		// then
+		EXPECT_LT(trained_error, initial_error / 4);
+		EXPECT_DOUBLE_EQ(trained_error, error_state.ComputeEpochError());
+		EXPECT_THROW(error_state.ComputeEpochGradient(), std::invalid_argument);
+
+		TrainingErrorState copy_state{ *copy, training_set };
+		EXPECT_DOUBLE_EQ(trained_error, copy_state.ComputeEpochError());
+	}
+
+	TEST(ModuleTest, RejectsInvalidGraphs)
+	{
+		struct Branching : Module
+		{
+			Branching() : Module{ 2 } { a = Register(Linear(2, 2)); b = Register(Linear(2, 2)); }
+			Tensor Forward(Tensor x) override { a(x); return b(x); }
+			ModuleHandle a, b;
+		};
+		struct Shared : Module
+		{
+			Shared() : Module{ 2 } { a = Register(Linear(2, 2)); }
+			Tensor Forward(Tensor x) override { return a(a(x)); }
+			ModuleHandle a;
+		};
+
+		Branching branching;
+		EXPECT_THROW(branching.Build(), std::invalid_argument);
+		Shared shared;
+		EXPECT_THROW(shared.Build(), std::invalid_argument);
+
+		Sequential mismatched{ 3 };
+		mismatched.Add<Linear>(2, 2);
+		EXPECT_THROW(mismatched.Build(), std::invalid_argument);
+		EXPECT_FALSE(mismatched.ComputeOutput(InputLayer::Zero(3)));
+	}
+}
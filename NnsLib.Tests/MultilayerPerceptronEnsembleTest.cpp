@@ -0,0 +1,117 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+
+	namespace
+	{
+		/** Independently trained members usually differ in hidden widths, one of them is sparse. */
+		vector<MultilayerPerceptron> MakeMembers()
+		{
+			vector<MultilayerPerceptron> members{ MultilayerPerceptron{ 4, 6, 5, 3 }, MultilayerPerceptron{ 4, 3, 7, 3 }, MultilayerPerceptron{ 4, 8, 2, 3 } };
+
+			ConnectivityPattern pattern(7, 3);
+			for (int j = 0; j < 7; ++j)
+			{
+				pattern.insert(j, j % 3) = 1.0;
+				if (j % 2 == 0)
+					pattern.insert(j, (j + 2) % 3) = 1.0;
+			}
+			members[1].SetConnectivity(2, pattern);
+
+			for (size_t m = 0; m < members.size(); ++m)
+				testHelpers::InitializeWeights(members[m], static_cast<unsigned int>(m + 1), 1.0);
+			return members;
+		}
+
+		vector<MultilayerPerceptron const*> Pointers(vector<MultilayerPerceptron> const& members)
+		{
+			vector<MultilayerPerceptron const*> pointers;
+			for (const auto& member : members)
+				pointers.push_back(&member);
+			return pointers;
+		}
+	}
+
+	TEST(MultilayerPerceptronEnsembleTest, AverageMatchesMembersComputedAlone)
+	{
+		// given
+		auto members = MakeMembers();
+		MultilayerPerceptronEnsemble ensemble{ Pointers(members) };
+		ASSERT_EQ(3u, ensemble.GetMemberCount());
+
+		for (double x = -2.0; x <= 2.0; x += 0.5)
+		{
+			InputLayer input(4);
+			input << x, -x, x * x, 1.0;
+
+			// when
+			ASSERT_TRUE(ensemble.ComputeOutput(input));
+
+			// then
+			OutputLayer expected = OutputLayer::Zero(3);
+			for (size_t m = 0; m < members.size(); ++m)
+			{
+				ASSERT_TRUE(members[m].ComputeOutput(input));
+				for (int k = 0; k < 3; ++k)
+					EXPECT_NEAR(members[m].GetOutputActivation(k), ensemble.GetMemberOutputs()(k, static_cast<Eigen::Index>(m)), 1e-14);
+				expected += members[m].GetActivationMatrix().back();
+			}
+			expected /= 3.0;
+
+			for (int k = 0; k < 3; ++k)
+				EXPECT_NEAR(expected[k], ensemble.GetOutputActivation(k), 1e-14);
+		}
+
+		EXPECT_FALSE(ensemble.ComputeOutput(InputLayer::Zero(3)));
+	}
+
+	TEST(MultilayerPerceptronEnsembleTest, CombinersArePluggable)
+	{
+		// given
+		const SignalUnit binary[] = { 0.9, 0.2, 0.6, 0.4 };
+		const SignalUnit classes[] = { 0.1, 0.8, 0.3,   0.7, 0.2, 0.1,   0.2, 0.6, 0.5,   0.3, 0.9, 0.1 };
+		OutputLayer binary_vote(1), class_vote(3), average(3);
+
+		// when
+		MajorityVote(MemberOutputs(binary, 1, 4), binary_vote);
+		MajorityVote(MemberOutputs(classes, 3, 4), class_vote);
+		AverageOutputs(MemberOutputs(classes, 3, 4), average);
+
+		// then
+		EXPECT_DOUBLE_EQ(0.5, binary_vote[0]);
+		EXPECT_DOUBLE_EQ(0.25, class_vote[0]);
+		EXPECT_DOUBLE_EQ(0.75, class_vote[1]);
+		EXPECT_DOUBLE_EQ(0.0, class_vote[2]);
+		EXPECT_DOUBLE_EQ(0.325, average[0]);
+
+		// given
+		auto members = MakeMembers();
+		MultilayerPerceptronEnsemble maximum{ Pointers(members), [](MemberOutputs const& outputs, OutputLayer& output) { output = outputs.rowwise().maxCoeff(); } };
+		InputLayer input(4);
+		input << 0.5, -1.0, 0.25, 1.0;
+
+		// when
+		ASSERT_TRUE(maximum.ComputeOutput(input));
+
+		// then
+		for (int k = 0; k < 3; ++k)
+			EXPECT_DOUBLE_EQ(maximum.GetMemberOutputs().row(k).maxCoeff(), maximum.GetOutputActivation(k));
+	}
+
+	TEST(MultilayerPerceptronEnsembleTest, RejectsIncompatibleMembers)
+	{
+		MultilayerPerceptron member{ 4, 6, 3 };
+		MultilayerPerceptron other_inputs{ 5, 6, 3 };
+		MultilayerPerceptron other_outputs{ 4, 6, 2 };
+		MultilayerPerceptron other_depth{ 4, 6, 6, 3 };
+
+		EXPECT_THROW(MultilayerPerceptronEnsemble({}), std::invalid_argument);
+		EXPECT_THROW(MultilayerPerceptronEnsemble({ &member, &other_inputs }), std::invalid_argument);
+		EXPECT_THROW(MultilayerPerceptronEnsemble({ &member, &other_outputs }), std::invalid_argument);
+		EXPECT_THROW(MultilayerPerceptronEnsemble({ &member, &other_depth }), std::invalid_argument);
+	}
+}
@@ -0,0 +1,130 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+	using namespace NNS::Initialization;
+
+	namespace
+	{
+		TrainingDataSet MakeDataSet(size_t rows)
+		{
+			return testHelpers::MakeRandomDataSet(rows, 3, 5, [](InputLayer const& input, size_t)
+			{
+				return OutputLayer::Constant(1, input[0] > input[1] ? 0.9 : 0.1);
+			});
+		}
+
+		void ExpectSameOutputs(MultilayerPerceptron& expected, MultilayerPerceptron& actual, TrainingDataSet const& data_set)
+		{
+			for (const auto& sample : data_set)
+			{
+				expected.ComputeOutput(sample.first);
+				actual.ComputeOutput(sample.first);
+				EXPECT_NEAR(expected.GetOutputActivation(0), actual.GetOutputActivation(0), 1e-12);
+			}
+		}
+	}
+
+	TEST(NeuronPruningTest, ConstantNeuronsAreFoldedIntoNextLayerBias)
+	{
+		// given
+		MultilayerPerceptron network{ 3, 6, 4, 1 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		weight_init.InitializeWeights(network);
+		for (int j : { 1, 4 }) /* Saturated neurons, activation does not depend on inputs. */
+		{
+			for (int k = 0; k < 3; ++k)
+				network.Weight(1, j, k) = 0.0;
+			network.Bias(1, j) = 2.0 + j;
+		}
+		network.Weight(2, 0, 1) = 1.5;
+		network.Weight(2, 3, 4) = -2.0;
+		const auto data_set = MakeDataSet(100);
+		NeuronPruning pruning{ NeuronPruningConfig{ NeuronScoreMethod::ActivationVariance, 0.34 } };
+
+		// when
+		auto pruned = pruning.Prune(network, data_set);
+
+		// then
+		EXPECT_EQ((NetworkLayerMap{ 3, 4, 3, 1 }), pruned.GetNetworkLayerMap());
+		EXPECT_NEAR(0.0, pruning.GetScores()[0][1], 1e-15);
+		EXPECT_NEAR(0.0, pruning.GetScores()[0][4], 1e-15);
+
+		/* Second hidden layer lost a neuron that does vary, so compare the first hidden layer only. */
+		NeuronPruning first_layer_only{ NeuronPruningConfig{ NeuronScoreMethod::ActivationVariance, 0.34, 1e-20 } };
+		auto exact = first_layer_only.Prune(network, data_set);
+		EXPECT_EQ((NetworkLayerMap{ 3, 4, 4, 1 }), exact.GetNetworkLayerMap());
+		ExpectSameOutputs(network, exact, data_set);
+	}
+
+	TEST(NeuronPruningTest, NeuronsWithoutOutgoingWeightsAreRemoved)
+	{
+		// given
+		MultilayerPerceptron network{ 3, 5, 1 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		weight_init.InitializeWeights(network);
+		network.Weight(2, 0, 2) = 0.0;
+		const auto data_set = MakeDataSet(50);
+		NeuronPruning pruning{ NeuronPruningConfig{ NeuronScoreMethod::OutgoingWeightMagnitude, 1.0, 0.0 } };
+
+		// when
+		auto pruned = pruning.Prune(network, data_set);
+
+		// then
+		EXPECT_EQ((NetworkLayerMap{ 3, 4, 1 }), pruned.GetNetworkLayerMap());
+		ExpectSameOutputs(network, pruned, data_set);
+	}
+
+	TEST(NeuronPruningTest, ErrorIncreaseKeepsLayerSizeLimitAndFineTunes)
+	{
+		// given
+		MultilayerPerceptron network{ 3, 8, 1 };
+		const auto data_set = MakeDataSet(200);
+		ConjugateGradient algorithm{ 0.0001, 20 };
+		SupervisedTraining trainer{ algorithm, 50, 0.001 };
+		testHelpers::InitializeWeights(network, 17);
+		trainer.Train(network, data_set);
+		const auto trained_weights = network.GetWeightMatrix();
+
+		SupervisedTraining fine_tuning{ algorithm, 20, 0.001 };
+		NeuronPruning pruning{ NeuronPruningConfig{ NeuronScoreMethod::ErrorIncrease, 1.0, std::numeric_limits<SignalUnit>::max(), 3 } };
+
+		// when
+		auto pruned = pruning.Prune(network, data_set);
+		auto fine_tuned = pruning.Prune(network, data_set, &fine_tuning);
+
+		// then
+		EXPECT_EQ((NetworkLayerMap{ 3, 3, 1 }), pruned.GetNetworkLayerMap());
+		EXPECT_EQ(trained_weights, network.GetWeightMatrix());
+
+		TrainingErrorState pruned_state(pruned, data_set);
+		TrainingErrorState fine_tuned_state(fine_tuned, data_set);
+		EXPECT_LT(fine_tuned_state.ComputeEpochError(), pruned_state.ComputeEpochError());
+	}
+
+	TEST(NeuronPruningTest, SparseLayersAreRejected)
+	{
+		MultilayerPerceptron network{ 2, 2, 1 };
+		ConnectivityPattern pattern(2, 2);
+		pattern.insert(0, 0) = 1.0;
+		pattern.insert(1, 1) = 1.0;
+		network.SetConnectivity(1, pattern);
+		NeuronPruning pruning;
+
+		EXPECT_THROW(pruning.Prune(network, MakeDataSet(4)), std::invalid_argument);
+	}
+
+	TEST(NeuronPruningTest, InvalidSettingsAreRejected)
+	{
+		NeuronPruningConfig fraction_too_large;
+		fraction_too_large.pruneFraction = 1.5;
+		NeuronPruningConfig empty_layers;
+		empty_layers.minLayerSize = 0;
+
+		EXPECT_THROW(NeuronPruning{ fraction_too_large }, std::invalid_argument);
+		EXPECT_THROW(NeuronPruning{ empty_layers }, std::invalid_argument);
+	}
+}
\ No newline at end of file
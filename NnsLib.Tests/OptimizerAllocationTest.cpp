@@ -0,0 +1,131 @@
+#include "pch.h"
+
+/* Eigen allocates with malloc, which the counting operator new does not see. Eigen checks its own allocations in the test-only
+* build with EIGEN_RUNTIME_NO_MALLOC ( NNS_EIGEN_RUNTIME_NO_MALLOC in CMake, NnsEigenRuntimeNoMalloc in MSBuild ), see Common/EigenSettings.h.
+* Other builds count operator new alone.
+*/
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+
+	namespace
+	{
+		/** Makes every Eigen heap allocation throw while in scope, does nothing unless Eigen checks its allocations. */
+		class EigenMallocForbidden final
+		{
+		public:
+			EigenMallocForbidden() { SetMallocAllowed(false); }
+			~EigenMallocForbidden() { SetMallocAllowed(true); }
+
+		private:
+			static void SetMallocAllowed(bool allowed)
+			{
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+				Eigen::internal::set_is_malloc_allowed(allowed);
+#else
+				(void)allowed;
+#endif
+			}
+		};
+
+		/** Allocations made by a few epochs of the optimizer once it was initialized, the gradient computation included. */
+		size_t CountEpochAllocations(IWeightOptimizer& optimizer)
+		{
+			MultilayerPerceptron network{ 2, 5, 1 };
+			testHelpers::InitializeWeights(network, 7);
+			const auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
+			TrainingErrorState error_state{ network, training_set };
+			error_state.UpdateErrorVector(error_state.ComputeEpochError());
+
+			optimizer.Initialize(network);
+			return testHelpers::CountAllocations([&]()
+			{
+				EigenMallocForbidden forbidden;
+				for (int epoch = 0; epoch < 5; ++epoch)
+				{
+					error_state.ComputeEpochGradient();
+					optimizer.OptimizeWeights(network, error_state);
+				}
+			});
+		}
+	}
+
+	TEST(OptimizerAllocationTest, CountingAllocatorSeesWeightCopies)
+	{
+		// given
+		MultilayerPerceptron network{ 2, 5, 1 };
+
+		// when
+		const auto allocations = testHelpers::CountAllocations([&]() { const auto copy = network.GetWeightMatrix(); });
+
+		// then
+		EXPECT_GT(allocations, 0u);
+	}
+
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+	TEST(OptimizerAllocationTest, ForbiddenEigenAllocationThrows)
+	{
+		// given
+		EigenMallocForbidden forbidden;
+
+		// when, then
+		EXPECT_THROW(ActivationVector(64).setZero(), std::logic_error);
+	}
+#endif
+
+	TEST(OptimizerAllocationTest, OptimizersWorkWithoutInitialize)
+	{
+		// given
+		MultilayerPerceptron network{ 2, 5, 1 };
+		testHelpers::InitializeWeights(network, 7);
+		const auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
+		TrainingErrorState error_state{ network, training_set };
+		const auto initial_error = error_state.ComputeEpochError();
+		error_state.UpdateErrorVector(initial_error);
+
+		SimulatedAnnealingConfig config;
+		config.temperatureNumber = 3;
+		config.temperatureIters = 20;
+		SimulatedAnnealing annealing{ config };
+		ConjugateGradient conjugate_gradient{ 0.0001, 50, 5 };
+
+		// when
+		annealing.OptimizeWeights(network, error_state);
+		error_state.ComputeEpochGradient();
+		conjugate_gradient.OptimizeWeights(network, error_state);
+
+		// then
+		EXPECT_LE(error_state.ComputeEpochError(), initial_error);
+	}
+
+	TEST(OptimizerAllocationTest, BackpropagationDoesNotAllocateAfterInitialize)
+	{
+		Backpropagation optimizer{ 0.25, 0.9 };
+		EXPECT_EQ(0u, CountEpochAllocations(optimizer));
+	}
+
+	TEST(OptimizerAllocationTest, ConjugateGradientDoesNotAllocateAfterInitialize)
+	{
+		ConjugateGradient optimizer{ 0.0001, 50, 5 };
+		EXPECT_EQ(0u, CountEpochAllocations(optimizer));
+	}
+
+	TEST(OptimizerAllocationTest, SimulatedAnnealingDoesNotAllocateAfterInitialize)
+	{
+		for (const auto distribution : { RandomDistributionMethod::Normal, RandomDistributionMethod::Uniform })
+		{
+			SimulatedAnnealingConfig config;
+			config.temperatureNumber = 3;
+			config.temperatureIters = 20;
+			config.setback = 5;
+			config.perturbationDistribution = distribution;
+			SimulatedAnnealing optimizer{ config };
+			EXPECT_EQ(0u, CountEpochAllocations(optimizer));
+		}
+	}
+}
\ No newline at end of file
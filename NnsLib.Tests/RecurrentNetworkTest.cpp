@@ -0,0 +1,223 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+
+	namespace
+	{
+		TrainingDataSet MakeRandomSequences(RecurrentNetwork const& network, size_t rows, unsigned int seed)
+		{
+			std::mt19937 random_generator(seed);
+			std::uniform_real_distribution<SignalUnit> random01(0, 1);
+			const auto networkmap = network.GetNetworkLayerMap();
+
+			TrainingDataSet data_set;
+			for (size_t i = 0; i < rows; ++i)
+			{
+				InputLayer input(networkmap.front());
+				for (auto& value : input)
+					value = random01(random_generator);
+				OutputLayer output(networkmap.back());
+				for (auto& value : output)
+					value = random01(random_generator) > 0.5 ? 1.0 : 0.0;
+				data_set.emplace_back(std::move(input), std::move(output));
+			}
+			return data_set;
+		}
+
+		/** Noisy sequences whose class is decided by the first step only, the network has to carry it to the last step. */
+		TrainingDataSet MakeRememberFirstStep(size_t rows, size_t steps, unsigned int seed)
+		{
+			std::mt19937 random_generator(seed);
+			std::uniform_real_distribution<SignalUnit> random01(0, 1);
+
+			TrainingDataSet data_set;
+			for (size_t i = 0; i < rows; ++i)
+			{
+				const auto isSet = i % 2 == 0;
+				InputLayer input(steps);
+				for (auto& value : input)
+					value = 0.5 * random01(random_generator);
+				input[0] = isSet ? 1.0 : 0.0;
+
+				OutputLayer output(1); output << (isSet ? 1.0 : 0.0);
+				data_set.emplace_back(std::move(input), std::move(output));
+			}
+			return data_set;
+		}
+
+		RecurrentNetworkConfig MakeStackedConfig(RecurrentCellType cell, RecurrentOutputType output)
+		{
+			RecurrentNetworkConfig config;
+			config.cell = cell;
+			config.output = output;
+			config.inputs = 2;
+			config.steps = 5;
+			config.hiddenLayers = { 3, 2 };
+			config.outputs = 2;
+			return config;
+		}
+	}
+
+	TEST(RecurrentNetworkTest, LongShortTermMemoryGradientMatchesFiniteDifference)
+	{
+		// given
+		RecurrentNetwork network{ MakeStackedConfig(RecurrentCellType::LongShortTermMemory, RecurrentOutputType::EachStep) };
+		testHelpers::InitializeWeights(network, 1);
+
+		// then
+		testHelpers::ExpectGradientMatchesFiniteDifference(network, MakeRandomSequences(network, 3, 2), ErrorCalculationMethod::BinaryCrossEntropy);
+	}
+
+	TEST(RecurrentNetworkTest, GatedRecurrentUnitGradientMatchesFiniteDifference)
+	{
+		// given
+		RecurrentNetwork network{ MakeStackedConfig(RecurrentCellType::GatedRecurrentUnit, RecurrentOutputType::LastStep) };
+		testHelpers::InitializeWeights(network, 3);
+
+		// then
+		testHelpers::ExpectGradientMatchesFiniteDifference(network, MakeRandomSequences(network, 3, 4), ErrorCalculationMethod::BinaryCrossEntropy);
+	}
+
+	TEST(RecurrentNetworkTest, TruncationStopsErrorFlowBeforeWindow)
+	{
+		for (const auto cell : { RecurrentCellType::LongShortTermMemory, RecurrentCellType::GatedRecurrentUnit })
+		{
+			// given
+			RecurrentNetworkConfig config;
+			config.cell = cell;
+			config.inputs = 2;
+			config.steps = 12;
+			config.hiddenLayers = { 4 };
+			RecurrentNetwork network{ config };
+			testHelpers::InitializeWeights(network, 5);
+
+			/* Second feature is only present before the last 4 steps. */
+			auto data_set = MakeRandomSequences(network, 4, 6);
+			for (auto& sample : data_set)
+				sample.second[0] = 1.0;
+			for (auto& sample : data_set)
+				for (size_t t = 8; t < 12; ++t)
+					sample.first[t * 2 + 1] = 0.0;
+
+			config.truncation = 4;
+			RecurrentNetwork truncated{ config };
+			truncated.GetWeightMatrix() = network.GetWeightMatrix();
+
+			// when
+			TrainingErrorState full_state{ network, data_set };
+			full_state.ComputeEpochGradient();
+			TrainingErrorState truncated_state{ truncated, data_set };
+			truncated_state.ComputeEpochGradient();
+
+			// then
+			const auto& full_gradient = full_state.GetErrorGradient();
+			const auto& truncated_gradient = truncated_state.GetErrorGradient();
+			for (size_t j = 0; j < truncated_gradient[0].size(); ++j) /* Each gate of each unit */
+			{
+				EXPECT_EQ(0.0, truncated_gradient[0][j][1]);
+				EXPECT_NE(0.0, truncated_gradient[0][j][0]);
+			}
+			EXPECT_NE(0.0, full_gradient[0][0][1]);
+			EXPECT_EQ(full_gradient.back(), truncated_gradient.back());
+		}
+	}
+
+	TEST(RecurrentNetworkTest, LearnsToRememberFirstStep)
+	{
+		for (const auto cell : { RecurrentCellType::LongShortTermMemory, RecurrentCellType::GatedRecurrentUnit })
+		{
+			// given
+			RecurrentNetworkConfig config;
+			config.cell = cell;
+			config.steps = 10;
+			config.hiddenLayers = { 4 };
+			RecurrentNetwork network{ config };
+			testHelpers::InitializeWeights(network, 7);
+			const auto training_set = MakeRememberFirstStep(100, config.steps, 8);
+			const auto test_set = MakeRememberFirstStep(50, config.steps, 9);
+
+			TrainingErrorState error_state{ network, training_set };
+			error_state.SetErrorComputationMethod(ErrorCalculationMethod::BinaryCrossEntropy);
+			Backpropagation optimizer{ 0.005, 0.9 };
+			optimizer.Initialize(network);
+
+			// when
+			for (int epoch = 0; epoch < 400; ++epoch)
+			{
+				error_state.UpdateErrorVector(error_state.ComputeEpochGradient());
+				optimizer.OptimizeWeights(network, error_state);
+			}
+
+			// then
+			size_t misclassified = 0;
+			for (const auto& sample : test_set)
+			{
+				network.ComputeOutput(sample.first);
+				misclassified += (network.GetOutputActivation(0) > 0.5) != (sample.second[0] > 0.5) ? 1 : 0;
+			}
+			EXPECT_EQ(0u, misclassified);
+		}
+	}
+
+	TEST(RecurrentNetworkTest, TrainsOnLongSequence)
+	{
+		// given
+		RecurrentNetworkConfig config;
+		config.output = RecurrentOutputType::EachStep;
+		config.steps = 2000;
+		config.hiddenLayers = { 8 };
+		config.truncation = 50;
+		RecurrentNetwork network{ config };
+		testHelpers::InitializeWeights(network, 10);
+
+		/* Next value of a noisy sine wave. */
+		std::mt19937 random_generator(11);
+		std::uniform_real_distribution<SignalUnit> noise(-0.05, 0.05);
+		InputLayer input(config.steps);
+		OutputLayer output(config.steps);
+		auto value = [&](size_t t) { return 0.5 + 0.4 * sin(0.3 * static_cast<double>(t)) + noise(random_generator); };
+		input[0] = value(0);
+		for (size_t t = 0; t < config.steps; ++t)
+		{
+			output[t] = value(t + 1);
+			if (t + 1 < config.steps)
+				input[t + 1] = output[t];
+		}
+		const TrainingDataSet training_set{ { input, output } };
+
+		TrainingErrorState error_state{ network, training_set };
+		Backpropagation optimizer{ 0.003, 0.9 };
+		optimizer.Initialize(network);
+		const auto initial_error = error_state.ComputeEpochError();
+
+		// when
+		for (int epoch = 0; epoch < 60; ++epoch)
+		{
+			error_state.UpdateErrorVector(error_state.ComputeEpochGradient());
+			optimizer.OptimizeWeights(network, error_state);
+		}
+
+		// then
+		EXPECT_LT(error_state.ComputeEpochError(), initial_error / 4);
+	}
+
+	TEST(RecurrentNetworkTest, RejectsInvalidConfig)
+	{
+		RecurrentNetworkConfig config;
+		config.steps = 0;
+		EXPECT_THROW(RecurrentNetwork{ config }, std::invalid_argument);
+
+		config.steps = 3;
+		config.hiddenLayers = { 4, 0 };
+		EXPECT_THROW(RecurrentNetwork{ config }, std::invalid_argument);
+
+		config.hiddenLayers.clear();
+		EXPECT_THROW(RecurrentNetwork{ config }, std::invalid_argument);
+	}
+}
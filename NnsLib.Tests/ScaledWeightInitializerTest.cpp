@@ -0,0 +1,112 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using namespace NNS::Models;
+	using namespace NNS::Initialization;
+
+	namespace
+	{
+		/** Mean and variance of all connection weights ( bias excluded ) of a layer. */
+		pair<double, double> GetWeightStatistics(MultilayerPerceptron& network, int layerId)
+		{
+			double sum = 0.0, squaredSum = 0.0, count = 0.0;
+			for (const auto& weightVect : network.GetWeightMatrix()[layerId - 1])
+			{
+				const auto connections = weightVect.head(weightVect.size() - 1);
+				sum += connections.sum();
+				squaredSum += connections.squaredNorm();
+				count += static_cast<double>(connections.size());
+			}
+			const auto mean = sum / count;
+			return { mean, squaredSum / count - mean * mean };
+		}
+	}
+
+	TEST(ScaledWeightInitializerTest, PhiloxMatchesKnownAnswers)
+	{
+		EXPECT_EQ((PhiloxRandom::Counter{ 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 }), PhiloxRandom{ 0 }({ 0, 0, 0, 0 }));
+		EXPECT_EQ((PhiloxRandom::Counter{ 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd }), PhiloxRandom{ 0xffffffffffffffffull }({ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }));
+	}
+
+	TEST(ScaledWeightInitializerTest, WeightsDoNotDependOnThreadCount)
+	{
+		// given
+		MultilayerPerceptron single_thread{ 512, 512, 512, 10 };
+		MultilayerPerceptron multi_thread{ 512, 512, 512, 10 };
+		MultilayerPerceptron other_seed{ 512, 512, 512, 10 };
+
+		// when
+		ScaledWeightInitializer{ ScaledWeightInitializerConfig{ WeightScaling::Xavier, WeightDistribution::Normal, 0.5, 0.0, 7, 1 } }.InitializeWeights(single_thread);
+		ScaledWeightInitializer{ ScaledWeightInitializerConfig{ WeightScaling::Xavier, WeightDistribution::Normal, 0.5, 0.0, 7, 8 } }.InitializeWeights(multi_thread);
+		ScaledWeightInitializer{ ScaledWeightInitializerConfig{ WeightScaling::Xavier, WeightDistribution::Normal, 0.5, 0.0, 8, 8 } }.InitializeWeights(other_seed);
+
+		// then
+		EXPECT_EQ(single_thread.GetWeightMatrix(), multi_thread.GetWeightMatrix());
+		EXPECT_NE(single_thread.GetWeightMatrix(), other_seed.GetWeightMatrix());
+	}
+
+	TEST(ScaledWeightInitializerTest, XavierUniformStaysWithinGlorotLimit)
+	{
+		// given
+		MultilayerPerceptron network{ 200, 100, 10 };
+		ScaledWeightInitializer initializer{ ScaledWeightInitializerConfig{ WeightScaling::Xavier, WeightDistribution::Uniform, 0.5, 0.25 } };
+
+		// when
+		initializer.InitializeWeights(network);
+
+		// then
+		const auto limit = std::sqrt(6.0 / (200 + 100));
+		EXPECT_DOUBLE_EQ(limit, initializer.GetSpread(network, 1));
+		for (const auto& weightVect : network.GetWeightMatrix()[0])
+		{
+			EXPECT_LE(weightVect.head(200).cwiseAbs().maxCoeff(), limit);
+			EXPECT_EQ(0.25, weightVect[200]);
+		}
+
+		const auto statistics = GetWeightStatistics(network, 1);
+		EXPECT_NEAR(0.0, statistics.first, 0.01);
+		EXPECT_NEAR(2.0 / (200 + 100), statistics.second, 0.05 * 2.0 / (200 + 100));
+	}
+
+	TEST(ScaledWeightInitializerTest, HeNormalVarianceFollowsFanIn)
+	{
+		// given
+		MultilayerPerceptron network{ 400, 300, 50 };
+		ScaledWeightInitializer initializer{ ScaledWeightInitializerConfig{ WeightScaling::He, WeightDistribution::Normal } };
+
+		// when
+		initializer.InitializeWeights(network);
+
+		// then
+		EXPECT_NEAR(2.0 / 400, GetWeightStatistics(network, 1).second, 0.05 * 2.0 / 400);
+		EXPECT_NEAR(2.0 / 300, GetWeightStatistics(network, 2).second, 0.1 * 2.0 / 300);
+	}
+
+	TEST(ScaledWeightInitializerTest, SparseLayerGetsWeightsOfSameConnections)
+	{
+		// given
+		MultilayerPerceptron dense{ 4, 3, 1 };
+		MultilayerPerceptron sparse{ 4, 3, 1 };
+		ConnectivityPattern pattern(3, 4);
+		pattern.insert(0, 1) = 1.0;
+		pattern.insert(1, 0) = 1.0;
+		pattern.insert(1, 3) = 1.0;
+		pattern.insert(2, 2) = 1.0;
+		sparse.SetConnectivity(1, pattern);
+		ScaledWeightInitializer initializer{ ScaledWeightInitializerConfig{ WeightScaling::Fixed, WeightDistribution::Uniform, 0.5 } };
+
+		// when
+		initializer.InitializeWeights(dense);
+		initializer.InitializeWeights(sparse);
+
+		// then
+		const auto& denseWeights = dense.GetWeightMatrix()[0];
+		const auto& sparseWeights = sparse.GetWeightMatrix()[0];
+		EXPECT_EQ(denseWeights[0][1], sparseWeights[0][0]);
+		EXPECT_EQ(denseWeights[1][0], sparseWeights[1][0]);
+		EXPECT_EQ(denseWeights[1][3], sparseWeights[1][1]);
+		EXPECT_EQ(denseWeights[2][2], sparseWeights[2][0]);
+		EXPECT_EQ(dense.GetWeightMatrix()[1], sparse.GetWeightMatrix()[1]);
+	}
+}
@@ -0,0 +1,148 @@
+#include "pch.h"
+
+#include <numeric>
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Initialization;
+
+	namespace
+	{
+		TrainingDataSet MakeUniformSquare(size_t points, unsigned int seed)
+		{
+			std::mt19937 random_generator(seed);
+			std::uniform_real_distribution<double> random01(0, 1);
+
+			TrainingDataSet data_set;
+			for (size_t i = 0; i < points; ++i)
+			{
+				InputLayer input(2);
+				input << random01(random_generator), random01(random_generator);
+				data_set.emplace_back(input, OutputLayer(0));
+			}
+			return data_set;
+		}
+
+		size_t BruteForceBestMatchingUnit(KohonenNetwork& network, InputLayer const& input)
+		{
+			const auto& neurons = network.GetWeightMatrix()[0];
+			size_t best = 0;
+			for (size_t j = 1; j < neurons.size(); ++j)
+			{
+				if ((neurons[j] - input).squaredNorm() < (neurons[best] - input).squaredNorm())
+					best = j;
+			}
+			return best;
+		}
+	}
+
+	TEST(SelfOrganizingMapTrainingTest, CodebookSearchMatchesBruteForce)
+	{
+		// given
+		KohonenNetwork network{ 2, 7, 5 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		weight_init.InitializeWeights(network);
+		const auto data_set = MakeUniformSquare(300, 7);
+
+		KohonenCodebook codebook{ network };
+		RowMatrix samples(static_cast<Eigen::Index>(data_set.size()), 2);
+		for (size_t i = 0; i < data_set.size(); ++i)
+			samples.row(static_cast<Eigen::Index>(i)) = data_set[i].first.transpose();
+
+		// when
+		vector<size_t> best_units;
+		codebook.FindBestMatchingUnits(samples, best_units);
+
+		// then
+		ASSERT_EQ(data_set.size(), best_units.size());
+		for (size_t i = 0; i < data_set.size(); ++i)
+		{
+			const auto expected = BruteForceBestMatchingUnit(network, data_set[i].first);
+			EXPECT_EQ(expected, best_units[i]);
+			EXPECT_EQ(expected, codebook.FindBestMatchingUnit(data_set[i].first));
+			EXPECT_EQ(expected, network.FindBestMatchingUnit(data_set[i].first));
+		}
+	}
+
+	TEST(SelfOrganizingMapTrainingTest, OnlineTrainingOrdersOneDimensionalMap)
+	{
+		// given
+		KohonenNetwork network{ 1, 10 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		weight_init.InitializeWeights(network);
+
+		TrainingDataSet data_set;
+		for (int i = 0; i < 200; ++i)
+		{
+			InputLayer input(1);
+			input << i / 199.0;
+			data_set.emplace_back(input, OutputLayer(0));
+		}
+		SelfOrganizingMapTraining trainer{ SelfOrganizingMapConfig{ SelfOrganizingMapMode::Online, 50, 0.5, 0.01, 0.0, 0.5, 1, 42 } };
+
+		// when
+		trainer.Train(network, data_set);
+
+		// then
+		const auto& neurons = network.GetWeightMatrix()[0];
+		const bool ascending = neurons.front()[0] < neurons.back()[0];
+		for (size_t j = 1; j < neurons.size(); ++j)
+		{
+			EXPECT_EQ(ascending, neurons[j - 1][0] < neurons[j][0]) << "neuron " << j;
+		}
+		EXPECT_LT(trainer.GetQuantizationError(), 0.01);
+	}
+
+	TEST(SelfOrganizingMapTrainingTest, BatchTrainingMatchesAcrossThreadCounts)
+	{
+		// given
+		const auto data_set = MakeUniformSquare(5000, 11);
+		KohonenNetwork single_thread_network{ 2, 6, 6 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		weight_init.InitializeWeights(single_thread_network);
+		auto multi_thread_network = single_thread_network.Clone();
+
+		KohonenCodebook initial{ single_thread_network };
+		vector<size_t> units;
+		vector<SignalUnit> distances;
+		RowMatrix samples(static_cast<Eigen::Index>(data_set.size()), 2);
+		for (size_t i = 0; i < data_set.size(); ++i)
+			samples.row(static_cast<Eigen::Index>(i)) = data_set[i].first.transpose();
+		initial.FindBestMatchingUnits(samples, units, &distances);
+		const auto initial_error = std::accumulate(distances.begin(), distances.end(), 0.0) / data_set.size();
+
+		SelfOrganizingMapTraining single_thread{ SelfOrganizingMapConfig{ SelfOrganizingMapMode::Batch, 20, 0.5, 0.01, 0.0, 0.5, 1, 42 } };
+		SelfOrganizingMapTraining multi_thread{ SelfOrganizingMapConfig{ SelfOrganizingMapMode::Batch, 20, 0.5, 0.01, 0.0, 0.5, 4, 42 } };
+
+		// when
+		single_thread.Train(single_thread_network, data_set);
+		multi_thread.Train(dynamic_cast<KohonenNetwork&>(*multi_thread_network), data_set);
+
+		// then ( partial sums are reduced in a different order, so only up to rounding )
+		EXPECT_LT(single_thread.GetQuantizationError(), initial_error / 4);
+		EXPECT_NEAR(single_thread.GetQuantizationError(), multi_thread.GetQuantizationError(), 1e-9);
+
+		const auto& expected = single_thread_network.GetWeightMatrix()[0];
+		const auto& actual = multi_thread_network->GetWeightMatrix()[0];
+		for (size_t j = 0; j < expected.size(); ++j)
+			EXPECT_TRUE(expected[j].isApprox(actual[j], 1e-9)) << "neuron " << j;
+	}
+
+	TEST(SelfOrganizingMapTrainingTest, InvalidMapSizeIsRejected)
+	{
+		EXPECT_THROW(KohonenNetwork(2, 0, 3), std::invalid_argument);
+		EXPECT_THROW(KohonenNetwork(0, 4), std::invalid_argument);
+	}
+
+	TEST(SelfOrganizingMapTrainingTest, NonPositiveRadiusOrLearningRateIsRejected)
+	{
+		EXPECT_THROW(SelfOrganizingMapTraining(SelfOrganizingMapConfig{ SelfOrganizingMapMode::Batch, 10, 0.5, 0.01, 0.0, 0.0, 1, 42 }), std::invalid_argument);
+		EXPECT_THROW(SelfOrganizingMapTraining(SelfOrganizingMapConfig{ SelfOrganizingMapMode::Batch, 10, 0.5, 0.01, -1.0, 0.5, 1, 42 }), std::invalid_argument);
+		EXPECT_THROW(SelfOrganizingMapTraining(SelfOrganizingMapConfig{ SelfOrganizingMapMode::Online, 10, 0.5, 0.0, 0.0, 0.5, 1, 42 }), std::invalid_argument);
+		EXPECT_NO_THROW(SelfOrganizingMapTraining(SelfOrganizingMapConfig{ SelfOrganizingMapMode::Batch, 10, 0.0, 0.0, 0.0, 0.5, 1, 42 }));
+	}
+}
@@ -0,0 +1,210 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using std::vector;
+
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+	using namespace NNS::Initialization;
+	using namespace NNS::Serialization;
+
+	namespace
+	{
+		/** Pattern connecting roughly the given fraction of neuron pairs, every neuron keeps at least one connection. */
+		ConnectivityPattern MakeRandomPattern(size_t rows, size_t columns, double density, unsigned int seed)
+		{
+			std::mt19937 random_generator(seed);
+			std::uniform_real_distribution<double> random01(0, 1);
+
+			vector<Eigen::Triplet<WeightUnit>> connections;
+			for (size_t j = 0; j < rows; ++j)
+			{
+				connections.emplace_back(static_cast<int>(j), static_cast<int>(j % columns), 1.0);
+				for (size_t k = 0; k < columns; ++k)
+					if (k != j % columns && random01(random_generator) < density)
+						connections.emplace_back(static_cast<int>(j), static_cast<int>(k), 1.0);
+			}
+
+			ConnectivityPattern pattern(static_cast<Eigen::Index>(rows), static_cast<Eigen::Index>(columns));
+			pattern.setFromTriplets(connections.begin(), connections.end());
+			return pattern;
+		}
+
+		/** Dense copy of a sparse network, missing connections have zero weight. */
+		MultilayerPerceptron MakeDenseEquivalent(MultilayerPerceptron& sparse)
+		{
+			MultilayerPerceptron dense{ sparse.GetNetworkLayerMap() };
+			const auto& weightMatrix = sparse.GetWeightMatrix();
+
+			for (size_t i = 0; i < weightMatrix.size(); ++i)
+			{
+				const auto connectivity = sparse.GetConnectivity(static_cast<int>(i + 1));
+				for (size_t j = 0; j < weightMatrix[i].size(); ++j)
+				{
+					auto& denseWeights = dense.GetWeightMatrix()[i][j];
+					denseWeights.setZero();
+					denseWeights.tail(1)[0] = weightMatrix[i][j].tail(1)[0];
+
+					for (Eigen::Index c = 0; c + 1 < weightMatrix[i][j].size(); ++c)
+					{
+						const auto source = connectivity == nullptr ? c : connectivity->innerIndexPtr()[connectivity->outerIndexPtr()[j] + c];
+						denseWeights[source] = weightMatrix[i][j][c];
+					}
+				}
+			}
+			return dense;
+		}
+
+		MultilayerPerceptron MakeSparseNetwork()
+		{
+			MultilayerPerceptron network{ 6, 12, 8, 2 };
+			network.SetConnectivity(1, MakeRandomPattern(12, 6, 0.3, 1));
+			network.SetConnectivity(2, MakeRandomPattern(8, 12, 0.2, 2));
+
+			RandomWeightInitializer weight_init{ 0.5 };
+			weight_init.InitializeWeights(network);
+			return network;
+		}
+
+		TrainingDataSet MakeDataSet(size_t rows)
+		{
+			return testHelpers::MakeRandomDataSet(rows, 6, 3, [](InputLayer const& input, size_t)
+			{
+				OutputLayer output(2);
+				output << (input[0] > input[1] ? 0.9 : 0.1), (input[2] + input[5] > 1.0 ? 0.9 : 0.1);
+				return output;
+			});
+		}
+	}
+
+	TEST(SparseConnectivityTest, WeightVectorsHoldOnlyExistingConnections)
+	{
+		// given
+		MultilayerPerceptron network{ 6, 12, 8, 2 };
+		const auto pattern = MakeRandomPattern(12, 6, 0.3, 1);
+
+		// when
+		network.SetConnectivity(1, pattern);
+
+		// then
+		ASSERT_NE(nullptr, network.GetConnectivity(1));
+		EXPECT_EQ(nullptr, network.GetConnectivity(2));
+		for (Eigen::Index j = 0; j < pattern.rows(); ++j)
+			EXPECT_EQ(pattern.outerIndexPtr()[j + 1] - pattern.outerIndexPtr()[j] + 1, network.GetWeightMatrix()[0][j].size());
+
+		EXPECT_THROW(network.SetConnectivity(2, pattern), std::invalid_argument);
+		EXPECT_THROW(network.SetConnectivity(0, pattern), std::invalid_argument);
+	}
+
+	TEST(SparseConnectivityTest, KeptConnectionsKeepTheirWeights)
+	{
+		// given
+		MultilayerPerceptron network{ 3, 2, 1 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		weight_init.InitializeWeights(network);
+		const auto dense_weights = network.GetWeightMatrix();
+
+		ConnectivityPattern pattern(2, 3);
+		pattern.insert(0, 2) = 1.0;
+		pattern.insert(1, 0) = 1.0;
+		pattern.insert(1, 1) = 1.0;
+
+		// when
+		network.SetConnectivity(1, pattern);
+
+		// then
+		const auto& weights = network.GetWeightMatrix()[0];
+		EXPECT_EQ(dense_weights[0][0][2], weights[0][0]);
+		EXPECT_EQ(dense_weights[0][0][3], weights[0][1]);
+		EXPECT_EQ(dense_weights[0][1][0], weights[1][0]);
+		EXPECT_EQ(dense_weights[0][1][1], weights[1][1]);
+		EXPECT_EQ(dense_weights[0][1][3], weights[1][2]);
+	}
+
+	TEST(SparseConnectivityTest, OutputAndGradientMatchDenseNetworkWithZeroWeights)
+	{
+		// given
+		auto sparse = MakeSparseNetwork();
+		auto dense = MakeDenseEquivalent(sparse);
+		const auto training_set = MakeDataSet(50);
+
+		TrainingErrorState sparseState(sparse, training_set);
+		TrainingErrorState denseState(dense, training_set);
+
+		// when
+		const auto sparse_error = sparseState.ComputeEpochGradient();
+		const auto dense_error = denseState.ComputeEpochGradient();
+
+		// then
+		EXPECT_NEAR(dense_error, sparse_error, 1e-12);
+
+		const auto& sparseGradient = sparseState.GetErrorGradient();
+		const auto& denseGradient = denseState.GetErrorGradient();
+		for (size_t i = 0; i < sparseGradient.size(); ++i)
+		{
+			const auto connectivity = sparse.GetConnectivity(static_cast<int>(i + 1));
+			for (size_t j = 0; j < sparseGradient[i].size(); ++j)
+			{
+				for (size_t c = 0; c + 1 < sparseGradient[i][j].size(); ++c)
+				{
+					const auto source = connectivity == nullptr ? c : static_cast<size_t>(connectivity->innerIndexPtr()[connectivity->outerIndexPtr()[j] + c]);
+					EXPECT_NEAR(denseGradient[i][j][source], sparseGradient[i][j][c], 1e-12);
+				}
+				EXPECT_NEAR(denseGradient[i][j].back(), sparseGradient[i][j].back(), 1e-12);
+			}
+		}
+	}
+
+	TEST(SparseConnectivityTest, TrainingKeepsSparsityPattern)
+	{
+		// given
+		auto network = MakeSparseNetwork();
+		const auto training_set = MakeDataSet(200);
+		ConjugateGradient algorithm{ 0.0001, 5 };
+		SupervisedTraining trainer{ algorithm, 20, 0.0001 };
+
+		TrainingErrorState initialState(network, training_set);
+		const auto initial_error = initialState.ComputeEpochError();
+		vector<Eigen::Index> sizes;
+		for (const auto& layer : network.GetWeightMatrix())
+			for (const auto& weights : layer)
+				sizes.push_back(weights.size());
+
+		// when
+		trainer.Train(network, training_set);
+
+		// then
+		EXPECT_LT(trainer.GetBestError(), initial_error);
+		size_t n = 0;
+		for (const auto& layer : network.GetWeightMatrix())
+			for (const auto& weights : layer)
+				EXPECT_EQ(sizes[n++], weights.size());
+	}
+
+	TEST(SparseConnectivityTest, SavedModelMatchesSparseNetwork)
+	{
+		// given
+		auto network = MakeSparseNetwork();
+		const auto path = (std::filesystem::temp_directory_path() / "nns_sparse_model.bin").string();
+		MultilayerPerceptron restored{ 6, 12, 8, 2 };
+		restored.SetConnectivity(1, *network.GetConnectivity(1));
+		restored.SetConnectivity(2, *network.GetConnectivity(2));
+
+		// when
+		SaveModel(network, path);
+		MappedModel model{ path };
+		model.CopyWeightsTo(restored);
+
+		// then
+		EXPECT_EQ(network.GetWeightMatrix(), restored.GetWeightMatrix());
+		for (const auto& sample : MakeDataSet(10))
+		{
+			ASSERT_TRUE(network.ComputeOutput(sample.first));
+			ASSERT_TRUE(model.ComputeOutput(sample.first));
+			EXPECT_NEAR(network.GetOutputActivation(0), model.GetOutputActivation(0), 1e-12);
+			EXPECT_NEAR(network.GetOutputActivation(1), model.GetOutputActivation(1), 1e-12);
+		}
+	}
+}
@@ -0,0 +1,179 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+	using namespace NNS::Initialization;
+	using namespace NNS::Data;
+
+	namespace
+	{
+		std::string GenerateXorLikeData(int rows)
+		{
+			std::ostringstream text;
+			std::mt19937 random_generator(42);
+			std::uniform_real_distribution<double> random01(0, 1);
+			for (int i = 0; i < rows; ++i)
+			{
+				const auto a = random01(random_generator), b = random01(random_generator);
+				text << a << '\t' << b << '\t' << ((a > 0.5) != (b > 0.5) ? 1 : 0) << '\n';
+			}
+			return text.str();
+		}
+
+		void ExpectEqualGradients(ErrorGradientMatrix const& expected, ErrorGradientMatrix const& actual)
+		{
+			ASSERT_EQ(expected.size(), actual.size());
+			for (size_t i = 0; i < expected.size(); ++i)
+				for (size_t j = 0; j < expected[i].size(); ++j)
+					for (size_t k = 0; k < expected[i][j].size(); ++k)
+						EXPECT_EQ(expected[i][j][k], actual[i][j][k]);
+		}
+	}
+
+	TEST(StreamingDataSourceTest, ChunksCoverWholeFileOnEveryPass)
+	{
+		// given
+		const auto content = GenerateXorLikeData(1000);
+		const auto path = testHelpers::WriteTemporaryFile("nns_streaming_passes.txt", content);
+		const auto expected = TextDataSetReader{}.Parse(content);
+		StreamingDataSource source{ path, StreamingDataSourceConfig{ {}, 512 } };
+
+		for (int pass = 0; pass < 3; ++pass)
+		{
+			// when
+			TrainingDataSet actual;
+			size_t chunks = 0;
+			source.Rewind();
+			while (const auto chunk = source.NextChunk())
+			{
+				actual.insert(actual.end(), chunk->begin(), chunk->end());
+				++chunks;
+			}
+
+			// then
+			EXPECT_GT(chunks, 2u);
+			ASSERT_EQ(expected.size(), actual.size());
+			for (size_t i = 0; i < expected.size(); ++i)
+			{
+				EXPECT_EQ(expected[i].first, actual[i].first);
+				EXPECT_EQ(expected[i].second, actual[i].second);
+			}
+		}
+	}
+
+	TEST(StreamingDataSourceTest, RewindInTheMiddleOfPassRestartsFromFirstRow)
+	{
+		// given
+		const auto content = GenerateXorLikeData(500);
+		const auto path = testHelpers::WriteTemporaryFile("nns_streaming_rewind.txt", content);
+		const auto expected = TextDataSetReader{}.Parse(content);
+		StreamingDataSource source{ path, StreamingDataSourceConfig{ {}, 256 } };
+
+		// when
+		source.Rewind();
+		source.NextChunk();
+		source.NextChunk();
+		source.Rewind();
+		const auto chunk = source.NextChunk();
+
+		// then
+		ASSERT_NE(nullptr, chunk);
+		EXPECT_EQ(expected.front().first, chunk->front().first);
+	}
+
+	TEST(StreamingDataSourceTest, MalformedRowIsReportedOnConsumerThread)
+	{
+		// given
+		auto content = GenerateXorLikeData(300) + "1\tbroken\t0\n";
+		const auto path = testHelpers::WriteTemporaryFile("nns_streaming_malformed.txt", content);
+		StreamingDataSource source{ path, StreamingDataSourceConfig{ {}, 256 } };
+
+		// when
+		try
+		{
+			source.Rewind();
+			while (source.NextChunk())
+			{
+			}
+			FAIL() << "DataSetFormatError expected";
+		}
+		// then
+		catch (const DataSetFormatError& e)
+		{
+			EXPECT_EQ(301u, e.GetLineNumber());
+		}
+	}
+
+	TEST(StreamingDataSourceTest, EpochGradientMatchesInMemoryDataSet)
+	{
+		// given
+		const auto content = GenerateXorLikeData(2000);
+		const auto path = testHelpers::WriteTemporaryFile("nns_streaming_gradient.txt", content);
+		const auto training_set = TextDataSetReader{}.Parse(content);
+		StreamingDataSource source{ path, StreamingDataSourceConfig{ {}, 1024 } };
+
+		MultilayerPerceptron network{ 2, 4, 1 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		weight_init.InitializeWeights(network);
+
+		TrainingErrorState inMemoryState(network, training_set);
+		TrainingErrorState streamingState(network, source);
+
+		// when
+		const auto expected_error = inMemoryState.ComputeEpochGradient();
+		const auto actual_error = streamingState.ComputeEpochGradient();
+
+		// then
+		EXPECT_EQ(expected_error, actual_error);
+		ExpectEqualGradients(inMemoryState.GetErrorGradient(), streamingState.GetErrorGradient());
+		EXPECT_EQ(inMemoryState.ComputeEpochError(), streamingState.ComputeEpochError());
+	}
+
+	TEST(StreamingDataSourceTest, TrainingOnEmptySourceThrows)
+	{
+		// given
+		const auto path = testHelpers::WriteTemporaryFile("nns_streaming_empty.txt", "");
+		StreamingDataSource source{ path, StreamingDataSourceConfig{ {}, 256 } };
+
+		MultilayerPerceptron network{ 2, 4, 1 };
+		Backpropagation bp{ 0.25, 0.9 };
+		SupervisedTraining training{ bp };
+
+		// when
+		// then
+		EXPECT_THROW(training.Train(network, source), std::invalid_argument);
+	}
+
+	TEST(StreamingDataSourceTest, ConjugateGradientWithSimulatedAnnealing_Xor2to1Problem)
+	{
+		// given
+		ErrorUnit errorThreshold = 0.00001f;
+		const auto path = testHelpers::WriteTemporaryFile("nns_streaming_xor.txt", "0\t0\t0\n1\t0\t1\n0\t1\t1\n1\t1\t0\n");
+		StreamingDataSource source{ path, StreamingDataSourceConfig{ {}, 8 } };
+
+		MultilayerPerceptron network{ 2, 3, 1 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		ConjugateGradient algorithm{ 0.0001f, 1000, 5 };
+		SupervisedTraining trainer{ algorithm, 1000, errorThreshold };
+		SimulatedAnnealing elm{ SimulatedAnnealingConfig{ 1.0f, 0.01f, errorThreshold, 5, 100, 30, RandomDistributionMethod::Normal, 0.5f } };
+		trainer.SetEludingLocalMinimaMethod(&elm);
+
+		// when
+		weight_init.InitializeWeights(network);
+		trainer.Train(network, source);
+
+		// then
+		InputLayer input(2);
+		input << 0.0, 0.0; network.ComputeOutput(input);
+		EXPECT_LE(network.GetOutputActivation(0), 0.1);
+		input << 1.0, 0.0; network.ComputeOutput(input);
+		EXPECT_GE(network.GetOutputActivation(0), 0.9);
+		input << 0.0, 1.0; network.ComputeOutput(input);
+		EXPECT_GE(network.GetOutputActivation(0), 0.9);
+		input << 1.0, 1.0; network.ComputeOutput(input);
+		EXPECT_LE(network.GetOutputActivation(0), 0.1);
+	}
+}
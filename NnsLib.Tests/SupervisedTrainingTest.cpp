@@ -0,0 +1,121 @@
+#include "pch.h"
+#include "TestFixtures.h"
+
+namespace NNSLibTest
+{
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+
+	namespace
+	{
+		// Optimizer that only ever makes the network worse.
+		class ScramblingOptimizer final : public IWeightOptimizer
+		{
+		public:
+			void Free() const override { delete this; }
+			void Initialize(IFeedforwardNetwork&) override {}
+
+			bool OptimizeWeights(IFeedforwardNetwork& network, TrainingErrorState&) override
+			{
+				++calls;
+				for (auto& layer : network.GetWeightMatrix())
+					for (auto& neuron : layer)
+						neuron.array() += 7.0;
+				return false;
+			}
+
+			size_t calls{ 0 };
+		};
+	}
+
+	TEST(SupervisedTrainingTest, BestWeightsAreRestoredAfterTraining)
+	{
+		// given
+		auto network = GetMultilayerPerceptronWithPredefinedWeights();
+		const auto initial_weights = network->GetWeightMatrix();
+		auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
+		const auto initial_error = TrainingErrorState(*network, training_set).ComputeEpochError();
+		ScramblingOptimizer algorithm;
+		SupervisedTraining trainer{ algorithm, 5, 0.0 };
+
+		// when
+		trainer.Train(*network, training_set);
+
+		// then
+		EXPECT_EQ(initial_weights, network->GetWeightMatrix());
+		EXPECT_EQ(initial_error, trainer.GetBestError());
+	}
+
+	TEST(SupervisedTrainingTest, BestErrorMatchesFinalWeights)
+	{
+		// given
+		MultilayerPerceptron network{ 2, 3, 1 };
+		NNS::Initialization::RandomWeightInitializer weight_init{ 0.5 };
+		Backpropagation algorithm{ 0.25, 0.9 };
+		SupervisedTraining trainer{ algorithm, 200, 0.0 };
+		auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
+
+		// when
+		weight_init.InitializeWeights(network);
+		trainer.Train(network, training_set);
+
+		// then
+		EXPECT_EQ(TrainingErrorState(network, training_set).ComputeEpochError(), trainer.GetBestError());
+	}
+
+	TEST(SupervisedTrainingTest, EpochsAndEvaluationsAreCounted)
+	{
+		// given
+		auto network = GetMultilayerPerceptronWithPredefinedWeights();
+		auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
+		Backpropagation algorithm{ 0.25, 0.9 };
+		SupervisedTraining trainer{ algorithm, 10, 0.0 };
+
+		// when
+		trainer.Train(*network, training_set);
+
+		// then
+		EXPECT_EQ(10u, trainer.GetEpochCount());
+		EXPECT_EQ(11u, trainer.GetEvaluationCount()); // One gradient per epoch plus evaluation of the last step.
+	}
+
+	TEST(SupervisedTrainingTest, ValidationStopsTrainingEarlyAndRestoresBestWeights)
+	{
+		// given
+		auto network = GetMultilayerPerceptronWithPredefinedWeights();
+		const auto initial_weights = network->GetWeightMatrix();
+		auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
+		const auto validation_set = training_set;
+		ScramblingOptimizer algorithm;
+		SupervisedTraining trainer{ algorithm, 100000, 0.0 };
+		trainer.SetValidationData(&validation_set, EarlyStoppingConfig{ 3, 0.0 });
+
+		// when
+		trainer.Train(*network, training_set);
+
+		// then
+		EXPECT_LT(algorithm.calls, 100000u);
+		EXPECT_EQ(initial_weights, network->GetWeightMatrix());
+		EXPECT_EQ(TrainingErrorState(*network, validation_set).ComputeEpochError(), trainer.GetBestValidationError());
+	}
+
+	TEST(SupervisedTrainingTest, ValidationKeepsWeightsOfLowestValidationError)
+	{
+		// given
+		MultilayerPerceptron network{ 2, 3, 1 };
+		NNS::Initialization::RandomWeightInitializer weight_init{ 0.5 };
+		Backpropagation algorithm{ 0.25, 0.9 };
+		SupervisedTraining trainer{ algorithm, 300, 0.0 };
+		auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
+		const TrainingDataSet validation_set(training_set.begin(), training_set.begin() + 2);
+		trainer.SetValidationData(&validation_set, EarlyStoppingConfig{ 0, 0.0 });
+
+		// when
+		weight_init.InitializeWeights(network);
+		trainer.Train(network, training_set);
+
+		// then
+		EXPECT_EQ(TrainingErrorState(network, validation_set).ComputeEpochError(), trainer.GetBestValidationError());
+	}
+}
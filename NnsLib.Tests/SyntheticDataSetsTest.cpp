@@ -0,0 +1,75 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using namespace NNS::Data;
+
+	namespace
+	{
+		void ExpectNearDataSets(const TrainingDataSet& expected, const TrainingDataSet& actual, double tolerance)
+		{
+			ASSERT_EQ(expected.size(), actual.size());
+			for (size_t i = 0; i < expected.size(); ++i)
+			{
+				ASSERT_EQ(expected[i].first.size(), actual[i].first.size());
+				EXPECT_LE((expected[i].first - actual[i].first).cwiseAbs().maxCoeff(), tolerance) << "row " << i;
+				EXPECT_NEAR(expected[i].second[0], actual[i].second[0], tolerance) << "row " << i;
+			}
+		}
+	}
+
+	TEST(SyntheticDataSetsTest, ThreeBitParityEqualsXorTestData)
+	{
+		// given
+		const auto expected = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i3_o1.txt"));
+
+		// when
+		const auto actual = MakeParityDataSet(3);
+
+		// then
+		ExpectNearDataSets(expected, actual, 0.0);
+	}
+
+	TEST(SyntheticDataSetsTest, ParityCoversAllCombinations)
+	{
+		// when
+		const auto data_set = MakeParityDataSet(6);
+
+		// then
+		ASSERT_EQ(64u, data_set.size());
+		for (size_t row = 0; row < data_set.size(); ++row)
+		{
+			EXPECT_EQ(6, data_set[row].first.size());
+			EXPECT_EQ(static_cast<double>(data_set[row].first.sum()) - 2.0 * floor(data_set[row].first.sum() / 2.0), data_set[row].second[0]);
+		}
+		EXPECT_THROW(MakeParityDataSet(0), std::invalid_argument);
+	}
+
+	TEST(SyntheticDataSetsTest, ElevenPointGaussianEqualsTestData)
+	{
+		// given
+		const auto expected = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("gaussian_function_i1_o1_11p.txt"));
+
+		// when
+		const auto actual = MakeGaussianDataSet(11);
+
+		// then
+		ExpectNearDataSets(expected, actual, 1.0e-4);
+	}
+
+	TEST(SyntheticDataSetsTest, SinusoidStaysInsideLogisticRange)
+	{
+		// when
+		const auto data_set = MakeSinusoidDataSet(101, 3.0);
+
+		// then
+		ASSERT_EQ(101u, data_set.size());
+		EXPECT_DOUBLE_EQ(0.0, data_set.front().first[0]);
+		EXPECT_DOUBLE_EQ(1.0, data_set.back().first[0]);
+		for (const auto& sample : data_set)
+		{
+			EXPECT_GE(sample.second[0], 0.1 - 1.0e-12);
+			EXPECT_LE(sample.second[0], 0.9 + 1.0e-12);
+		}
+	}
+}
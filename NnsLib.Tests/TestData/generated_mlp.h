@@ -0,0 +1,77 @@
+// Generated by NnsLib from a trained MultilayerPerceptron { 3, 5, 2 }. Do not edit.
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace generated_mlp
+{
+	using scalar = double;
+
+	constexpr std::size_t input_size = 3;
+	constexpr std::size_t output_size = 2;
+
+	namespace detail
+	{
+		constexpr scalar pi = 3.14159265358979323846;
+
+		/* Every neuron of the layer at once, neurons are independent and contiguous, so this vectorizes. */
+		template<std::size_t N>
+		inline void accumulate(scalar (&layer)[N], const scalar (&weights)[N], scalar x)
+		{
+			for (std::size_t j = 0; j < N; ++j)
+				layer[j] += weights[j] * x;
+		}
+
+		template<std::size_t N>
+		inline void logistic(scalar (&layer)[N])
+		{
+			for (std::size_t j = 0; j < N; ++j)
+			{
+				const scalar x = layer[j];
+				layer[j] = 1 / (1 + std::exp(-x));
+			}
+		}
+
+		/* Layer 1: 3 -> 5, logistic. Row k holds the weights of input k for every neuron. */
+		alignas(64) constexpr scalar layer1_weights[3][5] =
+		{
+			{ -1.125, 0, 0.75, 0.5, 0 },
+			{ -0.25, 1, 0, 0, 0.25 },
+			{ 0, 0, -0.75, 0, 1.125 },
+		};
+		alignas(64) constexpr scalar layer1_biases[5] = { 0.625, -0.5, 0.125, -1, -0.375 };
+
+		/* Layer 2: 5 -> 2, logistic. Row k holds the weights of input k for every neuron. */
+		alignas(64) constexpr scalar layer2_weights[5][2] =
+		{
+			{ 0.375, 0.125 },
+			{ -1.125, 1 },
+			{ -0.25, -0.5 },
+			{ 0.625, 0.375 },
+			{ -0.875, -1.125 },
+		};
+		alignas(64) constexpr scalar layer2_biases[2] = { 0, -0.25 };
+	}
+
+	/** Output of the network for one input. Uses the stack only. */
+	inline void predict(const scalar (&input)[input_size], scalar (&output)[output_size])
+	{
+		scalar layer1[5];
+		for (std::size_t j = 0; j < 5; ++j)
+			layer1[j] = detail::layer1_biases[j];
+		detail::accumulate(layer1, detail::layer1_weights[0], input[0]);
+		detail::accumulate(layer1, detail::layer1_weights[1], input[1]);
+		detail::accumulate(layer1, detail::layer1_weights[2], input[2]);
+		detail::logistic(layer1);
+
+		for (std::size_t j = 0; j < 2; ++j)
+			output[j] = detail::layer2_biases[j];
+		detail::accumulate(output, detail::layer2_weights[0], layer1[0]);
+		detail::accumulate(output, detail::layer2_weights[1], layer1[1]);
+		detail::accumulate(output, detail::layer2_weights[2], layer1[2]);
+		detail::accumulate(output, detail::layer2_weights[3], layer1[3]);
+		detail::accumulate(output, detail::layer2_weights[4], layer1[4]);
+		detail::logistic(output);
+	}
+}
@@ -0,0 +1,111 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using namespace NNS::Data;
+	using NNS::Types::TrainingDataSet;
+
+	TEST(TextDataSetReaderTest, ParseSingleOutputColumn)
+	{
+		// given
+		TextDataSetReader reader;
+
+		// when
+		auto training_set = reader.Parse("0.0\t0.0\t0.0\n1.0\t0.0\t1.0\r\n\n0.0\t1.0\t1.0\n1.0\t1.0\t0.0");
+
+		// then
+		ASSERT_EQ(4u, training_set.size());
+		EXPECT_EQ(2, training_set[1].first.size());
+		EXPECT_EQ(1, training_set[1].second.size());
+		EXPECT_EQ(1.0, training_set[1].first[0]);
+		EXPECT_EQ(1.0, training_set[1].second[0]);
+		EXPECT_EQ(0.0, training_set[3].second[0]);
+	}
+
+	TEST(TextDataSetReaderTest, ParseMultipleOutputColumns)
+	{
+		// given
+		TextDataSetReader reader{ TextDataSetReaderConfig{ ',', 2 } };
+
+		// when
+		auto training_set = reader.Parse("1, 2, 3, +4.5, -5e-1\n6,7,8,9,10\n");
+
+		// then
+		ASSERT_EQ(2u, training_set.size());
+		EXPECT_EQ(3, training_set[0].first.size());
+		EXPECT_EQ(2, training_set[0].second.size());
+		EXPECT_EQ(3.0, training_set[0].first[2]);
+		EXPECT_EQ(4.5, training_set[0].second[0]);
+		EXPECT_EQ(-0.5, training_set[0].second[1]);
+		EXPECT_EQ(10.0, training_set[1].second[1]);
+	}
+
+	TEST(TextDataSetReaderTest, MalformedRowReportsLineNumber)
+	{
+		// given
+		TextDataSetReader reader;
+
+		// when
+		try
+		{
+			reader.Parse("0\t0\t0\n\n1\tx\t1\n1\t1\t0\n");
+			FAIL() << "DataSetFormatError expected";
+		}
+		// then
+		catch (const DataSetFormatError& e)
+		{
+			EXPECT_EQ(3u, e.GetLineNumber());
+		}
+
+		EXPECT_THROW(reader.Parse("0\t0\t0\n1\t1\n"), DataSetFormatError);
+		EXPECT_THROW(reader.Parse("0\t0\t0\n1\t1\t1\t1\n"), DataSetFormatError);
+	}
+
+	TEST(TextDataSetReaderTest, ParallelChunksMatchSequentialParse)
+	{
+		// given
+		std::ostringstream text;
+		for (int i = 0; i < 10000; ++i)
+		{
+			text << i << '\t' << i * 0.5 << '\t' << -i << '\t' << i % 2 << '\n';
+		}
+		TextDataSetReader sequential{ TextDataSetReaderConfig{ '\t', 2, 0, 1 } };
+		TextDataSetReader parallel{ TextDataSetReaderConfig{ '\t', 2, 0, 7, 64 } };
+
+		// when
+		auto expected = sequential.Parse(text.str());
+		auto actual = parallel.Parse(text.str());
+
+		// then
+		ASSERT_EQ(10000u, expected.size());
+		ASSERT_EQ(expected.size(), actual.size());
+		for (size_t i = 0; i < expected.size(); ++i)
+		{
+			EXPECT_EQ(expected[i].first, actual[i].first);
+			EXPECT_EQ(expected[i].second, actual[i].second);
+		}
+	}
+
+	TEST(TextDataSetReaderTest, ParallelChunksReportGlobalLineNumber)
+	{
+		// given
+		std::ostringstream text;
+		for (int i = 0; i < 5000; ++i)
+		{
+			text << (i == 4321 ? "oops" : "1") << "\t2\n";
+		}
+		TextDataSetReader reader{ TextDataSetReaderConfig{ '\t', 1, 0, 8, 64 } };
+
+		// when
+		try
+		{
+			reader.Parse(text.str());
+			FAIL() << "DataSetFormatError expected";
+		}
+		// then
+		catch (const DataSetFormatError& e)
+		{
+			EXPECT_EQ(4322u, e.GetLineNumber());
+		}
+	}
+}
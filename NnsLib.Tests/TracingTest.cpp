@@ -0,0 +1,116 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using namespace NNS::Diagnostics;
+
+	namespace
+	{
+		size_t CountOccurrences(const std::string& text, const std::string& pattern)
+		{
+			size_t count = 0;
+			for (auto position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1))
+				++count;
+			return count;
+		}
+
+		void TraceNestedScopes()
+		{
+			TraceScope outer{ "test outer" };
+			TraceScope inner{ "test inner" };
+		}
+	}
+
+	TEST(TracingTest, ScopesFromSeveralThreadsAreExportedAsCompleteEvents)
+	{
+		// given
+		Tracer::Start();
+
+		// when
+		TraceNestedScopes();
+		std::thread worker{ TraceNestedScopes };
+		worker.join();
+		Tracer::Stop();
+
+		std::ostringstream trace;
+		Tracer::WriteChromeTrace(trace);
+		const auto summary = Tracer::GetSummary();
+
+		// then
+		EXPECT_EQ(0u, trace.str().find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+		EXPECT_EQ(2u, CountOccurrences(trace.str(), "{\"name\":\"test outer\",\"ph\":\"X\""));
+		EXPECT_EQ(2u, CountOccurrences(trace.str(), "{\"name\":\"test inner\",\"ph\":\"X\""));
+		const auto outer = std::find_if(summary.begin(), summary.end(), [](const TraceSummaryRow& row) { return row.name == "test outer"; });
+		ASSERT_NE(summary.end(), outer);
+		EXPECT_EQ(2u, outer->calls);
+		EXPECT_LE(outer->maxMilliseconds, outer->totalMilliseconds);
+	}
+
+	TEST(TracingTest, AggregatesAndCountersAppearInSummary)
+	{
+		// given
+		static TraceStatistic statistic{ "test aggregate" };
+		static TraceCounter counter{ "test counter" };
+		Tracer::Start();
+
+		// when
+		for (int i = 0; i < 3; ++i)
+		{
+			AggregateScope scope{ statistic };
+			counter.Add(2);
+		}
+		Tracer::Stop();
+
+		std::ostringstream table;
+		Tracer::WriteSummary(table);
+		const auto summary = Tracer::GetSummary();
+		const auto counters = Tracer::GetCounters();
+
+		// then
+		const auto aggregate = std::find_if(summary.begin(), summary.end(), [](const TraceSummaryRow& row) { return row.name == "test aggregate"; });
+		ASSERT_NE(summary.end(), aggregate);
+		EXPECT_EQ(3u, aggregate->calls);
+		EXPECT_NE(counters.end(), std::find(counters.begin(), counters.end(), std::make_pair(std::string("test counter"), std::int64_t{ 6 })));
+		EXPECT_NE(std::string::npos, table.str().find("test aggregate"));
+		EXPECT_NE(std::string::npos, table.str().find("test counter"));
+	}
+
+	TEST(TracingTest, LongRunsKeepSummaryCompleteAndBufferBounded)
+	{
+		// given
+		const size_t scopes = 200000; /* Several times the per-thread buffer. */
+		Tracer::Start();
+
+		// when
+		for (size_t i = 0; i < scopes; ++i)
+			TraceScope scope{ "test long run" };
+		Tracer::Stop();
+
+		std::ostringstream trace;
+		Tracer::WriteChromeTrace(trace);
+		const auto summary = Tracer::GetSummary();
+
+		// then
+		const auto row = std::find_if(summary.begin(), summary.end(), [](const TraceSummaryRow& summaryRow) { return summaryRow.name == "test long run"; });
+		ASSERT_NE(summary.end(), row);
+		EXPECT_EQ(scopes, row->calls);
+		EXPECT_LT(CountOccurrences(trace.str(), "{\"name\":\"test long run\",\"ph\":\"X\""), scopes);
+	}
+
+	TEST(TracingTest, NothingIsRecordedWhileStopped)
+	{
+		// given
+		static TraceCounter counter{ "test stopped counter" };
+		Tracer::Start();
+		Tracer::Stop();
+
+		// when
+		TraceNestedScopes();
+		counter.Add(1);
+
+		// then
+		EXPECT_TRUE(Tracer::GetSummary().empty());
+		for (const auto& value : Tracer::GetCounters())
+			EXPECT_EQ(0, value.second);
+	}
+}
@@ -6,12 +6,48 @@ namespace NNSLibTest
 	using namespace NNS::Models;
 	using namespace NNS::Training;
 	using namespace NNS::Activation;
+	using namespace NNS::Optimization;
+
+	namespace
+	{
+		/* Three noisy clusters in the unit square, one-hot targets. */
+		TrainingDataSet MakeClusters(size_t rows, unsigned int seed)
+		{
+			std::mt19937 random_generator(seed);
+			std::normal_distribution<double> noise(0.0, 0.1);
+			const double centers[3][2] = { { 0.2, 0.2 }, { 0.8, 0.3 }, { 0.5, 0.8 } };
+
+			TrainingDataSet data_set;
+			for (size_t i = 0; i < rows; ++i)
+			{
+				const auto label = i % 3;
+				InputLayer input(2);
+				input << centers[label][0] + noise(random_generator), centers[label][1] + noise(random_generator);
+				data_set.emplace_back(input, OutputLayer::Unit(3, static_cast<Eigen::Index>(label)));
+			}
+			return data_set;
+		}
+
+		size_t CountMisclassified(MultilayerPerceptron& network, TrainingDataSet const& data_set)
+		{
+			size_t errors = 0;
+			for (const auto& sample : data_set)
+			{
+				Eigen::Index predicted, expected;
+				network.ComputeOutput(sample.first);
+				network.GetActivationMatrix().back().maxCoeff(&predicted);
+				sample.second.maxCoeff(&expected);
+				errors += predicted != expected ? 1 : 0;
+			}
+			return errors;
+		}
+	}
 
 	TEST(TrainingErrorStateTests, ComputeEpochGradientForPredefinedWeights)
 	{
 		// given
 		auto e = 10'000'000;
-		auto training_set = testHelpers::ReadTrainingDataSet("C:\\Repos\\NNSimulator\\NnsLib.Tests\\TestData\\xor_i2_o1.txt");
+		auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
 		auto network = GetMultilayerPerceptronWithPredefinedWeights();
 		TrainingErrorState errorState(*network, training_set);
 		
@@ -31,4 +67,122 @@ namespace NNSLibTest
 		EXPECT_EQ(0.0231979, trunc(gradient[1][0][1]*e) / e);
 		EXPECT_EQ(-0.0084707, trunc(gradient[1][0][2]*e) / e);
 	}
+
+	TEST(TrainingErrorStateTests, CrossEntropyGradientMatchesFiniteDifference)
+	{
+		for (const auto method : { ErrorCalculationMethod::BinaryCrossEntropy, ErrorCalculationMethod::CategoricalCrossEntropy })
+		{
+			// given
+			MultilayerPerceptron network{ 2, 4, 3 };
+			testHelpers::InitializeWeights(network, 3);
+			const auto training_set = MakeClusters(12, 5);
+			TrainingErrorState error_state(network, training_set);
+			error_state.SetErrorComputationMethod(method);
+
+			// when
+			error_state.ComputeEpochGradient();
+			const auto gradient = error_state.GetErrorGradient();
+
+			// then
+			const auto step = 1e-6;
+			auto& weights = network.GetWeightMatrix();
+			const auto i = weights.size() - 1; /* Output layer, where the fused delta replaces loss and activation derivatives. */
+			for (size_t j = 0; j < weights[i].size(); ++j)
+				for (Eigen::Index k = 0; k < weights[i][j].size(); ++k)
+				{
+					const auto weight = weights[i][j][k];
+					weights[i][j][k] = weight + step;
+					const auto error_above = error_state.ComputeEpochError();
+					weights[i][j][k] = weight - step;
+					const auto error_below = error_state.ComputeEpochError();
+					weights[i][j][k] = weight;
+
+					/* Gradient is the negative one, summed over presentations, epoch error is their mean. */
+					const auto expected = -(error_above - error_below) / (2 * step) * training_set.size();
+					EXPECT_NEAR(expected, gradient[i][j][k], 1e-6) << "neuron " << j << " connection " << k;
+				}
+		}
+	}
+
+	TEST(TrainingErrorStateTests, CrossEntropyStaysFiniteOnSaturatedOutputs)
+	{
+		// given
+		MultilayerPerceptron network{ 1, 2 };
+		network.GetWeightMatrix()[0][0] << 800.0, 0.0;
+		network.GetWeightMatrix()[0][1] << -800.0, 0.0;
+		const TrainingDataSet training_set{ { InputLayer::Ones(1), OutputLayer::Unit(2, 1) } };
+		TrainingErrorState error_state(network, training_set);
+
+		// when
+		error_state.SetErrorComputationMethod(ErrorCalculationMethod::BinaryCrossEntropy);
+		const auto binary_error = error_state.ComputeEpochGradient();
+		const auto binary_delta = error_state.GetErrorGradient()[0][1][1];
+		error_state.SetErrorComputationMethod(ErrorCalculationMethod::CategoricalCrossEntropy);
+		const auto categorical_error = error_state.ComputeEpochError();
+
+		// then
+		EXPECT_DOUBLE_EQ(1600.0, binary_error); /* log( 1 + e^800 ) twice, while log( 1 - sigmoid( 800 ) ) is -inf. */
+		EXPECT_DOUBLE_EQ(1.0, binary_delta);
+		EXPECT_DOUBLE_EQ(1600.0, categorical_error);
+	}
+
+	TEST(TrainingErrorStateTests, CrossEntropyConvergesFasterThanMeanSquareError)
+	{
+		// given
+		const auto training_set = MakeClusters(90, 9);
+		MultilayerPerceptron mse_network{ 2, 6, 3 };
+		testHelpers::InitializeWeights(mse_network, 17);
+		MultilayerPerceptron cross_entropy_network{ mse_network };
+
+		Backpropagation mse_algorithm{ 0.01, 0.9 };
+		Backpropagation cross_entropy_algorithm{ 0.01, 0.9 };
+		SupervisedTraining mse_trainer(mse_algorithm, 20, 0.0);
+		SupervisedTraining cross_entropy_trainer(cross_entropy_algorithm, 20, 0.0);
+		cross_entropy_trainer.SetErrorCalculationMethod(ErrorCalculationMethod::CategoricalCrossEntropy);
+
+		// when
+		mse_trainer.Train(mse_network, training_set);
+		cross_entropy_trainer.Train(cross_entropy_network, training_set);
+
+		// then
+		const auto mse_errors = CountMisclassified(mse_network, training_set);
+		const auto cross_entropy_errors = CountMisclassified(cross_entropy_network, training_set);
+		EXPECT_LE(cross_entropy_errors, 3u);
+		EXPECT_GT(mse_errors, 15u); /* Saturated outputs learn slowly, y( 1 - y ) factor is close to zero. */
+	}
+
+	TEST(TrainingErrorStateTests, SubsampleIsDrawnWithoutReplacement)
+	{
+		// given
+		TrainingDataSet training_set;
+		for (int i = 0; i < 1000; ++i)
+			training_set.emplace_back(InputLayer::Constant(2, i), OutputLayer::Zero(3));
+		MultilayerPerceptron network{ 2, 4, 3 };
+		testHelpers::InitializeWeights(network, 3);
+		TrainingErrorState error_state(network, training_set);
+		std::mt19937 random_generator(5);
+
+		const auto distinct_rows = [&error_state]()
+		{
+			std::set<SignalUnit> rows; /* Every sample has its own input value, so duplicates shrink the set. */
+			for (const auto& sample : error_state.GetSubsample())
+				rows.insert(sample.first[0]);
+			return rows.size();
+		};
+
+		// when
+		const auto drawn = error_state.DrawSubsample(100, random_generator);
+		const auto drawn_distinct = distinct_rows();
+		const auto all = error_state.DrawSubsample(5000, random_generator);
+		const auto all_distinct = distinct_rows();
+
+		// then
+		EXPECT_EQ(100u, drawn);
+		EXPECT_EQ(100u, drawn_distinct);
+		EXPECT_EQ(1000u, all);
+		EXPECT_EQ(1000u, all_distinct); /* Whole data set, in some order. */
+		EXPECT_NEAR(error_state.ComputeEpochError(), error_state.ComputeSubsampleError(), 1e-12);
+		EXPECT_EQ(1u, error_state.GetSubsampleEvaluationCount());
+		EXPECT_EQ(1u, error_state.GetEvaluationCount());
+	}
 }
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "pch.h"
+
+namespace NNSLibTest
+{
+	using namespace NNS::Models;
+	using namespace NNS::Training;
+	using namespace NNS::Optimization;
+	using namespace NNS::Initialization;
+	using namespace NNS::Data;
+
+	namespace
+	{
+		// Large enough that a single epoch takes far longer than the cancellation latency we expect.
+		TrainingDataSet GenerateLargeDataSet(size_t rows, size_t inputs)
+		{
+			TrainingDataSet data_set;
+			std::mt19937 random_generator(42);
+			std::uniform_real_distribution<SignalUnit> random01(0, 1);
+			for (size_t i = 0; i < rows; ++i)
+			{
+				InputLayer input(inputs);
+				for (auto& value : input)
+					value = random01(random_generator);
+				OutputLayer output(1);
+				output[0] = input[0] > input[1] ? 1.0 : 0.0;
+				data_set.emplace_back(input, output);
+			}
+			return data_set;
+		}
+
+		template <typename Action>
+		long long MeasureMilliseconds(Action action)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			action();
+			return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	TEST(TrainingSessionTest, ProgressIsReportedForEveryEpoch)
+	{
+		// given
+		MultilayerPerceptron network{ 2, 3, 1 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		Backpropagation algorithm{ 0.25, 0.9 };
+		SupervisedTraining trainer{ algorithm, 50, 0.0 };
+		auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
+		std::vector<size_t> reported_epochs;
+		weight_init.InitializeWeights(network);
+
+		// when
+		TrainingSession session{ trainer, network, training_set, [&](TrainingProgress const& progress) { reported_epochs.push_back(progress.epoch); } };
+		session.Wait();
+
+		// then
+		ASSERT_EQ(50u, reported_epochs.size());
+		for (size_t i = 0; i < reported_epochs.size(); ++i)
+			EXPECT_EQ(i, reported_epochs[i]);
+		EXPECT_FALSE(session.IsRunning());
+		EXPECT_EQ(49u, session.GetProgress().epoch);
+		EXPECT_LE(trainer.GetBestError(), session.GetProgress().bestError); // The last optimization step is evaluated after the final report.
+	}
+
+	TEST(TrainingSessionTest, CancelInterruptsConjugateGradientWithinEpoch)
+	{
+		// given
+		MultilayerPerceptron network{ 20, 30, 1 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		ConjugateGradient algorithm{};
+		SupervisedTraining trainer{ algorithm, 100000, 0.0 };
+		const auto training_set = GenerateLargeDataSet(20000, 20);
+		weight_init.InitializeWeights(network);
+		const auto initial_error = TrainingErrorState(network, training_set).ComputeEpochError();
+		const auto epoch_duration = MeasureMilliseconds([&] { TrainingErrorState(network, training_set).ComputeEpochError(); });
+
+		// when
+		TrainingSession session{ trainer, network, training_set };
+		std::this_thread::sleep_for(std::chrono::milliseconds(3 * epoch_duration + 10));
+		const auto cancel_duration = MeasureMilliseconds([&] { session.Cancel(); session.Wait(); });
+
+		// then
+		EXPECT_TRUE(trainer.IsTrainingAborted());
+		EXPECT_LT(cancel_duration, epoch_duration / 2 + 50);
+		EXPECT_LE(TrainingErrorState(network, training_set).ComputeEpochError(), initial_error);
+	}
+
+	TEST(TrainingSessionTest, CancelInterruptsSimulatedAnnealing)
+	{
+		// given
+		MultilayerPerceptron network{ 20, 30, 1 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		SimulatedAnnealingConfig config;
+		config.temperatureNumber = 1000;
+		config.temperatureIters = 1000;
+		config.errorThreshold = 0.0;
+		SimulatedAnnealing algorithm{ config };
+		SupervisedTraining trainer{ algorithm, 10, 0.0 };
+		const auto training_set = GenerateLargeDataSet(20000, 20);
+		weight_init.InitializeWeights(network);
+		const auto initial_error = TrainingErrorState(network, training_set).ComputeEpochError();
+		const auto epoch_duration = MeasureMilliseconds([&] { TrainingErrorState(network, training_set).ComputeEpochError(); });
+
+		// when
+		TrainingSession session{ trainer, network, training_set };
+		std::this_thread::sleep_for(std::chrono::milliseconds(3 * epoch_duration + 10));
+		const auto cancel_duration = MeasureMilliseconds([&] { session.Cancel(); session.Wait(); });
+
+		// then
+		EXPECT_LT(cancel_duration, epoch_duration / 2 + 50);
+		EXPECT_LE(TrainingErrorState(network, training_set).ComputeEpochError(), initial_error);
+	}
+
+	TEST(TrainingSessionTest, CancelRightAfterStartIsNotLost)
+	{
+		// given
+		MultilayerPerceptron network{ 20, 30, 1 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		Backpropagation algorithm{ 0.25, 0.9 };
+		SupervisedTraining trainer{ algorithm, 3, 0.0 };
+		const auto training_set = GenerateLargeDataSet(20000, 20);
+		weight_init.InitializeWeights(network);
+		const auto initial_weights = network.GetWeightMatrix();
+		size_t reports = 0;
+
+		// when
+		{
+			TrainingSession session{ trainer, network, training_set, [&reports](TrainingProgress const&) { ++reports; } };
+			session.Cancel(); /* Most likely before the worker even entered Train(). */
+			session.Wait();
+		}
+		const auto reports_after_cancel = reports;
+		const auto weights_after_cancel = network.GetWeightMatrix();
+
+		TrainingSession session{ trainer, network, training_set, [&reports](TrainingProgress const&) { ++reports; } };
+		session.Wait();
+
+		// then
+		EXPECT_EQ(0u, reports_after_cancel);
+		EXPECT_EQ(initial_weights, weights_after_cancel);
+		EXPECT_EQ(3u, reports - reports_after_cancel); /* Next session starts with the abort cleared. */
+		EXPECT_FALSE(trainer.IsTrainingAborted());
+	}
+
+	TEST(TrainingSessionTest, TrainerTrainsOnItsOwnAfterSessionIsDestroyed)
+	{
+		// given
+		MultilayerPerceptron network{ 2, 3, 1 };
+		RandomWeightInitializer weight_init{ 0.5 };
+		Backpropagation algorithm{ 0.25, 0.9 };
+		SupervisedTraining trainer{ algorithm, 50, 0.0 };
+		auto training_set = testHelpers::ReadTrainingDataSet(testHelpers::TestDataPath("xor_i2_o1.txt"));
+		weight_init.InitializeWeights(network);
+		{
+			TrainingSession session{ trainer, network, training_set };
+			session.Wait();
+		}
+		const auto error_after_session = TrainingErrorState(network, training_set).ComputeEpochError();
+
+		// when
+		trainer.Train(network, training_set);
+
+		// then
+		EXPECT_FALSE(trainer.IsTrainingAborted());
+		EXPECT_LT(TrainingErrorState(network, training_set).ComputeEpochError(), error_after_session);
+	}
+
+	TEST(TrainingSessionTest, TrainingErrorIsRethrownByWait)
+	{
+		// given
+		MultilayerPerceptron network{ 2, 3, 1 };
+		Backpropagation algorithm{ 0.25, 0.9 };
+		SupervisedTraining trainer{ algorithm, 10, 0.0 };
+		const auto path = testHelpers::WriteTemporaryFile("nns_session_malformed.txt", "0\t0\t0\n1\tbroken\t1\n");
+		StreamingDataSource source{ path };
+
+		// when
+		TrainingSession session{ trainer, network, source };
+
+		// then
+		EXPECT_THROW(session.Wait(), DataSetFormatError);
+		EXPECT_FALSE(session.IsRunning());
+	}
+}
@@ -7,19 +7,50 @@
 
 #include "gtest/gtest.h"
 
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
 #include <memory>
+#include <set>
 #include <string>
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <filesystem>
+#include <functional>
+#include <thread>
 
+#include <Data/TextDataSetReader.h>
+#include <Data/StreamingDataSource.h>
+#include <Data/SyntheticDataSets.h>
+#include <Data/InputNormalizer.h>
 #include <Models/MultilayerPerceptron.h>
+#include <Models/MultilayerPerceptronEnsemble.h>
+#include <Models/ConvolutionalNetwork.h>
+#include <Models/RecurrentNetwork.h>
+#include <Modules/Layers.h>
+#include <Modules/Sequential.h>
 #include <Models/KohonenNetwork.h>
+#include <Models/KohonenCodebook.h>
+#include <Models/KohonenIndex.h>
 #include <Initialization/RandomWeightInitializer.h>
+#include <Initialization/ScaledWeightInitializer.h>
+#include <Initialization/PhiloxRandom.h>
 #include <Optimization/Backpropagation.h>
 #include <Optimization/ConjugateGradient.h>
 #include <Optimization/SimulatedAnnealing.h>
 #include <Training/SupervisedTraining.h>
+#include <Training/TrainingSession.h>
+#include <Training/SelfOrganizingMapTraining.h>
+#include <Training/NeuronPruning.h>
+#include <Training/BatchedTraining.h>
+#include <Distributed/SharedMemoryTransport.h>
+#include <Distributed/TcpTransport.h>
+#include <Diagnostics/Tracing.h>
+#include <Serialization/ModelWriter.h>
+#include <Serialization/MappedModel.h>
+#include <Serialization/CodeGenerator.h>
 
 #include "HelperFunctions.h"
@@ -17,6 +17,16 @@ namespace NNS
 		using NNS::Types::SignalUnit;
 		using ActivationFunctionPtr = std::function<SignalUnit(SignalUnit x)> ;
 
+		// Identifies activation function outside of the code, e.g. in saved models. Values must never be reordered.
+		enum class ActivationFunctionType : unsigned int
+		{
+			Treshold = 0,
+			Logistic,
+			HiperbolicTangens,
+			Kenue1,
+			Kenue2
+		};
+
 		template<typename T = SignalUnit>
 		struct TresholdActivationFunction
 		{
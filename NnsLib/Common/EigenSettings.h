@@ -0,0 +1,14 @@
+#pragma once
+
+/* Included ahead of every Eigen header, so all translation units see the same Eigen configuration. */
+
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+#include <stdexcept>
+
+/** EIGEN_RUNTIME_NO_MALLOC is only defined by the test-only build that checks Eigen heap allocations, never for a shipped library.
+* Eigen reports an allocation made while Eigen::internal::set_is_malloc_allowed( false ) through eigen_assert, which NDEBUG compiles out.
+* Throwing instead keeps the check in release test builds, see OptimizerAllocationTest. Every other Eigen assertion, coefficient
+* index checks included, is compiled in and throws as well, which is why this build is for tests only.
+*/
+#define eigen_assert(x) do { if (!(x)) throw std::logic_error("Eigen assertion failed: " #x); } while (false)
+#endif
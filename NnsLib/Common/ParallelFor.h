@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace NNS
+{
+	/** Splits [0; count) into one contiguous range per thread, calls work( begin, end, threadIndex ) and joins.
+	* The calling thread takes the first range. Fewer threads are started if there are fewer items than threads.
+	*/
+	template <typename Work>
+	void ParallelFor(size_t threadCount, size_t count, Work work)
+	{
+		threadCount = std::max<size_t>(threadCount, 1);
+		const auto chunk = (count + threadCount - 1) / threadCount;
+
+		std::vector<std::thread> workers;
+		for (size_t t = 1; t < threadCount && t * chunk < count; ++t)
+		{
+			workers.emplace_back(work, t * chunk, std::min(count, (t + 1) * chunk), t);
+		}
+		work(0, std::min(count, chunk), 0);
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	/** Threads worth starting for the given amount of work, never more than requested ( zero means one per hardware thread ). */
+	inline size_t GetWorkerCount(size_t requested, size_t workItems, size_t minItemsPerThread)
+	{
+		if (requested == 0)
+			requested = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+		return std::max<size_t>(1, std::min(requested, workItems / std::max<size_t>(minItemsPerThread, 1)));
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+
+#include "Common/IBase.h"
+#include "Types/Collections.h"
+
+namespace NNS
+{
+	namespace Data
+	{
+		using namespace NNS::Types;
+
+		/** Sequence of training samples consumed one chunk at a time.
+		* A pass over the data starts with Rewind() and ends when NextChunk() returns nullptr.
+		* Chunks are always handed out in the same order, so every pass sees the samples in the same sequence.
+		*/
+		class ITrainingDataSource : public IBase
+		{
+		public:
+			using Ptr = std::unique_ptr<ITrainingDataSource, SDeleter>;
+		public:
+			virtual void Rewind() = 0;
+
+			/** Next chunk of the current pass or nullptr once the pass is complete.
+			* Returned chunk stays valid until the next call to NextChunk() or Rewind().
+			*/
+			virtual TrainingDataSet const* NextChunk() = 0;
+		};
+	}
+}
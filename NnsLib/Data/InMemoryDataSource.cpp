@@ -0,0 +1,35 @@
+#include "pch.h"
+#include "Data/InMemoryDataSource.h"
+
+namespace NNS
+{
+	namespace Data
+	{
+		InMemoryDataSource::InMemoryDataSource(const TrainingDataSet& dataSet)
+			: trainingData{ dataSet }
+		{
+			// Nop
+		}
+
+		void InMemoryDataSource::Free() const
+		{
+			delete this;
+		}
+
+		void InMemoryDataSource::Rewind()
+		{
+			isConsumed = false;
+		}
+
+		TrainingDataSet const* InMemoryDataSource::NextChunk()
+		{
+			if (isConsumed)
+			{
+				return nullptr;
+			}
+
+			isConsumed = true;
+			return &trainingData;
+		}
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Data/ITrainingDataSource.h"
+
+namespace NNS
+{
+	namespace Data
+	{
+		using namespace NNS::Types;
+
+		/** Data source over a data set already loaded into memory. Each pass is a single chunk. */
+		class InMemoryDataSource final : public ITrainingDataSource
+		{
+		public:
+			explicit InMemoryDataSource(const TrainingDataSet& dataSet);
+
+			void Free() const override;
+
+			void Rewind() override;
+			TrainingDataSet const* NextChunk() override;
+
+		private:
+			const TrainingDataSet& trainingData;
+			bool isConsumed{ false };
+		};
+	}
+}
@@ -0,0 +1,125 @@
+#include "pch.h"
+#include "Data/InputNormalizer.h"
+#include "Data/InMemoryDataSource.h"
+
+namespace NNS
+{
+	namespace Data
+	{
+		InputNormalizer::InputNormalizer(TrainingDataSet const& trainingData, NormalizationMethod method)
+		{
+			InMemoryDataSource dataSource{ trainingData };
+			Fit(dataSource, method);
+		}
+
+		InputNormalizer::InputNormalizer(ITrainingDataSource& dataSource, NormalizationMethod method)
+		{
+			Fit(dataSource, method);
+		}
+
+		void InputNormalizer::Fit(ITrainingDataSource& dataSource, NormalizationMethod method)
+		{
+			ActivationVector minimum, maximum, mean, squares; /* Squares are summed deviations from the running mean ( Welford ). */
+			size_t count{ 0 };
+
+			dataSource.Rewind();
+			while (const auto chunk = dataSource.NextChunk())
+			{
+				for (const auto& sample : *chunk) /* For each presentation. */
+				{
+					const auto& input = sample.first;
+					if (count == 0)
+					{
+						minimum = maximum = mean = input;
+						squares = ActivationVector::Zero(input.size());
+					}
+					else if (input.size() != mean.size())
+					{
+						throw std::invalid_argument("Inconsistent input layer size");
+					}
+
+					++count;
+					minimum = minimum.cwiseMin(input);
+					maximum = maximum.cwiseMax(input);
+					const ActivationVector deviation = input - mean;
+					mean += deviation / static_cast<SignalUnit>(count);
+					squares += deviation.cwiseProduct(input - mean);
+				}
+			}
+
+			if (count == 0)
+			{
+				throw std::invalid_argument("Cannot fit normalization on empty data");
+			}
+
+			ActivationVector spread;
+			if (method == NormalizationMethod::MinMax)
+			{
+				offset = minimum;
+				spread = maximum - minimum;
+			}
+			else
+			{
+				offset = mean;
+				spread = (squares / static_cast<SignalUnit>(count)).cwiseSqrt();
+			}
+
+			/* Constant inputs carry no information, they are only shifted so that they do not blow up. */
+			scale = spread.unaryExpr([](SignalUnit value) { return value > 0.0 ? 1.0 / value : 1.0; });
+		}
+
+		void InputNormalizer::Normalize(InputLayer const& input, InputLayer& normalized) const
+		{
+			normalized = (input - offset).cwiseProduct(scale);
+		}
+
+		void InputNormalizer::FoldInto(MultilayerPerceptron& network) const
+		{
+			const auto networkmap = network.GetNetworkLayerMap();
+			if (networkmap.size() < 2 || networkmap.front() != GetInputCount())
+			{
+				throw std::invalid_argument("Network's input layer does not match the normalization");
+			}
+
+			auto& firstLayer = network.GetWeightMatrix().front();
+			const auto connectivity = network.GetConnectivity(1);
+
+			for (size_t j = 0; j < firstLayer.size(); ++j) /* Each neuron of the first hidden layer. */
+			{
+				auto& weightVect = firstLayer[j];
+				const auto connections = weightVect.size() - 1;
+				auto& bias = weightVect[connections];
+
+				if (connectivity == nullptr)
+				{
+					weightVect.head(connections) = weightVect.head(connections).cwiseProduct(scale);
+					bias -= weightVect.head(connections).dot(offset);
+				}
+				else
+				{
+					const auto* sources = connectivity->innerIndexPtr() + connectivity->outerIndexPtr()[j];
+					for (Eigen::Index k = 0; k < connections; ++k) /* Each existing connection */
+					{
+						weightVect[k] *= scale[sources[k]];
+						bias -= weightVect[k] * offset[sources[k]];
+					}
+				}
+			}
+		}
+
+		size_t InputNormalizer::GetInputCount() const
+		{
+			return static_cast<size_t>(offset.size());
+		}
+
+		ActivationVector const& InputNormalizer::GetOffset() const
+		{
+			return offset;
+		}
+
+		ActivationVector const& InputNormalizer::GetScale() const
+		{
+			return scale;
+		}
+	}
+}
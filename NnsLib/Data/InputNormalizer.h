@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Types/Units.h"
+#include "Types/Collections.h"
+#include "Data/ITrainingDataSource.h"
+#include "Models/MultilayerPerceptron.h"
+
+namespace NNS
+{
+	namespace Data
+	{
+		using namespace NNS::Types;
+		using NNS::Models::MultilayerPerceptron;
+
+		enum class NormalizationMethod : unsigned int
+		{
+			MinMax = 0, /**< Each input mapped onto <0; 1> by its minimum and maximum. */
+			ZScore /**< Each input shifted by its mean and divided by its standard deviation. */
+		};
+
+		/** Per input affine standardization x' = ( x - offset ) * scale, fitted once on training data.
+		* Inputs that never change keep scale 1, so they are only shifted to zero.
+		* Give it to SupervisedTraining::SetInputNormalizer() ( or TrainingErrorState::SetInputNormalizer() ) to train on normalized
+		* inputs without touching the data set. Before export, FoldInto() moves the transform into the first layer's weights and biases,
+		* so the network takes raw inputs again and inference pays nothing for it.
+		* Standardized inputs also condition the error surface much better, ConjugateGradient's line searches then need fewer steps.
+		*/
+		class InputNormalizer final
+		{
+		public:
+			/** Fit on an in-memory data set.
+			* @throw std::invalid_argument if the data set is empty.
+			*/
+			InputNormalizer(TrainingDataSet const& trainingData, NormalizationMethod method = NormalizationMethod::ZScore);
+
+			/** Fit in one pass over a data source, e.g. StreamingDataSource.
+			* @throw std::invalid_argument if the data source is empty.
+			*/
+			InputNormalizer(ITrainingDataSource& dataSource, NormalizationMethod method = NormalizationMethod::ZScore);
+
+			/** Write the normalized input into a preallocated vector, nothing is allocated once it has the right size. */
+			void Normalize(InputLayer const& input, InputLayer& normalized) const;
+
+			/** Make the network compute on raw inputs what it computed on normalized ones, w' = w * scale and b' = b - sum( w' * offset ).
+			* Apply it once, a network folded twice would normalize twice. Folded weights are not clamped by the network's weight magnitude limit.
+			* @throw std::invalid_argument if the network's input layer does not match the fitted inputs.
+			*/
+			void FoldInto(MultilayerPerceptron& network) const;
+
+			size_t GetInputCount() const;
+			ActivationVector const& GetOffset() const;
+			ActivationVector const& GetScale() const;
+
+		private:
+			void Fit(ITrainingDataSource& dataSource, NormalizationMethod method);
+
+			ActivationVector offset;
+			ActivationVector scale;
+		};
+	}
+}
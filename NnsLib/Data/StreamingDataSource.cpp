@@ -0,0 +1,203 @@
+#include "pch.h"
+#include "Data/StreamingDataSource.h"
+
+#include <algorithm>
+
+namespace NNS
+{
+	namespace Data
+	{
+		StreamingDataSource::StreamingDataSource(const std::string& filePath, StreamingDataSourceConfig config)
+			: Config{ config }, file{ filePath, std::ios::binary }, inputColumns{ config.format.inputColumns }
+		{
+			if (!file)
+			{
+				throw std::runtime_error("Unable to open data set file: " + filePath);
+			}
+
+			prefetcher = std::thread(&StreamingDataSource::Prefetch, this);
+		}
+
+		StreamingDataSource::~StreamingDataSource()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				isStopping = true;
+			}
+			bufferFreed.notify_all();
+			prefetcher.join();
+		}
+
+		void StreamingDataSource::Free() const
+		{
+			delete this;
+		}
+
+		void StreamingDataSource::ReleaseHeldBuffer()
+		{
+			if (isHoldingBuffer)
+			{
+				buffers[consumerIndex].state = BufferState::Free;
+				consumerIndex ^= 1;
+				isHoldingBuffer = false;
+				bufferFreed.notify_all();
+			}
+		}
+
+		void StreamingDataSource::Rewind()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			ReleaseHeldBuffer();
+
+			if (isMidPass) /* Prefetched chunks belong to the abandoned pass, drop them and start over. */
+			{
+				++generation;
+				for (auto& buffer : buffers)
+				{
+					if (buffer.state == BufferState::Ready)
+						buffer.state = BufferState::Free;
+				}
+				consumerIndex = 0;
+				bufferFreed.notify_all();
+			}
+
+			isMidPass = false;
+			isPassComplete = false;
+		}
+
+		TrainingDataSet const* StreamingDataSource::NextChunk()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			ReleaseHeldBuffer();
+
+			if (isPassComplete)
+			{
+				return nullptr;
+			}
+
+			bufferReady.wait(lock, [this] { return buffers[consumerIndex].state == BufferState::Ready || failure; });
+			if (buffers[consumerIndex].state != BufferState::Ready)
+			{
+				std::rethrow_exception(failure);
+			}
+
+			auto& buffer = buffers[consumerIndex];
+			buffer.state = BufferState::InUse;
+			isHoldingBuffer = true;
+			isPassComplete = buffer.isLastOfPass;
+			isMidPass = !buffer.isLastOfPass;
+
+			return &buffer.rows;
+		}
+
+		void StreamingDataSource::Prefetch()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			while (true)
+			{
+				if (producerGeneration != generation)
+				{
+					producerGeneration = generation;
+					producerIndex = 0;
+					RestartFile();
+				}
+
+				bufferFreed.wait(lock, [this] { return isStopping || producerGeneration != generation || buffers[producerIndex].state == BufferState::Free; });
+				if (isStopping)
+					return;
+				if (producerGeneration != generation)
+					continue;
+
+				auto& buffer = buffers[producerIndex];
+				buffer.state = BufferState::Filling;
+				lock.unlock();
+
+				bool isLast = false;
+				try
+				{
+					isLast = ReadChunk(buffer.rows);
+				}
+				catch (...)
+				{
+					lock.lock();
+					buffer.state = BufferState::Free;
+					failure = std::current_exception();
+					bufferReady.notify_all();
+					return;
+				}
+
+				lock.lock();
+				if (producerGeneration != generation) /* Consumer abandoned the pass while we were reading. */
+				{
+					buffer.state = BufferState::Free;
+					continue;
+				}
+
+				buffer.state = BufferState::Ready;
+				buffer.isLastOfPass = isLast;
+				producerIndex ^= 1;
+				bufferReady.notify_all();
+
+				if (isLast) /* Wrap around and prefetch the beginning of the next pass. */
+				{
+					RestartFile();
+				}
+			}
+		}
+
+		void StreamingDataSource::RestartFile()
+		{
+			file.clear();
+			file.seekg(0);
+			pendingText.clear();
+			nextLineNumber = 1;
+		}
+
+		bool StreamingDataSource::ReadChunk(TrainingDataSet& rows)
+		{
+			const auto chunkSize = std::max<size_t>(Config.chunkSize, 1);
+			bool isLast = false;
+
+			while (true) /* Keep reading until at least one complete row is buffered. */
+			{
+				const auto offset = pendingText.size();
+				pendingText.resize(offset + chunkSize);
+				file.read(&pendingText[offset], static_cast<std::streamsize>(chunkSize));
+				pendingText.resize(offset + static_cast<size_t>(file.gcount()));
+
+				if (file.bad())
+				{
+					throw std::runtime_error("Unable to read data set file");
+				}
+				if (file.eof())
+				{
+					isLast = true;
+					break;
+				}
+				if (pendingText.find('\n', offset) != std::string::npos)
+				{
+					break;
+				}
+			}
+
+			const auto end = isLast ? pendingText.size() : pendingText.rfind('\n') + 1;
+			const auto text = std::string_view(pendingText).substr(0, end);
+
+			TextDataSetReaderConfig format = Config.format;
+			format.inputColumns = inputColumns;
+			format.threadCount = 1;
+
+			rows = TextDataSetReader{ format }.Parse(text, nextLineNumber);
+			if (inputColumns == 0 && !rows.empty()) /* Remaining chunks must match the layout of the first row. */
+			{
+				inputColumns = static_cast<size_t>(rows.front().first.size());
+			}
+
+			nextLineNumber += static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+			pendingText.erase(0, end);
+
+			return isLast;
+		}
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Data/ITrainingDataSource.h"
+#include "Data/TextDataSetReader.h"
+
+namespace NNS
+{
+	namespace Data
+	{
+		using namespace NNS::Types;
+
+		struct StreamingDataSourceConfig final
+		{
+			// Row layout of the file. Thread count and chunk size are ignored, chunks are parsed on the prefetch thread.
+			TextDataSetReaderConfig format;
+			// Number of bytes read from disk per chunk. Rows are never split between two chunks.
+			size_t chunkSize{ 4 << 20 };
+		};
+
+		/** Out-of-core data source over a delimited text file.
+		* A background thread reads and parses the file chunk by chunk into one of two buffers while the other one is being consumed,
+		* so disk I/O overlaps with forward and backward passes. Only two chunks are ever held in memory.
+		* Once the last chunk of a pass is parsed the thread wraps around and prefetches the beginning of the next pass.
+		*/
+		class StreamingDataSource final : public ITrainingDataSource
+		{
+		public:
+			const StreamingDataSourceConfig Config;
+
+			/** Opens the file and starts prefetching the first chunk.
+			* @throw std::runtime_error if the file cannot be opened.
+			*/
+			explicit StreamingDataSource(const std::string& filePath, StreamingDataSourceConfig config = {});
+			~StreamingDataSource() override;
+
+			StreamingDataSource(const StreamingDataSource&) = delete;
+			StreamingDataSource& operator=(const StreamingDataSource&) = delete;
+
+			void Free() const override;
+
+			/** Start a new pass. Cheap when the previous pass was consumed completely, otherwise prefetched chunks are dropped and reading restarts. */
+			void Rewind() override;
+
+			/** Blocks until the next chunk is parsed.
+			* @throw DataSetFormatError or std::runtime_error raised on the prefetch thread.
+			*/
+			TrainingDataSet const* NextChunk() override;
+
+		private:
+			enum class BufferState : unsigned int
+			{
+				Free = 0,
+				Filling,
+				Ready,
+				InUse
+			};
+
+			struct Buffer
+			{
+				TrainingDataSet rows;
+				BufferState state{ BufferState::Free };
+				bool isLastOfPass{ false };
+			};
+
+			void Prefetch();
+
+			/** Reads and parses the next chunk of the file. Runs on the prefetch thread only.
+			* @return true if the chunk ends the pass.
+			*/
+			bool ReadChunk(TrainingDataSet& rows);
+			void RestartFile();
+			void ReleaseHeldBuffer();
+
+			/* Owned by the prefetch thread. */
+			std::ifstream file;
+			std::string pendingText; /**< Bytes read past the last complete line. */
+			size_t nextLineNumber{ 1 };
+			size_t inputColumns{ 0 };
+			size_t producerIndex{ 0 };
+			size_t producerGeneration{ 0 };
+
+			/* Guarded by mutex. */
+			std::array<Buffer, 2> buffers;
+			size_t consumerIndex{ 0 };
+			size_t generation{ 0 }; /**< Bumped whenever a pass is abandoned half way. */
+			bool isHoldingBuffer{ false };
+			bool isMidPass{ false };
+			bool isPassComplete{ false };
+			bool isStopping{ false };
+			std::exception_ptr failure;
+
+			std::mutex mutex;
+			std::condition_variable bufferFreed;
+			std::condition_variable bufferReady;
+			std::thread prefetcher;
+		};
+	}
+}
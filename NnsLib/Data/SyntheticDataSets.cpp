@@ -0,0 +1,85 @@
+#include "pch.h"
+#include "Data/SyntheticDataSets.h"
+
+#include <stdexcept>
+
+namespace NNS
+{
+	namespace Data
+	{
+		TrainingDataSet MakeParityDataSet(size_t bits)
+		{
+			if (bits == 0 || bits >= 8 * sizeof(size_t))
+			{
+				throw std::invalid_argument("Parity needs between 1 and 63 bits");
+			}
+
+			const size_t rows = size_t{ 1 } << bits;
+			TrainingDataSet data_set;
+			data_set.reserve(rows);
+
+			for (size_t row = 0; row < rows; ++row)
+			{
+				InputLayer input(bits);
+				size_t ones = 0;
+				for (size_t i = 0; i < bits; ++i) /* First input is the most significant bit. */
+				{
+					const auto bit = (row >> (bits - 1 - i)) & 1;
+					input[i] = static_cast<SignalUnit>(bit);
+					ones += bit;
+				}
+
+				OutputLayer output(1);
+				output[0] = static_cast<SignalUnit>(ones % 2);
+				data_set.emplace_back(std::move(input), std::move(output));
+			}
+
+			return data_set;
+		}
+
+		TrainingDataSet MakeGaussianDataSet(size_t points, SignalUnit range)
+		{
+			if (points == 0)
+			{
+				throw std::invalid_argument("At least one point is required");
+			}
+
+			TrainingDataSet data_set;
+			data_set.reserve(points);
+
+			const auto cell = 2.0 * range / static_cast<SignalUnit>(points);
+			for (size_t i = 0; i < points; ++i)
+			{
+				InputLayer input(1);
+				OutputLayer output(1);
+				input[0] = -range + (static_cast<SignalUnit>(i) + 0.5) * cell;
+				output[0] = exp(-input[0] * input[0]);
+				data_set.emplace_back(std::move(input), std::move(output));
+			}
+
+			return data_set;
+		}
+
+		TrainingDataSet MakeSinusoidDataSet(size_t points, SignalUnit periods)
+		{
+			if (points < 2)
+			{
+				throw std::invalid_argument("At least two points are required");
+			}
+
+			TrainingDataSet data_set;
+			data_set.reserve(points);
+
+			for (size_t i = 0; i < points; ++i)
+			{
+				InputLayer input(1);
+				OutputLayer output(1);
+				input[0] = static_cast<SignalUnit>(i) / static_cast<SignalUnit>(points - 1);
+				output[0] = 0.5 + 0.4 * sin(2.0 * M_PI * periods * input[0]);
+				data_set.emplace_back(std::move(input), std::move(output));
+			}
+
+			return data_set;
+		}
+	}
+}
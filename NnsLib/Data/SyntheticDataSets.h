@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Types/Units.h"
+#include "Types/Collections.h"
+
+namespace NNS
+{
+	namespace Data
+	{
+		using namespace NNS::Types;
+
+		/** All 2^bits combinations of binary inputs, output is 1 for an odd number of ones.
+		* Rows are ordered like counting in binary with the first input as the most significant bit, i.e. MakeParityDataSet( 3 ) equals xor_i3_o1.
+		* Parity is the hardest boolean function for a perceptron, every input bit changes the answer.
+		*/
+		TrainingDataSet MakeParityDataSet(size_t bits);
+
+		/** Samples of exp( -x^2 ) in the middles of 'points' equal cells covering <-range; range>.
+		* MakeGaussianDataSet( 11 ) equals gaussian_function_i1_o1_11p.
+		*/
+		TrainingDataSet MakeGaussianDataSet(size_t points, SignalUnit range = 3.0);
+
+		/** Samples of 0.5 + 0.4 sin( 2 pi periods x ) at 'points' evenly spaced x from <0; 1>.
+		* Output stays inside ( 0; 1 ), so logistic output neurons can fit it. More periods need more hidden neurons.
+		*/
+		TrainingDataSet MakeSinusoidDataSet(size_t points, SignalUnit periods = 1.0);
+	}
+}
@@ -0,0 +1,243 @@
+#include "pch.h"
+#include "Data/TextDataSetReader.h"
+
+#include <algorithm>
+#include <charconv>
+#include <thread>
+
+namespace NNS
+{
+	namespace Data
+	{
+		namespace
+		{
+			struct ParsedChunk
+			{
+				TrainingDataSet rows;
+				size_t lineCount{ 0 };
+				size_t errorLine{ 0 }; /* 1-based line within chunk, zero if chunk is well-formed */
+				std::string errorReason;
+			};
+
+			bool IsBlank(char c)
+			{
+				return c == ' ' || c == '\t' || c == '\r';
+			}
+
+			std::string_view Trim(std::string_view field, char delimiter)
+			{
+				while (!field.empty() && IsBlank(field.front()) && field.front() != delimiter)
+					field.remove_prefix(1);
+				while (!field.empty() && IsBlank(field.back()) && field.back() != delimiter)
+					field.remove_suffix(1);
+				return field;
+			}
+
+			bool IsEmptyLine(std::string_view line)
+			{
+				return std::all_of(line.begin(), line.end(), IsBlank);
+			}
+
+			/* Returns an empty string on success, otherwise the reason why the row is malformed. */
+			std::string ParseRow(std::string_view line, char delimiter, size_t columns, vector<SignalUnit>& values)
+			{
+				size_t column = 0;
+				size_t pos = 0;
+
+				while (true)
+				{
+					const auto next = line.find(delimiter, pos);
+					const auto field = Trim(line.substr(pos, next == std::string_view::npos ? std::string_view::npos : next - pos), delimiter);
+
+					if (column == columns)
+						return "expected " + std::to_string(columns) + " columns, found more";
+
+					auto first = field.data();
+					const auto last = field.data() + field.size();
+					if (first != last && *first == '+') /* from_chars does not accept an explicit plus sign */
+						++first;
+
+					const auto result = std::from_chars(first, last, values[column]);
+					if (field.empty() || result.ec != std::errc{} || result.ptr != last)
+						return "invalid number '" + std::string(field) + "' in column " + std::to_string(column + 1);
+
+					++column;
+					if (next == std::string_view::npos)
+						break;
+					pos = next + 1;
+				}
+
+				if (column != columns)
+					return "expected " + std::to_string(columns) + " columns, found " + std::to_string(column);
+
+				return {};
+			}
+
+			void ParseChunk(std::string_view chunk, char delimiter, size_t inputColumns, size_t outputColumns, ParsedChunk& result)
+			{
+				vector<SignalUnit> values(inputColumns + outputColumns);
+				size_t pos = 0;
+
+				while (pos < chunk.size())
+				{
+					auto next = chunk.find('\n', pos);
+					if (next == std::string_view::npos)
+						next = chunk.size();
+
+					const auto line = chunk.substr(pos, next - pos);
+					++result.lineCount;
+					pos = next + 1;
+
+					if (IsEmptyLine(line))
+						continue;
+
+					auto reason = ParseRow(line, delimiter, values.size(), values);
+					if (!reason.empty())
+					{
+						result.errorLine = result.lineCount;
+						result.errorReason = std::move(reason);
+						return;
+					}
+
+					result.rows.emplace_back(
+						Eigen::Map<const ActivationVector>(values.data(), inputColumns),
+						Eigen::Map<const ActivationVector>(values.data() + inputColumns, outputColumns));
+				}
+			}
+		}
+
+		DataSetFormatError::DataSetFormatError(size_t failedLineNumber, const std::string& reason)
+			: std::runtime_error("line " + std::to_string(failedLineNumber) + ": " + reason), lineNumber{ failedLineNumber }
+		{
+			// Nop
+		}
+
+		size_t DataSetFormatError::GetLineNumber() const
+		{
+			return lineNumber;
+		}
+
+		TextDataSetReader::TextDataSetReader(TextDataSetReaderConfig config)
+			: Config{ config }
+		{
+			// Nop
+		}
+
+		TrainingDataSet TextDataSetReader::ReadFile(const std::string& filePath) const
+		{
+			std::ifstream infile(filePath, std::ios::binary | std::ios::ate);
+			if (!infile)
+			{
+				throw std::runtime_error("Unable to open data set file: " + filePath);
+			}
+
+			std::string text(static_cast<size_t>(infile.tellg()), '\0');
+			infile.seekg(0);
+			if (!infile.read(text.data(), text.size()))
+			{
+				throw std::runtime_error("Unable to read data set file: " + filePath);
+			}
+
+			return Parse(text);
+		}
+
+		size_t TextDataSetReader::CountColumns(std::string_view text, size_t firstLineNumber) const
+		{
+			size_t pos = 0;
+			size_t lineNumber = firstLineNumber - 1;
+
+			while (pos < text.size())
+			{
+				auto next = text.find('\n', pos);
+				if (next == std::string_view::npos)
+					next = text.size();
+
+				const auto line = text.substr(pos, next - pos);
+				++lineNumber;
+				pos = next + 1;
+
+				if (!IsEmptyLine(line))
+				{
+					const auto columns = static_cast<size_t>(std::count(line.begin(), line.end(), Config.delimiter)) + 1;
+					if (columns <= Config.outputColumns)
+					{
+						throw DataSetFormatError(lineNumber, "expected more than " + std::to_string(Config.outputColumns) + " columns, found " + std::to_string(columns));
+					}
+					return columns;
+				}
+			}
+
+			return 0;
+		}
+
+		TrainingDataSet TextDataSetReader::Parse(std::string_view text, size_t firstLineNumber) const
+		{
+			size_t inputColumns = Config.inputColumns;
+			if (inputColumns == 0)
+			{
+				const auto columns = CountColumns(text, firstLineNumber);
+				if (columns == 0) /* Nothing but empty lines. */
+					return {};
+				inputColumns = columns - Config.outputColumns;
+			}
+
+			/* Split on line boundaries so that no row is shared between two chunks. */
+			size_t threadCount = Config.threadCount != 0 ? Config.threadCount : std::thread::hardware_concurrency();
+			threadCount = std::max<size_t>(threadCount, 1);
+			const auto chunkSize = std::max(Config.minChunkSize, text.size() / threadCount + 1);
+
+			vector<std::string_view> chunks;
+			for (size_t begin = 0; begin < text.size();)
+			{
+				auto end = std::min(begin + chunkSize, text.size());
+				end = text.find('\n', end > 0 ? end - 1 : 0);
+				end = (end == std::string_view::npos) ? text.size() : end + 1;
+
+				chunks.push_back(text.substr(begin, end - begin));
+				begin = end;
+			}
+
+			vector<ParsedChunk> parsed(chunks.size());
+			vector<std::thread> workers;
+			for (size_t i = 1; i < chunks.size(); ++i)
+			{
+				workers.emplace_back(ParseChunk, chunks[i], Config.delimiter, inputColumns, Config.outputColumns, std::ref(parsed[i]));
+			}
+			if (!chunks.empty())
+			{
+				ParseChunk(chunks.front(), Config.delimiter, inputColumns, Config.outputColumns, parsed.front());
+			}
+			for (auto& worker : workers)
+			{
+				worker.join();
+			}
+
+			/* Chunks are stitched in file order, line numbers are made global on the way. */
+			size_t lineOffset = firstLineNumber - 1;
+			size_t rowCount = 0;
+			for (const auto& chunk : parsed)
+			{
+				if (chunk.errorLine != 0)
+				{
+					throw DataSetFormatError(lineOffset + chunk.errorLine, chunk.errorReason);
+				}
+				lineOffset += chunk.lineCount;
+				rowCount += chunk.rows.size();
+			}
+
+			if (parsed.size() == 1)
+			{
+				return std::move(parsed.front().rows);
+			}
+
+			TrainingDataSet trainingData;
+			trainingData.reserve(rowCount);
+			for (auto& chunk : parsed)
+			{
+				std::move(chunk.rows.begin(), chunk.rows.end(), std::back_inserter(trainingData));
+			}
+
+			return trainingData;
+		}
+	}
+}
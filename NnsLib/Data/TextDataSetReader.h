@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "Types/Collections.h"
+
+namespace NNS
+{
+	namespace Data
+	{
+		using namespace NNS::Types;
+
+		struct TextDataSetReaderConfig final
+		{
+			// Character separating columns within a row. Spaces around each value are ignored.
+			char delimiter{ '\t' };
+			// Number of trailing columns forming the desired output layer.
+			size_t outputColumns{ 1 };
+			// Number of leading columns forming the input layer. Zero means "all columns except outputs".
+			size_t inputColumns{ 0 };
+			// Number of parsing threads. Zero means std::thread::hardware_concurrency().
+			size_t threadCount{ 0 };
+			// Chunks smaller than this are not worth a separate thread.
+			size_t minChunkSize{ 1 << 20 };
+		};
+
+		/** Raised when a row cannot be turned into an input/output pair.
+		* Line numbers are 1-based and count empty lines as well, so they match what a text editor shows.
+		*/
+		class DataSetFormatError : public std::runtime_error
+		{
+		public:
+			DataSetFormatError(size_t failedLineNumber, const std::string& reason);
+
+			size_t GetLineNumber() const;
+
+		private:
+			size_t lineNumber;
+		};
+
+		/** Delimited text loader for training data sets.
+		* The file is read in one go, split on line boundaries into chunks and each chunk is parsed on its own thread with std::from_chars.
+		* Chunk results are concatenated in file order, so the outcome does not depend on the number of threads.
+		*/
+		class TextDataSetReader final
+		{
+		public:
+			const TextDataSetReaderConfig Config;
+
+			explicit TextDataSetReader(TextDataSetReaderConfig config = {});
+
+			/** Load and parse a whole file.
+			* @throw std::runtime_error if the file cannot be read.
+			* @throw DataSetFormatError for the first malformed row.
+			*/
+			TrainingDataSet ReadFile(const std::string& filePath) const;
+
+			/** Parse already loaded text, same rules as ReadFile().
+			* @param firstLineNumber line number reported for the first line of text, used when text is a fragment of a larger file.
+			*/
+			TrainingDataSet Parse(std::string_view text, size_t firstLineNumber = 1) const;
+
+		private:
+			size_t CountColumns(std::string_view text, size_t firstLineNumber) const;
+		};
+	}
+}
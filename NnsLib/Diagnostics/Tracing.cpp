@@ -0,0 +1,291 @@
+#include "pch.h"
+#include "Diagnostics/Tracing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace NNS
+{
+	namespace Diagnostics
+	{
+		namespace
+		{
+			struct TraceEvent final
+			{
+				const char* name;
+				std::uint64_t start;
+				std::uint64_t end;
+			};
+
+			constexpr size_t MaxThreadEvents = 65536; /**< About 1.5 MB per thread, folded into 'foldedEvents' when full. */
+
+			struct ThreadTrace final
+			{
+				std::uint32_t threadId;
+				std::vector<TraceEvent> events;
+				std::map<std::string, TraceSummaryRow> foldedEvents; /**< Totals of events dropped from a full buffer. */
+			};
+
+			struct TraceRegistry final
+			{
+				std::mutex mutex;
+				std::vector<std::unique_ptr<ThreadTrace>> threads; /**< Kept after their thread exits, so events survive until export. */
+				std::vector<TraceStatistic*> statistics;
+				std::vector<TraceCounter*> counters;
+				const std::chrono::steady_clock::time_point origin{ std::chrono::steady_clock::now() };
+			};
+
+			TraceRegistry& GetRegistry()
+			{
+				static TraceRegistry registry;
+				return registry;
+			}
+
+			ThreadTrace& GetThreadTrace()
+			{
+				thread_local ThreadTrace* threadTrace = nullptr;
+				if (threadTrace == nullptr)
+				{
+					auto& registry = GetRegistry();
+					std::lock_guard<std::mutex> lock(registry.mutex);
+					registry.threads.push_back(std::make_unique<ThreadTrace>());
+					threadTrace = registry.threads.back().get();
+					threadTrace->threadId = static_cast<std::uint32_t>(registry.threads.size() - 1);
+					threadTrace->events.reserve(4096);
+				}
+				return *threadTrace;
+			}
+
+			void AddEvent(TraceSummaryRow& row, const TraceEvent& event)
+			{
+				const auto milliseconds = static_cast<double>(event.end - event.start) / 1.0e6;
+				row.calls += 1;
+				row.totalMilliseconds += milliseconds;
+				row.maxMilliseconds = std::max(row.maxMilliseconds, milliseconds);
+			}
+
+			/** Keeps only totals of the buffered events, the buffer keeps its capacity. */
+			void FoldEvents(ThreadTrace& threadTrace)
+			{
+				for (const auto& event : threadTrace.events)
+					AddEvent(threadTrace.foldedEvents[event.name], event);
+				threadTrace.events.clear();
+			}
+
+			void WriteJsonString(std::ostream& stream, const std::string& text)
+			{
+				stream << '"';
+				for (const auto c : text)
+				{
+					if (c == '"' || c == '\\')
+						stream << '\\';
+					stream << c;
+				}
+				stream << '"';
+			}
+
+			double ToMicroseconds(std::uint64_t nanoseconds)
+			{
+				return static_cast<double>(nanoseconds) / 1000.0;
+			}
+		}
+
+		std::atomic<bool> Tracer::isRecording{ false };
+
+		void Tracer::Start()
+		{
+			auto& registry = GetRegistry();
+			{
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				for (auto& thread : registry.threads)
+				{
+					thread->events.clear();
+					thread->foldedEvents.clear();
+				}
+				for (auto statistic : registry.statistics)
+				{
+					statistic->calls = 0;
+					statistic->totalNanoseconds = 0;
+				}
+				for (auto counter : registry.counters)
+					counter->value = 0;
+			}
+			isRecording.store(true, std::memory_order_relaxed);
+		}
+
+		void Tracer::Stop()
+		{
+			isRecording.store(false, std::memory_order_relaxed);
+		}
+
+		std::uint64_t Tracer::Now()
+		{
+			const auto elapsed = std::chrono::steady_clock::now() - GetRegistry().origin;
+			return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		}
+
+		void TraceScope::Record(const char* name, std::uint64_t start, std::uint64_t end)
+		{
+			auto& threadTrace = GetThreadTrace();
+			if (threadTrace.events.size() == MaxThreadEvents)
+				FoldEvents(threadTrace);
+			threadTrace.events.push_back(TraceEvent{ name, start, end });
+		}
+
+		TraceStatistic::TraceStatistic(const char* statisticName)
+			: name{ statisticName }
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.statistics.push_back(this);
+		}
+
+		TraceCounter::TraceCounter(const char* counterName)
+			: name{ counterName }
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.counters.push_back(this);
+		}
+
+		void Tracer::WriteChromeTrace(std::ostream& stream)
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			const auto flags = stream.flags();
+			const auto precision = stream.precision();
+			std::uint64_t last_timestamp{ 0 };
+			bool is_first = true;
+			const auto separator = [&] { stream << (is_first ? "\n" : ",\n"); is_first = false; };
+
+			stream << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+			for (const auto& thread : registry.threads)
+			{
+				for (const auto& event : thread->events)
+				{
+					separator();
+					stream << "{\"name\":";
+					WriteJsonString(stream, event.name);
+					stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->threadId
+						<< ",\"ts\":" << ToMicroseconds(event.start) << ",\"dur\":" << ToMicroseconds(event.end - event.start) << '}';
+					last_timestamp = std::max(last_timestamp, event.end);
+				}
+			}
+
+			/* Counters and aggregates are totals, a single sample at the end of the trace shows them. */
+			std::map<std::string, std::int64_t> totals;
+			for (auto counter : registry.counters)
+				totals[counter->name] += counter->value;
+			for (auto statistic : registry.statistics)
+				totals[std::string(statistic->name) + " calls"] += static_cast<std::int64_t>(statistic->calls.load());
+
+			for (const auto& total : totals)
+			{
+				separator();
+				stream << "{\"name\":";
+				WriteJsonString(stream, total.first);
+				stream << ",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":" << ToMicroseconds(last_timestamp) << ",\"args\":{\"value\":" << total.second << "}}";
+			}
+			stream << "\n]}\n";
+
+			stream.flags(flags);
+			stream.precision(precision);
+		}
+
+		std::vector<TraceSummaryRow> Tracer::GetSummary()
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			std::map<std::string, TraceSummaryRow> rows;
+			for (const auto& thread : registry.threads)
+			{
+				for (const auto& event : thread->events)
+					AddEvent(rows[event.name], event);
+
+				for (const auto& folded : thread->foldedEvents)
+				{
+					auto& row = rows[folded.first];
+					row.calls += folded.second.calls;
+					row.totalMilliseconds += folded.second.totalMilliseconds;
+					row.maxMilliseconds = std::max(row.maxMilliseconds, folded.second.maxMilliseconds);
+				}
+			}
+
+			for (auto statistic : registry.statistics)
+			{
+				if (statistic->calls == 0)
+					continue;
+
+				auto& row = rows[statistic->name];
+				row.calls += statistic->calls;
+				row.totalMilliseconds += static_cast<double>(statistic->totalNanoseconds) / 1.0e6;
+			}
+
+			std::vector<TraceSummaryRow> summary;
+			summary.reserve(rows.size());
+			for (auto& row : rows)
+			{
+				row.second.name = row.first;
+				summary.push_back(std::move(row.second));
+			}
+
+			std::stable_sort(summary.begin(), summary.end(), [](const TraceSummaryRow& a, const TraceSummaryRow& b) { return a.totalMilliseconds > b.totalMilliseconds; });
+			return summary;
+		}
+
+		std::vector<std::pair<std::string, std::int64_t>> Tracer::GetCounters()
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			std::map<std::string, std::int64_t> totals;
+			for (auto counter : registry.counters)
+				totals[counter->name] += counter->value;
+
+			return { totals.begin(), totals.end() };
+		}
+
+		void Tracer::WriteSummary(std::ostream& stream)
+		{
+			const auto summary = GetSummary();
+			const auto counters = GetCounters();
+
+			size_t name_width = 8;
+			for (const auto& row : summary)
+				name_width = std::max(name_width, row.name.size());
+			for (const auto& counter : counters)
+				name_width = std::max(name_width, counter.first.size());
+
+			const auto flags = stream.flags();
+			const auto precision = stream.precision();
+			stream << std::left << std::setw(static_cast<int>(name_width)) << "Scope" << std::right
+				<< std::setw(12) << "Calls" << std::setw(14) << "Total [ms]" << std::setw(14) << "Mean [us]" << std::setw(14) << "Max [ms]" << '\n';
+
+			stream << std::fixed;
+			for (const auto& row : summary)
+			{
+				stream << std::left << std::setw(static_cast<int>(name_width)) << row.name << std::right
+					<< std::setw(12) << row.calls
+					<< std::setw(14) << std::setprecision(3) << row.totalMilliseconds
+					<< std::setw(14) << std::setprecision(3) << (row.totalMilliseconds * 1000.0 / static_cast<double>(row.calls))
+					<< std::setw(14) << std::setprecision(3) << row.maxMilliseconds << '\n';
+			}
+
+			if (!counters.empty())
+			{
+				stream << '\n' << std::left << std::setw(static_cast<int>(name_width)) << "Counter" << std::right << std::setw(12) << "Value" << '\n';
+				for (const auto& counter : counters)
+					stream << std::left << std::setw(static_cast<int>(name_width)) << counter.first << std::right << std::setw(12) << counter.second << '\n';
+			}
+
+			stream.flags(flags);
+			stream.precision(precision);
+		}
+	}
+}
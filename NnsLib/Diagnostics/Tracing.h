@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** Instrumentation macros, compiled out unless NNS_ENABLE_TRACING is defined ( CMake option of the same name ).
+* NNS_TRACE_SCOPE( name ) records one timed event per call, use it for epochs, optimizer steps and line searches.
+* NNS_TRACE_AGGREGATE( name ) only accumulates call count and time, use it for per-presentation code such as forward passes.
+* NNS_TRACE_COUNTER( name, amount ) adds to a named counter.
+* Aggregate and counter names must be string literals, each call site keeps its own statistic.
+*/
+#if defined(NNS_ENABLE_TRACING)
+#define NNS_TRACE_CONCAT_IMPL(a, b) a##b
+#define NNS_TRACE_CONCAT(a, b) NNS_TRACE_CONCAT_IMPL(a, b)
+#define NNS_TRACE_SCOPE(name) const NNS::Diagnostics::TraceScope NNS_TRACE_CONCAT(nnsTraceScope, __LINE__){ name }
+#define NNS_TRACE_AGGREGATE(name) \
+	static NNS::Diagnostics::TraceStatistic NNS_TRACE_CONCAT(nnsTraceStatistic, __LINE__){ name }; \
+	const NNS::Diagnostics::AggregateScope NNS_TRACE_CONCAT(nnsAggregateScope, __LINE__){ NNS_TRACE_CONCAT(nnsTraceStatistic, __LINE__) }
+#define NNS_TRACE_COUNTER(name, amount) \
+	do { static NNS::Diagnostics::TraceCounter nnsTraceCounter{ name }; nnsTraceCounter.Add(amount); } while (false)
+#else
+#define NNS_TRACE_SCOPE(name) ((void)0)
+#define NNS_TRACE_AGGREGATE(name) ((void)0)
+#define NNS_TRACE_COUNTER(name, amount) ((void)0)
+#endif
+
+namespace NNS
+{
+	namespace Diagnostics
+	{
+		struct TraceSummaryRow final
+		{
+			std::string name;
+			std::uint64_t calls{ 0 };
+			double totalMilliseconds{ 0.0 };
+			double maxMilliseconds{ 0.0 }; /**< Zero for aggregates, which do not keep single calls. */
+		};
+
+		/** Process wide trace recorder.
+		* Every thread appends events to its own buffer, so recording takes no locks once a thread has been seen.
+		* A full buffer is folded into per-name totals of that thread, so long runs keep memory bounded and the summary complete,
+		* while the Chrome trace only shows the events recorded since the last fold.
+		* Start(), Stop() and the exporting methods must not run concurrently with traced code.
+		*/
+		class Tracer final
+		{
+		public:
+			/** Drop everything recorded so far and start recording. */
+			static void Start();
+			static void Stop();
+			static bool IsRecording()
+			{
+				return isRecording.load(std::memory_order_relaxed);
+			}
+
+			/** Nanoseconds since the first use of the tracer. */
+			static std::uint64_t Now();
+
+			/** Chrome trace-event JSON, open with chrome://tracing or Perfetto.
+			* Scopes become complete ( "X" ) events, counters and aggregates a single counter ( "C" ) event at the end.
+			*/
+			static void WriteChromeTrace(std::ostream& stream);
+
+			/** Scopes and aggregates merged by name, sorted by total time. */
+			static std::vector<TraceSummaryRow> GetSummary();
+			static std::vector<std::pair<std::string, std::int64_t>> GetCounters();
+
+			/** Human readable table of GetSummary() followed by counters. */
+			static void WriteSummary(std::ostream& stream);
+
+		private:
+			static std::atomic<bool> isRecording;
+		};
+
+		/** Records a single complete event from construction to destruction. */
+		class TraceScope final
+		{
+		public:
+			explicit TraceScope(const char* scopeName)
+				: name{ scopeName }, start{ Tracer::IsRecording() ? Tracer::Now() : NotRecording }
+			{
+			}
+
+			~TraceScope()
+			{
+				if (start != NotRecording)
+					Record(name, start, Tracer::Now());
+			}
+
+			TraceScope(const TraceScope&) = delete;
+			TraceScope& operator=(const TraceScope&) = delete;
+
+		private:
+			static constexpr std::uint64_t NotRecording = ~std::uint64_t{ 0 };
+			static void Record(const char* name, std::uint64_t start, std::uint64_t end);
+
+			const char* name;
+			const std::uint64_t start;
+		};
+
+		/** Call count and total time of one call site. */
+		class TraceStatistic final
+		{
+		public:
+			explicit TraceStatistic(const char* statisticName);
+
+			void Add(std::uint64_t nanoseconds)
+			{
+				calls.fetch_add(1, std::memory_order_relaxed);
+				totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+			}
+
+			const char* const name;
+			std::atomic<std::uint64_t> calls{ 0 };
+			std::atomic<std::uint64_t> totalNanoseconds{ 0 };
+		};
+
+		class AggregateScope final
+		{
+		public:
+			explicit AggregateScope(TraceStatistic& callSiteStatistic)
+				: statistic{ callSiteStatistic }, isRecording{ Tracer::IsRecording() }, start{ isRecording ? Tracer::Now() : 0 }
+			{
+			}
+
+			~AggregateScope()
+			{
+				if (isRecording)
+					statistic.Add(Tracer::Now() - start);
+			}
+
+			AggregateScope(const AggregateScope&) = delete;
+			AggregateScope& operator=(const AggregateScope&) = delete;
+
+		private:
+			TraceStatistic& statistic;
+			const bool isRecording;
+			const std::uint64_t start;
+		};
+
+		class TraceCounter final
+		{
+		public:
+			explicit TraceCounter(const char* counterName);
+
+			void Add(std::int64_t amount)
+			{
+				if (Tracer::IsRecording())
+					value.fetch_add(amount, std::memory_order_relaxed);
+			}
+
+			const char* const name;
+			std::atomic<std::int64_t> value{ 0 };
+		};
+	}
+}
@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "Distributed/Communicator.h"
+#include "Diagnostics/Tracing.h"
+
+#include <stdexcept>
+
+namespace NNS
+{
+	namespace Distributed
+	{
+		Communicator::Communicator(ITransport& peerTransport, AllReduceAlgorithm reduceAlgorithm)
+			: transport{ peerTransport }, algorithm{ reduceAlgorithm }, rank{ peerTransport.GetRank() }, worldSize{ peerTransport.GetWorldSize() }
+		{
+		}
+
+		int Communicator::GetRank() const
+		{
+			return rank;
+		}
+
+		int Communicator::GetWorldSize() const
+		{
+			return worldSize;
+		}
+
+		void Communicator::AllReduceSum(ErrorUnit* data, size_t count)
+		{
+			NNS_TRACE_SCOPE("Communicator::AllReduceSum");
+
+			if (worldSize == 1 || count == 0)
+				return;
+
+			if (algorithm == AllReduceAlgorithm::Tree)
+				TreeAllReduce(data, count);
+			else
+				RingAllReduce(data, count);
+		}
+
+		void Communicator::Broadcast(ErrorUnit* data, size_t count, int root)
+		{
+			if (root < 0 || root >= worldSize)
+				throw std::invalid_argument("Broadcast root is not a rank");
+
+			if (worldSize == 1 || count == 0)
+				return;
+
+			/* Binomial tree over ranks renumbered so that root is 0, every rank receives once and then forwards to its subtrees. */
+			const auto relative = (rank - root + worldSize) % worldSize;
+			const auto bytes = count * sizeof(ErrorUnit);
+
+			int mask = 1;
+			while (mask < worldSize)
+			{
+				if (relative & mask)
+				{
+					transport.SendReceive(0, nullptr, 0, (relative - mask + root) % worldSize, data, bytes);
+					break;
+				}
+				mask <<= 1;
+			}
+
+			for (mask >>= 1; mask > 0; mask >>= 1)
+			{
+				if (relative + mask < worldSize)
+					transport.SendReceive((relative + mask + root) % worldSize, data, bytes, 0, nullptr, 0);
+			}
+		}
+
+		void Communicator::RingAllReduce(ErrorUnit* data, size_t count)
+		{
+			const auto ranks = static_cast<size_t>(worldSize);
+			const auto next = (rank + 1) % worldSize;
+			const auto previous = (rank - 1 + worldSize) % worldSize;
+			const auto segmentBegin = [count, ranks](size_t segment) { return count * segment / ranks; };
+			const auto segmentSize = [&segmentBegin](size_t segment) { return segmentBegin(segment + 1) - segmentBegin(segment); };
+			const auto segmentOf = [ranks, this](int offset) { return static_cast<size_t>((rank + offset + 2 * worldSize) % worldSize); };
+			auto* buffer = ReceiveBuffer(segmentSize(ranks - 1));
+
+			/* Reduce-scatter, after step s every rank has summed s + 2 contributions into the segment it received last.
+			   Rank ends up holding the full sum of segment rank + 1. */
+			for (int step = 0; step + 1 < worldSize; ++step)
+			{
+				const auto sendSegment = segmentOf(-step);
+				const auto receiveSegment = segmentOf(-step - 1);
+				transport.SendReceive(next, data + segmentBegin(sendSegment), segmentSize(sendSegment) * sizeof(ErrorUnit),
+					previous, buffer, segmentSize(receiveSegment) * sizeof(ErrorUnit));
+
+				auto* target = data + segmentBegin(receiveSegment);
+				for (size_t i = 0; i < segmentSize(receiveSegment); ++i)
+					target[i] += buffer[i];
+			}
+
+			/* All-gather, finished sums travel around the ring and are copied, never added again. */
+			for (int step = 0; step + 1 < worldSize; ++step)
+			{
+				const auto sendSegment = segmentOf(1 - step);
+				const auto receiveSegment = segmentOf(-step);
+				transport.SendReceive(next, data + segmentBegin(sendSegment), segmentSize(sendSegment) * sizeof(ErrorUnit),
+					previous, data + segmentBegin(receiveSegment), segmentSize(receiveSegment) * sizeof(ErrorUnit));
+			}
+		}
+
+		void Communicator::TreeAllReduce(ErrorUnit* data, size_t count)
+		{
+			const auto bytes = count * sizeof(ErrorUnit);
+			auto* buffer = ReceiveBuffer(count);
+
+			/* Binomial tree reduce, at each level a rank either adds its partner's partial sum or hands its own over and leaves. */
+			for (int mask = 1; mask < worldSize; mask <<= 1)
+			{
+				if (rank & mask)
+				{
+					transport.SendReceive(rank - mask, data, bytes, 0, nullptr, 0);
+					break;
+				}
+
+				if (rank + mask < worldSize)
+				{
+					transport.SendReceive(0, nullptr, 0, rank + mask, buffer, bytes);
+					for (size_t i = 0; i < count; ++i)
+						data[i] += buffer[i];
+				}
+			}
+
+			Broadcast(data, count, 0);
+		}
+
+		ErrorUnit* Communicator::ReceiveBuffer(size_t count)
+		{
+			if (receiveBuffer.size() < count)
+				receiveBuffer.resize(count);
+			return receiveBuffer.data();
+		}
+
+		void BroadcastWeights(IFeedforwardNetwork& network, Communicator& communicator, int root)
+		{
+			auto& weightMatrix = network.GetWeightMatrix();
+
+			ErrorVector weights;
+			for (const auto& layer : weightMatrix) /* For each layer ( minus input layer ). */
+				for (const auto& weightVect : layer) /* For each neuron. */
+					weights.insert(weights.end(), weightVect.data(), weightVect.data() + weightVect.size());
+
+			communicator.Broadcast(weights.data(), weights.size(), root);
+
+			auto* source = weights.data();
+			for (auto& layer : weightMatrix)
+				for (auto& weightVect : layer)
+				{
+					std::copy(source, source + weightVect.size(), weightVect.data());
+					source += weightVect.size();
+				}
+		}
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Distributed/ITransport.h"
+#include "Models/IFeedforwardNetwork.h"
+#include "Types/Collections.h"
+
+namespace NNS
+{
+	namespace Distributed
+	{
+		using namespace NNS::Types;
+		using NNS::Models::IFeedforwardNetwork;
+
+		enum class AllReduceAlgorithm : unsigned int
+		{
+			Ring = 0, /**< Reduce-scatter then all-gather around a ring, each rank sends about twice the data whatever the rank count. */
+			Tree /**< Binomial tree reduce to rank 0 then broadcast back, log2( ranks ) steps, cheaper for a few values. */
+		};
+
+		/** Collectives over a transport, every rank of the run calls the same collectives in the same order.
+		* Each element of a sum is added up in one fixed order and the result is then copied to the other ranks,
+		* so every rank ends with bitwise identical values and optimizers fed by them take identical steps.
+		*/
+		class Communicator final
+		{
+		public:
+			/** @param peerTransport must outlive this object. */
+			explicit Communicator(ITransport& peerTransport, AllReduceAlgorithm reduceAlgorithm = AllReduceAlgorithm::Ring);
+
+			int GetRank() const;
+			int GetWorldSize() const;
+
+			/** Replace every element by its sum over all ranks. */
+			void AllReduceSum(ErrorUnit* data, size_t count);
+
+			/** Replace every element by root's. */
+			void Broadcast(ErrorUnit* data, size_t count, int root = 0);
+
+		private:
+			void RingAllReduce(ErrorUnit* data, size_t count);
+			void TreeAllReduce(ErrorUnit* data, size_t count);
+
+			/** Receive buffer grows to the largest message seen, later collectives of the same size allocate nothing. */
+			ErrorUnit* ReceiveBuffer(size_t count);
+
+			ITransport& transport;
+			const AllReduceAlgorithm algorithm;
+			const int rank;
+			const int worldSize;
+			ErrorVector receiveBuffer;
+		};
+
+		/** Copy root's weights into the network of every rank, e.g. so all ranks start training from the same point. */
+		void BroadcastWeights(IFeedforwardNetwork& network, Communicator& communicator, int root = 0);
+	}
+}
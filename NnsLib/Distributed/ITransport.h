@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "Common/IBase.h"
+
+namespace NNS
+{
+	namespace Distributed
+	{
+		/** Point-to-point byte channels between the ranks, i.e. processes, of one training run.
+		* Messages between two ranks arrive in the order they were sent. Collectives are built on top by Communicator.
+		*/
+		class ITransport : public IBase
+		{
+		public:
+			using Ptr = std::unique_ptr<ITransport, SDeleter>;
+		public:
+			virtual int GetRank() const = 0;
+			virtual int GetWorldSize() const = 0;
+
+			/** Send to one rank while receiving from another, returns once both are complete.
+			* Both directions progress together, so ranks exchanging around a ring never wait on each other's full buffers.
+			* An empty direction is skipped, its rank is ignored.
+			* @throw std::runtime_error if a peer is lost.
+			*/
+			virtual void SendReceive(int sendRank, const void* sendData, std::size_t sendBytes, int receiveRank, void* receiveData, std::size_t receiveBytes) = 0;
+		};
+	}
+}
@@ -0,0 +1,389 @@
+#include "pch.h"
+#include "Distributed/SharedMemoryTransport.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace NNS
+{
+	namespace Distributed
+	{
+		/* Atomics are shared between processes, that only works if they never fall back to a lock. */
+		static_assert(sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t), "Shared memory atomics must be plain words");
+		static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "Shared memory atomics must be plain words");
+
+		static constexpr std::uint32_t SegmentMagic = 0x4E4E5353; /* "NNSS", set by rank 0 once the header is filled in. */
+		static constexpr size_t CacheLine = 64;
+		static constexpr unsigned SpinsPerClockCheck = 4096;
+
+		/* Zero-filled memory is a valid initial state for all of these, ranks attach without any constructor running. */
+		struct alignas(CacheLine) SharedMemoryTransport::SegmentHeader
+		{
+			std::atomic<std::uint32_t> magic;
+			std::atomic<std::uint32_t> retired; /**< Set by rank 0 of a later run before it unlinks this segment. */
+			std::uint32_t worldSize;
+			std::uint64_t capacity;
+		};
+
+		/* One per rank, follows the segment header. A rank attaches by writing a fresh ticket, rank 0 accepts it by copying it.
+		* A segment left behind by a crashed run may already hold magic and tickets, but no live rank 0 accepts the new ticket.
+		*/
+		struct SharedMemoryTransport::AttachSlot
+		{
+			std::atomic<std::uint64_t> ticket;
+			std::atomic<std::uint64_t> accepted;
+		};
+
+		/* Producer and consumer positions on separate cache lines, they only ever grow, the buffer follows the header. */
+		struct SharedMemoryTransport::ChannelHeader
+		{
+			alignas(CacheLine) std::atomic<std::uint64_t> written;
+			alignas(CacheLine) std::atomic<std::uint64_t> read;
+		};
+
+		namespace
+		{
+			size_t RoundUp(size_t value, size_t alignment)
+			{
+				return (value + alignment - 1) / alignment * alignment;
+			}
+
+			/** Wait during setup, ranks may be started seconds apart. */
+			template<typename Predicate>
+			void WaitUntil(Predicate predicate, std::chrono::steady_clock::time_point deadline, const char* message)
+			{
+				while (!predicate())
+				{
+					if (std::chrono::steady_clock::now() > deadline)
+						throw std::runtime_error(message);
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+
+			template<typename Predicate>
+			void WaitUntil(Predicate predicate, std::chrono::milliseconds timeout, const char* message)
+			{
+				WaitUntil(predicate, std::chrono::steady_clock::now() + timeout, message);
+			}
+
+			/** Nonzero and unlike any ticket a previous run may have left in the segment. */
+			std::uint64_t MakeTicket()
+			{
+				std::random_device device;
+				const auto random = (static_cast<std::uint64_t>(device()) << 32) ^ device();
+				return (random ^ static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())) | 1u;
+			}
+		}
+
+		SharedMemoryTransport::SharedMemoryTransport(const std::string& runName, int localRank, int rankCount, size_t channelCapacity, std::chrono::milliseconds peerTimeout)
+			: name{ runName }, rank{ localRank }, worldSize{ rankCount }, capacity{ channelCapacity }, timeout{ peerTimeout }
+		{
+			if (worldSize < 1 || rank < 0 || rank >= worldSize || channelCapacity == 0 || name.empty())
+				throw std::invalid_argument("Invalid shared memory transport configuration");
+
+			channelStride = sizeof(ChannelHeader) + RoundUp(capacity, CacheLine);
+			channelsOffset = sizeof(SegmentHeader) + RoundUp(static_cast<size_t>(worldSize) * sizeof(AttachSlot), CacheLine);
+			const auto channels = static_cast<size_t>(worldSize) * static_cast<size_t>(worldSize);
+			const auto segmentSize = channelsOffset + channels * channelStride;
+
+			if (rank == 0)
+			{
+				Map(segmentSize);
+				try
+				{
+					auto& header = GetHeader();
+					header.worldSize = static_cast<std::uint32_t>(worldSize);
+					header.capacity = capacity;
+					header.magic.store(SegmentMagic, std::memory_order_release);
+
+					WaitUntil([this]()
+					{
+						bool allAccepted = true;
+						for (int other = 1; other < worldSize; ++other)
+						{
+							auto& slot = GetAttachSlot(other);
+							const auto ticket = slot.ticket.load(std::memory_order_acquire);
+							if (ticket != 0)
+								slot.accepted.store(ticket, std::memory_order_release);
+							allAccepted = allAccepted && ticket != 0;
+						}
+						return allAccepted;
+					}, timeout, "Not all ranks attached to the shared memory segment");
+				}
+				catch (...)
+				{
+					Unmap();
+					throw;
+				}
+				return;
+			}
+
+			/* The segment found under the name may be a crashed run's, once rank 0 retires it attach to the new one. */
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			const auto isRetired = [this]() { return GetHeader().retired.load(std::memory_order_acquire) != 0; };
+			for (;;)
+			{
+				Map(segmentSize);
+				try
+				{
+					auto& header = GetHeader();
+					WaitUntil([&header, &isRetired]() { return header.magic.load(std::memory_order_acquire) == SegmentMagic || isRetired(); },
+						deadline, "Shared memory segment was not initialized by rank 0");
+
+					if (!isRetired())
+					{
+						if (header.worldSize != static_cast<std::uint32_t>(worldSize) || header.capacity != capacity)
+							throw std::runtime_error("Shared memory segment was created for a different configuration: " + name);
+
+						auto& slot = GetAttachSlot(rank);
+						const auto ticket = MakeTicket();
+						slot.ticket.store(ticket, std::memory_order_release);
+						WaitUntil([&slot, ticket, &isRetired]() { return slot.accepted.load(std::memory_order_acquire) == ticket || isRetired(); },
+							deadline, "Shared memory segment was not initialized by rank 0");
+
+						if (!isRetired())
+							return;
+					}
+				}
+				catch (...)
+				{
+					Unmap();
+					throw;
+				}
+				Unmap();
+			}
+		}
+
+		SharedMemoryTransport::~SharedMemoryTransport()
+		{
+			Unmap();
+		}
+
+		void SharedMemoryTransport::Free() const
+		{
+			delete this;
+		}
+
+		int SharedMemoryTransport::GetRank() const
+		{
+			return rank;
+		}
+
+		int SharedMemoryTransport::GetWorldSize() const
+		{
+			return worldSize;
+		}
+
+		void SharedMemoryTransport::SendReceive(int sendRank, const void* sendData, size_t sendBytes, int receiveRank, void* receiveData, size_t receiveBytes)
+		{
+			assert(sendBytes == 0 || (sendRank >= 0 && sendRank < worldSize && sendRank != rank));
+			assert(receiveBytes == 0 || (receiveRank >= 0 && receiveRank < worldSize && receiveRank != rank));
+
+			auto* out = sendBytes != 0 ? &GetChannel(rank, sendRank) : nullptr;
+			auto* in = receiveBytes != 0 ? &GetChannel(receiveRank, rank) : nullptr;
+			const auto* source = static_cast<const unsigned char*>(sendData);
+			auto* target = static_cast<unsigned char*>(receiveData);
+			size_t sent = 0, received = 0;
+
+			auto lastProgress = std::chrono::steady_clock::now();
+			unsigned idleSpins = 0;
+
+			while (sent < sendBytes || received < receiveBytes)
+			{
+				bool progress = false;
+
+				if (sent < sendBytes)
+				{
+					/* Producer owns 'written', so only 'read' has to be loaded with acquire. */
+					const auto written = out->written.load(std::memory_order_relaxed);
+					const auto free = capacity - static_cast<size_t>(written - out->read.load(std::memory_order_acquire));
+					const auto bytes = std::min(free, sendBytes - sent);
+					if (bytes != 0)
+					{
+						const auto offset = static_cast<size_t>(written % capacity);
+						const auto first = std::min(bytes, capacity - offset);
+						auto* buffer = GetChannelData(*out);
+						std::memcpy(buffer + offset, source + sent, first);
+						std::memcpy(buffer, source + sent + first, bytes - first);
+						out->written.store(written + bytes, std::memory_order_release);
+						sent += bytes;
+						progress = true;
+					}
+				}
+
+				if (received < receiveBytes)
+				{
+					const auto read = in->read.load(std::memory_order_relaxed);
+					const auto available = static_cast<size_t>(in->written.load(std::memory_order_acquire) - read);
+					const auto bytes = std::min(available, receiveBytes - received);
+					if (bytes != 0)
+					{
+						const auto offset = static_cast<size_t>(read % capacity);
+						const auto first = std::min(bytes, capacity - offset);
+						const auto* buffer = GetChannelData(*in);
+						std::memcpy(target + received, buffer + offset, first);
+						std::memcpy(target + received + first, buffer, bytes - first);
+						in->read.store(read + bytes, std::memory_order_release);
+						received += bytes;
+						progress = true;
+					}
+				}
+
+				if (progress)
+				{
+					idleSpins = 0;
+					continue;
+				}
+
+				if (++idleSpins % SpinsPerClockCheck == 0)
+				{
+					const auto now = std::chrono::steady_clock::now();
+					if (idleSpins == SpinsPerClockCheck)
+						lastProgress = now; /* First check after progress stopped. */
+					else if (now - lastProgress > timeout)
+						throw std::runtime_error("Shared memory peer made no progress, it may have exited");
+				}
+				std::this_thread::yield();
+			}
+		}
+
+		void SharedMemoryTransport::Map(size_t segmentSize)
+		{
+			size = segmentSize;
+#ifdef _WIN32
+			const auto mappingName = "Local\\" + name;
+			/* Every rank creates or opens the same pagefile-backed mapping, it is zero-filled and lives while any rank holds it. */
+			mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+				static_cast<DWORD>(static_cast<std::uint64_t>(size) >> 32), static_cast<DWORD>(size & 0xFFFFFFFFu), mappingName.c_str());
+			if (mappingHandle == nullptr)
+				throw std::runtime_error("Unable to create shared memory segment: " + name);
+
+			data = static_cast<unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, size));
+			if (data == nullptr)
+			{
+				Unmap();
+				throw std::runtime_error("Unable to map shared memory segment: " + name);
+			}
+#else
+			const auto segmentName = name.front() == '/' ? name : "/" + name;
+			int descriptor = -1;
+			if (rank == 0)
+			{
+				/* A segment left behind by a crashed run may already be mapped by ranks of this run, retire it before unlinking,
+				* so they leave it and open the one created here. ftruncate() zero-fills the new segment.
+				*/
+				descriptor = shm_open(segmentName.c_str(), O_RDWR, 0);
+				if (descriptor >= 0)
+				{
+					struct stat status {};
+					if (fstat(descriptor, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(SegmentHeader))
+					{
+						void* stale = mmap(nullptr, sizeof(SegmentHeader), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+						if (stale != MAP_FAILED)
+						{
+							auto& staleHeader = *static_cast<SegmentHeader*>(stale);
+							staleHeader.magic.store(0, std::memory_order_relaxed);
+							staleHeader.retired.store(1, std::memory_order_release);
+							munmap(stale, sizeof(SegmentHeader));
+						}
+					}
+					close(descriptor);
+				}
+				shm_unlink(segmentName.c_str());
+				descriptor = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+				if (descriptor < 0 || ftruncate(descriptor, static_cast<off_t>(size)) != 0)
+				{
+					if (descriptor >= 0)
+						close(descriptor);
+					throw std::runtime_error("Unable to create shared memory segment: " + name);
+				}
+			}
+			else
+			{
+				/* Rank 0 may be between retiring an old segment and creating the new one, wait for it. */
+				WaitUntil([&descriptor, &segmentName, this]()
+				{
+					descriptor = shm_open(segmentName.c_str(), O_RDWR, 0);
+					struct stat status {};
+					if (descriptor >= 0 && fstat(descriptor, &status) == 0 && static_cast<size_t>(status.st_size) == size)
+						return true;
+					if (descriptor >= 0)
+						close(descriptor);
+					descriptor = -1;
+					return false;
+				}, timeout, "Shared memory segment was not created by rank 0");
+			}
+
+			void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+			close(descriptor); /* Mapping stays valid without the descriptor. */
+			if (address == MAP_FAILED)
+			{
+				if (rank == 0)
+					shm_unlink(segmentName.c_str());
+				throw std::runtime_error("Unable to map shared memory segment: " + name);
+			}
+			data = static_cast<unsigned char*>(address);
+#endif
+		}
+
+		void SharedMemoryTransport::Unmap()
+		{
+#ifdef _WIN32
+			if (data != nullptr)
+				UnmapViewOfFile(data);
+			if (mappingHandle != nullptr)
+				CloseHandle(mappingHandle);
+			mappingHandle = nullptr;
+#else
+			if (data != nullptr)
+			{
+				munmap(data, size);
+				if (rank == 0)
+					shm_unlink((name.front() == '/' ? name : "/" + name).c_str()); /* Attached ranks keep their mappings. */
+			}
+#endif
+			data = nullptr;
+		}
+
+		SharedMemoryTransport::ChannelHeader& SharedMemoryTransport::GetChannel(int from, int to) const
+		{
+			const auto index = static_cast<size_t>(from) * static_cast<size_t>(worldSize) + static_cast<size_t>(to);
+			return *reinterpret_cast<ChannelHeader*>(data + channelsOffset + index * channelStride);
+		}
+
+		SharedMemoryTransport::SegmentHeader& SharedMemoryTransport::GetHeader() const
+		{
+			return *reinterpret_cast<SegmentHeader*>(data);
+		}
+
+		SharedMemoryTransport::AttachSlot& SharedMemoryTransport::GetAttachSlot(int slotRank) const
+		{
+			return reinterpret_cast<AttachSlot*>(data + sizeof(SegmentHeader))[slotRank];
+		}
+
+		unsigned char* SharedMemoryTransport::GetChannelData(ChannelHeader& channel) const
+		{
+			return reinterpret_cast<unsigned char*>(&channel) + sizeof(ChannelHeader);
+		}
+	}
+}
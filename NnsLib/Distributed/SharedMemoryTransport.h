@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "Distributed/ITransport.h"
+
+namespace NNS
+{
+	namespace Distributed
+	{
+		/** Transport between processes on one host through a named shared memory segment, the default one.
+		* Every ordered pair of ranks gets a single-producer single-consumer ring buffer in the segment,
+		* positions are lock-free atomics, so a message costs two copies and no system call.
+		* Waiting ranks spin and yield, meant for one rank per core.
+		*/
+		class SharedMemoryTransport final : public ITransport
+		{
+		public:
+			/** Rank 0 creates the segment and waits until every other rank has attached to it, other ranks attach as soon as it exists.
+			* A segment a crashed run left under the same name is retired by rank 0, ranks that opened it first move to the new one.
+			* @param runName identifies the run, must be unique among runs active on the host.
+			* @param channelCapacity bytes buffered per direction between two ranks, larger messages stream through.
+			* @param peerTimeout limit on waiting for other ranks, during setup and for every exchange.
+			* @throw std::invalid_argument if rank or world size are out of range.
+			* @throw std::runtime_error if the segment cannot be created or attached, or other ranks do not show up in time.
+			*/
+			SharedMemoryTransport(const std::string& runName, int localRank, int rankCount, size_t channelCapacity = 1 << 16,
+				std::chrono::milliseconds peerTimeout = std::chrono::seconds(60));
+			~SharedMemoryTransport();
+
+			SharedMemoryTransport(const SharedMemoryTransport&) = delete;
+			SharedMemoryTransport& operator=(const SharedMemoryTransport&) = delete;
+
+			void Free() const override;
+
+			int GetRank() const override;
+			int GetWorldSize() const override;
+
+			/** @throw std::runtime_error if the peers make no progress within the timeout. */
+			void SendReceive(int sendRank, const void* sendData, size_t sendBytes, int receiveRank, void* receiveData, size_t receiveBytes) override;
+
+		private:
+			struct SegmentHeader;
+			struct AttachSlot;
+			struct ChannelHeader;
+
+			void Map(size_t segmentSize);
+			void Unmap();
+
+			SegmentHeader& GetHeader() const;
+			AttachSlot& GetAttachSlot(int slotRank) const;
+			ChannelHeader& GetChannel(int from, int to) const;
+			unsigned char* GetChannelData(ChannelHeader& channel) const;
+
+			const std::string name;
+			const int rank;
+			const int worldSize;
+			const size_t capacity;
+			const std::chrono::milliseconds timeout;
+			size_t channelStride{ 0 };
+			size_t channelsOffset{ 0 };
+
+			unsigned char* data{ nullptr };
+			size_t size{ 0 };
+#ifdef _WIN32
+			void* mappingHandle{ nullptr };
+#endif
+		};
+	}
+}
@@ -0,0 +1,332 @@
+#include "pch.h"
+#include "Distributed/TcpTransport.h"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <winsock2.h>
+#	include <ws2tcpip.h>
+#	pragma comment(lib, "Ws2_32.lib")
+#else
+#	include <arpa/inet.h>
+#	include <cerrno>
+#	include <fcntl.h>
+#	include <netdb.h>
+#	include <netinet/in.h>
+#	include <netinet/tcp.h>
+#	include <poll.h>
+#	include <sys/socket.h>
+#	include <unistd.h>
+#endif
+
+namespace NNS
+{
+	namespace Distributed
+	{
+		namespace
+		{
+#ifdef _WIN32
+			using SocketHandle = SOCKET;
+			const SocketHandle InvalidSocket = INVALID_SOCKET;
+			constexpr int SendFlags = 0;
+
+			void CloseSocket(SocketHandle socket) { closesocket(socket); }
+			int Poll(pollfd* fds, size_t count, int milliseconds) { return WSAPoll(fds, static_cast<ULONG>(count), milliseconds); }
+			bool WouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+
+			void SetNonBlocking(SocketHandle socket)
+			{
+				u_long mode = 1;
+				ioctlsocket(socket, FIONBIO, &mode);
+			}
+#else
+			using SocketHandle = int;
+			const SocketHandle InvalidSocket = -1;
+#	ifdef MSG_NOSIGNAL
+			constexpr int SendFlags = MSG_NOSIGNAL; /* A lost peer is reported as an error, not a SIGPIPE. */
+#	else
+			constexpr int SendFlags = 0;
+#	endif
+
+			void CloseSocket(SocketHandle socket) { close(socket); }
+			int Poll(pollfd* fds, size_t count, int milliseconds) { return poll(fds, static_cast<nfds_t>(count), milliseconds); }
+			bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+
+			void SetNonBlocking(SocketHandle socket)
+			{
+				fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+			}
+#endif
+
+			SocketHandle ToSocket(std::uintptr_t handle) { return static_cast<SocketHandle>(handle); }
+			std::uintptr_t ToHandle(SocketHandle socket) { return static_cast<std::uintptr_t>(socket); }
+
+			int ChunkSize(size_t bytes) { return static_cast<int>(std::min<size_t>(bytes, INT_MAX)); }
+
+			/** Connecting to a port nobody listens on yet may pick that very port as the ephemeral source, the socket then connects to itself. */
+			bool IsConnectedToItself(SocketHandle socket)
+			{
+				sockaddr_in local{}, remote{};
+				socklen_t localSize = sizeof(local), remoteSize = sizeof(remote);
+				if (getsockname(socket, reinterpret_cast<sockaddr*>(&local), &localSize) != 0 || getpeername(socket, reinterpret_cast<sockaddr*>(&remote), &remoteSize) != 0)
+					return false;
+				return local.sin_port == remote.sin_port && local.sin_addr.s_addr == remote.sin_addr.s_addr;
+			}
+
+			/** Blocking exchange of the rank number right after a connection is made. */
+			bool SendAll(SocketHandle socket, const char* data, size_t bytes)
+			{
+				while (bytes != 0)
+				{
+					const auto sent = send(socket, data, ChunkSize(bytes), SendFlags);
+					if (sent <= 0)
+						return false;
+					data += sent;
+					bytes -= static_cast<size_t>(sent);
+				}
+				return true;
+			}
+
+			bool ReceiveAll(SocketHandle socket, char* data, size_t bytes)
+			{
+				while (bytes != 0)
+				{
+					const auto received = recv(socket, data, ChunkSize(bytes), 0);
+					if (received <= 0)
+						return false;
+					data += received;
+					bytes -= static_cast<size_t>(received);
+				}
+				return true;
+			}
+		}
+
+		TcpTransport::TcpTransport(int localRank, int rankCount, unsigned short basePort, const std::string& host, std::chrono::milliseconds peerTimeout)
+			: rank{ localRank }, worldSize{ rankCount }, timeout{ peerTimeout }
+		{
+			if (worldSize < 1 || rank < 0 || rank >= worldSize || static_cast<int>(basePort) + worldSize > 65536)
+				throw std::invalid_argument("Invalid TCP transport configuration");
+
+#ifdef _WIN32
+			WSADATA winsockData;
+			if (WSAStartup(MAKEWORD(2, 2), &winsockData) != 0)
+				throw std::runtime_error("Unable to initialize Winsock");
+#endif
+
+			peers.assign(static_cast<size_t>(worldSize), ToHandle(InvalidSocket));
+			try
+			{
+				Connect(host, basePort);
+			}
+			catch (...)
+			{
+				Close();
+				throw;
+			}
+		}
+
+		TcpTransport::~TcpTransport()
+		{
+			Close();
+		}
+
+		void TcpTransport::Free() const
+		{
+			delete this;
+		}
+
+		int TcpTransport::GetRank() const
+		{
+			return rank;
+		}
+
+		int TcpTransport::GetWorldSize() const
+		{
+			return worldSize;
+		}
+
+		void TcpTransport::SendReceive(int sendRank, const void* sendData, size_t sendBytes, int receiveRank, void* receiveData, size_t receiveBytes)
+		{
+			assert(sendBytes == 0 || (sendRank >= 0 && sendRank < worldSize && sendRank != rank));
+			assert(receiveBytes == 0 || (receiveRank >= 0 && receiveRank < worldSize && receiveRank != rank));
+
+			const auto* source = static_cast<const char*>(sendData);
+			auto* target = static_cast<char*>(receiveData);
+			size_t sent = 0, received = 0;
+
+			while (sent < sendBytes || received < receiveBytes)
+			{
+				/* One entry per socket, with two ranks both directions share it. */
+				pollfd fds[2]{};
+				size_t count = 0;
+				pollfd* out = nullptr;
+				pollfd* in = nullptr;
+				if (sent < sendBytes)
+				{
+					out = &fds[count++];
+					out->fd = ToSocket(peers[static_cast<size_t>(sendRank)]);
+					out->events = POLLOUT;
+				}
+				if (received < receiveBytes)
+				{
+					const auto socket = ToSocket(peers[static_cast<size_t>(receiveRank)]);
+					in = (out != nullptr && out->fd == socket) ? out : &fds[count++];
+					in->fd = socket;
+					in->events |= POLLIN;
+				}
+
+				const auto ready = Poll(fds, count, static_cast<int>(std::min<long long>(timeout.count(), INT_MAX)));
+				if (ready == 0)
+					throw std::runtime_error("TCP peer made no progress, it may have exited");
+				if (ready < 0)
+				{
+					if (WouldBlock())
+						continue;
+					throw std::runtime_error("Polling TCP peers failed");
+				}
+
+				if (out != nullptr && (out->revents & (POLLOUT | POLLERR | POLLHUP)) != 0)
+				{
+					const auto bytes = send(out->fd, source + sent, ChunkSize(sendBytes - sent), SendFlags);
+					if (bytes > 0)
+						sent += static_cast<size_t>(bytes);
+					else if (!WouldBlock())
+						throw std::runtime_error("Sending to TCP peer failed");
+				}
+
+				if (in != nullptr && (in->revents & (POLLIN | POLLERR | POLLHUP)) != 0)
+				{
+					const auto bytes = recv(in->fd, target + received, ChunkSize(receiveBytes - received), 0);
+					if (bytes > 0)
+						received += static_cast<size_t>(bytes);
+					else if (bytes == 0)
+						throw std::runtime_error("TCP peer closed the connection");
+					else if (!WouldBlock())
+						throw std::runtime_error("Receiving from TCP peer failed");
+				}
+			}
+		}
+
+		void TcpTransport::Connect(const std::string& host, unsigned short basePort)
+		{
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			const auto port = [basePort](int peer) { return static_cast<unsigned short>(basePort + peer); };
+
+			/* Listen first, higher ranks may try to connect while this rank still connects to lower ones. */
+			const auto listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+			if (listener == InvalidSocket)
+				throw std::runtime_error("Unable to create TCP socket");
+
+			const int reuse = 1;
+			setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+			sockaddr_in address{};
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = htonl(INADDR_ANY);
+			address.sin_port = htons(port(rank));
+			if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, worldSize) != 0)
+			{
+				CloseSocket(listener);
+				throw std::runtime_error("Unable to listen on TCP port " + std::to_string(port(rank)));
+			}
+
+			try
+			{
+				for (int peer = 0; peer < rank; ++peer) /* Lower ranks are already listening, or will be soon. */
+				{
+					const auto service = std::to_string(port(peer));
+					addrinfo hints{};
+					hints.ai_family = AF_INET;
+					hints.ai_socktype = SOCK_STREAM;
+
+					auto connection = InvalidSocket;
+					while (connection == InvalidSocket)
+					{
+						addrinfo* resolved = nullptr;
+						if (getaddrinfo(host.c_str(), service.c_str(), &hints, &resolved) != 0 || resolved == nullptr)
+							throw std::runtime_error("Unable to resolve host " + host);
+
+						connection = socket(resolved->ai_family, resolved->ai_socktype, resolved->ai_protocol);
+						if (connection != InvalidSocket && (connect(connection, resolved->ai_addr, static_cast<int>(resolved->ai_addrlen)) != 0 || IsConnectedToItself(connection)))
+						{
+							CloseSocket(connection);
+							connection = InvalidSocket;
+						}
+						freeaddrinfo(resolved);
+
+						if (connection == InvalidSocket)
+						{
+							if (std::chrono::steady_clock::now() > deadline)
+								throw std::runtime_error("Unable to connect to rank " + std::to_string(peer));
+							std::this_thread::sleep_for(std::chrono::milliseconds(10));
+						}
+					}
+
+					peers[static_cast<size_t>(peer)] = ToHandle(connection);
+					const std::int32_t ownRank = rank;
+					if (!SendAll(connection, reinterpret_cast<const char*>(&ownRank), sizeof(ownRank)))
+						throw std::runtime_error("Unable to greet rank " + std::to_string(peer));
+				}
+
+				for (int accepted = rank + 1; accepted < worldSize; ++accepted) /* Higher ranks connect in any order. */
+				{
+					const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+					pollfd pending{};
+					pending.fd = listener;
+					pending.events = POLLIN;
+					if (remaining <= 0 || Poll(&pending, 1, static_cast<int>(std::min<long long>(remaining, INT_MAX))) <= 0)
+						throw std::runtime_error("Not all ranks connected in time");
+
+					const auto connection = accept(listener, nullptr, nullptr);
+					if (connection == InvalidSocket)
+						throw std::runtime_error("Unable to accept TCP connection");
+
+					std::int32_t peer = -1;
+					if (!ReceiveAll(connection, reinterpret_cast<char*>(&peer), sizeof(peer)) || peer <= rank || peer >= worldSize
+						|| peers[static_cast<size_t>(peer)] != ToHandle(InvalidSocket))
+					{
+						CloseSocket(connection);
+						throw std::runtime_error("Unexpected TCP connection");
+					}
+					peers[static_cast<size_t>(peer)] = ToHandle(connection);
+				}
+			}
+			catch (...)
+			{
+				CloseSocket(listener);
+				throw;
+			}
+			CloseSocket(listener);
+
+			const int noDelay = 1; /* Collectives send small messages and wait for the answer, Nagle would delay each of them. */
+			for (auto handle : peers)
+			{
+				if (handle == ToHandle(InvalidSocket))
+					continue;
+				setsockopt(ToSocket(handle), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+				SetNonBlocking(ToSocket(handle));
+			}
+		}
+
+		void TcpTransport::Close()
+		{
+			for (auto& handle : peers)
+			{
+				if (handle != ToHandle(InvalidSocket))
+					CloseSocket(ToSocket(handle));
+				handle = ToHandle(InvalidSocket);
+			}
+#ifdef _WIN32
+			WSACleanup();
+#endif
+		}
+	}
+}
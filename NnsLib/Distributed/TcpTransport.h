@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Distributed/ITransport.h"
+
+namespace NNS
+{
+	namespace Distributed
+	{
+		/** Transport over TCP connections between every pair of ranks.
+		* A stand-in for multi-host runs that works on localhost as well, shared memory is faster within one host.
+		* Sockets are non-blocking and polled, so a rank sending a large message keeps draining what it receives.
+		*/
+		class TcpTransport final : public ITransport
+		{
+		public:
+			/** Rank r listens on basePort + r, connects to every lower rank and accepts connections from every higher one.
+			* Pick ports below the system's ephemeral range, an outgoing connection may otherwise already hold one of them.
+			* @param host address all ranks are reached at, every rank must use the same host and base port.
+			* @param peerTimeout limit on waiting for other ranks, during setup and for every exchange.
+			* @throw std::invalid_argument if rank or world size are out of range.
+			* @throw std::runtime_error if a port cannot be bound or other ranks do not connect in time.
+			*/
+			TcpTransport(int localRank, int rankCount, unsigned short basePort, const std::string& host = "127.0.0.1",
+				std::chrono::milliseconds peerTimeout = std::chrono::seconds(60));
+			~TcpTransport();
+
+			TcpTransport(const TcpTransport&) = delete;
+			TcpTransport& operator=(const TcpTransport&) = delete;
+
+			void Free() const override;
+
+			int GetRank() const override;
+			int GetWorldSize() const override;
+
+			/** @throw std::runtime_error if a connection fails or the peers make no progress within the timeout. */
+			void SendReceive(int sendRank, const void* sendData, size_t sendBytes, int receiveRank, void* receiveData, size_t receiveBytes) override;
+
+		private:
+			void Connect(const std::string& host, unsigned short basePort);
+			void Close();
+
+			const int rank;
+			const int worldSize;
+			const std::chrono::milliseconds timeout;
+			std::vector<std::uintptr_t> peers; /**< Socket per rank, invalid for this rank. */
+		};
+	}
+}
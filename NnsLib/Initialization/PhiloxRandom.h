@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace NNS
+{
+	namespace Initialization
+	{
+		/** Philox4x32-10 counter-based random number generator ( Salmon et al., "Parallel random numbers: as easy as 1, 2, 3" ).
+		* Every output is a pure function of key and counter, there is no state to advance. Any thread can produce the number
+		* belonging to any position directly, so results do not depend on how work is split between threads.
+		*/
+		class PhiloxRandom final
+		{
+		public:
+			using Counter = std::array<std::uint32_t, 4>;
+
+			explicit PhiloxRandom(std::uint64_t seed)
+				: key{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) }
+			{
+			}
+
+			/** Four independent 32 bit words for the counter. */
+			Counter operator()(Counter counter) const
+			{
+				auto k0 = key[0], k1 = key[1];
+				for (int round = 0; round < 10; ++round)
+				{
+					const auto product0 = static_cast<std::uint64_t>(Multiplier0) * counter[0];
+					const auto product1 = static_cast<std::uint64_t>(Multiplier1) * counter[2];
+					counter = Counter{
+						static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ k0,
+						static_cast<std::uint32_t>(product1),
+						static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ k1,
+						static_cast<std::uint32_t>(product0) };
+					k0 += Weyl0;
+					k1 += Weyl1;
+				}
+				return counter;
+			}
+
+			/** Uniform value from ( 0; 1 ), never exactly 0 or 1, 32 bit resolution. */
+			static double ToOpenUnit(std::uint32_t word)
+			{
+				return (static_cast<double>(word) + 0.5) * (1.0 / 4294967296.0);
+			}
+
+			/** Uniform value from <-1; 1) using two words. */
+			static double ToSymmetricUnit(std::uint32_t high, std::uint32_t low)
+			{
+				const auto bits = (static_cast<std::uint64_t>(high) << 21) ^ (low >> 11); /* 53 bits */
+				return static_cast<double>(bits) * (1.0 / 4503599627370496.0) - 1.0;
+			}
+
+		private:
+			static constexpr std::uint32_t Multiplier0 = 0xD2511F53;
+			static constexpr std::uint32_t Multiplier1 = 0xCD9E8D57;
+			static constexpr std::uint32_t Weyl0 = 0x9E3779B9;
+			static constexpr std::uint32_t Weyl1 = 0xBB67AE85;
+
+			const std::array<std::uint32_t, 2> key;
+		};
+	}
+}
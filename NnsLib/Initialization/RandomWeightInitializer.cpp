@@ -20,25 +20,28 @@ namespace NNS
 
 		void RandomWeightInitializer::InitializeWeights(IFeedforwardNetwork& network)
 		{
-			const auto networkmap = network.GetNetworkLayerMap();
 			network.Rebuild();
 
-			if (auto biasedNetwork = as<Models::IBiased>(network))
+			const auto biasedNetwork = as<Models::IBiased>(network);
+			if (biasedNetwork)
 			{
 				biasedNetwork->SetBiasForAll(1.0);
 			}
 
+			const auto& weightMatrix = network.GetWeightMatrix();
+			const Eigen::Index biasCount = biasedNetwork ? 1 : 0;
+
 			std::mt19937 random_generator(static_cast<int>(time(0)));
 			std::uniform_real_distribution<WeightUnit> random01(0, 1);
 
-			for (int i = 1; i < networkmap.size(); ++i)  /* For each layer ( minus input layer ). */
+			for (size_t i = 1; i <= weightMatrix.size(); ++i)  /* For each layer ( minus input layer ). */
 			{
-				for (int j = 0; j < networkmap[i]; ++j)  /* For each neuron. */
+				for (size_t j = 0; j < weightMatrix[i - 1].size(); ++j)  /* For each neuron. */
 				{
-					for (int k = 0; k < networkmap[i - 1]; ++k) /* For each conenction with previous layer. */
+					for (Eigen::Index k = 0; k + biasCount < weightMatrix[i - 1][j].size(); ++k) /* For each conenction with previous layer. */
 					{
 						/* It is important to select small initial weights so that all of the units are uncommitted (having activations that are all close to 0.5 - the point of maximal weight change). */
-						network.Weight(i, j, k) = randomMagnitude * (1 - 2 * random01(random_generator)); /* Generate random number from range <-x; x> , best is <-0.5; 0.5> */
+						network.Weight(static_cast<int>(i), static_cast<int>(j), static_cast<int>(k)) = randomMagnitude * (1 - 2 * random01(random_generator)); /* Generate random number from range <-x; x> , best is <-0.5; 0.5> */
 					}
 				} 
 			}
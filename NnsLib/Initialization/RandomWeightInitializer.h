@@ -10,6 +10,7 @@ namespace NNS {
 		using namespace NNS::Types;
 		using NNS::Models::IFeedforwardNetwork;
 
+		/** Uniform weights from <-magnitude; magnitude>, seeded from the clock. See ScaledWeightInitializer for reproducible, layer scaled weights. */
 		class RandomWeightInitializer final : public IWeightInitializer {
 		public:
 
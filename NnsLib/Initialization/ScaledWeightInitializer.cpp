@@ -0,0 +1,128 @@
+#include "pch.h"
+#include "Initialization/ScaledWeightInitializer.h"
+#include "Initialization/PhiloxRandom.h"
+#include "Common/InterfaceHelpers.h"
+#include "Common/ParallelFor.h"
+#include "Diagnostics/Tracing.h"
+
+#include <limits>
+
+namespace NNS
+{
+	namespace Initialization
+	{
+		/* Fewer weights than this per thread do not pay for starting it. */
+		static constexpr size_t MinWeightsPerThread = 1 << 16;
+
+		ScaledWeightInitializer::ScaledWeightInitializer(ScaledWeightInitializerConfig config)
+			: Config{ config }
+		{
+		}
+
+		void ScaledWeightInitializer::Free() const
+		{
+			delete this;
+		}
+
+		void ScaledWeightInitializer::InitializeWeights(IFeedforwardNetwork& network)
+		{
+			NNS_TRACE_SCOPE("ScaledWeightInitializer::InitializeWeights");
+
+			const size_t biasCount = as<Models::IBiased>(network) ? 1 : 0;
+			auto& weightMatrix = network.GetWeightMatrix();
+
+			/* Every neuron of every layer is one work item. */
+			vector<pair<size_t, size_t>> neurons;
+			vector<WeightUnit> spreads(weightMatrix.size() + 1, 0.0);
+			size_t weightCount{ 0 };
+			for (size_t i = 1; i <= weightMatrix.size(); ++i) /* For each layer ( minus input layer ). */
+			{
+				if (weightMatrix[i - 1].empty()) /* No weights, e.g. pooling. */
+					continue;
+
+				spreads[i] = GetSpread(network, static_cast<int>(i));
+				for (size_t j = 0; j < weightMatrix[i - 1].size(); ++j) /* For each neuron. */
+				{
+					neurons.emplace_back(i, j);
+					weightCount += static_cast<size_t>(weightMatrix[i - 1][j].size());
+				}
+			}
+
+			const PhiloxRandom random{ Config.seed };
+			const auto threadCount = GetWorkerCount(Config.threadCount, weightCount, MinWeightsPerThread);
+
+			ParallelFor(threadCount, neurons.size(), [&](size_t begin, size_t end, size_t)
+			{
+				for (auto n = begin; n < end; ++n)
+				{
+					const auto i = neurons[n].first, j = neurons[n].second;
+					const auto connectivity = network.GetConnectivity(static_cast<int>(i));
+					const auto* sources = connectivity == nullptr ? nullptr : connectivity->innerIndexPtr() + connectivity->outerIndexPtr()[j];
+					auto& weightVect = weightMatrix[i - 1][j];
+					const auto connections = static_cast<size_t>(weightVect.size()) - biasCount;
+
+					/* One generator call covers two neighboring connections: two uniforms, or both Box-Muller normals. */
+					PhiloxRandom::Counter words{};
+					size_t block = std::numeric_limits<size_t>::max();
+					double radius{ 0.0 }, angle{ 0.0 };
+
+					for (size_t k = 0; k < connections; ++k) /* For each connection with previous layer. */
+					{
+						const auto source = sources == nullptr ? k : static_cast<size_t>(sources[k]);
+						if (source / 2 != block)
+						{
+							block = source / 2;
+							words = random({ static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(j), static_cast<std::uint32_t>(i), 0 });
+							if (Config.distribution == WeightDistribution::Normal)
+							{
+								radius = std::sqrt(-2.0 * std::log(PhiloxRandom::ToOpenUnit(words[0])));
+								angle = 2.0 * M_PI * PhiloxRandom::ToOpenUnit(words[1]);
+							}
+						}
+
+						const auto odd = (source & 1) != 0;
+						if (Config.distribution == WeightDistribution::Normal)
+							weightVect[k] = spreads[i] * radius * (odd ? std::sin(angle) : std::cos(angle));
+						else
+							weightVect[k] = spreads[i] * (odd ? PhiloxRandom::ToSymmetricUnit(words[2], words[3]) : PhiloxRandom::ToSymmetricUnit(words[0], words[1]));
+					}
+
+					if (biasCount != 0)
+						weightVect.tail(1)[0] = Config.bias;
+				}
+			});
+		}
+
+		WeightUnit ScaledWeightInitializer::GetSpread(IFeedforwardNetwork const& network, int layerId) const
+		{
+			const auto networkmap = network.GetNetworkLayerMap();
+			const auto& weightVectors = network.GetWeightMatrix()[layerId - 1];
+			const size_t biasCount = as<const Models::IBiased>(network) ? 1 : 0;
+
+			/* Average connections per weight vector, i.e. per neuron or per shared filter. Every neuron of the layer uses
+			   that many inputs, so the layer has networkmap[ layerId ] * fanIn connections, spread over the previous layer. */
+			size_t connections{ 0 };
+			for (const auto& weightVect : weightVectors)
+				connections += static_cast<size_t>(weightVect.size()) - biasCount;
+			const auto fanIn = static_cast<WeightUnit>(connections) / static_cast<WeightUnit>(std::max<size_t>(weightVectors.size(), 1));
+			const auto fanOut = fanIn * static_cast<WeightUnit>(networkmap[layerId]) / static_cast<WeightUnit>(std::max<size_t>(networkmap[layerId - 1], 1));
+
+			WeightUnit variance;
+			switch (Config.scaling)
+			{
+			case WeightScaling::Fixed:
+				return Config.magnitude;
+			case WeightScaling::He:
+				variance = 2.0 / std::max<WeightUnit>(fanIn, 1.0);
+				break;
+			case WeightScaling::Xavier:
+			default:
+				variance = 2.0 / std::max<WeightUnit>(fanIn + fanOut, 1.0);
+				break;
+			}
+
+			/* Uniform <-a; a> has variance a^2 / 3. */
+			return Config.distribution == WeightDistribution::Normal ? sqrt(variance) : sqrt(3.0 * variance);
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Initialization/IWeightInitializer.h"
+
+namespace NNS
+{
+	namespace Initialization
+	{
+		using namespace NNS::Types;
+		using NNS::Models::IFeedforwardNetwork;
+
+		enum class WeightScaling : unsigned int
+		{
+			Fixed = 0, // Spread given by magnitude, the same for every layer.
+			Xavier,    // Glorot, variance 2 / ( fanIn + fanOut ). Suits logistic and tanh activations.
+			He         // Variance 2 / fanIn. Suits rectifier activations.
+		};
+
+		enum class WeightDistribution : unsigned int
+		{
+			Uniform = 0,
+			Normal
+		};
+
+		struct ScaledWeightInitializerConfig final
+		{
+			WeightScaling scaling{ WeightScaling::Xavier };
+			WeightDistribution distribution{ WeightDistribution::Uniform };
+			// Fixed scaling only, half-width of the uniform range or standard deviation of the normal distribution.
+			WeightUnit magnitude{ 0.5 };
+			// Value of every bias weight.
+			WeightUnit bias{ 0.0 };
+			// Same seed, same weights, no matter the thread count.
+			std::uint64_t seed{ 42 };
+			// Zero means one per hardware thread.
+			size_t threadCount{ 0 };
+		};
+
+		/** Reproducible weight initialization with per layer scaling.
+		* Every weight is drawn from a counter-based generator keyed by the seed, the counter being the weight's layer, neuron and
+		* previous layer neuron ( halved, one call yields values for two neighboring connections ). Neurons are filled in parallel directly in the weight matrix and the outcome does not depend on the
+		* thread count. A connection gets the same weight in a dense and in a sparse layer.
+		* Fan-in is the average number of connections per weight vector, so sparse layers and shared convolution filters get theirs,
+		* fan-out the layer's connections divided by the previous layer's size.
+		*/
+		class ScaledWeightInitializer final : public IWeightInitializer
+		{
+		public:
+			const ScaledWeightInitializerConfig Config;
+
+			explicit ScaledWeightInitializer(ScaledWeightInitializerConfig config = {});
+			void Free() const override;
+
+			void InitializeWeights(IFeedforwardNetwork& network) override;
+
+			/** Half-width of the uniform range, or standard deviation, used for the given layer. */
+			WeightUnit GetSpread(IFeedforwardNetwork const& network, int layerId) const;
+		};
+	}
+}
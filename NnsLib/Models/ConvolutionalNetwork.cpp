@@ -0,0 +1,499 @@
+#include "pch.h"
+#include "Models/ConvolutionalNetwork.h"
+#include "Diagnostics/Tracing.h"
+
+#include <algorithm>
+
+namespace NNS
+{
+	namespace Models
+	{
+		ConvolutionalLayerConfig ConvolutionalLayerConfig::Convolution(size_t filters, size_t width, size_t height, size_t stride)
+		{
+			return ConvolutionalLayerConfig{ ConvolutionalLayerType::Convolution, filters, width, height, stride };
+		}
+
+		ConvolutionalLayerConfig ConvolutionalLayerConfig::MaxPooling(size_t width, size_t height)
+		{
+			return ConvolutionalLayerConfig{ ConvolutionalLayerType::MaxPooling, 0, width, height, 1 };
+		}
+
+		ConvolutionalLayerConfig ConvolutionalLayerConfig::AveragePooling(size_t width, size_t height)
+		{
+			return ConvolutionalLayerConfig{ ConvolutionalLayerType::AveragePooling, 0, width, height, 1 };
+		}
+
+		ConvolutionalLayerConfig ConvolutionalLayerConfig::FullyConnected(size_t neurons)
+		{
+			return ConvolutionalLayerConfig{ ConvolutionalLayerType::FullyConnected, neurons, 1, 1, 1 };
+		}
+
+		ConvolutionalNetwork::ConvolutionalNetwork(TensorShape inputShape, vector<ConvolutionalLayerConfig> const& layerConfigs)
+			: ConvolutionalNetwork(BuildLayers(inputShape, layerConfigs))
+		{
+		}
+
+		ConvolutionalNetwork::ConvolutionalNetwork(vector<Layer> builtLayers)
+			: FeedforwardNetworkBase(GetLayerMap(builtLayers)), layers{ std::move(builtLayers) }
+		{
+			Rebuild();
+		}
+
+		vector<ConvolutionalNetwork::Layer> ConvolutionalNetwork::BuildLayers(TensorShape inputShape, vector<ConvolutionalLayerConfig> const& configs)
+		{
+			if (configs.empty() || inputShape.GetSize() == 0)
+			{
+				throw std::invalid_argument("Invalid network size");
+			}
+
+			vector<Layer> layers(configs.size());
+			auto shape = inputShape;
+			for (size_t i = 0; i < configs.size(); ++i) /* For each layer ( minus input layer ). */
+			{
+				const auto& config = configs[i];
+				auto& layer = layers[i];
+				layer.config = config;
+				layer.input = shape;
+
+				switch (config.type)
+				{
+				case ConvolutionalLayerType::Convolution:
+				{
+					if (config.channels == 0 || config.stride == 0 || config.width == 0 || config.height == 0 || config.width > shape.width || config.height > shape.height)
+					{
+						throw std::invalid_argument("Invalid convolution layer");
+					}
+					layer.output = TensorShape{ config.channels, (shape.width - config.width) / config.stride + 1, (shape.height - config.height) / config.stride + 1 };
+					layer.connections = config.width * config.height * shape.channels;
+					break;
+				}
+				case ConvolutionalLayerType::MaxPooling:
+				case ConvolutionalLayerType::AveragePooling:
+				{
+					if (config.width == 0 || config.height == 0 || config.width > shape.width || config.height > shape.height)
+					{
+						throw std::invalid_argument("Invalid pooling layer");
+					}
+					layer.output = TensorShape{ shape.channels, shape.width / config.width, shape.height / config.height };
+					break;
+				}
+				case ConvolutionalLayerType::FullyConnected:
+				default:
+				{
+					if (config.channels == 0)
+					{
+						throw std::invalid_argument("Invalid fully connected layer");
+					}
+					layer.output = TensorShape{ config.channels, 1, 1 };
+					layer.connections = shape.GetSize();
+					break;
+				}
+				}
+
+				shape = layer.output;
+			}
+
+			return layers;
+		}
+
+		NetworkLayerMap ConvolutionalNetwork::GetLayerMap(vector<Layer> const& layers)
+		{
+			NetworkLayerMap networkmap{ layers.front().input.GetSize() };
+			for (const auto& layer : layers)
+				networkmap.push_back(layer.output.GetSize());
+			return networkmap;
+		}
+
+		IFeedforwardNetwork::Ptr ConvolutionalNetwork::Clone() const
+		{
+			return IFeedforwardNetwork::Ptr(new ConvolutionalNetwork(*this));
+		}
+
+		void ConvolutionalNetwork::Rebuild()
+		{
+			weightMatrix = WeightMatrix{ layers.size() };
+			Eigen::Index largestLayer{ 0 };
+
+			for (size_t i = 1; i <= layers.size(); ++i) /* For each layer ( minus input layer ). */
+			{
+				auto& layer = layers[i - 1];
+				const auto neurons = HasActivation(i) ? layer.config.channels : 0; /* Pooling has no weights. */
+				const auto connections = static_cast<Eigen::Index>(layer.connections);
+				const auto positions = static_cast<Eigen::Index>(layer.output.width * layer.output.height);
+
+				weightMatrix[i - 1].resize(neurons);
+				for (auto& weightVect : weightMatrix[i - 1]) /* For each filter or neuron. */
+				{
+					weightVect = WeightVector::Zero(connections + 1); /* Connections + bias */
+					weightVect.tail(1)[0] = 1.0;
+				}
+
+				layer.kernel.resize(static_cast<Eigen::Index>(neurons), connections);
+				layer.biases.resize(static_cast<Eigen::Index>(neurons));
+				layer.kernelGradient.resize(static_cast<Eigen::Index>(neurons), connections);
+				if (layer.config.type == ConvolutionalLayerType::Convolution)
+				{
+					layer.columns.resize(connections, positions);
+					layer.columnsDelta.resize(connections, positions);
+				}
+				if (layer.config.type == ConvolutionalLayerType::MaxPooling)
+				{
+					layer.maxima.assign(layer.output.GetSize(), 0);
+				}
+
+				largestLayer = std::max(largestLayer, std::max(activationMatrix[i - 1].size(), activationMatrix[i].size()));
+			}
+
+			outputNetInput = ActivationVector::Zero(activationMatrix.back().size());
+			delta = ActivationVector::Zero(largestLayer);
+			previousDelta = ActivationVector::Zero(largestLayer);
+			isWeightMagLimited = false;
+		}
+
+		bool ConvolutionalNetwork::ComputeOutput(InputLayer const& inputLayer)
+		{
+			NNS_TRACE_AGGREGATE("ConvolutionalNetwork::ComputeOutput");
+
+			if (weightMatrix.empty() || activationMatrix.front().size() != inputLayer.size())
+				return false;
+
+			activationMatrix.front() = inputLayer;
+
+			if (isWeightMagLimited && weightMagnitudeLimit != 0.0)
+				SetWeightMagnitudeLimit(weightMagnitudeLimit); /* check weights magnitude for correctness */
+
+			for (size_t i = 1; i < activationMatrix.size(); ++i)  /* Each layer, except first */
+			{
+				switch (layers[i - 1].config.type)
+				{
+				case ConvolutionalLayerType::Convolution:
+					GatherKernel(i);
+					ComputeConvolution(i);
+					break;
+				case ConvolutionalLayerType::MaxPooling:
+				case ConvolutionalLayerType::AveragePooling:
+					ComputePooling(i);
+					break;
+				case ConvolutionalLayerType::FullyConnected:
+				default:
+					ComputeFullyConnected(i);
+					break;
+				}
+
+				if (i == activationMatrix.size() - 1)
+					outputNetInput = activationMatrix[i];
+
+				if (HasActivation(i))
+					activationMatrix[i] = activationMatrix[i].unaryExpr(activationFunction);
+			}
+
+			return true;
+		}
+
+		void ConvolutionalNetwork::GatherKernel(size_t layerId)
+		{
+			auto& layer = layers[layerId - 1];
+			const auto connections = static_cast<Eigen::Index>(layer.connections);
+
+			for (size_t j = 0; j < weightMatrix[layerId - 1].size(); ++j) /* For each filter. */
+			{
+				const auto& weightVect = weightMatrix[layerId - 1][j];
+				layer.kernel.row(static_cast<Eigen::Index>(j)) = weightVect.head(connections).transpose();
+				layer.biases[static_cast<Eigen::Index>(j)] = weightVect[connections];
+			}
+		}
+
+		void ConvolutionalNetwork::ComputeConvolution(size_t layerId)
+		{
+			auto& layer = layers[layerId - 1];
+			const auto& input = layer.input;
+			const auto& output = layer.output;
+			const auto& config = layer.config;
+			const auto* source = activationMatrix[layerId - 1].data();
+
+			/* im2col, a window row is contiguous in the input, so every column is filled with config.height copies. */
+			const auto rowLength = static_cast<Eigen::Index>(config.width * input.channels);
+			Eigen::Index column{ 0 };
+			for (size_t y = 0; y < output.height; ++y)
+			{
+				for (size_t x = 0; x < output.width; ++x, ++column) /* Each output position */
+				{
+					for (size_t dy = 0; dy < config.height; ++dy) /* Each window row */
+					{
+						const auto offset = ((y * config.stride + dy) * input.width + x * config.stride) * input.channels;
+						layer.columns.col(column).segment(static_cast<Eigen::Index>(dy) * rowLength, rowLength) = Eigen::Map<const ActivationVector>(source + offset, rowLength);
+					}
+				}
+			}
+
+			/* All filters at all positions. */
+			Eigen::Map<ColumnMatrix> net(activationMatrix[layerId].data(), static_cast<Eigen::Index>(output.channels), column);
+			net.noalias() = layer.kernel * layer.columns;
+			net.colwise() += layer.biases;
+		}
+
+		void ConvolutionalNetwork::ComputePooling(size_t layerId)
+		{
+			auto& layer = layers[layerId - 1];
+			const auto& in = layer.input;
+			const auto& out = layer.output;
+			const auto& config = layer.config;
+			const auto channels = static_cast<Eigen::Index>(in.channels);
+			const auto isMax = config.type == ConvolutionalLayerType::MaxPooling;
+
+			const Eigen::Map<const ColumnMatrix> input(activationMatrix[layerId - 1].data(), channels, static_cast<Eigen::Index>(in.width * in.height));
+			Eigen::Map<ColumnMatrix> output(activationMatrix[layerId].data(), channels, static_cast<Eigen::Index>(out.width * out.height));
+			if (!isMax)
+				output.setZero();
+
+			for (size_t y = 0; y < out.height; ++y)
+			{
+				for (size_t x = 0; x < out.width; ++x) /* Each output position */
+				{
+					const auto p = static_cast<Eigen::Index>(y * out.width + x);
+					for (size_t dy = 0; dy < config.height; ++dy)
+					{
+						for (size_t dx = 0; dx < config.width; ++dx) /* Each window element */
+						{
+							const auto q = static_cast<Eigen::Index>((y * config.height + dy) * in.width + x * config.width + dx);
+							if (!isMax)
+							{
+								output.col(p) += input.col(q);
+								continue;
+							}
+
+							const auto isFirst = dy == 0 && dx == 0;
+							for (Eigen::Index c = 0; c < channels; ++c) /* Each channel */
+							{
+								if (isFirst || input(c, q) > output(c, p))
+								{
+									output(c, p) = input(c, q);
+									layer.maxima[static_cast<size_t>(p * channels + c)] = q * channels + c;
+								}
+							}
+						}
+					}
+				}
+			}
+
+			if (!isMax)
+				output /= static_cast<SignalUnit>(config.width * config.height);
+		}
+
+		void ConvolutionalNetwork::ComputeFullyConnected(size_t layerId)
+		{
+			const auto connections = static_cast<Eigen::Index>(layers[layerId - 1].connections);
+			const auto& prevLayer = activationMatrix[layerId - 1];
+
+			for (size_t j = 0; j < weightMatrix[layerId - 1].size(); ++j) /* Each neuron */
+			{
+				const auto& weightVect = weightMatrix[layerId - 1][j];
+				activationMatrix[layerId][static_cast<Eigen::Index>(j)] = weightVect[connections] + prevLayer.dot(weightVect.head(connections));
+			}
+		}
+
+		void ConvolutionalNetwork::AccumulateGradient(ErrorVector const& outputDelta, ErrorGradientMatrix& gradient)
+		{
+			NNS_TRACE_AGGREGATE("ConvolutionalNetwork::AccumulateGradient");
+
+			delta.head(static_cast<Eigen::Index>(outputDelta.size())) = Eigen::Map<const ActivationVector>(outputDelta.data(), static_cast<Eigen::Index>(outputDelta.size()));
+
+			for (size_t i = layers.size(); i > 0; --i) /* For each layer ( minus input layer ), backwards. */
+			{
+				switch (layers[i - 1].config.type)
+				{
+				case ConvolutionalLayerType::Convolution:
+					BackpropagateConvolution(i, gradient);
+					break;
+				case ConvolutionalLayerType::MaxPooling:
+				case ConvolutionalLayerType::AveragePooling:
+					BackpropagatePooling(i);
+					break;
+				case ConvolutionalLayerType::FullyConnected:
+				default:
+					BackpropagateFullyConnected(i, gradient);
+					break;
+				}
+
+				if (i > 1 && HasActivation(i - 1)) /* Previous layer's delta is taken with respect to its net inputs. */
+				{
+					const auto& activation = activationMatrix[i - 1].array();
+					previousDelta.head(activation.size()).array() *= activation * (1.0 - activation);
+				}
+
+				delta.swap(previousDelta);
+			}
+		}
+
+		void ConvolutionalNetwork::BackpropagateConvolution(size_t layerId, ErrorGradientMatrix& gradient)
+		{
+			auto& layer = layers[layerId - 1];
+			const auto& input = layer.input;
+			const auto& output = layer.output;
+			const auto& config = layer.config;
+			const auto connections = static_cast<Eigen::Index>(layer.connections);
+			const Eigen::Map<const ColumnMatrix> outputDelta(delta.data(), static_cast<Eigen::Index>(output.channels), layer.columns.cols());
+
+			/* Filter gradient sums over all positions, the columns still hold this presentation's windows. */
+			layer.kernelGradient.noalias() = outputDelta * layer.columns.transpose();
+			for (size_t j = 0; j < gradient[layerId - 1].size(); ++j) /* For each filter. */
+			{
+				auto& filterGradient = gradient[layerId - 1][j];
+				Eigen::Map<ActivationVector>(filterGradient.data(), connections) += layer.kernelGradient.row(static_cast<Eigen::Index>(j)).transpose();
+				filterGradient.back() += outputDelta.row(static_cast<Eigen::Index>(j)).sum(); /* Bias activation is always equal to 1.*/
+			}
+
+			if (layerId == 1)
+				return;
+
+			/* col2im, every window adds its share of the input delta. */
+			layer.columnsDelta.noalias() = layer.kernel.transpose() * outputDelta;
+			previousDelta.head(static_cast<Eigen::Index>(input.GetSize())).setZero();
+
+			const auto rowLength = static_cast<Eigen::Index>(config.width * input.channels);
+			Eigen::Index column{ 0 };
+			for (size_t y = 0; y < output.height; ++y)
+			{
+				for (size_t x = 0; x < output.width; ++x, ++column) /* Each output position */
+				{
+					for (size_t dy = 0; dy < config.height; ++dy) /* Each window row */
+					{
+						const auto offset = static_cast<Eigen::Index>(((y * config.stride + dy) * input.width + x * config.stride) * input.channels);
+						previousDelta.segment(offset, rowLength) += layer.columnsDelta.col(column).segment(static_cast<Eigen::Index>(dy) * rowLength, rowLength);
+					}
+				}
+			}
+		}
+
+		void ConvolutionalNetwork::BackpropagatePooling(size_t layerId)
+		{
+			if (layerId == 1) /* No weights, nothing to pass to. */
+				return;
+
+			const auto& layer = layers[layerId - 1];
+			const auto& in = layer.input;
+			const auto& out = layer.output;
+			const auto& config = layer.config;
+			previousDelta.head(static_cast<Eigen::Index>(in.GetSize())).setZero();
+
+			if (config.type == ConvolutionalLayerType::MaxPooling)
+			{
+				for (size_t i = 0; i < layer.maxima.size(); ++i) /* Each output element, only the selected input gets the delta. */
+					previousDelta[layer.maxima[i]] += delta[static_cast<Eigen::Index>(i)];
+				return;
+			}
+
+			const auto channels = static_cast<Eigen::Index>(in.channels);
+			const auto share = 1.0 / static_cast<SignalUnit>(config.width * config.height);
+			const Eigen::Map<const ColumnMatrix> outputDelta(delta.data(), channels, static_cast<Eigen::Index>(out.width * out.height));
+			Eigen::Map<ColumnMatrix> inputDelta(previousDelta.data(), channels, static_cast<Eigen::Index>(in.width * in.height));
+
+			for (size_t y = 0; y < out.height; ++y)
+				for (size_t x = 0; x < out.width; ++x) /* Each output position */
+					for (size_t dy = 0; dy < config.height; ++dy)
+						for (size_t dx = 0; dx < config.width; ++dx) /* Each window element */
+							inputDelta.col(static_cast<Eigen::Index>((y * config.height + dy) * in.width + x * config.width + dx)) += share * outputDelta.col(static_cast<Eigen::Index>(y * out.width + x));
+		}
+
+		void ConvolutionalNetwork::BackpropagateFullyConnected(size_t layerId, ErrorGradientMatrix& gradient)
+		{
+			const auto connections = static_cast<Eigen::Index>(layers[layerId - 1].connections);
+			const auto& prevLayer = activationMatrix[layerId - 1];
+
+			for (size_t j = 0; j < gradient[layerId - 1].size(); ++j) /* For each neuron. */
+			{
+				const auto neuronDelta = delta[static_cast<Eigen::Index>(j)];
+				auto& neuronGradient = gradient[layerId - 1][j];
+				Eigen::Map<ActivationVector>(neuronGradient.data(), connections) += neuronDelta * prevLayer;
+				neuronGradient.back() += neuronDelta; /* Bias activation is always equal to 1.*/
+			}
+
+			if (layerId == 1)
+				return;
+
+			previousDelta.head(connections).setZero();
+			for (size_t j = 0; j < weightMatrix[layerId - 1].size(); ++j) /* For each neuron. */
+				previousDelta.head(connections) += delta[static_cast<Eigen::Index>(j)] * weightMatrix[layerId - 1][j].head(connections);
+		}
+
+		bool ConvolutionalNetwork::HasActivation(size_t layerId) const
+		{
+			if (layerId == 0)
+				return false;
+
+			const auto type = layers[layerId - 1].config.type;
+			return type == ConvolutionalLayerType::Convolution || type == ConvolutionalLayerType::FullyConnected;
+		}
+
+		SignalUnit ConvolutionalNetwork::GetActivationDerivative(int layerId, int neuronId) const
+		{
+			if (!HasActivation(static_cast<size_t>(layerId)))
+				return 1.0;
+
+			const auto activation = GetActivation(layerId, neuronId);
+			return activation * (1.0 - activation);
+		}
+
+		ActivationVector const& ConvolutionalNetwork::GetOutputNetInput() const
+		{
+			return outputNetInput;
+		}
+
+		WeightVector& ConvolutionalNetwork::GetWeightVector(int layerId, int neuronId)
+		{
+			if (layerId < 1 || static_cast<size_t>(layerId) > layers.size() || !HasActivation(static_cast<size_t>(layerId)))
+			{
+				throw std::invalid_argument("Layer has no weights");
+			}
+			auto& layer = weightMatrix[layerId - 1];
+			if (neuronId < 0 || static_cast<size_t>(neuronId) >= layer.size())
+			{
+				throw std::invalid_argument("Invalid neuron id");
+			}
+			return layer[neuronId];
+		}
+
+		WeightUnit& ConvolutionalNetwork::Weight(int layerId, int neuronId, int connectionId)
+		{
+			auto& weightVect = GetWeightVector(layerId, neuronId);
+			if (connectionId < 0 || connectionId >= weightVect.size())
+			{
+				throw std::invalid_argument("Invalid connection id");
+			}
+			isWeightMagLimited = true;
+			return weightVect[connectionId];
+		}
+
+		WeightUnit& ConvolutionalNetwork::Bias(int layerId, int neuronId)
+		{
+			auto& weightVect = GetWeightVector(layerId, neuronId);
+			isWeightMagLimited = true;
+			return weightVect.tail(1)[0];
+		}
+
+		void ConvolutionalNetwork::SetBiasForAll(WeightUnit value)
+		{
+			for (auto& layer : weightMatrix) /* Each layer, except first */
+				for (auto& weightVect : layer) /* Each filter or neuron */
+					weightVect.tail(1)[0] = value;
+		}
+
+		TensorShape ConvolutionalNetwork::GetLayerShape(int layerId) const
+		{
+			if (layerId < 0 || static_cast<size_t>(layerId) > layers.size())
+			{
+				throw std::invalid_argument("Invalid layer id");
+			}
+			return layerId == 0 ? layers.front().input : layers[layerId - 1].output;
+		}
+
+		ConvolutionalLayerConfig const& ConvolutionalNetwork::GetLayerConfig(int layerId) const
+		{
+			if (layerId < 1 || static_cast<size_t>(layerId) > layers.size())
+			{
+				throw std::invalid_argument("Invalid layer id");
+			}
+			return layers[layerId - 1].config;
+		}
+	}
+}
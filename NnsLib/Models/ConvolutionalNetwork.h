@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Models/FeedforwardNetworkBase.h"
+#include "Common/ActivationFunctions.h"
+#include "Types/Collections.h"
+
+namespace NNS
+{
+	namespace Models
+	{
+		using namespace NNS::Types;
+		using namespace NNS::Activation;
+
+		/** Size of a layer's signal. Elements are stored channel fastest, element ( x, y, c ) is at ( y * width + x ) * channels + c.
+		* One dimensional signals have height 1.
+		*/
+		struct TensorShape final
+		{
+			size_t channels{ 1 };
+			size_t width{ 1 };
+			size_t height{ 1 };
+
+			size_t GetSize() const { return channels * width * height; }
+		};
+
+		enum class ConvolutionalLayerType : unsigned int
+		{
+			Convolution = 0,
+			MaxPooling,
+			AveragePooling,
+			FullyConnected
+		};
+
+		struct ConvolutionalLayerConfig final
+		{
+			ConvolutionalLayerType type{ ConvolutionalLayerType::Convolution };
+			// Filters of a convolution or neurons of a fully connected layer, pooling keeps its input's channels.
+			size_t channels{ 1 };
+			// Filter or pooling window.
+			size_t width{ 1 };
+			size_t height{ 1 };
+			// Distance between neighboring convolution windows, pooling windows never overlap.
+			size_t stride{ 1 };
+
+			static ConvolutionalLayerConfig Convolution(size_t filters, size_t width, size_t height = 1, size_t stride = 1);
+			static ConvolutionalLayerConfig MaxPooling(size_t width, size_t height = 1);
+			static ConvolutionalLayerConfig AveragePooling(size_t width, size_t height = 1);
+			static ConvolutionalLayerConfig FullyConnected(size_t neurons);
+		};
+
+		/** Convolutional network for one dimensional signals and small images.
+		* Convolution and fully connected layers apply the logistic function, pooling layers pass values through. Windows only cover
+		* the input ( no padding ), pooling drops the rows and columns that do not fill a whole window.
+		* Weight vector of a filter holds width * height * input channels weights in the order of the window's input elements, then bias.
+		* Fully connected layers have one vector per neuron, pooling layers none. All positions share the filter, so there are fewer
+		* weight vectors than neurons, loop over GetWeightMatrix() rather than GetNetworkLayerMap() to visit the weights.
+		* Convolutions run as im2col + GEMM: every window is copied into a column of a matrix, one matrix product then applies
+		* all filters at all positions. Backward pass reuses the columns for the filter gradient and scatters the input gradient back ( col2im ).
+		*/
+		class ConvolutionalNetwork final : public FeedforwardNetworkBase, public IBiased, public IDifferentiable
+		{
+		public:
+			ConvolutionalNetwork(TensorShape inputShape, vector<ConvolutionalLayerConfig> const& layerConfigs);
+
+			IFeedforwardNetwork::Ptr Clone() const override;
+
+			bool ComputeOutput(InputLayer const& inputLayer) override;
+			void Rebuild() override;
+
+			SignalUnit GetActivationDerivative(int layerId, int neuronId) const override;
+			ActivationVector const& GetOutputNetInput() const override;
+
+			/** @throw std::invalid_argument for pooling and input layers, which have no weights, or ids out of range. */
+			WeightUnit& Weight(int layerId, int neuronId, int connectionId) override;
+			/** @throw std::invalid_argument for pooling and input layers, which have no weights, or ids out of range. */
+			WeightUnit& Bias(int layerId, int neuronId) override;
+			void SetBiasForAll(WeightUnit value = 1.0) override;
+
+			void AccumulateGradient(ErrorVector const& outputDelta, ErrorGradientMatrix& gradient) override;
+
+			/** @param layerId 0 for the input layer. */
+			TensorShape GetLayerShape(int layerId) const;
+			ConvolutionalLayerConfig const& GetLayerConfig(int layerId) const;
+
+		private:
+			using ColumnMatrix = Eigen::Matrix<SignalUnit, Eigen::Dynamic, Eigen::Dynamic>;
+			using KernelMatrix = Eigen::Matrix<WeightUnit, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+			struct Layer final
+			{
+				ConvolutionalLayerConfig config;
+				TensorShape input;
+				TensorShape output;
+				size_t connections{ 0 }; /**< Weights per filter or neuron, bias excluded. */
+
+				KernelMatrix kernel; /**< Weights gathered for the matrix product, one row per filter or neuron. */
+				ActivationVector biases;
+				ColumnMatrix columns; /**< im2col of the last input, one column per output position. */
+				vector<Eigen::Index> maxima; /**< Max pooling, input element selected for every output element. */
+
+				KernelMatrix kernelGradient; /**< Backward pass buffers, sized once so that training does not allocate. */
+				ColumnMatrix columnsDelta;
+			};
+
+			static vector<Layer> BuildLayers(TensorShape inputShape, vector<ConvolutionalLayerConfig> const& configs);
+			static NetworkLayerMap GetLayerMap(vector<Layer> const& layers);
+
+			ConvolutionalNetwork(vector<Layer> builtLayers);
+
+			void GatherKernel(size_t layerId);
+			void ComputeConvolution(size_t layerId);
+			void ComputePooling(size_t layerId);
+			void ComputeFullyConnected(size_t layerId);
+
+			/** Turns delta of the layer's outputs into delta of its inputs, adding the layer's weight gradient on the way. */
+			void BackpropagateConvolution(size_t layerId, ErrorGradientMatrix& gradient);
+			void BackpropagatePooling(size_t layerId);
+			void BackpropagateFullyConnected(size_t layerId, ErrorGradientMatrix& gradient);
+
+			bool HasActivation(size_t layerId) const;
+			/** Weights of a filter or neuron, bias last. */
+			WeightVector& GetWeightVector(int layerId, int neuronId);
+
+			vector<Layer> layers; /**< layers[ layerId - 1 ] */
+			ActivationVector outputNetInput;
+
+			ActivationVector delta; /**< Error delta of the layer being backpropagated, sized for the largest layer. */
+			ActivationVector previousDelta;
+
+			LogisticActivationFunction<SignalUnit> activationFunction;
+		};
+	}
+}
@@ -7,6 +7,11 @@ namespace NNS
 	{
 
 		FeedforwardNetworkBase::FeedforwardNetworkBase(std::initializer_list<int> networkLayerMap)
+			: FeedforwardNetworkBase(NetworkLayerMap(networkLayerMap.begin(), networkLayerMap.end()))
+		{
+		}
+
+		FeedforwardNetworkBase::FeedforwardNetworkBase(NetworkLayerMap const& networkLayerMap)
 		{
 			if (networkLayerMap.size() < 2)
 			{ 
@@ -51,6 +56,11 @@ namespace NNS
 			return weightMatrix[layerId - 1][neuronId][connectionId];
 		}
 
+		ConnectivityPattern const* FeedforwardNetworkBase::GetConnectivity(int /*layerId*/) const
+		{
+			return nullptr; /* Fully connected. */
+		}
+
 		SignalUnit const& FeedforwardNetworkBase::GetActivation(int layerId, int neuronId) const
 		{
 			return activationMatrix[layerId][neuronId];
@@ -61,6 +71,11 @@ namespace NNS
 			return activationMatrix.back()[neuronId];
 		}
 
+		ActivationVector const& FeedforwardNetworkBase::GetOutputNetInput() const
+		{
+			return activationMatrix.back();
+		}
+
 		NetworkLayerMap FeedforwardNetworkBase::GetNetworkLayerMap() const
 		{
 			NetworkLayerMap layers(activationMatrix.size());
@@ -112,5 +127,10 @@ namespace NNS
 
 			return weightMatrix;
 		}
+
+		WeightMatrix const& FeedforwardNetworkBase::GetWeightMatrix() const
+		{
+			return weightMatrix;
+		}
 	} 
 }
\ No newline at end of file
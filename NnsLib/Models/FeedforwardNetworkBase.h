@@ -12,6 +12,7 @@ namespace NNS
 		{
 		public:
 			explicit FeedforwardNetworkBase(std::initializer_list<int> networkLayerMap);
+			explicit FeedforwardNetworkBase(NetworkLayerMap const& networkLayerMap);
 
 			void Free() const override;
 
@@ -21,9 +22,13 @@ namespace NNS
 			ActivationMatrix const& GetActivationMatrix() const override;
 			SignalUnit const& GetActivation(int layerId, int neuronId) const override;
 			SignalUnit const& GetOutputActivation(int neuronId) const override;
+			/** Output activations, the output layer is linear unless a derived network says otherwise. */
+			ActivationVector const& GetOutputNetInput() const override;
 
 			WeightMatrix& GetWeightMatrix() override;
+			WeightMatrix const& GetWeightMatrix() const override;
 			WeightUnit& Weight(int layerId, int neuronId, int connectionId) override;
+			ConnectivityPattern const* GetConnectivity(int layerId) const override;
 
 			void SetWeightMagnitudeLimit(WeightUnit limit = 5.0);
 
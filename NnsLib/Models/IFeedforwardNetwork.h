@@ -16,6 +16,8 @@ namespace NNS
 		public:
 			using Ptr = std::unique_ptr<IFeedforwardNetwork, SDeleter>;
 		public:
+			virtual Ptr Clone() const = 0;
+
 			virtual NetworkLayerMap GetNetworkLayerMap() const = 0;
 			virtual bool ComputeOutput(InputLayer const& inputLayer) = 0;
 			virtual void Rebuild() = 0;
@@ -24,9 +26,18 @@ namespace NNS
 			virtual SignalUnit const& GetActivation(int layerId, int neuronId) const = 0;
 			virtual SignalUnit GetActivationDerivative(int layerId, int neuronId) const = 0;
 			virtual SignalUnit const& GetOutputActivation(int neuronId) const = 0;
+			/** Output layer's weighted input sums before the activation function, i.e. logits of a logistic output layer. */
+			virtual ActivationVector const& GetOutputNetInput() const = 0;
 
 			virtual WeightMatrix& GetWeightMatrix() = 0;
+			virtual WeightMatrix const& GetWeightMatrix() const = 0;
+			/** Connection ids index the neuron's weight vector: previous layer neuron for fully connected layers,
+			* position in the neuron's connectivity row for sparse ones. Bias, if any, comes last.
+			*/
 			virtual WeightUnit& Weight(int layerId, int neuronId, int connectionId) = 0;
+
+			/** Previous layer neurons feeding each neuron of the layer, in the order of its weights. nullptr if fully connected. */
+			virtual ConnectivityPattern const* GetConnectivity(int layerId) const = 0;
 		};
 
 		// Additional behaviours
@@ -37,5 +48,17 @@ namespace NNS
 			virtual WeightUnit& Bias(int layerId, int neuronId) = 0;
 			virtual void SetBiasForAll(WeightUnit value = 1.0) = 0;
 		};
+
+		/** Networks whose weights are not one vector per neuron, e.g. convolution filters shared by all positions, backpropagate themselves.
+		* Their error gradient is shaped like their weight matrix, TrainingErrorState only supplies the output layer's deltas.
+		*/
+		class IDifferentiable
+		{
+		public:
+			/** Add the negative error gradient of the last ComputeOutput() to the gradient.
+			* @param outputDelta negative derivative of the error with respect to the output layer's net inputs.
+			*/
+			virtual void AccumulateGradient(ErrorVector const& outputDelta, ErrorGradientMatrix& gradient) = 0;
+		};
 	}
 }
\ No newline at end of file
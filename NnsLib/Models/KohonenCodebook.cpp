@@ -0,0 +1,110 @@
+#include "pch.h"
+#include "Models/KohonenCodebook.h"
+#include "Diagnostics/Tracing.h"
+
+#include <algorithm>
+
+namespace NNS
+{
+	namespace Models
+	{
+		/* Samples searched per matrix product, the distance block of 64 samples x thousands of neurons stays in L2. */
+		static constexpr Eigen::Index SampleBlockSize = 64;
+
+		KohonenCodebook::KohonenCodebook(KohonenNetwork& network)
+		{
+			Load(network);
+		}
+
+		void KohonenCodebook::Load(KohonenNetwork& network)
+		{
+			const auto& neurons = network.GetWeightMatrix().back();
+			const auto input_size = network.GetNetworkLayerMap().front();
+
+			weights.resize(static_cast<Eigen::Index>(neurons.size()), static_cast<Eigen::Index>(input_size));
+			for (size_t j = 0; j < neurons.size(); ++j) /* Each neuron */
+				weights.row(static_cast<Eigen::Index>(j)) = neurons[j].transpose();
+
+			UpdateNorms();
+		}
+
+		void KohonenCodebook::Store(KohonenNetwork& network) const
+		{
+			auto& neurons = network.GetWeightMatrix().back();
+			assert(neurons.size() == GetNeuronCount());
+
+			for (size_t j = 0; j < neurons.size(); ++j) /* Each neuron */
+				neurons[j] = weights.row(static_cast<Eigen::Index>(j)).transpose();
+		}
+
+		size_t KohonenCodebook::GetNeuronCount() const
+		{
+			return static_cast<size_t>(weights.rows());
+		}
+
+		size_t KohonenCodebook::GetInputSize() const
+		{
+			return static_cast<size_t>(weights.cols());
+		}
+
+		RowMatrix const& KohonenCodebook::GetWeights() const
+		{
+			return weights;
+		}
+
+		RowMatrix::RowXpr KohonenCodebook::Neuron(size_t neuronId)
+		{
+			return weights.row(static_cast<Eigen::Index>(neuronId));
+		}
+
+		void KohonenCodebook::UpdateNorm(size_t neuronId)
+		{
+			squaredNorms[static_cast<Eigen::Index>(neuronId)] = weights.row(static_cast<Eigen::Index>(neuronId)).squaredNorm();
+		}
+
+		void KohonenCodebook::UpdateNorms()
+		{
+			squaredNorms = weights.rowwise().squaredNorm();
+		}
+
+		size_t KohonenCodebook::FindBestMatchingUnit(Eigen::Ref<const ActivationVector> inputLayer) const
+		{
+			assert(static_cast<size_t>(inputLayer.size()) == GetInputSize());
+
+			Eigen::Index best{ 0 };
+			(squaredNorms - 2.0 * (weights * inputLayer)).minCoeff(&best);
+			return static_cast<size_t>(best);
+		}
+
+		void KohonenCodebook::FindBestMatchingUnits(Eigen::Ref<const RowMatrix> samples, vector<size_t>& bestUnits, vector<SignalUnit>* squaredDistances) const
+		{
+			NNS_TRACE_SCOPE("KohonenCodebook::FindBestMatchingUnits");
+			assert(static_cast<size_t>(samples.cols()) == GetInputSize());
+
+			bestUnits.resize(static_cast<size_t>(samples.rows()));
+			if (squaredDistances != nullptr)
+				squaredDistances->resize(static_cast<size_t>(samples.rows()));
+
+			RowMatrix distances(std::min(SampleBlockSize, samples.rows()), weights.rows());
+			for (Eigen::Index begin = 0; begin < samples.rows(); begin += SampleBlockSize)
+			{
+				const auto count = std::min(SampleBlockSize, samples.rows() - begin);
+				auto block = distances.topRows(count);
+
+				/* -2 x.w for every sample and neuron, then add |w|^2 per neuron. */
+				block.noalias() = -2.0 * samples.middleRows(begin, count) * weights.transpose();
+				block.rowwise() += squaredNorms.transpose();
+
+				for (Eigen::Index i = 0; i < count; ++i) /* Each sample in block */
+				{
+					Eigen::Index best{ 0 };
+					const auto distance = block.row(i).minCoeff(&best);
+					bestUnits[static_cast<size_t>(begin + i)] = static_cast<size_t>(best);
+
+					if (squaredDistances != nullptr)
+						(*squaredDistances)[static_cast<size_t>(begin + i)] = std::max<SignalUnit>(0.0, distance + samples.row(begin + i).squaredNorm());
+				}
+			}
+		}
+	}
+}
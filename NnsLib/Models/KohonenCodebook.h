@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Common/EigenSettings.h"
+#include <Eigen/Core>
+
+#include "Types/Collections.h"
+#include "Models/KohonenNetwork.h"
+
+namespace NNS
+{
+	namespace Models
+	{
+		using namespace NNS::Types;
+
+		/** One vector per row, e.g. codebook neurons or input samples. */
+		using RowMatrix = Eigen::Matrix<SignalUnit, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+		/** Contiguous copy of a Kohonen map's weights for best-matching-unit search.
+		* Squared Euclidean distance is expanded to |w|^2 - 2 w.x + |x|^2, so the search becomes a matrix product
+		* against the cached neuron norms ( |x|^2 does not change the winner ). Eigen vectorizes the product over the whole codebook.
+		* After changing a neuron through Neuron(), call UpdateNorm() for it before searching again.
+		*/
+		class KohonenCodebook final
+		{
+		public:
+			KohonenCodebook() = default;
+			explicit KohonenCodebook(KohonenNetwork& network);
+
+			void Load(KohonenNetwork& network);
+			void Store(KohonenNetwork& network) const;
+
+			size_t GetNeuronCount() const;
+			size_t GetInputSize() const;
+
+			RowMatrix const& GetWeights() const;
+			RowMatrix::RowXpr Neuron(size_t neuronId);
+
+			void UpdateNorm(size_t neuronId);
+			void UpdateNorms();
+
+			size_t FindBestMatchingUnit(Eigen::Ref<const ActivationVector> inputLayer) const;
+
+			/** Best matching units of many samples at once, processed in blocks of rows so distances stay in cache.
+			* Safe to call from several threads on different sample ranges.
+			* @param samples one sample per row.
+			* @param bestUnits resized to the number of samples.
+			* @param squaredDistances optional, receives squared distance of each sample to its best matching unit.
+			*/
+			void FindBestMatchingUnits(Eigen::Ref<const RowMatrix> samples, vector<size_t>& bestUnits, vector<SignalUnit>* squaredDistances = nullptr) const;
+
+		private:
+			RowMatrix weights;
+			ActivationVector squaredNorms;
+		};
+	}
+}
@@ -0,0 +1,239 @@
+#include "pch.h"
+#include "Models/KohonenIndex.h"
+#include "Diagnostics/Tracing.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+namespace NNS
+{
+	namespace Models
+	{
+		namespace
+		{
+			using Candidate = std::pair<SignalUnit, size_t>;
+
+			/** Work areas of a lookup. Lookups are const and may run concurrently, so every thread keeps its own,
+			* they only grow, and a thread allocates nothing once it has seen its largest k and leaf.
+			*/
+			struct SearchScratch final
+			{
+				vector<Candidate> nearest; /**< Max-heap of the best k so far, worst on top. */
+				vector<Candidate> pending; /**< Min-heap of nodes waiting to be visited, closest box on top. */
+				ActivationVector distances; /**< Squared distances of the current leaf's neurons, leading part. */
+				vector<size_t> best; /**< FindBestMatchingUnit() result. */
+			};
+
+			SearchScratch& GetSearchScratch()
+			{
+				thread_local SearchScratch scratch;
+				return scratch;
+			}
+		}
+
+		KohonenIndex::KohonenIndex(KohonenIndexConfig config)
+			: Config{ config }
+		{
+			if (Config.leafSize == 0)
+			{
+				throw std::invalid_argument("Leaf size has to be positive");
+			}
+		}
+
+		KohonenIndex::KohonenIndex(KohonenCodebook const& codebook, KohonenIndexConfig config)
+			: KohonenIndex(config)
+		{
+			Build(codebook);
+		}
+
+		void KohonenIndex::Build(KohonenCodebook const& codebook)
+		{
+			NNS_TRACE_SCOPE("KohonenIndex::Build");
+
+			const auto& weights = codebook.GetWeights();
+			neuronIds.resize(codebook.GetNeuronCount());
+			std::iota(neuronIds.begin(), neuronIds.end(), size_t{ 0 });
+
+			nodes.clear();
+			if (!neuronIds.empty())
+				BuildNode(weights, 0, weights.rows());
+
+			points.resize(weights.rows(), weights.cols());
+			Refresh(codebook);
+		}
+
+		void KohonenIndex::Refresh(KohonenCodebook const& codebook)
+		{
+			NNS_TRACE_SCOPE("KohonenIndex::Refresh");
+
+			const auto& weights = codebook.GetWeights();
+			if (static_cast<size_t>(weights.rows()) != neuronIds.size() || weights.cols() != points.cols())
+			{
+				throw std::invalid_argument("Codebook does not match the index, rebuild it instead");
+			}
+
+			for (size_t i = 0; i < neuronIds.size(); ++i) /* Each neuron */
+				points.row(static_cast<Eigen::Index>(i)) = weights.row(static_cast<Eigen::Index>(neuronIds[i]));
+
+			UpdateBounds();
+		}
+
+		size_t KohonenIndex::GetNeuronCount() const
+		{
+			return neuronIds.size();
+		}
+
+		size_t KohonenIndex::FindBestMatchingUnit(Eigen::Ref<const ActivationVector> inputLayer) const
+		{
+			if (GetNeuronCount() == 0)
+			{
+				throw std::logic_error("Index is empty, build it from a codebook first");
+			}
+
+			auto& best = GetSearchScratch().best;
+			FindNearestUnits(inputLayer, 1, best);
+			return best.front();
+		}
+
+		void KohonenIndex::FindNearestUnits(Eigen::Ref<const ActivationVector> inputLayer, size_t k, vector<size_t>& nearestIds, vector<SignalUnit>* squaredDistances) const
+		{
+			NNS_TRACE_AGGREGATE("KohonenIndex::FindNearestUnits");
+			assert(inputLayer.size() == points.cols());
+
+			auto& scratch = GetSearchScratch();
+			auto& nearest = scratch.nearest;
+			auto& pending = scratch.pending;
+			const auto closer = std::greater<Candidate>{};
+
+			k = std::min(k, GetNeuronCount());
+			nearest.clear();
+			pending.clear();
+			if (k > 0)
+				pending.emplace_back(BoxDistance(0, inputLayer), 0);
+
+			size_t checks{ 0 };
+			while (!pending.empty())
+			{
+				std::pop_heap(pending.begin(), pending.end(), closer);
+				const auto [boxDistance, nodeId] = pending.back();
+				pending.pop_back();
+
+				if (nearest.size() == k && boxDistance >= nearest.front().first)
+					break; /* No closer neuron left in any pending box. */
+
+				const auto& node = nodes[nodeId];
+				if (node.left != 0)
+				{
+					pending.emplace_back(BoxDistance(node.left, inputLayer), node.left);
+					std::push_heap(pending.begin(), pending.end(), closer);
+					pending.emplace_back(BoxDistance(node.right, inputLayer), node.right);
+					std::push_heap(pending.begin(), pending.end(), closer);
+					continue;
+				}
+
+				const auto leafSize = node.end - node.begin;
+				if (scratch.distances.size() < leafSize)
+					scratch.distances.resize(leafSize);
+				auto distances = scratch.distances.head(leafSize);
+				distances.noalias() = (points.middleRows(node.begin, leafSize).rowwise() - inputLayer.transpose()).rowwise().squaredNorm();
+				for (Eigen::Index i = 0; i < distances.size(); ++i) /* Each neuron in leaf */
+				{
+					if (nearest.size() < k || distances[i] < nearest.front().first)
+					{
+						nearest.emplace_back(distances[i], neuronIds[static_cast<size_t>(node.begin + i)]);
+						std::push_heap(nearest.begin(), nearest.end());
+						if (nearest.size() > k)
+						{
+							std::pop_heap(nearest.begin(), nearest.end());
+							nearest.pop_back();
+						}
+					}
+				}
+
+				checks += static_cast<size_t>(distances.size());
+				if (Config.maxChecks != 0 && checks >= Config.maxChecks && nearest.size() == k)
+					break;
+			}
+
+			std::sort_heap(nearest.begin(), nearest.end());
+
+			nearestIds.resize(nearest.size());
+			if (squaredDistances != nullptr)
+				squaredDistances->resize(nearest.size());
+
+			for (size_t i = 0; i < nearest.size(); ++i)
+			{
+				nearestIds[i] = nearest[i].second;
+				if (squaredDistances != nullptr)
+					(*squaredDistances)[i] = nearest[i].first;
+			}
+		}
+
+		size_t KohonenIndex::BuildNode(RowMatrix const& weights, Eigen::Index begin, Eigen::Index end)
+		{
+			const auto nodeId = nodes.size();
+			nodes.push_back(Node{ begin, end });
+
+			if (static_cast<size_t>(end - begin) <= Config.leafSize)
+				return nodeId;
+
+			/* Split at the median of the dimension with the widest spread. */
+			ActivationVector lower = weights.row(static_cast<Eigen::Index>(neuronIds[begin])).transpose();
+			ActivationVector upper = lower;
+			for (auto i = begin + 1; i < end; ++i)
+			{
+				lower = lower.cwiseMin(weights.row(static_cast<Eigen::Index>(neuronIds[i])).transpose());
+				upper = upper.cwiseMax(weights.row(static_cast<Eigen::Index>(neuronIds[i])).transpose());
+			}
+
+			Eigen::Index dimension{ 0 };
+			(upper - lower).maxCoeff(&dimension);
+
+			const auto middle = begin + (end - begin) / 2;
+			std::nth_element(neuronIds.begin() + begin, neuronIds.begin() + middle, neuronIds.begin() + end, [&](size_t a, size_t b)
+			{
+				return weights(static_cast<Eigen::Index>(a), dimension) < weights(static_cast<Eigen::Index>(b), dimension);
+			});
+
+			const auto left = BuildNode(weights, begin, middle);
+			const auto right = BuildNode(weights, middle, end);
+			nodes[nodeId].left = left;
+			nodes[nodeId].right = right;
+			return nodeId;
+		}
+
+		void KohonenIndex::UpdateBounds()
+		{
+			lowerBounds.resize(static_cast<Eigen::Index>(nodes.size()), points.cols());
+			upperBounds.resize(static_cast<Eigen::Index>(nodes.size()), points.cols());
+
+			/* Children always follow their parent, so walking backwards visits them first. */
+			for (auto n = nodes.size(); n-- > 0;)
+			{
+				const auto& node = nodes[n];
+				const auto row = static_cast<Eigen::Index>(n);
+				if (node.left == 0)
+				{
+					lowerBounds.row(row) = points.middleRows(node.begin, node.end - node.begin).colwise().minCoeff();
+					upperBounds.row(row) = points.middleRows(node.begin, node.end - node.begin).colwise().maxCoeff();
+				}
+				else
+				{
+					const auto left = static_cast<Eigen::Index>(node.left), right = static_cast<Eigen::Index>(node.right);
+					lowerBounds.row(row) = lowerBounds.row(left).cwiseMin(lowerBounds.row(right));
+					upperBounds.row(row) = upperBounds.row(left).cwiseMax(upperBounds.row(right));
+				}
+			}
+		}
+
+		SignalUnit KohonenIndex::BoxDistance(size_t nodeId, Eigen::Ref<const ActivationVector> inputLayer) const
+		{
+			const auto row = static_cast<Eigen::Index>(nodeId);
+			const auto below = (lowerBounds.row(row).transpose() - inputLayer).cwiseMax(0.0);
+			const auto above = (inputLayer - upperBounds.row(row).transpose()).cwiseMax(0.0);
+			return (below + above).squaredNorm();
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Common/EigenSettings.h"
+#include <Eigen/Core>
+
+#include "Types/Collections.h"
+#include "Models/KohonenCodebook.h"
+
+namespace NNS
+{
+	namespace Models
+	{
+		using namespace NNS::Types;
+
+		struct KohonenIndexConfig final
+		{
+			// Neurons stored in one leaf, scanned together with a single matrix product.
+			size_t leafSize{ 32 };
+			// Neurons compared before the search gives up and returns what it has found so far. Zero means exact search.
+			// Trades recall for speed, a few hundred checks usually find the true winner on well trained maps.
+			size_t maxChecks{ 0 };
+		};
+
+		/** KD-tree over a KohonenCodebook for sub-linear best matching unit lookups on large maps.
+		* Every node keeps the bounding box of its neurons and the search visits nodes best-first by distance to that box,
+		* so results stay exact as long as the boxes are up to date, no matter how well the splits fit the current weights.
+		* Build() sorts the neurons into a new tree, O( N log N ). Refresh() keeps the tree and only recomputes boxes, O( N ),
+		* which is enough after fine tuning; rebuild after training from scratch, when neurons moved far from their original leaves.
+		* Exact search stays sub-linear only for low dimensional inputs, above roughly ten dimensions limit maxChecks.
+		* Lookups are const and can run concurrently. Every thread reuses its own search buffers, so repeated lookups do not allocate.
+		*/
+		class KohonenIndex final
+		{
+		public:
+			const KohonenIndexConfig Config;
+
+			explicit KohonenIndex(KohonenIndexConfig config = {});
+			KohonenIndex(KohonenCodebook const& codebook, KohonenIndexConfig config = {});
+
+			void Build(KohonenCodebook const& codebook);
+
+			/** Copy current weights of the same codebook into the existing tree. */
+			void Refresh(KohonenCodebook const& codebook);
+
+			size_t GetNeuronCount() const;
+
+			/** Throws std::logic_error when the index holds no neurons. */
+			size_t FindBestMatchingUnit(Eigen::Ref<const ActivationVector> inputLayer) const;
+
+			/** Up to k neurons closest to the input, nearest first.
+			* @param nearestIds resized to min( k, neuron count ).
+			* @param squaredDistances optional, receives squared distance of each returned neuron.
+			*/
+			void FindNearestUnits(Eigen::Ref<const ActivationVector> inputLayer, size_t k, vector<size_t>& nearestIds, vector<SignalUnit>* squaredDistances = nullptr) const;
+
+		private:
+			struct Node final
+			{
+				Eigen::Index begin; /**< First row of the node's neurons in points. */
+				Eigen::Index end;
+				size_t left{ 0 }; /**< Children, zero for leaves ( root is never a child ). */
+				size_t right{ 0 };
+			};
+
+			size_t BuildNode(RowMatrix const& weights, Eigen::Index begin, Eigen::Index end);
+			void UpdateBounds();
+			SignalUnit BoxDistance(size_t nodeId, Eigen::Ref<const ActivationVector> inputLayer) const;
+
+			RowMatrix points; /**< Codebook rows permuted so that every leaf is contiguous. */
+			vector<size_t> neuronIds; /**< Codebook row of every point. */
+			vector<Node> nodes;
+			RowMatrix lowerBounds; /**< Bounding box of every node, one row per node. */
+			RowMatrix upperBounds;
+		};
+	}
+}
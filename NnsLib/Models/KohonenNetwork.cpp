@@ -1,5 +1,9 @@
 #include "pch.h"
 #include "Models/KohonenNetwork.h"
+#include "Diagnostics/Tracing.h"
+
+#include <limits>
+#include <stdexcept>
 
 namespace NNS 
 {
@@ -7,11 +11,34 @@ namespace NNS
 	{
 
 		KohonenNetwork::KohonenNetwork(int inputLayerSize, int outputLayerSize)
-			: FeedforwardNetworkBase({ inputLayerSize, outputLayerSize })
+			: KohonenNetwork(inputLayerSize, outputLayerSize, 1)
+		{
+		}
+
+		KohonenNetwork::KohonenNetwork(int inputLayerSize, int width, int height)
+			: FeedforwardNetworkBase({ inputLayerSize, width * height }), mapWidth{ static_cast<size_t>(width) }, mapHeight{ static_cast<size_t>(height) }
 		{
+			if (inputLayerSize <= 0)
+			{
+				throw std::invalid_argument("Invalid input layer size");
+			}
+			if (width <= 0 || height <= 0)
+			{
+				throw std::invalid_argument("Invalid map size");
+			}
+
 			InitializeKohonen();
 		}
 
+		IFeedforwardNetwork::Ptr KohonenNetwork::Clone() const
+		{
+			auto clone = new KohonenNetwork(static_cast<int>(activationMatrix.front().size()), static_cast<int>(mapWidth), static_cast<int>(mapHeight));
+			clone->weightMatrix = weightMatrix;
+			clone->weightMagnitudeLimit = weightMagnitudeLimit;
+			clone->isWeightMagLimited = isWeightMagLimited;
+			return IFeedforwardNetwork::Ptr(clone);
+		}
+
 		void KohonenNetwork::InitializeKohonen()
 		{
 			Rebuild();
@@ -19,36 +46,59 @@ namespace NNS
 
 		bool KohonenNetwork::ComputeOutput(InputLayer const& inputLayer)
 		{
+			NNS_TRACE_AGGREGATE("KohonenNetwork::ComputeOutput");
+
 			if (weightMatrix.empty() || activationMatrix.front().size() != inputLayer.size())
 				return false;
 
-			static const auto networkmap = GetNetworkLayerMap(); /* Obtain network architecture */
-
 			activationMatrix.front() = inputLayer;
 
 			if (isWeightMagLimited && weightMagnitudeLimit != 0.0)
 				SetWeightMagnitudeLimit(weightMagnitudeLimit);
 
-
-			for (size_t i = 1; i < networkmap.size(); ++i)  /* Each layer, except first */
+			for (size_t i = 1; i < activationMatrix.size(); ++i)  /* Each layer, except first */
 			{
 				auto& currLayer = activationMatrix[i];
 				auto& prevLayer = activationMatrix[i - 1];
 
-				for (size_t j = 0; j < networkmap[i]; ++j) /* Each neuron */
+				for (Eigen::Index j = 0; j < currLayer.size(); ++j) /* Each neuron */
 				{
-					SignalUnit activationSum = 0;
-					for (size_t k = 0; k < networkmap[i - 1]; ++k) /* Each previous connection */
-					{
-						activationSum += prevLayer[k] * weightMatrix[i - 1][j][k];
-					}
-					currLayer[j] = activationSum;
+					currLayer[j] = weightMatrix[i - 1][j].dot(prevLayer);
 				}
 			}
 
 			return true;
 		}
 
+		size_t KohonenNetwork::FindBestMatchingUnit(InputLayer const& inputLayer) const
+		{
+			const auto& codebook = weightMatrix.back();
+
+			size_t best = 0;
+			auto best_distance = std::numeric_limits<SignalUnit>::max();
+			for (size_t j = 0; j < codebook.size(); ++j) /* Each neuron */
+			{
+				const auto distance = (codebook[j] - inputLayer).squaredNorm();
+				if (distance < best_distance)
+				{
+					best_distance = distance;
+					best = j;
+				}
+			}
+
+			return best;
+		}
+
+		size_t KohonenNetwork::GetMapWidth() const
+		{
+			return mapWidth;
+		}
+
+		size_t KohonenNetwork::GetMapHeight() const
+		{
+			return mapHeight;
+		}
+
 		SignalUnit KohonenNetwork::GetActivationDerivative(int layerId, int neuronId) const 
 		{
 			return GetActivation(layerId, neuronId);
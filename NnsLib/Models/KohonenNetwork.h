@@ -13,17 +13,33 @@ namespace NNS
 		public:
 
 			KohonenNetwork() = delete;
+			/** One dimensional map, neurons form a line. */
 			KohonenNetwork(int inputLayerSize, int outputLayerSize);
+			/** Two dimensional map, neuron at ( x, y ) has index y * width + x. */
+			KohonenNetwork(int inputLayerSize, int width, int height);
 
 			KohonenNetwork(const KohonenNetwork&) = delete;
 			KohonenNetwork& operator=(const KohonenNetwork&) = delete;
 
+			IFeedforwardNetwork::Ptr Clone() const override;
+
 			bool ComputeOutput(InputLayer const& inputLayer) override;
 			
 			SignalUnit GetActivationDerivative(int layerId, int neuronId) const override;
 
+			/** Index of the neuron whose weights are closest to the input in squared Euclidean distance.
+			* Scans per-neuron weight vectors, see Models::KohonenCodebook for searching many inputs at once.
+			*/
+			size_t FindBestMatchingUnit(InputLayer const& inputLayer) const;
+
+			size_t GetMapWidth() const;
+			size_t GetMapHeight() const;
+
 		protected:
 			void InitializeKohonen();
+
+			size_t mapWidth;
+			size_t mapHeight;
 		};
 	}
 }
\ No newline at end of file
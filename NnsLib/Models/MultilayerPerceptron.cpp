@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "Models/MultilayerPerceptron.h"
+#include "Diagnostics/Tracing.h"
 
 
 namespace NNS 
@@ -13,26 +14,43 @@ namespace NNS
 			Rebuild();
 		};
 
+		MultilayerPerceptron::MultilayerPerceptron(NetworkLayerMap const& networkLayerMap)
+			: FeedforwardNetworkBase(networkLayerMap)
+		{
+			Rebuild();
+		}
+
+
+		IFeedforwardNetwork::Ptr MultilayerPerceptron::Clone() const
+		{
+			return IFeedforwardNetwork::Ptr(new MultilayerPerceptron(*this));
+		}
 
 		void MultilayerPerceptron::Rebuild()
 		{
 			weightMatrix = WeightMatrix{ activationMatrix.size() - 1 };
+			connectivity.resize(activationMatrix.size());
 
 			for (size_t i = 1; i < activationMatrix.size(); ++i) /* For each layer ( minus input layer ). */
 			{
+				const auto& pattern = connectivity[i];
 				weightMatrix[i - 1].resize(activationMatrix[i].size());
 				for (size_t j = 0; j < activationMatrix[i].size(); ++j) /* For each neuron. */
 				{
-					weightMatrix[i - 1][j] = WeightVector::Zero(activationMatrix[i - 1].size() + 1); /* Previous layer size + bias */
+					const Eigen::Index connections = pattern.size() == 0 ? activationMatrix[i - 1].size() : pattern.outerIndexPtr()[j + 1] - pattern.outerIndexPtr()[j];
+					weightMatrix[i - 1][j] = WeightVector::Zero(connections + 1); /* Connections + bias */
 					weightMatrix[i - 1][j].tail(1)[0] = 1.0; /* Bias is always equal to 1.0 */
 				}
 			}
-				
+
+			outputNetInput = ActivationVector::Zero(activationMatrix.back().size());
 			isWeightMagLimited = false;
 		}
 
 		bool MultilayerPerceptron::ComputeOutput(InputLayer const& inputLayer)
 		{
+			NNS_TRACE_AGGREGATE("MultilayerPerceptron::ComputeOutput");
+
 			if (weightMatrix.empty() || activationMatrix.front().size() != inputLayer.size())
 				return false;
 			
@@ -44,24 +62,116 @@ namespace NNS
 			for (size_t i = 1; i < activationMatrix.size(); ++i)  /* Each layer, except first */
 			{
 				auto& prevLayer = activationMatrix[i - 1];
-				for (size_t j = 0; j < activationMatrix[i].size(); ++j) /* Each neuron */
+				if (connectivity[i].size() != 0)
 				{
-					auto& weightVect = weightMatrix[i - 1][j];
-					const auto& weightVectWithoutBias = weightVect.head(prevLayer.size());
-					auto& bias = weightVect[weightVect.size() - 1];
+					ComputeSparseLayer(i);
+				}
+				else
+				{
+					for (size_t j = 0; j < activationMatrix[i].size(); ++j) /* Each neuron */
+					{
+						auto& weightVect = weightMatrix[i - 1][j];
+						const auto& weightVectWithoutBias = weightVect.head(prevLayer.size());
+						auto& bias = weightVect[weightVect.size() - 1];
 
-					activationMatrix[i][j] = activationFunction(bias + prevLayer.dot(weightVectWithoutBias));
+						activationMatrix[i][j] = bias + prevLayer.dot(weightVectWithoutBias);
+					}
 				}
+
+				if (i == activationMatrix.size() - 1)
+					outputNetInput = activationMatrix[i];
+
+				activationMatrix[i] = activationMatrix[i].unaryExpr(activationFunction);
 			}
 
 			return true;
 		}
 
+		/* Leaves weighted sums in the layer's activations, caller applies the activation function. */
+		void MultilayerPerceptron::ComputeSparseLayer(size_t layerId)
+		{
+			const auto& pattern = connectivity[layerId];
+			const auto* rowBegin = pattern.outerIndexPtr();
+			const auto* sources = pattern.innerIndexPtr();
+			const auto& prevLayer = activationMatrix[layerId - 1];
+
+			for (size_t j = 0; j < weightMatrix[layerId - 1].size(); ++j) /* Each neuron */
+			{
+				const auto& weightVect = weightMatrix[layerId - 1][j];
+				const auto* rowSources = sources + rowBegin[j];
+				const auto connections = weightVect.size() - 1;
+				auto sum = weightVect[connections]; /* Bias */
+
+				for (Eigen::Index c = 0; c < connections; ++c) /* Each existing connection */
+					sum += weightVect[c] * prevLayer[rowSources[c]];
+
+				activationMatrix[layerId][j] = sum;
+			}
+		}
+
+		void MultilayerPerceptron::SetConnectivity(int layerId, ConnectivityPattern pattern)
+		{
+			if (layerId < 1 || static_cast<size_t>(layerId) >= activationMatrix.size())
+			{
+				throw std::invalid_argument("Invalid layer id");
+			}
+			if (static_cast<size_t>(pattern.rows()) != static_cast<size_t>(activationMatrix[layerId].size()) || static_cast<size_t>(pattern.cols()) != static_cast<size_t>(activationMatrix[layerId - 1].size()))
+			{
+				throw std::invalid_argument("Connectivity pattern does not match layer sizes");
+			}
+
+			pattern.makeCompressed();
+			const auto& previous = connectivity[layerId];
+			const auto* rowBegin = pattern.outerIndexPtr();
+			const auto* sources = pattern.innerIndexPtr();
+
+			/* Kept connections keep their weights, whatever the previous connectivity was. */
+			WeightVector denseRow(activationMatrix[layerId - 1].size());
+			for (size_t j = 0; j < weightMatrix[layerId - 1].size(); ++j) /* For each neuron. */
+			{
+				auto& weightVect = weightMatrix[layerId - 1][j];
+				if (previous.size() == 0)
+				{
+					denseRow = weightVect.head(denseRow.size());
+				}
+				else
+				{
+					denseRow.setZero();
+					for (auto c = previous.outerIndexPtr()[j]; c < previous.outerIndexPtr()[j + 1]; ++c)
+						denseRow[previous.innerIndexPtr()[c]] = weightVect[c - previous.outerIndexPtr()[j]];
+				}
+
+				WeightVector compressed(rowBegin[j + 1] - rowBegin[j] + 1);
+				for (auto c = rowBegin[j]; c < rowBegin[j + 1]; ++c)
+					compressed[c - rowBegin[j]] = denseRow[sources[c]];
+				compressed.tail(1)[0] = weightVect.tail(1)[0]; /* Bias */
+
+				weightVect.swap(compressed);
+			}
+
+			connectivity[layerId] = std::move(pattern);
+		}
+
+		ConnectivityPattern const* MultilayerPerceptron::GetConnectivity(int layerId) const
+		{
+			return connectivity[layerId].size() == 0 ? nullptr : &connectivity[layerId];
+		}
+
 		SignalUnit MultilayerPerceptron::GetActivationDerivative(int layerId, int neuronId) const
 		{
 			return activationFunction.Deriv(GetActivation(layerId, neuronId));
 		}
 
+		ActivationVector const& MultilayerPerceptron::GetOutputNetInput() const
+		{
+			return outputNetInput;
+		}
+
+		ActivationFunctionType MultilayerPerceptron::GetActivationFunctionType(int /*layerId*/) const
+		{
+			return ActivationFunctionType::Logistic;
+		}
+
 		WeightUnit& MultilayerPerceptron::Bias(int layerId, int neuronId)
 		{
 			isWeightMagLimited = true;
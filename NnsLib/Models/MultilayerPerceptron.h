@@ -17,18 +17,37 @@ namespace NNS
 		{
 		public:
 			explicit MultilayerPerceptron(std::initializer_list<int> networkLayerMap);
+			/** Topology known only at run time, e.g. read from a file or generated by a benchmark. */
+			explicit MultilayerPerceptron(NetworkLayerMap const& networkLayerMap);
+
+			IFeedforwardNetwork::Ptr Clone() const override;
 
 			bool ComputeOutput(InputLayer const& inputLayer) override;
 
 			SignalUnit GetActivationDerivative(int layerId, int neuronId) const override;
+			ActivationVector const& GetOutputNetInput() const override;
+			ActivationFunctionType GetActivationFunctionType(int layerId) const;
 
 			WeightUnit& Bias(int layerId, int neuronId) override;
 			void SetBiasForAll(WeightUnit value = 1.0) override;
 
+			/** Restrict the layer to a fixed set of connections with the previous layer.
+			* Every stored entry of the pattern is a connection, its value is ignored. Kept connections keep their weights,
+			* neuron's weight vector shrinks to its connections plus bias, so forward pass, gradient and optimizers touch only those.
+			* @param layerId layer whose incoming connections are restricted, 1 for the first hidden layer.
+			* @param pattern layer size rows, previous layer size columns.
+			*/
+			void SetConnectivity(int layerId, ConnectivityPattern pattern);
+			ConnectivityPattern const* GetConnectivity(int layerId) const override;
+
 			virtual void Rebuild() override;
 
 		private:
+			void ComputeSparseLayer(size_t layerId);
+
 			LogisticActivationFunction<SignalUnit> activationFunction; // TODO: make configurable
+			vector<ConnectivityPattern> connectivity; /**< Per layer, empty if fully connected. */
+			ActivationVector outputNetInput; /**< Kept for losses computed from logits, see GetOutputNetInput(). */
 		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "pch.h"
+#include "Models/MultilayerPerceptronEnsemble.h"
+#include "Diagnostics/Tracing.h"
+
+#include <stdexcept>
+
+namespace NNS
+{
+	namespace Models
+	{
+		void AverageOutputs(MemberOutputs const& memberOutputs, OutputLayer& output)
+		{
+			output = memberOutputs.rowwise().mean();
+		}
+
+		void MajorityVote(MemberOutputs const& memberOutputs, OutputLayer& output)
+		{
+			output.setZero();
+			for (Eigen::Index m = 0; m < memberOutputs.cols(); ++m) /* For each member. */
+			{
+				if (memberOutputs.rows() == 1)
+				{
+					output[0] += memberOutputs(0, m) > 0.5 ? 1.0 : 0.0;
+				}
+				else
+				{
+					Eigen::Index vote;
+					memberOutputs.col(m).maxCoeff(&vote);
+					output[vote] += 1.0;
+				}
+			}
+			output /= static_cast<SignalUnit>(memberOutputs.cols());
+		}
+
+		MultilayerPerceptronEnsemble::MultilayerPerceptronEnsemble(vector<MultilayerPerceptron const*> const& members, EnsembleCombiner outputCombiner)
+			: memberCount{ members.size() }, combiner{ std::move(outputCombiner) }
+		{
+			if (members.empty())
+				throw std::invalid_argument("Ensemble needs at least one member");
+
+			const auto firstMap = members.front()->GetNetworkLayerMap();
+			vector<NetworkLayerMap> maps;
+			for (const auto* member : members)
+			{
+				maps.push_back(member->GetNetworkLayerMap());
+				if (maps.back().size() != firstMap.size() || maps.back().front() != firstMap.front() || maps.back().back() != firstMap.back())
+					throw std::invalid_argument("Ensemble members must share input size, output size and depth");
+			}
+
+			layers.resize(firstMap.size() - 1);
+			activationMatrix.resize(firstMap.size());
+			activationMatrix.front().setZero(static_cast<Eigen::Index>(firstMap.front()));
+
+			for (size_t i = 1; i < firstMap.size(); ++i) /* Each layer, except first */
+			{
+				auto& layer = layers[i - 1];
+
+				Eigen::Index rows = 0;
+				for (const auto& map : maps)
+					rows += static_cast<Eigen::Index>(map[i]);
+
+				if (i == 1)
+				{
+					/* Every member reads the same input, their first layers stack into one wide block. */
+					layer.blocks.push_back(MemberBlock{ 0, 0, LayerWeights::Zero(rows, static_cast<Eigen::Index>(firstMap.front())) });
+				}
+				layer.biases.setZero(rows);
+				activationMatrix[i].setZero(rows);
+
+				Eigen::Index row = 0, column = 0;
+				for (size_t m = 0; m < members.size(); ++m) /* For each member. */
+				{
+					const auto neurons = static_cast<Eigen::Index>(maps[m][i]);
+					const auto prevNeurons = static_cast<Eigen::Index>(maps[m][i - 1]);
+					if (i > 1)
+						layer.blocks.push_back(MemberBlock{ row, column, LayerWeights::Zero(neurons, prevNeurons) });
+
+					auto& block = layer.blocks.back();
+					const auto blockRow = row - block.row;
+					const auto& weightMatrix = members[m]->GetWeightMatrix()[i - 1];
+					const auto connectivity = members[m]->GetConnectivity(static_cast<int>(i));
+
+					for (Eigen::Index j = 0; j < neurons; ++j) /* For each neuron. */
+					{
+						const auto& weightVect = weightMatrix[static_cast<size_t>(j)];
+						if (connectivity == nullptr)
+						{
+							block.weights.row(blockRow + j) = weightVect.head(prevNeurons).transpose();
+						}
+						else
+						{
+							/* Missing connections stay zero. */
+							const auto* sources = connectivity->innerIndexPtr() + connectivity->outerIndexPtr()[j];
+							for (Eigen::Index k = 0; k + 1 < weightVect.size(); ++k) /* Each existing connection */
+								block.weights(blockRow + j, sources[k]) = weightVect[k];
+						}
+						layer.biases[row + j] = weightVect[weightVect.size() - 1];
+					}
+
+					row += neurons;
+					column += prevNeurons;
+				}
+			}
+
+			outputLayer.setZero(static_cast<Eigen::Index>(firstMap.back()));
+		}
+
+		size_t MultilayerPerceptronEnsemble::GetMemberCount() const
+		{
+			return memberCount;
+		}
+
+		bool MultilayerPerceptronEnsemble::ComputeOutput(InputLayer const& inputLayer)
+		{
+			NNS_TRACE_AGGREGATE("MultilayerPerceptronEnsemble::ComputeOutput");
+
+			if (activationMatrix.front().size() != inputLayer.size())
+				return false;
+
+			activationMatrix.front() = inputLayer;
+
+			for (size_t i = 1; i < activationMatrix.size(); ++i) /* Each layer, except first */
+			{
+				const auto& layer = layers[i - 1];
+				const auto& prevLayer = activationMatrix[i - 1];
+				auto& netInput = activationMatrix[i];
+
+				netInput = layer.biases;
+				for (const auto& block : layer.blocks) /* Only the diagonal blocks, members never see each other's neurons. */
+				{
+					netInput.segment(block.row, block.weights.rows()).noalias() += block.weights * prevLayer.segment(block.column, block.weights.cols());
+				}
+
+				/* Logistic function over all members at once, Eigen's vectorized exp() differs from std::exp() in the last bits only. */
+				netInput = (1.0 + (-netInput.array()).exp()).inverse().matrix();
+			}
+
+			combiner(GetMemberOutputs(), outputLayer);
+			return true;
+		}
+
+		OutputLayer const& MultilayerPerceptronEnsemble::GetOutputLayer() const
+		{
+			return outputLayer;
+		}
+
+		SignalUnit const& MultilayerPerceptronEnsemble::GetOutputActivation(int neuronId) const
+		{
+			return outputLayer[neuronId];
+		}
+
+		MemberOutputs MultilayerPerceptronEnsemble::GetMemberOutputs() const
+		{
+			return MemberOutputs(activationMatrix.back().data(), outputLayer.size(), static_cast<Eigen::Index>(memberCount));
+		}
+	}
+}
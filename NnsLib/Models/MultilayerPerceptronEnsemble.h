@@ -0,0 +1,74 @@
+#pragma once
+
+#include <functional>
+
+#include "Models/MultilayerPerceptron.h"
+#include "Types/Collections.h"
+
+namespace NNS
+{
+	namespace Models
+	{
+		using namespace NNS::Types;
+
+		/** Outputs of all members, a column per member in the order they were given. */
+		using MemberOutputs = Eigen::Map<const Eigen::Matrix<SignalUnit, Dynamic, Dynamic>>;
+
+		/** Reduces member outputs to the ensemble's output, which is already sized to the members' output layer. */
+		using EnsembleCombiner = std::function<void(MemberOutputs const& memberOutputs, OutputLayer& output)>;
+
+		/** Mean of the members' outputs. */
+		void AverageOutputs(MemberOutputs const& memberOutputs, OutputLayer& output);
+
+		/** Share of members voting for each output.
+		* A single output is a binary classifier, a member votes for it if its output is above 0.5.
+		* Several outputs are classes, a member votes for its highest output, so the ensemble's highest output is the majority class.
+		*/
+		void MajorityVote(MemberOutputs const& memberOutputs, OutputLayer& output);
+
+		/** Inference-only ensemble of perceptrons evaluated as one network.
+		* Members' first layers are stacked into one wide matrix, so the input is read once for all of them.
+		* Deeper layers form a block-diagonal matrix, each member's block multiplies only its own activations,
+		* and every layer's activation function runs once over all members.
+		* Members must share input and output sizes and depth, hidden layer widths may differ. Sparse layers are stored dense.
+		* Weights are copied on construction, later changes to the members are not seen. Use one instance per thread.
+		*/
+		class MultilayerPerceptronEnsemble final
+		{
+		public:
+			/** @throw std::invalid_argument if there are no members or their input size, output size or depth differ. */
+			explicit MultilayerPerceptronEnsemble(vector<MultilayerPerceptron const*> const& members, EnsembleCombiner outputCombiner = AverageOutputs);
+
+			size_t GetMemberCount() const;
+
+			bool ComputeOutput(InputLayer const& inputLayer);
+			OutputLayer const& GetOutputLayer() const;
+			SignalUnit const& GetOutputActivation(int neuronId) const;
+
+			/** Outputs of every member from the last ComputeOutput(), before they were combined. */
+			MemberOutputs GetMemberOutputs() const;
+
+		private:
+			using LayerWeights = Eigen::Matrix<WeightUnit, Dynamic, Dynamic>;
+
+			struct MemberBlock
+			{
+				Eigen::Index row; /**< First neuron of the member in this layer. */
+				Eigen::Index column; /**< First neuron of the member in the previous layer. */
+				LayerWeights weights;
+			};
+
+			struct Layer
+			{
+				vector<MemberBlock> blocks; /**< One for the first layer, spanning the input, then one per member. */
+				WeightVector biases;
+			};
+
+			vector<Layer> layers; /**< Layers after the input one. */
+			ActivationMatrix activationMatrix; /**< Members' neurons of each layer one after another. */
+			OutputLayer outputLayer;
+			size_t memberCount{ 0 };
+			EnsembleCombiner combiner;
+		};
+	}
+}
@@ -0,0 +1,441 @@
+#include "pch.h"
+#include "Models/RecurrentNetwork.h"
+#include "Diagnostics/Tracing.h"
+
+#include <algorithm>
+
+namespace NNS
+{
+	namespace Models
+	{
+		namespace
+		{
+			void ApplyLogistic(Eigen::Ref<ActivationVector> values)
+			{
+				values.array() = (1.0 + (-values.array()).exp()).inverse();
+			}
+		}
+
+		RecurrentNetwork::RecurrentNetwork(RecurrentNetworkConfig const& networkConfig)
+			: FeedforwardNetworkBase(GetLayerMap(networkConfig)), config{ networkConfig }
+		{
+			Rebuild();
+		}
+
+		NetworkLayerMap RecurrentNetwork::GetLayerMap(RecurrentNetworkConfig const& config)
+		{
+			const auto isZero = [](size_t units) { return units == 0; };
+			if (config.inputs == 0 || config.steps == 0 || config.outputs == 0 || config.hiddenLayers.empty()
+				|| std::any_of(config.hiddenLayers.begin(), config.hiddenLayers.end(), isZero))
+			{
+				throw std::invalid_argument("Invalid network size");
+			}
+
+			NetworkLayerMap networkmap{ config.inputs * config.steps };
+			for (const auto units : config.hiddenLayers)
+				networkmap.push_back(units * config.steps);
+			networkmap.push_back(config.output == RecurrentOutputType::EachStep ? config.outputs * config.steps : config.outputs);
+			return networkmap;
+		}
+
+		IFeedforwardNetwork::Ptr RecurrentNetwork::Clone() const
+		{
+			return IFeedforwardNetwork::Ptr(new RecurrentNetwork(*this));
+		}
+
+		void RecurrentNetwork::Rebuild()
+		{
+			steps = static_cast<Eigen::Index>(config.steps);
+			gateCount = config.cell == RecurrentCellType::LongShortTermMemory ? 4 : 3;
+			weightMatrix = WeightMatrix{ config.hiddenLayers.size() + 1 };
+			layers.resize(config.hiddenLayers.size());
+
+			auto inputs = static_cast<Eigen::Index>(config.inputs);
+			auto largestLayer = inputs;
+			for (size_t i = 1; i <= layers.size(); ++i) /* For each recurrent layer. */
+			{
+				auto& layer = layers[i - 1];
+				const auto units = static_cast<Eigen::Index>(config.hiddenLayers[i - 1]);
+				const auto rows = gateCount * units;
+				layer.inputs = inputs;
+				layer.units = units;
+
+				weightMatrix[i - 1].resize(static_cast<size_t>(rows));
+				for (auto& weightVect : weightMatrix[i - 1]) /* For each gate of each unit. */
+				{
+					weightVect = WeightVector::Zero(inputs + units + 1); /* Inputs + previous hidden state + bias */
+					weightVect.tail(1)[0] = 1.0;
+				}
+
+				layer.inputWeights.resize(rows, inputs);
+				layer.recurrentWeights.resize(rows, units);
+				layer.biases.resize(rows);
+				layer.gates.resize(rows, steps);
+				layer.states.resize(units, steps);
+				layer.gateDelta.resize(rows, steps);
+				layer.recurrentDelta.resize(config.cell == RecurrentCellType::GatedRecurrentUnit ? rows : 0, steps); /* LSTM reuses gate deltas. */
+				layer.inputGradient.resize(rows, inputs);
+				layer.recurrentGradient.resize(rows, units);
+
+				inputs = units;
+				largestLayer = std::max(largestLayer, units);
+			}
+
+			const auto outputs = static_cast<Eigen::Index>(config.outputs);
+			weightMatrix.back().resize(config.outputs);
+			for (auto& weightVect : weightMatrix.back()) /* For each output neuron. */
+			{
+				weightVect = WeightVector::Zero(inputs + 1); /* Last hidden state + bias */
+				weightVect.tail(1)[0] = 1.0;
+			}
+			outputWeights.resize(outputs, inputs);
+			outputBiases.resize(outputs);
+			outputGradient.resize(outputs, inputs);
+
+			outputNetInput = ActivationVector::Zero(activationMatrix.back().size());
+			recurrentProduct = ActivationVector::Zero(gateCount * largestLayer);
+			hiddenDelta = ActivationVector::Zero(largestLayer * steps);
+			inputDelta = ActivationVector::Zero(largestLayer * steps);
+			carriedDelta = ActivationVector::Zero(largestLayer);
+			cellDelta = ActivationVector::Zero(largestLayer);
+			isWeightMagLimited = false;
+		}
+
+		bool RecurrentNetwork::ComputeOutput(InputLayer const& inputLayer)
+		{
+			NNS_TRACE_AGGREGATE("RecurrentNetwork::ComputeOutput");
+
+			if (weightMatrix.empty() || activationMatrix.front().size() != inputLayer.size())
+				return false;
+
+			activationMatrix.front() = inputLayer;
+
+			if (isWeightMagLimited && weightMagnitudeLimit != 0.0)
+				SetWeightMagnitudeLimit(weightMagnitudeLimit); /* check weights magnitude for correctness */
+
+			for (size_t i = 1; i <= layers.size(); ++i) /* Each recurrent layer */
+			{
+				GatherWeights(i);
+				if (config.cell == RecurrentCellType::LongShortTermMemory)
+					ComputeLongShortTermMemory(i);
+				else
+					ComputeGatedRecurrentUnit(i);
+			}
+
+			GatherWeights(weightMatrix.size());
+			ComputeOutputLayer();
+			return true;
+		}
+
+		void RecurrentNetwork::GatherWeights(size_t layerId)
+		{
+			const auto& weightLayer = weightMatrix[layerId - 1];
+			if (layerId > layers.size()) /* Output layer */
+			{
+				const auto inputs = outputWeights.cols();
+				for (size_t j = 0; j < weightLayer.size(); ++j) /* For each neuron. */
+				{
+					outputWeights.row(static_cast<Eigen::Index>(j)) = weightLayer[j].head(inputs).transpose();
+					outputBiases[static_cast<Eigen::Index>(j)] = weightLayer[j][inputs];
+				}
+				return;
+			}
+
+			auto& layer = layers[layerId - 1];
+			for (size_t j = 0; j < weightLayer.size(); ++j) /* For each gate of each unit. */
+			{
+				const auto& weightVect = weightLayer[j];
+				const auto row = static_cast<Eigen::Index>(j);
+				layer.inputWeights.row(row) = weightVect.head(layer.inputs).transpose();
+				layer.recurrentWeights.row(row) = weightVect.segment(layer.inputs, layer.units).transpose();
+				layer.biases[row] = weightVect[layer.inputs + layer.units];
+			}
+		}
+
+		void RecurrentNetwork::ComputeLongShortTermMemory(size_t layerId)
+		{
+			auto& layer = layers[layerId - 1];
+			const auto units = layer.units;
+			const Eigen::Map<const ColumnMatrix> input(activationMatrix[layerId - 1].data(), layer.inputs, steps);
+			Eigen::Map<ColumnMatrix> hidden(activationMatrix[layerId].data(), units, steps);
+
+			/* Input projections of all steps at once. */
+			layer.gates.noalias() = layer.inputWeights * input;
+			layer.gates.colwise() += layer.biases;
+
+			for (Eigen::Index t = 0; t < steps; ++t) /* Each step */
+			{
+				auto gates = layer.gates.col(t);
+				if (t > 0)
+					gates.noalias() += layer.recurrentWeights * hidden.col(t - 1);
+
+				ApplyLogistic(gates.head(3 * units));
+				gates.tail(units) = gates.tail(units).array().tanh();
+
+				const auto inputGate = gates.segment(0, units).array();
+				const auto forgetGate = gates.segment(units, units).array();
+				const auto outputGate = gates.segment(2 * units, units).array();
+				const auto candidate = gates.segment(3 * units, units).array();
+
+				auto cell = layer.states.col(t).array();
+				cell = inputGate * candidate;
+				if (t > 0)
+					cell += forgetGate * layer.states.col(t - 1).array();
+
+				hidden.col(t).array() = outputGate * cell.tanh();
+			}
+		}
+
+		void RecurrentNetwork::ComputeGatedRecurrentUnit(size_t layerId)
+		{
+			auto& layer = layers[layerId - 1];
+			const auto units = layer.units;
+			const Eigen::Map<const ColumnMatrix> input(activationMatrix[layerId - 1].data(), layer.inputs, steps);
+			Eigen::Map<ColumnMatrix> hidden(activationMatrix[layerId].data(), units, steps);
+			auto product = recurrentProduct.head(3 * units);
+
+			/* Input projections of all steps at once. */
+			layer.gates.noalias() = layer.inputWeights * input;
+			layer.gates.colwise() += layer.biases;
+
+			for (Eigen::Index t = 0; t < steps; ++t) /* Each step */
+			{
+				auto gates = layer.gates.col(t);
+				if (t > 0)
+					product.noalias() = layer.recurrentWeights * hidden.col(t - 1);
+				else
+					product.setZero();
+
+				gates.head(2 * units) += product.head(2 * units);
+				ApplyLogistic(gates.head(2 * units));
+
+				const auto resetGate = gates.segment(0, units).array();
+				const auto updateGate = gates.segment(units, units).array();
+				auto candidate = gates.segment(2 * units, units).array();
+
+				layer.states.col(t) = product.tail(units);
+				candidate = (candidate + resetGate * product.tail(units).array()).tanh();
+
+				if (t > 0)
+					hidden.col(t).array() = candidate + updateGate * (hidden.col(t - 1).array() - candidate);
+				else
+					hidden.col(t).array() = candidate * (1.0 - updateGate);
+			}
+		}
+
+		void RecurrentNetwork::ComputeOutputLayer()
+		{
+			const Eigen::Map<const ColumnMatrix> hidden(activationMatrix[layers.size()].data(), outputWeights.cols(), steps);
+			auto& output = activationMatrix.back();
+
+			if (config.output == RecurrentOutputType::EachStep)
+			{
+				Eigen::Map<ColumnMatrix> net(output.data(), outputWeights.rows(), steps);
+				net.noalias() = outputWeights * hidden;
+				net.colwise() += outputBiases;
+			}
+			else
+			{
+				output.noalias() = outputWeights * hidden.col(steps - 1);
+				output += outputBiases;
+			}
+
+			outputNetInput = output;
+			ApplyLogistic(output);
+		}
+
+		void RecurrentNetwork::AccumulateGradient(ErrorVector const& outputDelta, ErrorGradientMatrix& gradient)
+		{
+			NNS_TRACE_AGGREGATE("RecurrentNetwork::AccumulateGradient");
+
+			const auto outputs = outputWeights.rows();
+			const auto units = outputWeights.cols();
+			const Eigen::Map<const ColumnMatrix> hidden(activationMatrix[layers.size()].data(), units, steps);
+			Eigen::Map<ColumnMatrix> topDelta(hiddenDelta.data(), units, steps);
+			auto& outputLayerGradient = gradient.back();
+
+			if (config.output == RecurrentOutputType::EachStep)
+			{
+				const Eigen::Map<const ColumnMatrix> delta(outputDelta.data(), outputs, steps);
+				outputGradient.noalias() = delta * hidden.transpose();
+				for (Eigen::Index j = 0; j < outputs; ++j) /* For each neuron. */
+					outputLayerGradient[static_cast<size_t>(j)].back() += delta.row(j).sum(); /* Bias activation is always equal to 1.*/
+				topDelta.noalias() = outputWeights.transpose() * delta;
+			}
+			else
+			{
+				const Eigen::Map<const ActivationVector> delta(outputDelta.data(), outputs);
+				outputGradient.noalias() = delta * hidden.col(steps - 1).transpose();
+				for (Eigen::Index j = 0; j < outputs; ++j) /* For each neuron. */
+					outputLayerGradient[static_cast<size_t>(j)].back() += delta[j]; /* Bias activation is always equal to 1.*/
+				topDelta.leftCols(steps - 1).setZero();
+				topDelta.col(steps - 1).noalias() = outputWeights.transpose() * delta;
+			}
+
+			for (Eigen::Index j = 0; j < outputs; ++j) /* For each neuron. */
+				Eigen::Map<ActivationVector>(outputLayerGradient[static_cast<size_t>(j)].data(), units) += outputGradient.row(j).transpose();
+
+			for (size_t i = layers.size(); i > 0; --i) /* For each recurrent layer, backwards. */
+			{
+				if (config.cell == RecurrentCellType::LongShortTermMemory)
+					BackpropagateLongShortTermMemory(i);
+				else
+					BackpropagateGatedRecurrentUnit(i);
+
+				AccumulateLayerGradient(i, gradient);
+				hiddenDelta.swap(inputDelta);
+			}
+		}
+
+		void RecurrentNetwork::BackpropagateLongShortTermMemory(size_t layerId)
+		{
+			auto& layer = layers[layerId - 1];
+			const auto units = layer.units;
+			Eigen::Map<ColumnMatrix> delta(hiddenDelta.data(), units, steps);
+			auto hiddenCarry = carriedDelta.head(units);
+			auto cellCarry = cellDelta.head(units);
+			hiddenCarry.setZero();
+			cellCarry.setZero();
+
+			for (Eigen::Index t = steps - 1; t >= 0; --t) /* Each step, backwards. */
+			{
+				if (IsTruncatedAt(t))
+				{
+					hiddenCarry.setZero();
+					cellCarry.setZero();
+				}
+
+				auto hiddenStep = delta.col(t).array();
+				hiddenStep += hiddenCarry.array();
+
+				const auto gates = layer.gates.col(t);
+				const auto inputGate = gates.segment(0, units).array();
+				const auto forgetGate = gates.segment(units, units).array();
+				const auto outputGate = gates.segment(2 * units, units).array();
+				const auto candidate = gates.segment(3 * units, units).array();
+				const auto cell = layer.states.col(t).array();
+
+				auto gateDelta = layer.gateDelta.col(t);
+				auto cellStep = cellCarry.array();
+
+				/* Output gate uses tanh( cell ) before the cell delta takes its share. */
+				gateDelta.segment(2 * units, units).array() = hiddenStep * cell.tanh() * outputGate * (1.0 - outputGate);
+				cellStep += hiddenStep * outputGate * (1.0 - cell.tanh().square());
+
+				gateDelta.segment(0, units).array() = cellStep * candidate * inputGate * (1.0 - inputGate);
+				gateDelta.segment(3 * units, units).array() = cellStep * inputGate * (1.0 - candidate.square());
+				if (t > 0)
+					gateDelta.segment(units, units).array() = cellStep * layer.states.col(t - 1).array() * forgetGate * (1.0 - forgetGate);
+				else
+					gateDelta.segment(units, units).setZero();
+
+				cellStep *= forgetGate;
+				hiddenCarry.noalias() = layer.recurrentWeights.transpose() * gateDelta;
+			}
+		}
+
+		void RecurrentNetwork::BackpropagateGatedRecurrentUnit(size_t layerId)
+		{
+			auto& layer = layers[layerId - 1];
+			const auto units = layer.units;
+			const Eigen::Map<const ColumnMatrix> hidden(activationMatrix[layerId].data(), units, steps);
+			Eigen::Map<ColumnMatrix> delta(hiddenDelta.data(), units, steps);
+			auto hiddenCarry = carriedDelta.head(units);
+			hiddenCarry.setZero();
+
+			for (Eigen::Index t = steps - 1; t >= 0; --t) /* Each step, backwards. */
+			{
+				if (IsTruncatedAt(t))
+					hiddenCarry.setZero();
+
+				auto hiddenStep = delta.col(t).array();
+				hiddenStep += hiddenCarry.array();
+
+				const auto gates = layer.gates.col(t);
+				const auto resetGate = gates.segment(0, units).array();
+				const auto updateGate = gates.segment(units, units).array();
+				const auto candidate = gates.segment(2 * units, units).array();
+				const auto product = layer.states.col(t).array();
+
+				auto gateDelta = layer.gateDelta.col(t);
+				auto candidateDelta = gateDelta.segment(2 * units, units).array();
+				candidateDelta = hiddenStep * (1.0 - updateGate) * (1.0 - candidate.square());
+				gateDelta.segment(0, units).array() = candidateDelta * product * resetGate * (1.0 - resetGate);
+				if (t > 0)
+					gateDelta.segment(units, units).array() = hiddenStep * (hidden.col(t - 1).array() - candidate) * updateGate * (1.0 - updateGate);
+				else
+					gateDelta.segment(units, units).array() = -hiddenStep * candidate * updateGate * (1.0 - updateGate);
+
+				/* Candidate's recurrent product is scaled by the reset gate. */
+				auto recurrentDelta = layer.recurrentDelta.col(t);
+				recurrentDelta.head(2 * units) = gateDelta.head(2 * units);
+				recurrentDelta.tail(units).array() = candidateDelta * resetGate;
+
+				hiddenCarry.array() = hiddenStep * updateGate;
+				hiddenCarry.noalias() += layer.recurrentWeights.transpose() * recurrentDelta;
+			}
+		}
+
+		void RecurrentNetwork::AccumulateLayerGradient(size_t layerId, ErrorGradientMatrix& gradient)
+		{
+			auto& layer = layers[layerId - 1];
+			const auto& recurrentDelta = config.cell == RecurrentCellType::LongShortTermMemory ? layer.gateDelta : layer.recurrentDelta;
+			const Eigen::Map<const ColumnMatrix> input(activationMatrix[layerId - 1].data(), layer.inputs, steps);
+			const Eigen::Map<const ColumnMatrix> hidden(activationMatrix[layerId].data(), layer.units, steps);
+
+			/* Step t's recurrent weights see the hidden state of step t - 1, the first step sees zeros. */
+			layer.inputGradient.noalias() = layer.gateDelta * input.transpose();
+			layer.recurrentGradient.noalias() = recurrentDelta.rightCols(steps - 1) * hidden.leftCols(steps - 1).transpose();
+
+			for (size_t j = 0; j < gradient[layerId - 1].size(); ++j) /* For each gate of each unit. */
+			{
+				const auto row = static_cast<Eigen::Index>(j);
+				auto& unitGradient = gradient[layerId - 1][j];
+				Eigen::Map<ActivationVector>(unitGradient.data(), layer.inputs) += layer.inputGradient.row(row).transpose();
+				Eigen::Map<ActivationVector>(unitGradient.data() + layer.inputs, layer.units) += layer.recurrentGradient.row(row).transpose();
+				unitGradient.back() += layer.gateDelta.row(row).sum(); /* Bias activation is always equal to 1.*/
+			}
+
+			if (layerId > 1)
+				Eigen::Map<ColumnMatrix>(inputDelta.data(), layer.inputs, steps).noalias() = layer.inputWeights.transpose() * layer.gateDelta;
+		}
+
+		bool RecurrentNetwork::IsTruncatedAt(Eigen::Index step) const
+		{
+			const auto truncation = static_cast<Eigen::Index>(config.truncation);
+			return truncation != 0 && step < steps - 1 && (steps - 1 - step) % truncation == 0;
+		}
+
+		SignalUnit RecurrentNetwork::GetActivationDerivative(int layerId, int neuronId) const
+		{
+			if (static_cast<size_t>(layerId) != weightMatrix.size())
+				return 1.0;
+
+			const auto activation = GetActivation(layerId, neuronId);
+			return activation * (1.0 - activation);
+		}
+
+		ActivationVector const& RecurrentNetwork::GetOutputNetInput() const
+		{
+			return outputNetInput;
+		}
+
+		WeightUnit& RecurrentNetwork::Bias(int layerId, int neuronId)
+		{
+			isWeightMagLimited = true;
+			return weightMatrix[layerId - 1][neuronId].tail(1)[0];
+		}
+
+		void RecurrentNetwork::SetBiasForAll(WeightUnit value)
+		{
+			for (auto& layer : weightMatrix) /* Each layer, except first */
+				for (auto& weightVect : layer) /* Each gate or neuron */
+					weightVect.tail(1)[0] = value;
+		}
+
+		RecurrentNetworkConfig const& RecurrentNetwork::GetConfig() const
+		{
+			return config;
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Models/FeedforwardNetworkBase.h"
+#include "Types/Collections.h"
+
+namespace NNS
+{
+	namespace Models
+	{
+		using namespace NNS::Types;
+
+		enum class RecurrentCellType : unsigned int
+		{
+			LongShortTermMemory = 0, /**< Input, forget and output gates, then the cell candidate. */
+			GatedRecurrentUnit /**< Reset, update and candidate gates, reset applies after the recurrent product. */
+		};
+
+		enum class RecurrentOutputType : unsigned int
+		{
+			LastStep = 0, /**< Sequence classification or regression, outputs follow the last step only. */
+			EachStep /**< Sequence labeling, outputs for every step. */
+		};
+
+		struct RecurrentNetworkConfig final
+		{
+			RecurrentCellType cell{ RecurrentCellType::LongShortTermMemory };
+			RecurrentOutputType output{ RecurrentOutputType::LastStep };
+			// Features per step.
+			size_t inputs{ 1 };
+			// Sequence length, longer series are split into windows of this many steps.
+			size_t steps{ 1 };
+			// Units of each stacked recurrent layer.
+			vector<size_t> hiddenLayers{ 8 };
+			// Logistic output neurons per step.
+			size_t outputs{ 1 };
+			// Steps the error flows back through the recurrent connections, counted in windows from the sequence's end. 0 for the whole sequence.
+			size_t truncation{ 0 };
+		};
+
+		/** Stacked LSTM or GRU layers followed by a logistic output layer, unrolled over a fixed number of steps.
+		* Unrolled, a sequence is just a wider input, so the network trains through TrainingErrorState and the existing optimizers.
+		* Input layer holds the sequence step after step ( step t's features start at t * inputs ), every recurrent layer holds
+		* its hidden state at each step the same way, output layer holds outputs of the last step or of each step.
+		* Each unit has one weight vector per gate: input weights, recurrent weights, bias. Vector gate * units + unit of the layer.
+		* Input projections of all steps are one matrix product, each step then adds one product of all gates' recurrent weights with
+		* the previous hidden state. Backpropagation through time collects gate deltas of all steps, after which weight gradients
+		* and the input delta are again one product per layer. All buffers are sized by Rebuild(), nothing is allocated per sequence.
+		*/
+		class RecurrentNetwork final : public FeedforwardNetworkBase, public IBiased, public IDifferentiable
+		{
+		public:
+			explicit RecurrentNetwork(RecurrentNetworkConfig const& networkConfig);
+
+			IFeedforwardNetwork::Ptr Clone() const override;
+
+			bool ComputeOutput(InputLayer const& inputLayer) override;
+			void Rebuild() override;
+
+			/** Output layer only, derivatives of the hidden states are handled by AccumulateGradient(). Returns 1 for recurrent layers. */
+			SignalUnit GetActivationDerivative(int layerId, int neuronId) const override;
+			ActivationVector const& GetOutputNetInput() const override;
+
+			WeightUnit& Bias(int layerId, int neuronId) override;
+			void SetBiasForAll(WeightUnit value = 1.0) override;
+
+			void AccumulateGradient(ErrorVector const& outputDelta, ErrorGradientMatrix& gradient) override;
+
+			RecurrentNetworkConfig const& GetConfig() const;
+
+		private:
+			using ColumnMatrix = Eigen::Matrix<SignalUnit, Eigen::Dynamic, Eigen::Dynamic>;
+			using KernelMatrix = Eigen::Matrix<WeightUnit, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+			struct Layer final
+			{
+				Eigen::Index inputs{ 0 };
+				Eigen::Index units{ 0 };
+
+				KernelMatrix inputWeights; /**< Gathered for the matrix products, one row per gate and unit. */
+				KernelMatrix recurrentWeights;
+				ActivationVector biases;
+
+				ColumnMatrix gates; /**< Gate activations, one column per step. */
+				ColumnMatrix states; /**< LSTM cell states, GRU recurrent product of the candidate gate, one column per step. */
+
+				ColumnMatrix gateDelta; /**< Deltas of gate net inputs, one column per step. */
+				ColumnMatrix recurrentDelta; /**< Same deltas as seen by the recurrent weights, GRU's candidate rows are scaled by the reset gate. */
+				KernelMatrix inputGradient;
+				KernelMatrix recurrentGradient;
+			};
+
+			static NetworkLayerMap GetLayerMap(RecurrentNetworkConfig const& config);
+
+			void GatherWeights(size_t layerId);
+			void ComputeLongShortTermMemory(size_t layerId);
+			void ComputeGatedRecurrentUnit(size_t layerId);
+			void ComputeOutputLayer();
+
+			/** Backpropagate through time, hiddenDelta holds the layer's hidden state deltas from above and is overwritten. */
+			void BackpropagateLongShortTermMemory(size_t layerId);
+			void BackpropagateGatedRecurrentUnit(size_t layerId);
+			/** Add the layer's weight gradient and write the delta of its inputs to inputDelta. */
+			void AccumulateLayerGradient(size_t layerId, ErrorGradientMatrix& gradient);
+
+			bool IsTruncatedAt(Eigen::Index step) const;
+
+			RecurrentNetworkConfig config;
+			Eigen::Index steps{ 0 };
+			Eigen::Index gateCount{ 0 };
+
+			vector<Layer> layers; /**< layers[ layerId - 1 ], recurrent layers only. */
+			KernelMatrix outputWeights;
+			ActivationVector outputBiases;
+			KernelMatrix outputGradient;
+			ActivationVector outputNetInput;
+
+			ActivationVector recurrentProduct; /**< GRU, recurrent weights times the previous hidden state. */
+			ActivationVector hiddenDelta; /**< Deltas of a recurrent layer's hidden states, stored like its activations. */
+			ActivationVector inputDelta; /**< Deltas of its inputs, i.e. the layer below's hidden state deltas. */
+			ActivationVector carriedDelta; /**< Hidden state delta carried to the previous step. */
+			ActivationVector cellDelta; /**< LSTM cell state delta carried to the previous step. */
+		};
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+
+#include "Types/Collections.h"
+
+namespace NNS
+{
+	namespace Modules
+	{
+		using namespace NNS::Types;
+
+		using Signal = Eigen::Ref<ActivationVector>;
+		using ConstSignal = Eigen::Ref<const ActivationVector>;
+		using WeightLayer = vector<WeightVector>;
+		using ErrorGradientLayer = vector<ErrorVector>;
+
+		/** Signals a module reads again during its backward pass, the memory plan keeps only these between the passes. */
+		struct BackwardNeeds final
+		{
+			bool input{ false };
+			bool output{ false };
+		};
+
+		/** Single step of a Module's forward pass, e.g. a fully connected layer or an activation function.
+		* Modules are stateless, weights live in the owning network's weight matrix, one layer per applied module,
+		* each weight vector ending with a bias. Signals passed in are views into the network's planned buffers.
+		*/
+		class IModule
+		{
+		public:
+			using Ptr = std::unique_ptr<IModule>;
+
+			virtual ~IModule() = default;
+			virtual Ptr Clone() const = 0;
+
+			/** @throw std::invalid_argument if the module does not accept inputs of the size. */
+			virtual size_t GetOutputSize(size_t inputSize) const = 0;
+			/** Size of each weight vector, bias included. Empty for modules without weights. */
+			virtual vector<size_t> GetWeightShape() const = 0;
+			virtual BackwardNeeds GetBackwardNeeds() const = 0;
+
+			/** Activation functions, each output depends only on the input at the same position. */
+			virtual bool IsElementwise() const { return false; }
+			/** Derivative of an elementwise module expressed through its output, 1 for others. */
+			virtual SignalUnit GetDerivative(SignalUnit /*output*/) const { return 1.0; }
+
+			virtual void Forward(WeightLayer const& weights, ConstSignal input, Signal output) const = 0;
+
+			/** Add the module's ( negative ) error gradient and propagate the delta of its output to its input.
+			* Signals the module did not ask for in GetBackwardNeeds() are empty, inputDelta is empty for the first module.
+			*/
+			virtual void Backward(WeightLayer const& weights, ConstSignal input, ConstSignal output, ConstSignal outputDelta, Signal inputDelta, ErrorGradientLayer& gradient) const = 0;
+		};
+	}
+}
@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "Modules/Layers.h"
+
+namespace NNS
+{
+	namespace Modules
+	{
+		Linear::Linear(size_t inputSize, size_t outputSize)
+			: inputs{ inputSize }, outputs{ outputSize }
+		{
+			if (inputSize == 0 || outputSize == 0)
+			{
+				throw std::invalid_argument("Invalid layer size");
+			}
+		}
+
+		IModule::Ptr Linear::Clone() const
+		{
+			return Ptr(new Linear(*this));
+		}
+
+		size_t Linear::GetOutputSize(size_t inputSize) const
+		{
+			if (inputSize != inputs)
+			{
+				throw std::invalid_argument("Input size does not match the layer");
+			}
+			return outputs;
+		}
+
+		vector<size_t> Linear::GetWeightShape() const
+		{
+			return vector<size_t>(outputs, inputs + 1); /* Connections + bias */
+		}
+
+		BackwardNeeds Linear::GetBackwardNeeds() const
+		{
+			return BackwardNeeds{ true, false };
+		}
+
+		void Linear::Forward(WeightLayer const& weights, ConstSignal input, Signal output) const
+		{
+			const auto connections = static_cast<Eigen::Index>(inputs);
+			for (size_t j = 0; j < outputs; ++j) /* Each neuron */
+				output[static_cast<Eigen::Index>(j)] = weights[j][connections] + input.dot(weights[j].head(connections));
+		}
+
+		void Linear::Backward(WeightLayer const& weights, ConstSignal input, ConstSignal /*output*/, ConstSignal outputDelta, Signal inputDelta, ErrorGradientLayer& gradient) const
+		{
+			const auto connections = static_cast<Eigen::Index>(inputs);
+			for (size_t j = 0; j < outputs; ++j) /* Each neuron */
+			{
+				const auto neuronDelta = outputDelta[static_cast<Eigen::Index>(j)];
+				Eigen::Map<ActivationVector>(gradient[j].data(), connections) += neuronDelta * input;
+				gradient[j].back() += neuronDelta; /* Bias activation is always equal to 1.*/
+			}
+
+			if (inputDelta.size() == 0)
+				return;
+
+			inputDelta.setZero();
+			for (size_t j = 0; j < outputs; ++j) /* Each neuron */
+				inputDelta += outputDelta[static_cast<Eigen::Index>(j)] * weights[j].head(connections);
+		}
+
+		size_t ElementwiseModule::GetOutputSize(size_t inputSize) const
+		{
+			return inputSize;
+		}
+
+		vector<size_t> ElementwiseModule::GetWeightShape() const
+		{
+			return {};
+		}
+
+		BackwardNeeds ElementwiseModule::GetBackwardNeeds() const
+		{
+			return BackwardNeeds{ false, true };
+		}
+
+		bool ElementwiseModule::IsElementwise() const
+		{
+			return true;
+		}
+
+		void ElementwiseModule::Backward(WeightLayer const& /*weights*/, ConstSignal /*input*/, ConstSignal output, ConstSignal outputDelta, Signal inputDelta, ErrorGradientLayer& /*gradient*/) const
+		{
+			if (inputDelta.size() == 0)
+				return;
+
+			inputDelta = outputDelta;
+			ScaleByDerivative(output, inputDelta);
+		}
+
+		IModule::Ptr Logistic::Clone() const
+		{
+			return Ptr(new Logistic(*this));
+		}
+
+		SignalUnit Logistic::GetDerivative(SignalUnit output) const
+		{
+			return output * (1.0 - output);
+		}
+
+		void Logistic::Forward(WeightLayer const& /*weights*/, ConstSignal input, Signal output) const
+		{
+			output.array() = (1.0 + (-input.array()).exp()).inverse();
+		}
+
+		void Logistic::ScaleByDerivative(ConstSignal output, Signal delta) const
+		{
+			delta.array() *= output.array() * (1.0 - output.array());
+		}
+
+		IModule::Ptr HyperbolicTangent::Clone() const
+		{
+			return Ptr(new HyperbolicTangent(*this));
+		}
+
+		SignalUnit HyperbolicTangent::GetDerivative(SignalUnit output) const
+		{
+			return 1.0 - output * output;
+		}
+
+		void HyperbolicTangent::Forward(WeightLayer const& /*weights*/, ConstSignal input, Signal output) const
+		{
+			output.array() = input.array().tanh();
+		}
+
+		void HyperbolicTangent::ScaleByDerivative(ConstSignal output, Signal delta) const
+		{
+			delta.array() *= 1.0 - output.array().square();
+		}
+
+		IModule::Ptr Relu::Clone() const
+		{
+			return Ptr(new Relu(*this));
+		}
+
+		SignalUnit Relu::GetDerivative(SignalUnit output) const
+		{
+			return output > 0.0 ? 1.0 : 0.0;
+		}
+
+		void Relu::Forward(WeightLayer const& /*weights*/, ConstSignal input, Signal output) const
+		{
+			output.array() = input.array().max(0.0);
+		}
+
+		void Relu::ScaleByDerivative(ConstSignal output, Signal delta) const
+		{
+			delta.array() = (output.array() > 0.0).select(delta.array(), 0.0);
+		}
+	}
+}
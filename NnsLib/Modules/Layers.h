@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Modules/IModule.h"
+
+namespace NNS
+{
+	namespace Modules
+	{
+		/** Fully connected layer, output = W * input + b. One weight vector per output, input weights then bias. */
+		class Linear final : public IModule
+		{
+		public:
+			Linear(size_t inputSize, size_t outputSize);
+
+			Ptr Clone() const override;
+			size_t GetOutputSize(size_t inputSize) const override;
+			vector<size_t> GetWeightShape() const override;
+			BackwardNeeds GetBackwardNeeds() const override;
+
+			void Forward(WeightLayer const& weights, ConstSignal input, Signal output) const override;
+			void Backward(WeightLayer const& weights, ConstSignal input, ConstSignal output, ConstSignal outputDelta, Signal inputDelta, ErrorGradientLayer& gradient) const override;
+
+		private:
+			size_t inputs;
+			size_t outputs;
+		};
+
+		/** Base of activation functions, size follows the input, no weights, derivative is taken from the output. */
+		class ElementwiseModule : public IModule
+		{
+		public:
+			size_t GetOutputSize(size_t inputSize) const override;
+			vector<size_t> GetWeightShape() const override;
+			BackwardNeeds GetBackwardNeeds() const override;
+			bool IsElementwise() const override;
+
+			void Backward(WeightLayer const& weights, ConstSignal input, ConstSignal output, ConstSignal outputDelta, Signal inputDelta, ErrorGradientLayer& gradient) const override;
+
+		protected:
+			/** Multiply the delta by the derivative at each position, vectorized GetDerivative(). */
+			virtual void ScaleByDerivative(ConstSignal output, Signal delta) const = 0;
+		};
+
+		class Logistic final : public ElementwiseModule
+		{
+		public:
+			Ptr Clone() const override;
+			SignalUnit GetDerivative(SignalUnit output) const override;
+			void Forward(WeightLayer const& weights, ConstSignal input, Signal output) const override;
+
+		protected:
+			void ScaleByDerivative(ConstSignal output, Signal delta) const override;
+		};
+
+		class HyperbolicTangent final : public ElementwiseModule
+		{
+		public:
+			Ptr Clone() const override;
+			SignalUnit GetDerivative(SignalUnit output) const override;
+			void Forward(WeightLayer const& weights, ConstSignal input, Signal output) const override;
+
+		protected:
+			void ScaleByDerivative(ConstSignal output, Signal delta) const override;
+		};
+
+		class Relu final : public ElementwiseModule
+		{
+		public:
+			Ptr Clone() const override;
+			SignalUnit GetDerivative(SignalUnit output) const override;
+			void Forward(WeightLayer const& weights, ConstSignal input, Signal output) const override;
+
+		protected:
+			void ScaleByDerivative(ConstSignal output, Signal delta) const override;
+		};
+	}
+}
@@ -0,0 +1,360 @@
+#include "pch.h"
+#include "Modules/Module.h"
+#include "Modules/Layers.h"
+#include "Modules/Sequential.h"
+#include "Diagnostics/Tracing.h"
+
+#include <algorithm>
+
+namespace NNS
+{
+	namespace Modules
+	{
+		Tensor ModuleHandle::operator()(Tensor input) const
+		{
+			if (input.owner == nullptr)
+			{
+				throw std::invalid_argument("Tensor does not belong to a network");
+			}
+			return input.owner->Apply(index, input);
+		}
+
+		namespace Functional
+		{
+			namespace
+			{
+				Tensor ApplyElementwise(IModule::Ptr module, Tensor input)
+				{
+					if (input.owner == nullptr)
+					{
+						throw std::invalid_argument("Tensor does not belong to a network");
+					}
+					return input.owner->Apply(std::move(module), input);
+				}
+			}
+
+			Tensor Logistic(Tensor input)
+			{
+				return ApplyElementwise(IModule::Ptr(new Modules::Logistic()), input);
+			}
+
+			Tensor HyperbolicTangent(Tensor input)
+			{
+				return ApplyElementwise(IModule::Ptr(new Modules::HyperbolicTangent()), input);
+			}
+
+			Tensor Relu(Tensor input)
+			{
+				return ApplyElementwise(IModule::Ptr(new Modules::Relu()), input);
+			}
+		}
+
+		Module::Module(size_t inputSize)
+			: inputs{ inputSize }, tensorSizes{ inputSize }
+		{
+			if (inputSize == 0)
+			{
+				throw std::invalid_argument("Invalid network size");
+			}
+		}
+
+		ModuleHandle Module::Register(IModule::Ptr module)
+		{
+			if (isTracing || registeredCount != modules.size())
+			{
+				throw std::invalid_argument("Modules are registered before Build()");
+			}
+
+			modules.push_back(std::move(module));
+			return ModuleHandle(registeredCount++);
+		}
+
+		void Module::Build()
+		{
+			/* Modules applied through Functional are recorded again. */
+			modules.resize(registeredCount);
+			nodes.clear();
+			tensorSizes = NetworkLayerMap{ inputs };
+
+			Tensor output;
+			isTracing = true;
+			try
+			{
+				output = Forward(Tensor{ this, 0, inputs });
+			}
+			catch (...)
+			{
+				isTracing = false;
+				throw;
+			}
+			isTracing = false;
+
+			if (nodes.empty() || output.owner != this || output.id != nodes.size())
+			{
+				throw std::invalid_argument("Forward() must return the last applied module's output");
+			}
+
+			activationMatrix = ActivationMatrix{ ActivationVector::Zero(static_cast<Eigen::Index>(inputs)), ActivationVector::Zero(static_cast<Eigen::Index>(tensorSizes.back())) };
+			Rebuild();
+		}
+
+		Tensor Module::Apply(size_t moduleIndex, Tensor input)
+		{
+			if (!isTracing)
+			{
+				throw std::invalid_argument("Modules are applied only inside Forward()");
+			}
+			if (input.owner != this || input.id != nodes.size())
+			{
+				throw std::invalid_argument("Modules must form a chain, each applied to the previous module's output");
+			}
+			if (std::find(nodes.begin(), nodes.end(), moduleIndex) != nodes.end())
+			{
+				throw std::invalid_argument("Module is applied more than once");
+			}
+
+			const auto size = modules[moduleIndex]->GetOutputSize(input.size);
+			nodes.push_back(moduleIndex);
+			tensorSizes.push_back(size);
+			return Tensor{ this, nodes.size(), size };
+		}
+
+		Tensor Module::Apply(IModule::Ptr module, Tensor input)
+		{
+			if (!isTracing)
+			{
+				throw std::invalid_argument("Modules are applied only inside Forward()");
+			}
+
+			modules.push_back(std::move(module));
+			return Apply(modules.size() - 1, input);
+		}
+
+		void Module::SetTrainingMode(bool training)
+		{
+			isTraining = training;
+			if (!nodes.empty())
+				Plan();
+		}
+
+		bool Module::IsTrainingMode() const
+		{
+			return isTraining;
+		}
+
+		size_t Module::GetActivationMemory() const
+		{
+			return static_cast<size_t>(arena.size() + scratch.size());
+		}
+
+		void Module::Free() const
+		{
+			delete this;
+		}
+
+		IFeedforwardNetwork::Ptr Module::Clone() const
+		{
+			auto copy = new Sequential(inputs);
+			for (const auto node : nodes)
+				copy->Add(modules[node]->Clone());
+
+			Module& base = *copy;
+			base.isTraining = isTraining;
+			if (!nodes.empty())
+			{
+				base.Build();
+				base.weightMatrix = weightMatrix;
+			}
+			return IFeedforwardNetwork::Ptr(copy);
+		}
+
+		NetworkLayerMap Module::GetNetworkLayerMap() const
+		{
+			return tensorSizes;
+		}
+
+		void Module::Rebuild()
+		{
+			weightMatrix = WeightMatrix{ nodes.size() };
+			for (size_t i = 0; i < nodes.size(); ++i) /* For each layer ( minus input layer ). */
+			{
+				for (const auto size : modules[nodes[i]]->GetWeightShape()) /* For each neuron. */
+				{
+					weightMatrix[i].push_back(WeightVector::Zero(static_cast<Eigen::Index>(size)));
+					weightMatrix[i].back().tail(1)[0] = 1.0; /* Bias is always equal to 1.0 */
+				}
+			}
+
+			outputNetInput = ActivationVector::Zero(static_cast<Eigen::Index>(tensorSizes.back()));
+			Plan();
+		}
+
+		void Module::Plan()
+		{
+			const auto layers = nodes.size();
+			Eigen::Index arenaSize{ 0 };
+			scratchSize = 0;
+			offsets.assign(layers + 1, -1);
+
+			for (size_t t = 1; t < layers; ++t) /* Each hidden signal, node t - 1 writes it, node t reads it. */
+			{
+				const auto size = static_cast<Eigen::Index>(tensorSizes[t]);
+				const auto isKept = isTraining && (modules[nodes[t - 1]]->GetBackwardNeeds().output || modules[nodes[t]]->GetBackwardNeeds().input);
+				if (isKept)
+				{
+					offsets[t] = arenaSize;
+					arenaSize += size;
+				}
+				else
+				{
+					scratchSize = std::max(scratchSize, size);
+				}
+			}
+
+			arena = ActivationVector::Zero(arenaSize);
+			scratch = ActivationVector::Zero(2 * scratchSize);
+
+			const auto largestLayer = static_cast<Eigen::Index>(*std::max_element(tensorSizes.begin(), tensorSizes.end()));
+			delta = ActivationVector::Zero(isTraining ? largestLayer : 0);
+			previousDelta = ActivationVector::Zero(isTraining ? largestLayer : 0);
+		}
+
+		bool Module::IsOutputElementwise() const
+		{
+			return modules[nodes.back()]->IsElementwise();
+		}
+
+		Signal Module::GetSignal(size_t tensor)
+		{
+			if (tensor == 0)
+				return activationMatrix.front();
+			if (tensor == nodes.size())
+				return activationMatrix.back();
+
+			const auto size = static_cast<Eigen::Index>(tensorSizes[tensor]);
+			if (offsets[tensor] >= 0)
+				return arena.segment(offsets[tensor], size);
+			return scratch.segment(static_cast<Eigen::Index>(tensor % 2) * scratchSize, size);
+		}
+
+		ConstSignal Module::GetKeptSignal(size_t tensor) const
+		{
+			if (tensor == 0)
+				return activationMatrix.front();
+			if (tensor == nodes.size())
+				return activationMatrix.back();
+			if (offsets[tensor] >= 0)
+				return arena.segment(offsets[tensor], static_cast<Eigen::Index>(tensorSizes[tensor]));
+			return Eigen::Map<const ActivationVector>(nullptr, 0);
+		}
+
+		bool Module::ComputeOutput(InputLayer const& inputLayer)
+		{
+			NNS_TRACE_AGGREGATE("Module::ComputeOutput");
+
+			if (nodes.empty() || activationMatrix.front().size() != inputLayer.size())
+				return false;
+
+			activationMatrix.front() = inputLayer;
+
+			for (size_t i = 0; i < nodes.size(); ++i) /* Each layer, except first */
+				modules[nodes[i]]->Forward(weightMatrix[i], GetSignal(i), GetSignal(i + 1));
+
+			/* Hidden signal before the output activation is still in its buffer, the output layer does not use scratch. */
+			outputNetInput = IsOutputElementwise() ? GetSignal(nodes.size() - 1) : GetSignal(nodes.size());
+			return true;
+		}
+
+		void Module::AccumulateGradient(ErrorVector const& outputDelta, ErrorGradientMatrix& gradient)
+		{
+			NNS_TRACE_AGGREGATE("Module::AccumulateGradient");
+
+			if (!isTraining)
+			{
+				throw std::invalid_argument("Gradient is available in training mode only");
+			}
+
+			/* Output delta is taken with respect to the output activation's input, so that module is skipped. */
+			const auto first = IsOutputElementwise() ? nodes.size() - 1 : nodes.size();
+			const auto outputSize = static_cast<Eigen::Index>(outputDelta.size());
+			delta.head(outputSize) = Eigen::Map<const ActivationVector>(outputDelta.data(), outputSize);
+
+			for (size_t i = first; i > 0; --i) /* For each layer ( minus input layer ), backwards. */
+			{
+				const auto size = static_cast<Eigen::Index>(tensorSizes[i]);
+				const auto inputSize = i > 1 ? static_cast<Eigen::Index>(tensorSizes[i - 1]) : 0; /* Input layer needs no delta. */
+				modules[nodes[i - 1]]->Backward(weightMatrix[i - 1], GetKeptSignal(i - 1), GetKeptSignal(i), delta.head(size), previousDelta.head(inputSize), gradient[i - 1]);
+				delta.swap(previousDelta);
+			}
+		}
+
+		ActivationMatrix const& Module::GetActivationMatrix() const
+		{
+			return activationMatrix;
+		}
+
+		SignalUnit const& Module::GetActivation(int layerId, int neuronId) const
+		{
+			const auto layer = static_cast<size_t>(layerId);
+			if (layer == 0)
+				return activationMatrix.front()[neuronId];
+			if (layer == nodes.size())
+				return activationMatrix.back()[neuronId];
+			if (layer > nodes.size() || offsets[layer] < 0)
+			{
+				throw std::invalid_argument("Activation is not kept by the memory plan");
+			}
+			return arena[offsets[layer] + neuronId];
+		}
+
+		SignalUnit Module::GetActivationDerivative(int layerId, int neuronId) const
+		{
+			if (static_cast<size_t>(layerId) != nodes.size())
+				return 1.0;
+
+			return modules[nodes.back()]->GetDerivative(activationMatrix.back()[neuronId]);
+		}
+
+		SignalUnit const& Module::GetOutputActivation(int neuronId) const
+		{
+			return activationMatrix.back()[neuronId];
+		}
+
+		ActivationVector const& Module::GetOutputNetInput() const
+		{
+			return outputNetInput;
+		}
+
+		WeightMatrix& Module::GetWeightMatrix()
+		{
+			return weightMatrix;
+		}
+
+		WeightMatrix const& Module::GetWeightMatrix() const
+		{
+			return weightMatrix;
+		}
+
+		WeightUnit& Module::Weight(int layerId, int neuronId, int connectionId)
+		{
+			return weightMatrix[layerId - 1][neuronId][connectionId];
+		}
+
+		ConnectivityPattern const* Module::GetConnectivity(int /*layerId*/) const
+		{
+			return nullptr; /* Fully connected. */
+		}
+
+		WeightUnit& Module::Bias(int layerId, int neuronId)
+		{
+			return weightMatrix[layerId - 1][neuronId].tail(1)[0];
+		}
+
+		void Module::SetBiasForAll(WeightUnit value)
+		{
+			for (auto& layer : weightMatrix) /* Each layer, except first */
+				for (auto& weightVect : layer) /* Each neuron */
+					weightVect.tail(1)[0] = value;
+		}
+	}
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Models/IFeedforwardNetwork.h"
+#include "Modules/IModule.h"
+
+namespace NNS
+{
+	namespace Modules
+	{
+		using namespace NNS::Models;
+
+		class Module;
+
+		/** Symbolic signal passed through Forward() while Build() records it, holds no data. */
+		struct Tensor final
+		{
+			Module* owner{ nullptr };
+			size_t id{ 0 };
+			size_t size{ 0 };
+		};
+
+		/** Module registered with a network, call it on a tensor inside Forward(). */
+		class ModuleHandle final
+		{
+		public:
+			ModuleHandle() = default;
+			Tensor operator()(Tensor input) const;
+
+		private:
+			friend class Module;
+			explicit ModuleHandle(size_t moduleIndex) : index{ moduleIndex } {}
+
+			size_t index{ 0 };
+		};
+
+		/** Activation functions applied to a tensor inside Forward(), like registered modules without weights. */
+		namespace Functional
+		{
+			Tensor Logistic(Tensor input);
+			Tensor HyperbolicTangent(Tensor input);
+			Tensor Relu(Tensor input);
+		}
+
+		/** Network defined the way torch::nn::Module is: register modules in the constructor, chain them in Forward().
+		* Build() calls Forward() once on a symbolic input, so the order of modules is known before any data flows and
+		* activation buffers are planned up front:
+		* - training mode ( default ) keeps only signals some module reads again in its backward pass, e.g. inputs of Linear and
+		*   outputs of activation functions, packed into one arena, others go through two scratch buffers,
+		* - inference mode keeps nothing, modules run on the two scratch buffers in turns.
+		* ComputeOutput() and AccumulateGradient() then work on these buffers only and never allocate.
+		* Every applied module is a layer: GetNetworkLayerMap() lists their output sizes and GetWeightMatrix() their weights, empty
+		* for activation functions. Only the input and output layers are in GetActivationMatrix(), hidden signals are available
+		* through GetActivation() while the plan keeps them. An activation function applied last is the output layer's activation,
+		* its input is GetOutputNetInput() and the output delta given to AccumulateGradient() is taken with respect to it.
+		* Modules must form a chain, each applied once to the previous module's output.
+		*/
+		class Module : public IFeedforwardNetwork, public IBiased, public IDifferentiable
+		{
+		public:
+			explicit Module(size_t inputSize);
+			Module(Module const&) = delete;
+			Module& operator=(Module const&) = delete;
+
+			/** Record Forward(), size the weights and plan the activation buffers. Call after the modules are registered. */
+			void Build();
+
+			/** Switching re-plans the buffers, AccumulateGradient() is available in training mode only. */
+			void SetTrainingMode(bool training);
+			bool IsTrainingMode() const;
+
+			/** Signal units held for the hidden layers by the current plan, arena and scratch buffers together. */
+			size_t GetActivationMemory() const;
+
+			/** Recording hooks for ModuleHandle and Functional, valid only while Build() runs Forward(). */
+			Tensor Apply(size_t moduleIndex, Tensor input);
+			Tensor Apply(IModule::Ptr module, Tensor input);
+
+			void Free() const override;
+			/** Sequential replaying the recorded chain with the same weights and mode. */
+			IFeedforwardNetwork::Ptr Clone() const override;
+
+			NetworkLayerMap GetNetworkLayerMap() const override;
+			bool ComputeOutput(InputLayer const& inputLayer) override;
+			void Rebuild() override;
+
+			/** Input and output layers only. */
+			ActivationMatrix const& GetActivationMatrix() const override;
+			/** @throw std::invalid_argument for hidden layers not kept by the current plan. */
+			SignalUnit const& GetActivation(int layerId, int neuronId) const override;
+			/** Output layer's activation function, 1 for other layers. */
+			SignalUnit GetActivationDerivative(int layerId, int neuronId) const override;
+			SignalUnit const& GetOutputActivation(int neuronId) const override;
+			ActivationVector const& GetOutputNetInput() const override;
+
+			WeightMatrix& GetWeightMatrix() override;
+			WeightMatrix const& GetWeightMatrix() const override;
+			WeightUnit& Weight(int layerId, int neuronId, int connectionId) override;
+			ConnectivityPattern const* GetConnectivity(int layerId) const override;
+
+			WeightUnit& Bias(int layerId, int neuronId) override;
+			void SetBiasForAll(WeightUnit value = 1.0) override;
+
+			void AccumulateGradient(ErrorVector const& outputDelta, ErrorGradientMatrix& gradient) override;
+
+		protected:
+			template<typename T>
+			ModuleHandle Register(T module)
+			{
+				return Register(IModule::Ptr(new T(std::move(module))));
+			}
+			ModuleHandle Register(IModule::Ptr module);
+
+			/** Chain the registered modules, called by Build() only. */
+			virtual Tensor Forward(Tensor input) = 0;
+
+		private:
+			void Plan();
+			bool IsOutputElementwise() const;
+			Signal GetSignal(size_t tensor);
+			/** Signal kept for the backward pass, empty if the plan did not keep it. */
+			ConstSignal GetKeptSignal(size_t tensor) const;
+
+			size_t inputs;
+			vector<IModule::Ptr> modules; /**< Registered modules first, then those applied through Functional. */
+			size_t registeredCount{ 0 };
+			vector<size_t> nodes; /**< Applied modules in order, node k maps tensor k to tensor k + 1. */
+			NetworkLayerMap tensorSizes; /**< Tensor 0 is the input layer. */
+			bool isTracing{ false };
+			bool isTraining{ true };
+
+			WeightMatrix weightMatrix;
+			ActivationMatrix activationMatrix; /**< Input and output layers. */
+			ActivationVector outputNetInput;
+
+			ActivationVector arena; /**< Hidden signals kept for the backward pass. */
+			vector<Eigen::Index> offsets; /**< Per tensor, offset in the arena or -1 for the scratch buffers. */
+			ActivationVector scratch; /**< Two halves, tensor t uses half t % 2. */
+			Eigen::Index scratchSize{ 0 };
+
+			ActivationVector delta;
+			ActivationVector previousDelta;
+		};
+	}
+}
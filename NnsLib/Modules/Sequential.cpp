@@ -0,0 +1,26 @@
+#include "pch.h"
+#include "Modules/Sequential.h"
+
+namespace NNS
+{
+	namespace Modules
+	{
+		Sequential::Sequential(size_t inputSize)
+			: Module(inputSize)
+		{
+		}
+
+		Sequential& Sequential::Add(IModule::Ptr module)
+		{
+			layers.push_back(Register(std::move(module)));
+			return *this;
+		}
+
+		Tensor Sequential::Forward(Tensor input)
+		{
+			for (const auto& layer : layers)
+				input = layer(input);
+			return input;
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Modules/Module.h"
+
+namespace NNS
+{
+	namespace Modules
+	{
+		/** Modules applied in the order they were added, e.g.
+		* Sequential network{ 8 };
+		* network.Add<Linear>(8, 64).Add<Relu>().Add<Linear>(64, 1).Add<Logistic>().Build();
+		*/
+		class Sequential final : public Module
+		{
+		public:
+			explicit Sequential(size_t inputSize);
+
+			template<typename T, typename... Args>
+			Sequential& Add(Args&&... args)
+			{
+				return Add(IModule::Ptr(new T(std::forward<Args>(args)...)));
+			}
+			Sequential& Add(IModule::Ptr module);
+
+		protected:
+			Tensor Forward(Tensor input) override;
+
+		private:
+			vector<ModuleHandle> layers;
+		};
+	}
+}
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Common/InterfaceHelpers.h"
 #include "Optimization/Backpropagation.h"
+#include "Diagnostics/Tracing.h"
 #include "Models/IFeedforwardNetwork.h"
 
 namespace NNS 
@@ -20,17 +21,17 @@ namespace NNS
 
 		void Backpropagation::Initialize(IFeedforwardNetwork& network)
 		{
-			const auto networkmap = network.GetNetworkLayerMap();
+			const auto& weightMatrix = network.GetWeightMatrix();
 			prevMomentumMatrix.clear();
-			prevMomentumMatrix.resize(networkmap.size() - 1);
+			prevMomentumMatrix.resize(weightMatrix.size());
 
-			for (size_t i = 0; i < networkmap.size() - 1; ++i) /* For each layer ( minus input layer ). */
+			for (size_t i = 0; i < weightMatrix.size(); ++i) /* For each layer ( minus input layer ). */
 			{
-				prevMomentumMatrix[i].resize(networkmap[i + 1]);
+				prevMomentumMatrix[i].resize(weightMatrix[i].size());
 
-				for (size_t j = 0; j < networkmap[i + 1]; ++j) /* For each neuron. */
+				for (size_t j = 0; j < weightMatrix[i].size(); ++j) /* For each neuron. */
 				{
-					prevMomentumMatrix[i][j].resize(networkmap[i] + 1, 0.0); /* Copy connections number. */
+					prevMomentumMatrix[i][j].resize(weightMatrix[i][j].size(), 0.0); /* Copy connections number. */
 					/* +1 becaue of additional bias */
 				}
 			}
@@ -38,17 +39,18 @@ namespace NNS
 
 		bool Backpropagation::OptimizeWeights(IFeedforwardNetwork& network, TrainingErrorState& errorState)
 		{
+			NNS_TRACE_SCOPE("Backpropagation::OptimizeWeights");
+
 			ErrorUnit correction = 0.0; /* Temporal variable */
-			const auto networkmap = network.GetNetworkLayerMap(); /* Obtain network architecture */
 
 			/* For each layer ( minus input layer ). */
-			for (size_t i = 0; i < networkmap.size() - 1; ++i)
+			for (size_t i = 0; i < prevMomentumMatrix.size(); ++i)
 			{
-				/* For each neuron. */
-				for (size_t j = 0; j < networkmap[i + 1]; ++j)
+				/* For each neuron ( or shared filter ). */
+				for (size_t j = 0; j < prevMomentumMatrix[i].size(); ++j)
 				{
 					/* For each connection with previous layer + bias */
-					for (size_t k = 0; k <= networkmap[i]; ++k)
+					for (size_t k = 0; k < prevMomentumMatrix[i][j].size(); ++k)
 					{
 						/* Calculate weight correction. */
 						correction = learningRate * errorState.GetErrorGradient()[i][j][k] + momentumCoeff * prevMomentumMatrix[i][j][k];
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "Optimization/ConjugateGradient.h"
+#include "Diagnostics/Tracing.h"
 #include <ctime>
 
 namespace NNS 
@@ -10,7 +11,7 @@ namespace NNS
 			size_t maxInternalIter, int maxRandomRetry):
 			errorDeltaTolerance{ errorDeltaTolerance }, maxInternalIterations{ maxInternalIter }, maxRandomRetry{ maxRandomRetry }
 		{
-			rngEngine.seed(static_cast<int>(time(0)));
+			SetSeed(static_cast<std::mt19937::result_type>(time(0)));
 		}
 
 		void ConjugateGradient::Free() const
@@ -20,14 +21,41 @@ namespace NNS
 
 		void ConjugateGradient::Initialize(IFeedforwardNetwork& network)
 		{
-			tempMatrixG.clear();
-			searchDirectionH.clear();
+			/* Error gradient is shaped like the weights, so copying it into the work matrices reuses their storage. */
+			const auto& weightMatrix = network.GetWeightMatrix();
+			tempMatrixG.resize(weightMatrix.size());
+			for (size_t i = 0; i < weightMatrix.size(); ++i) /* For each layer ( minus input layer ). */
+			{
+				tempMatrixG[i].resize(weightMatrix[i].size());
+				for (size_t j = 0; j < weightMatrix[i].size(); ++j) /* For each neuron. */
+					tempMatrixG[i][j].assign(static_cast<size_t>(weightMatrix[i][j].size()), 0.0); /* For each connection + bias. */
+			}
+			searchDirectionH = tempMatrixG;
+
+			lineSearchBase.Initialize(network);
+			isGradientCurrent = false;
+		}
+
+		void ConjugateGradient::SetLineSearchSampleSize(size_t samples)
+		{
+			lineSearchSampleSize = samples;
+		}
+
+		void ConjugateGradient::SetSeed(std::mt19937::result_type seed)
+		{
+			rngSeed = seed;
+			rngEngine.seed(seed);
+		}
 
-			networkmap = network.GetNetworkLayerMap();
+		std::mt19937::result_type ConjugateGradient::GetSeed() const
+		{
+			return rngSeed;
 		}
 
 		bool ConjugateGradient::OptimizeWeights(IFeedforwardNetwork& network, TrainingErrorState& errorState)
 		{
+			NNS_TRACE_SCOPE("ConjugateGradient::OptimizeWeights");
+
 			/* Initialize matrices used as a sequence of work vectors and search directions. */
 			tempMatrixG = errorState.GetErrorGradient();
 			searchDirectionH = errorState.GetErrorGradient();
@@ -42,7 +70,7 @@ namespace NNS
 				/* Check absolute error for convergence. */
 				auto error = LineMinimization(network, errorState, previous_error, 10, 1.0e-10, 0.5);
 
-				if (error < 0.0) /* Forced end of calculation. */
+				if (errorState.IsCancelled()) /* Forced end of calculation. */
 				{
 					errorState.UpdateErrorVector(error);
 					return true;
@@ -54,19 +82,30 @@ namespace NNS
 				if ((2.0 * (previous_error - error)) <= (errorDeltaTolerance * (previous_error + error + 1.e-10)))
 				{
 					previous_error = error; /* But first exhaust weight gradient. */
-					error = errorState.ComputeEpochGradient(); /* Recompute gradient. */
+					if (!isGradientCurrent)
+					{
+						error = errorState.ComputeEpochGradient(); /* Recompute gradient. */
+						if (errorState.IsCancelled()) /* Forced end of calculation, gradient is incomplete. */
+						{
+							errorState.UpdateErrorVector(previous_error);
+							return true;
+						}
+					}
+
 					error = LineMinimization(network, errorState, error, 15, 1.0e-10, 1.e-3);
 
 					int retry;
 					for (retry = 0; retry < maxRandomRetry; ++retry)
 					{
-						for (size_t i = 1; i < networkmap.size(); ++i) /* For each layer ( minus input layer ). */
-							for (size_t j = 0; j < networkmap[i]; ++j) /* For each neuron. */
-								for (size_t k = 0; k < networkmap[i - 1] + 1; ++k) /* For each connection + bias. */
+						NNS_TRACE_COUNTER("ConjugateGradient random directions", 1);
+
+						for (size_t i = 1; i <= errorState.GetErrorGradient().size(); ++i) /* For each layer ( minus input layer ). */
+							for (size_t j = 0; j < errorState.GetErrorGradient()[i - 1].size(); ++j) /* For each neuron. */
+								for (size_t k = 0; k < errorState.GetErrorGradient()[i - 1][j].size(); ++k) /* For each connection + bias. */
 									errorState.GetErrorGradient()[i - 1][j][k] = (0.5 - rngUni01(rngEngine)) / 10;
 
 						error = LineMinimization(network, errorState, error, 10, 1.e-10, 1.e-2);
-						if (error < 0.0) /* Forced end of calculation. */
+						if (errorState.IsCancelled()) /* Forced end of calculation. */
 						{
 							errorState.UpdateErrorVector(error);
 							return true;
@@ -93,7 +132,15 @@ namespace NNS
 				//_epochErrorVector.push_back( error );
 
 				/* Setup for next iteration. */
-				error = errorState.ComputeEpochGradient(); /* Recompute gradient. */
+				if (!isGradientCurrent) /* Subsampled line search already computed it while verifying the accepted point. */
+				{
+					error = errorState.ComputeEpochGradient(); /* Recompute gradient. */
+					if (errorState.IsCancelled()) /* Forced end of calculation, gradient is incomplete. */
+					{
+						errorState.UpdateErrorVector(previous_error);
+						return true;
+					}
+				}
 
 				/* Calculate gamma constant. */
 				auto gamma = ComputeGamma(errorState, tempMatrixG);
@@ -114,11 +161,11 @@ namespace NNS
 			ErrorUnit denominator{};
 			ErrorUnit numerator{};
 
-			for (size_t i = 1; i < networkmap.size(); ++i)
+			for (size_t i = 1; i <= tempMatrixG.size(); ++i)
 			{ /* For each layer ( minus input layer ). */
-				for (size_t j = 0; j < networkmap[i]; ++j)
+				for (size_t j = 0; j < tempMatrixG[i - 1].size(); ++j)
 				{ /* For each neuron. */
-					for (size_t k = 0; k < networkmap[i - 1] + 1; ++k)
+					for (size_t k = 0; k < tempMatrixG[i - 1][j].size(); ++k)
 					{ /* For each connection + bias. */
 						denominator += pow(tempMatrixG[i - 1][j][k], 2.0);
 						numerator += (errorState.GetErrorGradient()[i - 1][j][k] - tempMatrixG[i - 1][j][k]) * errorState.GetErrorGradient()[i - 1][j][k]; /* error gradient is negative gradient */
@@ -136,11 +183,11 @@ namespace NNS
 		void ConjugateGradient::ComputeNewSearchDirection(TrainingErrorState& errorState, ErrorUnit gamma, ErrorGradientMatrix& tempMatrixG, DirectionMatrix& searchDirectionH)
 		{
 			//tempMatrixG = errorGradient;
-			for (size_t i = 1; i < static_cast<int>(networkmap.size()); ++i)
+			for (size_t i = 1; i <= searchDirectionH.size(); ++i)
 			{ /* For each layer ( minus input layer ). */
-				for (size_t j = 0; j < networkmap[i]; ++j)
+				for (size_t j = 0; j < searchDirectionH[i - 1].size(); ++j)
 				{ /* For each neuron. */
-					for (size_t k = 0; k < networkmap[i - 1] + 1; ++k)
+					for (size_t k = 0; k < searchDirectionH[i - 1][j].size(); ++k)
 					{ /* For each connection + bias. */
 						tempMatrixG[i - 1][j][k] = errorState.GetErrorGradient()[i - 1][j][k]; /* Save previous directon. */
 						searchDirectionH[i - 1][j][k] = tempMatrixG[i - 1][j][k] + gamma * searchDirectionH[i - 1][j][k];
@@ -153,49 +200,61 @@ namespace NNS
 
 		ErrorUnit ConjugateGradient::LineMinimization(IFeedforwardNetwork& network, TrainingErrorState& errorState, ErrorUnit startError, size_t maxIterations, ErrorUnit epsilon, ErrorUnit tolerance)
 		{
+			NNS_TRACE_SCOPE("ConjugateGradient::LineMinimization");
+
 			ErrorUnit step /* next step */, max_step, x1, x2, x3, t1 /* temporal x1 */, t2 /* temporal x2 */, numerator, denominator /* for parabolic fit */;
 			ErrorUnit current_error /* x2 error */, error /* x3 error */, previous_error /* x1 error */, step_error /* temporal error */;
 
 			ErrorUnit  first_step = 2.5; /* Heuristically found best. */
 
-			WeightMatrix baseWeights = network.GetWeightMatrix(); /* Establishes a baseWeights for stepping out ( saves the weights, so they serve as X0 ). */
+			lineSearchBase.Capture(network); /* Establishes a baseWeights for stepping out ( saves the weights, so they serve as X0 ). */
+			const auto& baseWeights = lineSearchBase.GetWeightMatrix();
+
+			/* Fresh subsample for every direction, trial errors are then compared against the subsample's error at X0. */
+			isGradientCurrent = false;
+			isSubsampled = lineSearchSampleSize != 0 && errorState.DrawSubsample(lineSearchSampleSize, rngEngine) == lineSearchSampleSize;
+			const auto base_error = isSubsampled ? errorState.ComputeSubsampleError() : startError;
 
 			StepOut(network, first_step, errorState.GetErrorGradient()/* direction Xd */, baseWeights); /* Take one step out in the gradient direction. Computes new weights appropriately. */
-			error = errorState.ComputeEpochError(); /* Compute epoch error. */
+			error = ComputeTrialError(errorState); /* Compute epoch error. */
 
-			if (error > startError) /* If the error increased, we may have stepped too far. reverse the role of the two points. */
+			if (error > base_error) /* If the error increased, we may have stepped too far. reverse the role of the two points. */
 			{
 				ReverseDirection(errorState.GetErrorGradient()); /* Negate the direction */
 				x1 = -first_step; /* Use -1, 0 and 1.618 as first three steps. */
 				x2 = 0.0;
 
 				previous_error = error;
-				current_error = startError;
+				current_error = base_error;
 			}
 			else /* Otherwise use 0, 1 and 2.618 as first three steps. */
 			{
 				x1 = 0.0;
 				x2 = first_step;
 
-				previous_error = startError;
+				previous_error = base_error;
 				current_error = error;
 			}
 
-			/*if (isTrainingAborted)
-				return -current_error;*/
+			if (errorState.IsCancelled()) /* If forced end of calculation. */
+			{
+				StepOut(network, 0.0, errorState.GetErrorGradient(), baseWeights); /* Errors above may be partial, fall back to the starting point. */
+				UpdateDirection(0.0, errorState.GetErrorGradient());
+				return startError;
+			}
 
 			/* At this point we have taken a single step and the function decreased. */
 			/* Take one more ( 3rd ) step in the golden ratio. */
 			x3 = x2 + 1.618034 * first_step;
 			StepOut(network, x3, errorState.GetErrorGradient(), baseWeights);
-			error = errorState.ComputeEpochError();
+			error = ComputeTrialError(errorState);
 
 			/*
 			We now have three points x1, x2 and x3 with corresponding errors of 'previous_error', 'current_error' and 'error'.
 			Endlessly loop until we bracket the minimum with the outer two.
 			*/
 
-			while (error < current_error) /* As long as we are descending. */
+			while (error < current_error && !errorState.IsCancelled()) /* As long as we are descending. */
 			{
 				/*
 				Try a parabolic fit to estimate the location of the minimum.
@@ -220,7 +279,7 @@ namespace NNS
 				if ((x2 - step) * (step - x3) > 0.0) /* It's between x2 and x3. */
 				{
 					StepOut(network, step, errorState.GetErrorGradient(), baseWeights);
-					step_error = errorState.ComputeEpochError();
+					step_error = ComputeTrialError(errorState);
 
 					if (step_error < error) /* It worked!  We found min between x2 and x3. */
 					{
@@ -240,13 +299,13 @@ namespace NNS
 					{
 						step = x3 + 1.618034 * (x3 - x2);
 						StepOut(network, step, errorState.GetErrorGradient(), baseWeights);
-						step_error = errorState.ComputeEpochError();
+						step_error = ComputeTrialError(errorState);
 					}
 				}
 				else if ((x3 - step) * (step - max_step) > 0.0) /* Between x3 and lim. */
 				{
 					StepOut(network, step, errorState.GetErrorGradient(), baseWeights);
-					step_error = errorState.ComputeEpochError();
+					step_error = ComputeTrialError(errorState);
 					if (step_error < error)  /* Decreased, so advance by golden ratio. */
 					{
 						x2 = x3;
@@ -255,14 +314,14 @@ namespace NNS
 						current_error = error;
 						error = step_error;
 						StepOut(network, step, errorState.GetErrorGradient(), baseWeights);
-						step_error = errorState.ComputeEpochError();
+						step_error = ComputeTrialError(errorState);
 					}
 				}
 				else if ((step - max_step) * (max_step - x3) >= 0.0) /* Beyond limit. */
 				{
 					step = max_step;
 					StepOut(network, step, errorState.GetErrorGradient(), baseWeights);
-					step_error = errorState.ComputeEpochError();
+					step_error = ComputeTrialError(errorState);
 					if (step_error < error) {  /* Decreased, so advance by golden ratio. */
 						x2 = x3;
 						x3 = step;
@@ -270,14 +329,14 @@ namespace NNS
 						current_error = error;
 						error = step_error;
 						StepOut(network, step, errorState.GetErrorGradient(), baseWeights);
-						step_error = errorState.ComputeEpochError();
+						step_error = ComputeTrialError(errorState);
 					}
 				}
 				else  /* Wild!  Reject parabolic and use golden ratio. */
 				{
 					step = x3 + 1.618034 * (x3 - x2);
 					StepOut(network, step, errorState.GetErrorGradient(), baseWeights);
-					step_error = errorState.ComputeEpochError();
+					step_error = ComputeTrialError(errorState);
 				}
 
 				/* Shift three points and continue endless loop. */
@@ -299,12 +358,13 @@ namespace NNS
 				x3 = t1;
 			}
 
-			//if (isTrainingAborted) /* If forced end of calculation. */
-			//{
-			//	UpdateDirection(x2, errorGradient);/* Make it be the actual dist moved (multiplies search direction vector by the specified value of the parameter t,
-			//								  so that it reflects the actual vector difference between the point corresponding to t and the baseWeights point X0. */
-			//	return -current_error;
-			//}
+			if (errorState.IsCancelled()) /* If forced end of calculation. */
+			{
+				/* The last evaluated points may carry partial errors, fall back to the starting point. */
+				StepOut(network, 0.0, errorState.GetErrorGradient(), baseWeights);
+				UpdateDirection(0.0, errorState.GetErrorGradient());
+				return startError;
+			}
 
 			/* 2nd Step starts here. */
 			/* At this point we have bounded the minimum between x1 and x3. */
@@ -325,6 +385,8 @@ namespace NNS
 
 			for (size_t i = 0; i < maxIterations; i++) /* Loop with limit of iterations */
 			{
+				if (errorState.IsCancelled()) /* If forced end of calculation. */
+					break;
 
 				xmid = 0.5 * (xlow + xhigh);
 				tol1 = tolerance * (fabs(xbest) + epsilon);
@@ -394,7 +456,10 @@ namespace NNS
 				/* At long last we have a trial point 'xrecent'.  Evaluate the function. */
 
 				StepOut(network, xrecent, errorState.GetErrorGradient(), baseWeights);
-				frecent = errorState.ComputeEpochError();
+				frecent = ComputeTrialError(errorState);
+
+				if (errorState.IsCancelled()) /* Partial error, keep the best point found so far. */
+					break;
 
 				if (frecent <= fbest) /* If we improved... */
 				{
@@ -435,21 +500,43 @@ namespace NNS
 			} /* End of For loop */
 
 			StepOut(network, xbest, errorState.GetErrorGradient(), baseWeights); /* Leave coefficients at minimum */
+
+			if (isSubsampled)
+			{
+				/* Subsample only suggested the point, accept it if the full data agrees. Its gradient is needed next anyway. */
+				if (!errorState.IsCancelled())
+				{
+					const auto full_error = errorState.ComputeEpochGradient();
+					if (!errorState.IsCancelled() && full_error <= startError)
+					{
+						isGradientCurrent = true;
+						return full_error;
+					}
+				}
+
+				lineSearchBase.Restore(network); /* Direction was overwritten by the gradient, restore X0 directly. */
+				return startError;
+			}
+
 			UpdateDirection(xbest, errorState.GetErrorGradient()); /* Make it be the actual distance moved. */
 
-			//if (isTrainingAborted) /* If forced end of calculation. */
-			//	return -fbest;
-			//else
-				return fbest;
+			return fbest;
 		}
 
-		void ConjugateGradient::StepOut(IFeedforwardNetwork& network, ErrorUnit step, DirectionMatrix& direction, WeightMatrix& baseWeights)
+		ErrorUnit ConjugateGradient::ComputeTrialError(TrainingErrorState& errorState)
 		{
-			for (size_t i = 1; i < networkmap.size(); ++i)
+			return isSubsampled ? errorState.ComputeSubsampleError() : errorState.ComputeEpochError();
+		}
+
+		void ConjugateGradient::StepOut(IFeedforwardNetwork& network, ErrorUnit step, DirectionMatrix& direction, WeightMatrix const& baseWeights)
+		{
+			NNS_TRACE_SCOPE("ConjugateGradient::StepOut");
+
+			for (size_t i = 1; i <= direction.size(); ++i)
 			{	/* For each layer ( minus input layer ). */
-				for (size_t j = 0; j < networkmap[i]; ++j)
+				for (size_t j = 0; j < direction[i - 1].size(); ++j)
 				{	/* For each neuron. */
-					for (size_t k = 0; k < networkmap[i - 1] + 1; ++k)
+					for (size_t k = 0; k < direction[i - 1][j].size(); ++k)
 					{	/* For each connection + bias. */
 						network.Weight(i, j, k) = baseWeights[i - 1][j][k] + step * direction[i - 1][j][k];
 					}
@@ -460,11 +547,11 @@ namespace NNS
 
 		void ConjugateGradient::UpdateDirection(ErrorUnit step, DirectionMatrix& direction)
 		{
-			for (size_t i = 1; i < networkmap.size(); ++i)
+			for (size_t i = 1; i <= direction.size(); ++i)
 			{	/* For each layer ( minus input layer ). */
-				for (size_t j = 0; j < networkmap[i]; ++j)
+				for (size_t j = 0; j < direction[i - 1].size(); ++j)
 				{	/* For each neuron. */
-					for (size_t k = 0; k < networkmap[i - 1] + 1; ++k)
+					for (size_t k = 0; k < direction[i - 1][j].size(); ++k)
 					{	/* For each connection + bias. */
 						direction[i - 1][j][k] *= step;
 					}
@@ -474,11 +561,11 @@ namespace NNS
 
 		void ConjugateGradient::ReverseDirection(DirectionMatrix& direction)
 		{
-			for (size_t i = 1; i < networkmap.size(); ++i)
+			for (size_t i = 1; i <= direction.size(); ++i)
 			{	/* For each layer ( minus input layer ). */
-				for (size_t j = 0; j < networkmap[i]; ++j)
+				for (size_t j = 0; j < direction[i - 1].size(); ++j)
 				{	/* For each neuron. */
-					for (size_t k = 0; k < networkmap[i - 1] + 1; ++k)
+					for (size_t k = 0; k < direction[i - 1][j].size(); ++k)
 					{	/* For each connection + bias. */
 						direction[i - 1][j][k] = -direction[i - 1][j][k];
 					}
@@ -4,6 +4,7 @@
 
 #include "Types/Collections.h"
 #include "Optimization/IWeightOptimizer.h"
+#include "Training/WeightSnapshot.h"
 
 namespace NNS 
 {
@@ -29,8 +30,21 @@ namespace NNS
 
 			void Free() const override;
 
+			/** Shape the work matrices and the line search's base weights like the network, iterations then only copy values. */
 			void Initialize(IFeedforwardNetwork& network) override;
 
+			/** Evaluate line search trial points on a random subsample instead of the whole training data.
+			* A new subsample is drawn for every search direction. Only the accepted point is evaluated on the full data,
+			* together with the gradient there, and the step is rejected if the full error did not decrease.
+			* Line search cost then depends on the sample size, not on the data set size, which pays off on large data sets.
+			* @param samples subsample size, zero ( default ) or more than the data set has evaluates every trial on the full data.
+			*/
+			void SetLineSearchSampleSize(size_t samples);
+
+			/** Seed random search directions and subsamples, the constructor seeds from the clock. */
+			void SetSeed(std::mt19937::result_type seed) override;
+			std::mt19937::result_type GetSeed() const override;
+
 			/** Conjugate gradient algorithm.
 			* Conjugate gradient algorithm which intelligently choose the search directions for line minimization method.
 			* Based on Polak-Ribiere (1971) work, which proves that if our n-dimensional function to minimize ( epoch error ) can be expressed
@@ -71,12 +85,16 @@ namespace NNS
 			*/
 			ErrorUnit LineMinimization(IFeedforwardNetwork& network, TrainingErrorState& errorState, ErrorUnit startError, size_t maxIterations, ErrorUnit epsilon, ErrorUnit tolerance);
 
+			/** Error of a line search trial point, over the subsample if one is in use.
+			*/
+			ErrorUnit ComputeTrialError(TrainingErrorState& errorState);
+
 			/** Method to step out from base.\ Computes new weights appropriately.
 			* @param step size.
 			* @param direction search direction matrix ( weight gradient ).
 			* @param baseWeights base weight matrix.
 			*/
-			void StepOut(IFeedforwardNetwork& network, ErrorUnit step, DirectionMatrix& direction, WeightMatrix& baseWeights);
+			void StepOut(IFeedforwardNetwork& network, ErrorUnit step, DirectionMatrix& direction, WeightMatrix const& baseWeights);
 
 			/** Method to make direction gradient be the actual distance moved.
 			* This method multiplies the search direction matrix by the specified value.
@@ -90,16 +108,19 @@ namespace NNS
 			*/
 			void ReverseDirection(DirectionMatrix& direction);
 
-			NetworkLayerMap networkmap;
-
 			size_t maxIterations;
 			ErrorUnit errorDeltaTolerance; /**< Iteration terminates once a line minimization fails to reduce the error by approximately this fraction of the actual error. */
 			size_t maxInternalIterations; /**< Limit on the number of iterations  allowed inside conjugate gradient loop. */
 			int maxRandomRetry; /**< Limit on the number of random directions generated if the directional minimization is not effective. */
+			size_t lineSearchSampleSize{ 0 }; /**< Trial points are evaluated on this many random samples, zero for the full data. */
+			bool isSubsampled{ false }; /**< Current line search evaluates trial points on a subsample. */
+			bool isGradientCurrent{ false }; /**< Last line search left the full gradient of the accepted point in the error state. */
 
 			ErrorGradientMatrix tempMatrixG; /**< Work matrix for Polak-Ribiere (1971) ( conjugate gradient ) algorithm. */
 			DirectionMatrix searchDirectionH; /**< Generated search directions which are mutually conjugate. */
+			Training::WeightSnapshot lineSearchBase; /**< Starting point ( X0 ) of the current line search. */
 
+			std::mt19937::result_type rngSeed; /**< Last seed of rngEngine. */
 			std::mt19937 rngEngine; /**< This engine produces randomness out of thin air. */
 			std::uniform_real_distribution<ErrorUnit> rngUni01; /**< Uniform distribution in range <0;1> for random number generator. */
 		};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <random>
 
 #include "Common/IBase.h"
 #include "Models/IFeedforwardNetwork.h"
@@ -18,8 +19,17 @@ namespace NNS
 		public:
 			using Ptr = std::unique_ptr<IWeightOptimizer, SDeleter>;
 		public:
+			/** Size the optimizer's workspace for the network, OptimizeWeights() then does not allocate. Call again after Rebuild(). */
 			virtual void Initialize(IFeedforwardNetwork& network) = 0;
 			virtual bool OptimizeWeights(IFeedforwardNetwork& network, TrainingErrorState& errorState) = 0;
+
+			/** Seed of the optimizer's random choices, the one last set or drawn by the constructor. Zero if it makes none. */
+			virtual std::mt19937::result_type GetSeed() const { return 0; }
+
+			/** Restart the optimizer's random choices from the seed, ignored if it makes none.
+			* Data-parallel training sets rank 0's seed on every rank, see SupervisedTraining::SetCommunicator().
+			*/
+			virtual void SetSeed(std::mt19937::result_type /* seed */) {}
 		};
 	}
 }
\ No newline at end of file
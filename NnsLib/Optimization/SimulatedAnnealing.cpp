@@ -1,14 +1,15 @@
 #include "pch.h"
 #include "Optimization/SimulatedAnnealing.h"
+#include "Diagnostics/Tracing.h"
 
 namespace NNS 
 {
 	namespace Optimization 
 	{
 		SimulatedAnnealing::SimulatedAnnealing(SimulatedAnnealingConfig cfg)
-			: Config{ cfg }
+			: Config{ cfg }, rngGaussian{ 0.0, cfg.perturbationVariance }
 		{
-			rngEngine.seed(static_cast<int>(time(0)));
+			SetSeed(static_cast<std::mt19937::result_type>(time(0)));
 		}
 
 		void SimulatedAnnealing::Free() const
@@ -18,11 +19,25 @@ namespace NNS
 
 		void SimulatedAnnealing::Initialize(IFeedforwardNetwork& network)
 		{
-			// Nop
+			bestWeights.Initialize(network);
+		}
+
+		void SimulatedAnnealing::SetSeed(std::mt19937::result_type seed)
+		{
+			rngSeed = seed;
+			rngEngine.seed(seed);
+			rngGaussian.reset();
+		}
+
+		std::mt19937::result_type SimulatedAnnealing::GetSeed() const
+		{
+			return rngSeed;
 		}
 
 		bool SimulatedAnnealing::OptimizeWeights(IFeedforwardNetwork& network, TrainingErrorState& errorState)
 		{
+			NNS_TRACE_SCOPE("SimulatedAnnealing::OptimizeWeights");
+
 			ComputeSimulatedAnnealing(network, errorState);
 			return true;
 		}
@@ -32,19 +47,13 @@ namespace NNS
 			bool improved; /* True if we improved. */
 			size_t seed, best_seed;
 			ErrorUnit error, best_error; /* Current error and best achieved error. */
-			WeightMatrix best_weights; /* Work area used to keep best network */
-			const auto networkmap = network.GetNetworkLayerMap();
 
-			/* Configure random number generation for simulated annealing. */
-			if (Config.perturbationDistribution == RandomDistributionMethod::Normal)
-			{
-				rngGaussianParams = new std::normal_distribution<ErrorUnit>::param_type(0.0, Config.perturbationVariance);
-				rngGaussian.param((*rngGaussianParams));
-			}
-
-			best_weights = network.GetWeightMatrix(); /* Current weights are best so far. */
+			bestWeights.Capture(network); /* Current weights are best so far. */
 			best_error = errorState.ComputeEpochError();
 
+			if (errorState.IsCancelled()) /* Nothing was perturbed yet. */
+				return;
+
 			auto temperature = Config.startTemperature;
 			auto temperature_mult = exp(log(Config.stopTemperature / Config.startTemperature) / (Config.temperatureNumber - 1));
 
@@ -62,12 +71,19 @@ namespace NNS
 					if (Config.perturbationDistribution == RandomDistributionMethod::Normal)
 						rngGaussian.reset();
 
-					ComputeWeightsPerturbation(network, best_weights, temperature); /* Randomly perturb about best. */
+					ComputeWeightsPerturbation(network, bestWeights.GetWeightMatrix(), temperature); /* Randomly perturb about best. */
 
 					error = errorState.ComputeEpochError();
 
+					if (errorState.IsCancelled()) /* Error of this trial is partial, drop it. */
+						break;
+
+					NNS_TRACE_COUNTER("SimulatedAnnealing trials", 1);
+
 					if (error < best_error) /* If this iteration improved then update the best record. */
 					{
+						NNS_TRACE_COUNTER("SimulatedAnnealing accepted trials", 1);
+
 						best_error = error;
 						best_seed = seed; /* Save seed to recreate it. */
 						//best_weights = _network->GetWeightMatrix();
@@ -86,40 +102,37 @@ namespace NNS
 				{
 					rngEngine.seed(best_seed); /* Reassign best seed. */
 					rngGaussian.reset();
-					ComputeWeightsPerturbation(network, best_weights, temperature); /* Recreate best weights. */
-					best_weights = network.GetWeightMatrix(); /* New best weights. */
+					ComputeWeightsPerturbation(network, bestWeights.GetWeightMatrix(), temperature); /* Recreate best weights. */
+					bestWeights.Capture(network); /* New best weights. */
 				}
 
 				if (best_error <= Config.errorThreshold) /* Stop if we reached the error threshold. */
 					break;
 
 				/* We may break computation here if we need to. */
-				/*if (trainer.IsTrainingAborted())
-					break;*/
+				if (errorState.IsCancelled())
+					break;
 
 				temperature *= temperature_mult; /* Reduce temp for next pass. */
 			}
 
 			/* Apply the best weights we got into the multilayer perceptron. */
-			for (size_t i = 1; i < static_cast<int>(networkmap.size()); ++i) /* For each layer ( minus input layer ). */
-				for (size_t j = 0; j < networkmap[i]; ++j) /* For each neuron. */
-					for (size_t k = 0; k < networkmap[i - 1] + 1; ++k) /* For each connection + bias. */
-						network.Weight(i, j, k) = best_weights[i - 1][j][k];
+			bestWeights.Restore(network);
 		}
 
-		void SimulatedAnnealing::ComputeWeightsPerturbation(IFeedforwardNetwork& network, WeightMatrix& center, ErrorUnit temperature)
+		void SimulatedAnnealing::ComputeWeightsPerturbation(IFeedforwardNetwork& network, WeightMatrix const& center, ErrorUnit temperature)
 		{
-			const auto networkmap = network.GetNetworkLayerMap();
+			NNS_TRACE_SCOPE("SimulatedAnnealing::ComputeWeightsPerturbation");
 
 			/* We reduced the periodicallity of random numbers by using mt19937 pseudo-random number generator. */
 			/* It is derivative of mersenne twister engine and is better than linear congruential engine. */
 			/* We also may use normal distribution ( gaussian ) instead of uniform distribution. */
 
-			for (size_t i = 1; i < networkmap.size(); ++i) /* For each layer ( minus input layer ). */
+			for (size_t i = 1; i <= center.size(); ++i) /* For each layer ( minus input layer ). */
 			{
-				for (size_t j = 0; j < networkmap[i]; ++j) /* For each neuron. */
+				for (size_t j = 0; j < center[i - 1].size(); ++j) /* For each neuron. */
 				{
-					for (size_t k = 0; k < networkmap[i - 1] + 1; ++k) /* For each connection + bias. */
+					for (size_t k = 0; k < static_cast<size_t>(center[i - 1][j].size()); ++k) /* For each connection + bias. */
 					{
 						if (Config.perturbationDistribution == RandomDistributionMethod::Normal)
 						{
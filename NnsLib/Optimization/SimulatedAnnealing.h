@@ -4,6 +4,7 @@
 #include <random>
 
 #include "Optimization/IWeightOptimizer.h"
+#include "Training/WeightSnapshot.h"
 
 namespace NNS 
 {
@@ -56,9 +57,14 @@ namespace NNS
 
 			void Free() const override;
 
+			/** Shape the best weights' buffer like the network, annealing then only copies values. */
 			void Initialize(IFeedforwardNetwork& network) override;
 			bool OptimizeWeights(IFeedforwardNetwork& network, TrainingErrorState& errorState) override;
 
+			/** Seed perturbations, the constructor seeds from the clock. */
+			void SetSeed(std::mt19937::result_type seed) override;
+			std::mt19937::result_type GetSeed() const override;
+
 		private:
 			/** Eluding local minima by means of simulated annealing.
 			* Simple yet effective method for avoiding local minima, as well as escaping from them if necessary.
@@ -73,13 +79,14 @@ namespace NNS
 			* @param center Center around which we will perform perturbation.
 			* @param temperature Temperature magnitude for perturbations.
 			*/
-			void ComputeWeightsPerturbation(IFeedforwardNetwork& network, WeightMatrix& center, ErrorUnit temperature);
+			void ComputeWeightsPerturbation(IFeedforwardNetwork& network, WeightMatrix const& center, ErrorUnit temperature);
 
+			std::mt19937::result_type rngSeed; /**< Last seed set from outside, trials reseed rngEngine on their own. */
 			std::mt19937 rngEngine; /**< This engine produces randomness out of thin air. */
 			std::uniform_real_distribution<ErrorUnit> rngUni01; /**< Uniform distribution in range <0;1> for random number generator. */
 			std::uniform_int_distribution<int> rngUniInt; /**< Uniform distribution in range <0;MAX INT> for random number generator. */
-			std::normal_distribution<ErrorUnit> rngGaussian; /**< Normal (gaussian) distribution for random number generator. */
-			std::normal_distribution<ErrorUnit>::param_type* rngGaussianParams; /**< Parameters (mean, variance) for normal distribution. */
+			std::normal_distribution<ErrorUnit> rngGaussian; /**< Normal (gaussian) distribution for random number generator, configured once in constructor. */
+			Training::WeightSnapshot bestWeights; /**< Work area used to keep best network. */
 		};
 
 
@@ -0,0 +1,299 @@
+#include "pch.h"
+#include "Serialization/CodeGenerator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iomanip>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <type_traits>
+
+namespace NNS
+{
+	namespace Serialization
+	{
+		using NNS::Activation::ActivationFunctionType;
+
+		namespace
+		{
+			const char* const ScalarName = std::is_same<SignalUnit, float>::value ? "float" : "double";
+
+			void ValidateName(const std::string& name)
+			{
+				const auto isIdentifier = !name.empty() && !std::isdigit(static_cast<unsigned char>(name.front()))
+					&& std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+				if (!isIdentifier)
+				{
+					throw std::invalid_argument("Generated code name must be a C++ identifier: " + name);
+				}
+			}
+
+			/** Stream printing values so that they read back exactly. */
+			std::ostringstream MakeStream()
+			{
+				std::ostringstream stream;
+				stream.imbue(std::locale::classic());
+				stream << std::setprecision(std::numeric_limits<SignalUnit>::max_digits10);
+				return stream;
+			}
+
+			const char* ActivationName(ActivationFunctionType activation)
+			{
+				switch (activation)
+				{
+				case ActivationFunctionType::Treshold: return "threshold";
+				case ActivationFunctionType::HiperbolicTangens: return "hyperbolic_tangent";
+				case ActivationFunctionType::Kenue1: return "kenue1";
+				case ActivationFunctionType::Kenue2: return "kenue2";
+				case ActivationFunctionType::Logistic:
+				default: return "logistic";
+				}
+			}
+
+			/** Same formulas as NNS::Activation, so generated and library outputs agree. */
+			const char* ActivationExpression(ActivationFunctionType activation)
+			{
+				switch (activation)
+				{
+				case ActivationFunctionType::Treshold: return "x > 0 ? 1 : 0";
+				case ActivationFunctionType::HiperbolicTangens: return "std::tanh(x)";
+				case ActivationFunctionType::Kenue1: return "(2.0 / pi) * std::atan(std::sinh(x))";
+				case ActivationFunctionType::Kenue2: return "(2.0 / pi) * (std::tanh(x) / std::cosh(x) + std::atan(std::sinh(x)))";
+				case ActivationFunctionType::Logistic:
+				default: return "1 / (1 + std::exp(-x))";
+				}
+			}
+
+			void WriteValue(std::ostringstream& stream, SignalUnit value)
+			{
+				if (!std::isfinite(value))
+				{
+					throw std::invalid_argument("Cannot generate code for a network with non-finite weights");
+				}
+				stream << value;
+			}
+
+			void WriteRow(std::ostringstream& stream, const SignalUnit* values, size_t count)
+			{
+				stream << "{ ";
+				for (size_t k = 0; k < count; ++k)
+				{
+					if (k != 0)
+						stream << ", ";
+					WriteValue(stream, values[k]);
+				}
+				stream << " }";
+			}
+
+			std::string FormatTopology(NetworkLayerMap const& networkmap)
+			{
+				std::ostringstream stream;
+				stream << "{ ";
+				for (size_t i = 0; i < networkmap.size(); ++i)
+					stream << (i != 0 ? ", " : "") << networkmap[i];
+				stream << " }";
+				return stream.str();
+			}
+
+			void WriteFile(const std::string& filePath, const std::string& content)
+			{
+				std::ofstream outfile(filePath, std::ios::binary | std::ios::trunc);
+				if (!outfile.write(content.data(), static_cast<std::streamsize>(content.size())))
+				{
+					throw std::runtime_error("Unable to write generated code: " + filePath);
+				}
+			}
+		}
+
+		std::string GenerateInferenceHeader(MultilayerPerceptron& network, CodeGeneratorConfig const& config)
+		{
+			ValidateName(config.name);
+
+			const auto networkmap = network.GetNetworkLayerMap();
+			const auto& weightMatrix = network.GetWeightMatrix();
+			const auto layers = networkmap.size();
+
+			std::set<ActivationFunctionType> activations;
+			for (size_t i = 1; i < layers; ++i)
+				activations.insert(network.GetActivationFunctionType(static_cast<int>(i)));
+
+			auto stream = MakeStream();
+			stream << "// Generated by NnsLib from a trained MultilayerPerceptron " << FormatTopology(networkmap) << ". Do not edit.\n"
+				<< "#pragma once\n\n"
+				<< "#include <cmath>\n"
+				<< "#include <cstddef>\n\n"
+				<< "namespace " << config.name << "\n{\n"
+				<< "\tusing scalar = " << ScalarName << ";\n\n"
+				<< "\tconstexpr std::size_t input_size = " << networkmap.front() << ";\n"
+				<< "\tconstexpr std::size_t output_size = " << networkmap.back() << ";\n\n"
+				<< "\tnamespace detail\n\t{\n"
+				<< "\t\tconstexpr scalar pi = 3.14159265358979323846;\n\n"
+				<< "\t\t/* Every neuron of the layer at once, neurons are independent and contiguous, so this vectorizes. */\n"
+				<< "\t\ttemplate<std::size_t N>\n"
+				<< "\t\tinline void accumulate(scalar (&layer)[N], const scalar (&weights)[N], scalar x)\n"
+				<< "\t\t{\n"
+				<< "\t\t\tfor (std::size_t j = 0; j < N; ++j)\n"
+				<< "\t\t\t\tlayer[j] += weights[j] * x;\n"
+				<< "\t\t}\n";
+
+			for (const auto activation : activations)
+			{
+				stream << "\n"
+					<< "\t\ttemplate<std::size_t N>\n"
+					<< "\t\tinline void " << ActivationName(activation) << "(scalar (&layer)[N])\n"
+					<< "\t\t{\n"
+					<< "\t\t\tfor (std::size_t j = 0; j < N; ++j)\n"
+					<< "\t\t\t{\n"
+					<< "\t\t\t\tconst scalar x = layer[j];\n"
+					<< "\t\t\t\tlayer[j] = " << ActivationExpression(activation) << ";\n"
+					<< "\t\t\t}\n"
+					<< "\t\t}\n";
+			}
+
+			vector<SignalUnit> row;
+			for (size_t i = 1; i < layers; ++i) /* For each layer ( minus input layer ). */
+			{
+				const auto connectivity = network.GetConnectivity(static_cast<int>(i));
+				const auto inputs = networkmap[i - 1];
+				const auto neurons = networkmap[i];
+
+				stream << "\n\t\t/* Layer " << i << ": " << inputs << " -> " << neurons << ", " << ActivationName(network.GetActivationFunctionType(static_cast<int>(i)))
+					<< ". Row k holds the weights of input k for every neuron. */\n"
+					<< "\t\talignas(64) constexpr scalar layer" << i << "_weights[" << inputs << "][" << neurons << "] =\n\t\t{\n";
+
+				for (size_t k = 0; k < inputs; ++k) /* For each connection with previous layer. */
+				{
+					row.assign(neurons, 0.0);
+					for (size_t j = 0; j < neurons; ++j) /* For each neuron. */
+					{
+						const auto& weightVect = weightMatrix[i - 1][j];
+						if (connectivity == nullptr)
+						{
+							row[j] = weightVect[static_cast<Eigen::Index>(k)];
+							continue;
+						}
+
+						const auto* sources = connectivity->innerIndexPtr() + connectivity->outerIndexPtr()[j];
+						for (Eigen::Index c = 0; c + 1 < weightVect.size(); ++c) /* Each existing connection */
+							if (static_cast<size_t>(sources[c]) == k)
+								row[j] = weightVect[c];
+					}
+
+					stream << "\t\t\t";
+					WriteRow(stream, row.data(), neurons);
+					stream << ",\n";
+				}
+
+				row.resize(neurons);
+				for (size_t j = 0; j < neurons; ++j) /* For each neuron. */
+					row[j] = weightMatrix[i - 1][j].tail(1)[0];
+
+				stream << "\t\t};\n"
+					<< "\t\talignas(64) constexpr scalar layer" << i << "_biases[" << neurons << "] = ";
+				WriteRow(stream, row.data(), neurons);
+				stream << ";\n";
+			}
+
+			stream << "\t}\n\n"
+				<< "\t/** Output of the network for one input. Uses the stack only. */\n"
+				<< "\tinline void predict(const scalar (&input)[input_size], scalar (&output)[output_size])\n"
+				<< "\t{\n";
+
+			for (size_t i = 1; i < layers; ++i) /* For each layer ( minus input layer ). */
+			{
+				const auto layerName = i + 1 == layers ? std::string("output") : "layer" + std::to_string(i);
+				const auto previousName = i == 1 ? std::string("input") : "layer" + std::to_string(i - 1);
+
+				if (i + 1 < layers)
+					stream << "\t\tscalar " << layerName << "[" << networkmap[i] << "];\n";
+
+				stream << "\t\tfor (std::size_t j = 0; j < " << networkmap[i] << "; ++j)\n"
+					<< "\t\t\t" << layerName << "[j] = detail::layer" << i << "_biases[j];\n";
+
+				for (size_t k = 0; k < networkmap[i - 1]; ++k) /* For each connection with previous layer. */
+					stream << "\t\tdetail::accumulate(" << layerName << ", detail::layer" << i << "_weights[" << k << "], " << previousName << "[" << k << "]);\n";
+
+				stream << "\t\tdetail::" << ActivationName(network.GetActivationFunctionType(static_cast<int>(i))) << "(" << layerName << ");\n";
+				if (i + 1 < layers)
+					stream << "\n";
+			}
+
+			stream << "\t}\n"
+				<< "}\n";
+			return stream.str();
+		}
+
+		std::string GenerateInferenceTest(MultilayerPerceptron& network, TrainingDataSet const& samples, CodeGeneratorConfig const& config)
+		{
+			ValidateName(config.name);
+
+			if (samples.empty())
+			{
+				throw std::invalid_argument("Generated test needs at least one sample");
+			}
+
+			auto inputs = MakeStream();
+			auto expected = MakeStream();
+			for (const auto& sample : samples)
+			{
+				if (!network.ComputeOutput(sample.first))
+				{
+					throw std::invalid_argument("Sample does not match the network's input layer");
+				}
+
+				const auto& output = network.GetActivationMatrix().back();
+				inputs << "\t\t";
+				WriteRow(inputs, sample.first.data(), static_cast<size_t>(sample.first.size()));
+				inputs << ",\n";
+				expected << "\t\t";
+				WriteRow(expected, output.data(), static_cast<size_t>(output.size()));
+				expected << ",\n";
+			}
+
+			auto stream = MakeStream();
+			const auto& name = config.name;
+			stream << "// Generated by NnsLib, checks " << name << "::predict() against MultilayerPerceptron::ComputeOutput(). Do not edit.\n"
+				<< "#include <cmath>\n"
+				<< "#include <cstdio>\n\n"
+				<< "#include \"" << name << ".h\"\n\n"
+				<< "namespace\n{\n"
+				<< "\tusing " << name << "::scalar;\n\n"
+				<< "\tconstexpr std::size_t sample_count = " << samples.size() << ";\n"
+				<< "\tconstexpr scalar tolerance = " << config.tolerance << ";\n\n"
+				<< "\tconstexpr scalar inputs[sample_count][" << name << "::input_size] =\n\t{\n" << inputs.str() << "\t};\n\n"
+				<< "\tconstexpr scalar expected[sample_count][" << name << "::output_size] =\n\t{\n" << expected.str() << "\t};\n"
+				<< "}\n\n"
+				<< "int main()\n{\n"
+				<< "\tint failures = 0;\n"
+				<< "\tfor (std::size_t s = 0; s < sample_count; ++s)\n"
+				<< "\t{\n"
+				<< "\t\tscalar output[" << name << "::output_size];\n"
+				<< "\t\t" << name << "::predict(inputs[s], output);\n\n"
+				<< "\t\tfor (std::size_t k = 0; k < " << name << "::output_size; ++k)\n"
+				<< "\t\t{\n"
+				<< "\t\t\tif (!(std::fabs(output[k] - expected[s][k]) <= tolerance * (1 + std::fabs(expected[s][k]))))\n"
+				<< "\t\t\t{\n"
+				<< "\t\t\t\tstd::printf(\"sample %u, output %u: %.17g, expected %.17g\\n\", static_cast<unsigned>(s), static_cast<unsigned>(k), static_cast<double>(output[k]), static_cast<double>(expected[s][k]));\n"
+				<< "\t\t\t\t++failures;\n"
+				<< "\t\t\t}\n"
+				<< "\t\t}\n"
+				<< "\t}\n\n"
+				<< "\tstd::printf(\"%d mismatches in %u samples\\n\", failures, static_cast<unsigned>(sample_count));\n"
+				<< "\treturn failures == 0 ? 0 : 1;\n"
+				<< "}\n";
+			return stream.str();
+		}
+
+		void SaveInferenceCode(MultilayerPerceptron& network, TrainingDataSet const& samples, const std::string& directory, CodeGeneratorConfig const& config)
+		{
+			const auto header = GenerateInferenceHeader(network, config);
+			const auto test = GenerateInferenceTest(network, samples, config);
+
+			const auto base = (std::filesystem::path(directory) / config.name).string();
+			WriteFile(base + ".h", header);
+			WriteFile(base + "_test.cpp", test);
+		}
+	}
+}
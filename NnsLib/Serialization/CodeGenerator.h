@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+
+#include "Models/MultilayerPerceptron.h"
+#include "Types/Collections.h"
+
+namespace NNS
+{
+	namespace Serialization
+	{
+		using namespace NNS::Types;
+		using NNS::Models::MultilayerPerceptron;
+
+		struct CodeGeneratorConfig final
+		{
+			// Namespace of the generated code and base name of the generated files, must be a C++ identifier.
+			std::string name{ "nns_model" };
+			// Emitted test accepts outputs within this tolerance relative to ( 1 + |expected| ), summation order may differ from the library's.
+			SignalUnit tolerance{ 1e-12 };
+		};
+
+		/** Ahead-of-time compiled inference, a self-contained header for targets without the library.
+		* Weights and biases become constexpr arrays, predict() works on fixed size stack arrays, so there is no Eigen, no allocation and no virtual call.
+		* Every layer is unrolled over its inputs, each step adding one input times its weights to all neurons of the layer at once.
+		* Those inner loops have constant bounds and no reduction, so compilers vectorize them without fast-math.
+		* Weights are printed with max_digits10, the generated network computes exactly what the library's does up to summation order.
+		* Sparse layers are emitted dense, missing connections have zero weight.
+		* @throw std::invalid_argument if the name is not an identifier or a weight is not finite.
+		*/
+		std::string GenerateInferenceHeader(MultilayerPerceptron& network, CodeGeneratorConfig const& config = {});
+
+		/** Standalone test for the generated header, main() returns nonzero unless predict() reproduces the network's outputs.
+		* Expected outputs are computed now by the library's ComputeOutput() on the inputs of the given samples.
+		* @throw std::invalid_argument if there are no samples or their inputs do not match the network.
+		*/
+		std::string GenerateInferenceTest(MultilayerPerceptron& network, TrainingDataSet const& samples, CodeGeneratorConfig const& config = {});
+
+		/** Write both into a directory as <name>.h and <name>_test.cpp.
+		* @throw std::runtime_error if a file cannot be written.
+		*/
+		void SaveInferenceCode(MultilayerPerceptron& network, TrainingDataSet const& samples, const std::string& directory, CodeGeneratorConfig const& config = {});
+	}
+}
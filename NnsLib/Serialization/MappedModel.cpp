@@ -0,0 +1,256 @@
+#include "pch.h"
+#include "Serialization/MappedModel.h"
+#include "Diagnostics/Tracing.h"
+
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace NNS
+{
+	namespace Serialization
+	{
+		using namespace NNS::Activation;
+
+		namespace
+		{
+			template<typename TFunction>
+			void ApplyActivation(ActivationVector& layer, TFunction function)
+			{
+				layer = layer.unaryExpr(function);
+			}
+
+			void ApplyActivation(ActivationVector& layer, ActivationFunctionType activation)
+			{
+				switch (activation)
+				{
+				case ActivationFunctionType::Treshold:
+					return ApplyActivation(layer, TresholdActivationFunction<SignalUnit>{});
+				case ActivationFunctionType::HiperbolicTangens:
+					return ApplyActivation(layer, HiperbolicTangensActivationFunction<SignalUnit>{});
+				case ActivationFunctionType::Kenue1:
+					return ApplyActivation(layer, Kenue1ActivationFunction<SignalUnit>{});
+				case ActivationFunctionType::Kenue2:
+					return ApplyActivation(layer, Kenue2ActivationFunction<SignalUnit>{});
+				case ActivationFunctionType::Logistic:
+				default:
+					return ApplyActivation(layer, LogisticActivationFunction<SignalUnit>{});
+				}
+			}
+
+			/** Block of rows x columns weights, sizes come from the file, so the byte count is checked for overflow first. */
+			bool IsBlockInFile(std::uint64_t offset, std::uint64_t rows, std::uint64_t columns, std::uint64_t fileSize)
+			{
+				constexpr auto maxElements = std::numeric_limits<std::uint64_t>::max() / sizeof(WeightUnit);
+				if (columns != 0 && rows > maxElements / columns)
+					return false;
+
+				const auto bytes = rows * columns * sizeof(WeightUnit);
+				return offset % ModelBlockAlignment == 0 && offset <= fileSize && bytes <= fileSize - offset;
+			}
+		}
+
+		MappedModel::MappedModel(const std::string& filePath)
+		{
+#ifdef _WIN32
+			fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			LARGE_INTEGER fileSize{};
+			if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &fileSize))
+			{
+				Unmap();
+				throw std::runtime_error("Unable to open model file: " + filePath);
+			}
+			size = static_cast<size_t>(fileSize.QuadPart);
+
+			mappingHandle = size > 0 ? CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+			data = mappingHandle ? static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+			const int fd = open(filePath.c_str(), O_RDONLY);
+			struct stat fileStat {};
+			if (fd < 0 || fstat(fd, &fileStat) != 0)
+			{
+				if (fd >= 0)
+					close(fd);
+				throw std::runtime_error("Unable to open model file: " + filePath);
+			}
+			size = static_cast<size_t>(fileStat.st_size);
+
+			void* mapping = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+			close(fd); /* The mapping keeps the file referenced. */
+			data = mapping != MAP_FAILED ? static_cast<const unsigned char*>(mapping) : nullptr;
+#endif
+			if (data == nullptr)
+			{
+				Unmap();
+				throw std::runtime_error("Unable to map model file: " + filePath);
+			}
+
+			/* Validate header and block bounds only, the blocks themselves are used as they are. */
+			ModelFileHeader header;
+			if (size < sizeof(header))
+			{
+				Unmap();
+				throw ModelFormatError("Model file is truncated: " + filePath);
+			}
+			std::memcpy(&header, data, sizeof(header));
+
+			std::string reason;
+			if (std::memcmp(header.magic, ModelFileMagic, sizeof(header.magic)) != 0)
+				reason = "not a model file";
+			else if (header.version != ModelFileVersion)
+				reason = "unsupported model version " + std::to_string(header.version);
+			else if (header.endiannessTag != ModelEndiannessTag || header.signalUnitSize != sizeof(SignalUnit))
+				reason = "model was written on an incompatible platform";
+			else if (header.fileSize != size || header.layerCount < 2 || header.layerCount > (size - sizeof(header)) / sizeof(ModelLayerRecord))
+				reason = "model file is truncated";
+
+			const auto records = reinterpret_cast<const ModelLayerRecord*>(data + sizeof(header));
+			if (reason.empty() && records[0].size == 0)
+				reason = "invalid layer record 0";
+			for (size_t i = 1; reason.empty() && i < header.layerCount; ++i)
+			{
+				/* Non-empty layers keep every size bounded by the blocks that must fit in the file, input layer included. */
+				const auto& record = records[i];
+				if (record.size == 0
+					|| !IsBlockInFile(record.weightOffset, record.size, records[i - 1].size, size)
+					|| !IsBlockInFile(record.biasOffset, record.size, 1, size)
+					|| record.activation > static_cast<std::uint32_t>(ActivationFunctionType::Kenue2))
+				{
+					reason = "invalid layer record " + std::to_string(i);
+				}
+			}
+
+			if (!reason.empty())
+			{
+				Unmap();
+				throw ModelFormatError(reason + ": " + filePath);
+			}
+
+			activationMatrix.push_back(ActivationVector::Zero(static_cast<Eigen::Index>(records[0].size)));
+			for (size_t i = 1; i < header.layerCount; ++i)
+			{
+				const auto rows = static_cast<Eigen::Index>(records[i].size);
+				const auto cols = static_cast<Eigen::Index>(records[i - 1].size);
+
+				layers.push_back(MappedLayer{
+					MappedWeights(reinterpret_cast<const WeightUnit*>(data + records[i].weightOffset), rows, cols),
+					MappedBiases(reinterpret_cast<const WeightUnit*>(data + records[i].biasOffset), rows),
+					static_cast<ActivationFunctionType>(records[i].activation) });
+				activationMatrix.push_back(ActivationVector::Zero(rows));
+			}
+		}
+
+		MappedModel::~MappedModel()
+		{
+			Unmap();
+		}
+
+		void MappedModel::Unmap()
+		{
+#ifdef _WIN32
+			if (data != nullptr)
+				UnmapViewOfFile(data);
+			if (mappingHandle != nullptr)
+				CloseHandle(mappingHandle);
+			if (fileHandle != nullptr && fileHandle != INVALID_HANDLE_VALUE)
+				CloseHandle(fileHandle);
+			mappingHandle = fileHandle = nullptr;
+#else
+			if (data != nullptr)
+				munmap(const_cast<unsigned char*>(data), size);
+#endif
+			data = nullptr;
+		}
+
+		NetworkLayerMap MappedModel::GetNetworkLayerMap() const
+		{
+			NetworkLayerMap networkmap(activationMatrix.size());
+
+			for (size_t i = 0; i < activationMatrix.size(); ++i)
+				networkmap[i] = static_cast<size_t>(activationMatrix[i].size());
+
+			return networkmap;
+		}
+
+		ActivationFunctionType MappedModel::GetActivationFunctionType(int layerId) const
+		{
+			return layers[layerId - 1].activation;
+		}
+
+		bool MappedModel::ComputeOutput(InputLayer const& inputLayer)
+		{
+			NNS_TRACE_AGGREGATE("MappedModel::ComputeOutput");
+
+			if (activationMatrix.front().size() != inputLayer.size())
+				return false;
+
+			activationMatrix.front() = inputLayer;
+
+			for (size_t i = 1; i < activationMatrix.size(); ++i) /* Each layer, except first */
+			{
+				const auto& layer = layers[i - 1];
+				activationMatrix[i].noalias() = layer.weights * activationMatrix[i - 1];
+				activationMatrix[i] += layer.biases;
+				ApplyActivation(activationMatrix[i], layer.activation);
+			}
+
+			return true;
+		}
+
+		OutputLayer const& MappedModel::GetOutputLayer() const
+		{
+			return activationMatrix.back();
+		}
+
+		SignalUnit const& MappedModel::GetOutputActivation(int neuronId) const
+		{
+			return activationMatrix.back()[neuronId];
+		}
+
+		void MappedModel::CopyWeightsTo(IFeedforwardNetwork& network) const
+		{
+			if (network.GetNetworkLayerMap() != GetNetworkLayerMap())
+			{
+				throw std::invalid_argument("Network topology does not match the model");
+			}
+
+			for (size_t i = 1; i < activationMatrix.size(); ++i) /* For each layer ( minus input layer ). */
+			{
+				const auto& layer = layers[i - 1];
+				const auto connectivity = network.GetConnectivity(static_cast<int>(i));
+				for (Eigen::Index j = 0; j < layer.weights.rows(); ++j) /* For each neuron. */
+				{
+					if (connectivity == nullptr)
+					{
+						for (Eigen::Index k = 0; k < layer.weights.cols(); ++k) /* For each connection. */
+							network.Weight(static_cast<int>(i), static_cast<int>(j), static_cast<int>(k)) = layer.weights(j, k);
+
+						network.Weight(static_cast<int>(i), static_cast<int>(j), static_cast<int>(layer.weights.cols())) = layer.biases[j];
+					}
+					else
+					{	/* Only connections existing in the network are copied. */
+						const auto rowBegin = connectivity->outerIndexPtr()[j], rowEnd = connectivity->outerIndexPtr()[j + 1];
+						for (auto c = rowBegin; c < rowEnd; ++c) /* For each connection. */
+							network.Weight(static_cast<int>(i), static_cast<int>(j), static_cast<int>(c - rowBegin)) = layer.weights(j, connectivity->innerIndexPtr()[c]);
+
+						network.Weight(static_cast<int>(i), static_cast<int>(j), static_cast<int>(rowEnd - rowBegin)) = layer.biases[j];
+					}
+				}
+			}
+		}
+	}
+}
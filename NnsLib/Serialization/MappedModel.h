@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+
+#include "Common/ActivationFunctions.h"
+#include "Models/IFeedforwardNetwork.h"
+#include "Serialization/ModelFormat.h"
+#include "Types/Collections.h"
+
+namespace NNS
+{
+	namespace Serialization
+	{
+		using namespace NNS::Types;
+		using NNS::Activation::ActivationFunctionType;
+		using NNS::Models::IFeedforwardNetwork;
+
+		/** Inference-only network backed by a memory mapped model file.
+		* Weight and bias blocks are used in place through Eigen::Map, nothing is parsed or copied on load apart from a few header checks.
+		* The mapping is read-only and shared, so every process serving the same model file shares its physical pages.
+		* Each instance keeps its own activation buffers, use one instance per thread.
+		*/
+		class MappedModel final
+		{
+		public:
+			/** Maps the file and validates its header and block bounds.
+			* @throw std::runtime_error if the file cannot be mapped.
+			* @throw ModelFormatError if the file is not a compatible model.
+			*/
+			explicit MappedModel(const std::string& filePath);
+			~MappedModel();
+
+			MappedModel(const MappedModel&) = delete;
+			MappedModel& operator=(const MappedModel&) = delete;
+
+			NetworkLayerMap GetNetworkLayerMap() const;
+			ActivationFunctionType GetActivationFunctionType(int layerId) const;
+
+			bool ComputeOutput(InputLayer const& inputLayer);
+			OutputLayer const& GetOutputLayer() const;
+			SignalUnit const& GetOutputActivation(int neuronId) const;
+
+			/** Copy weights into a network of the same topology, e.g. to resume training. */
+			void CopyWeightsTo(IFeedforwardNetwork& network) const;
+
+		private:
+			using RowMajorWeightMatrix = Eigen::Matrix<WeightUnit, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+			using MappedWeights = Eigen::Map<const RowMajorWeightMatrix, Eigen::Aligned16>;
+			using MappedBiases = Eigen::Map<const WeightVector, Eigen::Aligned16>;
+
+			struct MappedLayer
+			{
+				MappedWeights weights;
+				MappedBiases biases;
+				ActivationFunctionType activation;
+			};
+
+			void Unmap();
+
+			const unsigned char* data{ nullptr };
+			size_t size{ 0 };
+#ifdef _WIN32
+			void* fileHandle{ nullptr };
+			void* mappingHandle{ nullptr };
+#endif
+
+			vector<MappedLayer> layers; /**< Layers after the input one. */
+			ActivationMatrix activationMatrix;
+		};
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace NNS
+{
+	namespace Serialization
+	{
+		/** Binary model file layout, version 1.
+		* [ModelFileHeader][ModelLayerRecord x layerCount][padding][weight block][bias block]...
+		* Each layer except the input one owns a row-major weight block (neurons x previous layer size) followed by a bias block (neurons).
+		* Every block starts at a multiple of ModelBlockAlignment, so once the file is mapped the blocks can be used in place as Eigen matrices.
+		* All values are stored in native byte order, the endianness tag lets a foreign machine reject the file instead of misreading it.
+		*/
+		constexpr char ModelFileMagic[8] = { 'N', 'N', 'S', 'M', 'O', 'D', 'E', 'L' };
+		constexpr std::uint32_t ModelFileVersion = 1;
+		constexpr std::uint32_t ModelEndiannessTag = 0x01020304;
+		constexpr std::uint64_t ModelBlockAlignment = 64;
+
+		struct ModelFileHeader
+		{
+			char magic[8];
+			std::uint32_t version;
+			std::uint32_t endiannessTag;
+			std::uint32_t signalUnitSize; /**< sizeof(SignalUnit) of the writer. */
+			std::uint32_t layerCount; /**< Including input layer. */
+			std::uint64_t fileSize;
+		};
+
+		struct ModelLayerRecord
+		{
+			std::uint64_t size; /**< Number of neurons. */
+			std::uint32_t activation; /**< Activation::ActivationFunctionType, unused for input layer. */
+			std::uint32_t reserved;
+			std::uint64_t weightOffset; /**< Zero for input layer. */
+			std::uint64_t biasOffset; /**< Zero for input layer. */
+		};
+
+		static_assert(sizeof(ModelFileHeader) == 32, "Model file header layout must not depend on the compiler");
+		static_assert(sizeof(ModelLayerRecord) == 32, "Model layer record layout must not depend on the compiler");
+
+		/** Raised when a file is not a model or is a model this build cannot use. */
+		class ModelFormatError : public std::runtime_error
+		{
+		public:
+			using std::runtime_error::runtime_error;
+		};
+	}
+}
@@ -0,0 +1,94 @@
+#include "pch.h"
+#include "Serialization/ModelWriter.h"
+
+#include <cstring>
+
+namespace NNS
+{
+	namespace Serialization
+	{
+		namespace
+		{
+			std::uint64_t AlignOffset(std::uint64_t offset)
+			{
+				return (offset + ModelBlockAlignment - 1) / ModelBlockAlignment * ModelBlockAlignment;
+			}
+		}
+
+		void SaveModel(MultilayerPerceptron& network, const std::string& filePath)
+		{
+			const auto networkmap = network.GetNetworkLayerMap();
+			const auto& weightMatrix = network.GetWeightMatrix();
+
+			/* Lay out the blocks first, so the header can carry the final file size. */
+			vector<ModelLayerRecord> layers(networkmap.size());
+			std::uint64_t offset = sizeof(ModelFileHeader) + layers.size() * sizeof(ModelLayerRecord);
+
+			for (size_t i = 0; i < networkmap.size(); ++i)
+			{
+				layers[i] = ModelLayerRecord{};
+				layers[i].size = networkmap[i];
+
+				if (i == 0) /* Input layer has no weights. */
+					continue;
+
+				layers[i].activation = static_cast<std::uint32_t>(network.GetActivationFunctionType(static_cast<int>(i)));
+				layers[i].weightOffset = AlignOffset(offset);
+				offset = layers[i].weightOffset + networkmap[i] * networkmap[i - 1] * sizeof(WeightUnit);
+				layers[i].biasOffset = AlignOffset(offset);
+				offset = layers[i].biasOffset + networkmap[i] * sizeof(WeightUnit);
+			}
+
+			ModelFileHeader header{};
+			std::memcpy(header.magic, ModelFileMagic, sizeof(header.magic));
+			header.version = ModelFileVersion;
+			header.endiannessTag = ModelEndiannessTag;
+			header.signalUnitSize = sizeof(SignalUnit);
+			header.layerCount = static_cast<std::uint32_t>(layers.size());
+			header.fileSize = offset;
+
+			/* Serialize into one buffer and write it in one go. Padding stays zeroed. */
+			std::string image(static_cast<size_t>(header.fileSize), '\0');
+			std::memcpy(&image[0], &header, sizeof(header));
+			std::memcpy(&image[sizeof(header)], layers.data(), layers.size() * sizeof(ModelLayerRecord));
+
+			for (size_t i = 1; i < networkmap.size(); ++i) /* For each layer ( minus input layer ). */
+			{
+				const auto rowSize = networkmap[i - 1] * sizeof(WeightUnit);
+				const auto connectivity = network.GetConnectivity(static_cast<int>(i));
+
+				for (size_t j = 0; j < networkmap[i]; ++j) /* For each neuron. */
+				{
+					const auto& weightVect = weightMatrix[i - 1][j];
+					const auto connections = static_cast<size_t>(weightVect.size()) - 1;
+					const auto rowOffset = layers[i].weightOffset + j * rowSize;
+
+					if (connectivity == nullptr)
+					{
+						std::memcpy(&image[rowOffset], weightVect.data(), rowSize);
+					}
+					else
+					{	/* The format is dense, missing connections stay zero. */
+						const auto* sources = connectivity->innerIndexPtr() + connectivity->outerIndexPtr()[j];
+						for (size_t k = 0; k < connections; ++k)
+							std::memcpy(&image[rowOffset + sources[k] * sizeof(WeightUnit)], weightVect.data() + k, sizeof(WeightUnit));
+					}
+					std::memcpy(&image[layers[i].biasOffset + j * sizeof(WeightUnit)], weightVect.data() + connections, sizeof(WeightUnit));
+				}
+			}
+
+			std::ofstream outfile(filePath, std::ios::binary | std::ios::trunc);
+			if (!outfile.write(image.data(), static_cast<std::streamsize>(image.size())))
+			{
+				throw std::runtime_error("Unable to write model file: " + filePath);
+			}
+		}
+
+		void SaveModel(MultilayerPerceptron const& network, Data::InputNormalizer const& normalizer, const std::string& filePath)
+		{
+			MultilayerPerceptron folded{ network };
+			normalizer.FoldInto(folded);
+			SaveModel(folded, filePath);
+		}
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+#include "Models/MultilayerPerceptron.h"
+#include "Data/InputNormalizer.h"
+#include "Serialization/ModelFormat.h"
+
+namespace NNS
+{
+	namespace Serialization
+	{
+		using namespace NNS::Types;
+		using NNS::Models::MultilayerPerceptron;
+
+		/** Save topology, per layer activation and weights of a trained network in the binary model format.
+		* @see ModelFormat.h
+		* @throw std::runtime_error if the file cannot be written.
+		*/
+		void SaveModel(MultilayerPerceptron& network, const std::string& filePath);
+
+		/** Save a network trained on normalized inputs, the normalization is folded into the saved first layer, see InputNormalizer::FoldInto().
+		* Saved model takes raw inputs, the network itself is left untouched.
+		*/
+		void SaveModel(MultilayerPerceptron const& network, Data::InputNormalizer const& normalizer, const std::string& filePath);
+	}
+}
@@ -0,0 +1,327 @@
+#include "pch.h"
+#include "Training/BatchedTraining.h"
+#include "Diagnostics/Tracing.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace NNS
+{
+	namespace Training
+	{
+		namespace
+		{
+			/** Logistic function over a whole batch, same expression as LogisticActivationFunction. */
+			template<typename Derived>
+			auto Logistic(Eigen::ArrayBase<Derived> const& x)
+			{
+				return (1.0 + (-x).exp()).inverse();
+			}
+		}
+
+		BatchedTraining::BatchedTraining(BatchedTrainingConfig config)
+			: Config{ config }
+		{
+			if (config.errorMethod != ErrorCalculationMethod::MeanSquareError && config.errorMethod != ErrorCalculationMethod::BinaryCrossEntropy)
+				throw std::invalid_argument("BatchedTraining supports MeanSquareError and BinaryCrossEntropy only");
+		}
+
+		void BatchedTraining::Train(vector<MultilayerPerceptron*> const& networks, vector<TrainingDataSet const*> const& trainingData)
+		{
+			NNS_TRACE_SCOPE("BatchedTraining::Train");
+
+			Prepare(networks, trainingData);
+
+			ErrorVector finalErrors(static_cast<size_t>(modelCount));
+			for (size_t i = 0; i < Config.maxIterations && (activeMask > 0.0).any(); ++i)
+			{
+				NNS_TRACE_SCOPE("BatchedTraining epoch");
+
+				ComputeEpoch(true);
+
+				for (Eigen::Index m = 0; m < modelCount; ++m) /* For each model still training. */
+				{
+					if (activeMask[m] == 0.0)
+						continue;
+
+					const auto model = static_cast<size_t>(m);
+					++epochCounts[model];
+					finalErrors[model] = epochError[m];
+
+					if (epochError[m] < bestErrors[model])
+					{
+						/* Save best error and weight combination. */
+						bestErrors[model] = epochError[m];
+						CopyModel(weights, bestWeights, m);
+					}
+
+					if (epochError[m] <= Config.errorThreshold)
+					{
+						/* Converged, its weights stay as they are while other models carry on. */
+						activeMask[m] = 0.0;
+					}
+				}
+
+				UpdateWeights();
+			}
+
+			if ((activeMask > 0.0).any())
+			{
+				/* Last optimization step of models that ran out of iterations has not been evaluated yet. */
+				ComputeEpoch(false);
+			}
+
+			for (Eigen::Index m = 0; m < modelCount; ++m)
+			{
+				const auto model = static_cast<size_t>(m);
+				if (activeMask[m] != 0.0)
+					finalErrors[model] = epochError[m];
+
+				if (bestErrors[model] < finalErrors[model])
+				{
+					/* Model ended worse than an earlier epoch, bring back the best weights. */
+					CopyModel(bestWeights, weights, m);
+				}
+				else
+				{
+					bestErrors[model] = finalErrors[model];
+				}
+
+				auto& weightMatrix = networks[model]->GetWeightMatrix();
+				for (size_t i = 0; i < weightMatrix.size(); ++i) /* For each layer ( minus input layer ). */
+				{
+					const auto stride = static_cast<Eigen::Index>(networkmap[i] + 1);
+					for (size_t j = 0; j < weightMatrix[i].size(); ++j) /* For each neuron. */
+						for (Eigen::Index k = 0; k < stride; ++k)
+							weightMatrix[i][j][k] = weights[i](static_cast<Eigen::Index>(j) * stride + k, m);
+				}
+			}
+		}
+
+		ErrorVector const& BatchedTraining::GetBestErrors() const
+		{
+			return bestErrors;
+		}
+
+		vector<size_t> const& BatchedTraining::GetEpochCounts() const
+		{
+			return epochCounts;
+		}
+
+		void BatchedTraining::Prepare(vector<MultilayerPerceptron*> const& networks, vector<TrainingDataSet const*> const& trainingData)
+		{
+			if (networks.empty() || networks.size() != trainingData.size())
+				throw std::invalid_argument("BatchedTraining needs one training data set per network");
+
+			networkmap = networks.front()->GetNetworkLayerMap();
+			modelCount = static_cast<Eigen::Index>(networks.size());
+			stepCount = 0;
+
+			for (size_t m = 0; m < networks.size(); ++m)
+			{
+				if (networks[m]->GetNetworkLayerMap() != networkmap)
+					throw std::invalid_argument("BatchedTraining needs networks of identical topology");
+
+				for (size_t i = 1; i < networkmap.size(); ++i)
+					if (networks[m]->GetConnectivity(static_cast<int>(i)) != nullptr)
+						throw std::invalid_argument("BatchedTraining needs fully connected networks");
+
+				if (trainingData[m] == nullptr || trainingData[m]->empty())
+					throw std::invalid_argument("BatchedTraining needs a non-empty training data set per network");
+
+				for (const auto& sample : *trainingData[m])
+					if (static_cast<size_t>(sample.first.size()) != networkmap.front() || static_cast<size_t>(sample.second.size()) != networkmap.back())
+						throw std::invalid_argument("Training data does not match the network");
+
+				stepCount = std::max(stepCount, static_cast<Eigen::Index>(trainingData[m]->size()));
+			}
+
+			const auto layerCount = networkmap.size() - 1;
+			weights.resize(layerCount);
+			gradient.resize(layerCount);
+			prevMomentum.resize(layerCount);
+			activations.resize(networkmap.size());
+			deltas.resize(layerCount);
+
+			activations[0].resize(static_cast<Eigen::Index>(networkmap[0]), modelCount);
+			for (size_t i = 0; i < layerCount; ++i) /* For each layer ( minus input layer ). */
+			{
+				const auto stride = static_cast<Eigen::Index>(networkmap[i] + 1); /* +1 because of bias */
+				const auto neurons = static_cast<Eigen::Index>(networkmap[i + 1]);
+
+				weights[i].resize(neurons * stride, modelCount);
+				for (Eigen::Index m = 0; m < modelCount; ++m)
+				{
+					const auto& layer = networks[static_cast<size_t>(m)]->GetWeightMatrix()[i];
+					for (Eigen::Index j = 0; j < neurons; ++j) /* For each neuron. */
+						weights[i].block(j * stride, m, stride, 1) = layer[static_cast<size_t>(j)];
+				}
+
+				gradient[i].setZero(neurons * stride, modelCount);
+				prevMomentum[i].setZero(neurons * stride, modelCount);
+				activations[i + 1].resize(neurons, modelCount);
+				deltas[i].resize(neurons, modelCount);
+			}
+			bestWeights = weights;
+			outputNetInput.resize(static_cast<Eigen::Index>(networkmap.back()), modelCount);
+
+			/* Transpose the data sets once, every epoch then reads a presentation of all models as contiguous rows. */
+			const auto inputSize = static_cast<Eigen::Index>(networkmap.front());
+			const auto outputSize = static_cast<Eigen::Index>(networkmap.back());
+			inputs.setZero(stepCount * inputSize, modelCount);
+			targets.setZero(stepCount * outputSize, modelCount);
+			presentMask.setZero(stepCount, modelCount);
+			sampleCounts.resize(modelCount);
+
+			for (Eigen::Index m = 0; m < modelCount; ++m)
+			{
+				const auto& data = *trainingData[static_cast<size_t>(m)];
+				for (Eigen::Index p = 0; p < static_cast<Eigen::Index>(data.size()); ++p) /* For each presentation. */
+				{
+					inputs.block(p * inputSize, m, inputSize, 1) = data[static_cast<size_t>(p)].first;
+					targets.block(p * outputSize, m, outputSize, 1) = data[static_cast<size_t>(p)].second;
+					presentMask(p, m) = 1.0;
+				}
+				sampleCounts[m] = static_cast<SignalUnit>(data.size());
+			}
+
+			epochError.resize(modelCount);
+			activeMask.setOnes(modelCount);
+			bestErrors.assign(networks.size(), std::numeric_limits<ErrorUnit>::max());
+			epochCounts.assign(networks.size(), 0);
+		}
+
+		void BatchedTraining::ComputeEpoch(bool computeGradient)
+		{
+			NNS_TRACE_SCOPE("BatchedTraining::ComputeEpoch");
+
+			if (computeGradient)
+			{
+				for (auto& layer : gradient)
+					layer.setZero();
+			}
+
+			const auto outputSize = static_cast<Eigen::Index>(networkmap.back());
+			const auto outputs = activations.back().array();
+			const auto logits = outputNetInput.array();
+
+			epochError.setZero();
+			for (Eigen::Index p = 0; p < stepCount; ++p) /* For each presentation in epoch. */
+			{
+				ComputeForward(p);
+
+				const auto desired = targets.middleRows(p * outputSize, outputSize).array();
+				if (Config.errorMethod == ErrorCalculationMethod::BinaryCrossEntropy)
+				{
+					/* log( 1 + exp( z ) ) - t*z as in TrainingErrorState, summed over outputs. */
+					epochError += (logits.max(0.0) - desired * logits + (-logits.abs()).exp().log1p()).colwise().sum() * presentMask.row(p).array();
+				}
+				else
+				{
+					epochError += (desired - outputs).square().colwise().sum() / static_cast<SignalUnit>(outputSize) * presentMask.row(p).array();
+				}
+
+				if (computeGradient)
+				{
+					ComputeBackward(p);
+				}
+			}
+
+			epochError /= sampleCounts;
+		}
+
+		void BatchedTraining::ComputeForward(Eigen::Index step)
+		{
+			const auto inputSize = static_cast<Eigen::Index>(networkmap.front());
+			activations.front() = inputs.middleRows(step * inputSize, inputSize);
+
+			for (size_t i = 1; i < activations.size(); ++i) /* Each layer, except first */
+			{
+				const auto& prevLayer = activations[i - 1];
+				const auto& layerWeights = weights[i - 1];
+				const auto stride = prevLayer.rows() + 1;
+				auto& layer = activations[i];
+
+				for (Eigen::Index j = 0; j < layer.rows(); ++j) /* Each neuron, of all models at once. */
+				{
+					auto netInput = layer.row(j).array();
+					netInput = layerWeights.row(j * stride + prevLayer.rows()).array(); /* Bias */
+					for (Eigen::Index k = 0; k < prevLayer.rows(); ++k)
+						netInput += layerWeights.row(j * stride + k).array() * prevLayer.row(k).array();
+				}
+
+				if (i == activations.size() - 1)
+					outputNetInput = layer;
+
+				layer = Logistic(layer.array()).matrix();
+			}
+		}
+
+		void BatchedTraining::ComputeBackward(Eigen::Index step)
+		{
+			const auto outputSize = static_cast<Eigen::Index>(networkmap.back());
+			const auto desired = targets.middleRows(step * outputSize, outputSize).array();
+			const auto output = activations.back().array();
+			const auto present = presentMask.row(step).array();
+
+			/* Models without this presentation get zero deltas, so they add nothing to their gradient. */
+			if (Config.errorMethod == ErrorCalculationMethod::BinaryCrossEntropy)
+			{
+				deltas.back() = ((desired - output).rowwise() * present).matrix();
+			}
+			else
+			{
+				/* Same derivative MultilayerPerceptron::GetActivationDerivative() gives, so each model trains exactly as it would alone. */
+				const auto logistic = Logistic(output);
+				deltas.back() = (((desired - output) * logistic * (1.0 - logistic)).rowwise() * present).matrix();
+			}
+
+			for (size_t i = networkmap.size() - 1; i > 0; --i) /* For each layer ( minus input layer ). */
+			{
+				const auto& prevActivation = activations[i - 1];
+				const auto& delta = deltas[i - 1];
+				const auto stride = prevActivation.rows() + 1;
+				auto& layerGradient = gradient[i - 1];
+
+				for (Eigen::Index j = 0; j < delta.rows(); ++j) /* For each neuron. */
+				{
+					for (Eigen::Index k = 0; k < prevActivation.rows(); ++k)
+						layerGradient.row(j * stride + k).array() += delta.row(j).array() * prevActivation.row(k).array();
+					layerGradient.row(j * stride + prevActivation.rows()) += delta.row(j); /* Bias activation is always equal to 1.*/
+				}
+
+				if (i > 1)
+				{
+					/* Sum this layer's deltas over connections to each previous layer neuron. */
+					auto& prevDelta = deltas[i - 2];
+					const auto& layerWeights = weights[i - 1];
+					prevDelta.setZero();
+					for (Eigen::Index j = 0; j < delta.rows(); ++j) /* For each neuron. */
+						for (Eigen::Index k = 0; k < prevActivation.rows(); ++k)
+							prevDelta.row(k).array() += layerWeights.row(j * stride + k).array() * delta.row(j).array();
+
+					const auto logistic = Logistic(prevActivation.array());
+					prevDelta.array() *= logistic * (1.0 - logistic);
+				}
+			}
+		}
+
+		void BatchedTraining::UpdateWeights()
+		{
+			NNS_TRACE_SCOPE("BatchedTraining::UpdateWeights");
+
+			for (size_t i = 0; i < weights.size(); ++i) /* For each layer ( minus input layer ). */
+			{
+				/* Backpropagation with momentum, converged models get a zero correction. */
+				prevMomentum[i] = ((Config.learningRate * gradient[i].array() + Config.momentumCoeff * prevMomentum[i].array()).rowwise() * activeMask).matrix();
+				weights[i] += prevMomentum[i];
+			}
+		}
+
+		void BatchedTraining::CopyModel(vector<BatchMatrix> const& source, vector<BatchMatrix>& target, Eigen::Index model)
+		{
+			for (size_t i = 0; i < source.size(); ++i)
+				target[i].col(model) = source[i].col(model);
+		}
+	}
+}
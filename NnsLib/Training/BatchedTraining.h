@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Types/Collections.h"
+#include "Models/MultilayerPerceptron.h"
+#include "Training/TrainingErrorState.h"
+
+namespace NNS
+{
+	namespace Training
+	{
+		using namespace NNS::Types;
+		using NNS::Models::MultilayerPerceptron;
+
+		struct BatchedTrainingConfig final
+		{
+			// Limit on the number of epochs of every model.
+			size_t maxIterations{ 1000 };
+			// Model converges and stops training once its epoch error drops this low.
+			ErrorUnit errorThreshold{ 0.05 };
+			// Backpropagation's learning rate and momentum, same for all models.
+			ErrorUnit learningRate{ 0.25 };
+			ErrorUnit momentumCoeff{ 0.9 };
+			// MeanSquareError or BinaryCrossEntropy.
+			ErrorCalculationMethod errorMethod{ ErrorCalculationMethod::MeanSquareError };
+		};
+
+		/** Lock-step training of many small perceptrons of identical topology, each on its own data set.
+		* Weights of all K models are stacked into one row major matrix per layer, a row per connection and a column per model,
+		* so every step of the forward and backward pass is an elementwise operation over K contiguous values and vectorizes
+		* no matter how small the networks are.
+		* Presentations run in lock-step, presentation p of every model at once. Models with fewer samples are masked out
+		* of the steps past their data, a model's error and gradient are those TrainingErrorState computes for it alone.
+		* Every model has its own Backpropagation momentum and convergence mask, a converged model keeps its weights
+		* while the others carry on. Like SupervisedTraining each network ends with the weights of its lowest epoch error.
+		*/
+		class BatchedTraining final
+		{
+		public:
+			const BatchedTrainingConfig Config;
+
+			/** @throw std::invalid_argument if the error method is not supported. */
+			explicit BatchedTraining(BatchedTrainingConfig config = {});
+
+			/** Train networks[m] on trainingData[m] for every m, weights are read from the networks and written back at the end.
+			* @throw std::invalid_argument if the counts differ, topologies differ, a network is sparse, or a data set is empty
+			* or does not match the network.
+			*/
+			void Train(vector<MultilayerPerceptron*> const& networks, vector<TrainingDataSet const*> const& trainingData);
+
+			/** Per model, lowest epoch error, i.e. the one of the weights the network ended with. */
+			ErrorVector const& GetBestErrors() const;
+
+			/** Per model, epochs run before it converged or ran out of iterations. */
+			vector<size_t> const& GetEpochCounts() const;
+
+		private:
+			using BatchMatrix = Eigen::Matrix<SignalUnit, Dynamic, Dynamic, Eigen::RowMajor>;
+			using BatchVector = Eigen::Array<SignalUnit, 1, Dynamic>;
+
+			void Prepare(vector<MultilayerPerceptron*> const& networks, vector<TrainingDataSet const*> const& trainingData);
+			void ComputeEpoch(bool computeGradient);
+			void ComputeForward(Eigen::Index step);
+			void ComputeBackward(Eigen::Index step);
+			void UpdateWeights();
+			void CopyModel(vector<BatchMatrix> const& source, vector<BatchMatrix>& target, Eigen::Index model);
+
+			NetworkLayerMap networkmap;
+			Eigen::Index modelCount{ 0 };
+			Eigen::Index stepCount{ 0 };
+
+			/* Per layer ( minus input layer ), row j * ( previous layer size + 1 ) + k is connection k of neuron j, bias last. */
+			vector<BatchMatrix> weights;
+			vector<BatchMatrix> bestWeights;
+			vector<BatchMatrix> gradient;
+			vector<BatchMatrix> prevMomentum;
+
+			/* Per layer, a row per neuron. Deltas skip the input layer. */
+			vector<BatchMatrix> activations;
+			vector<BatchMatrix> deltas;
+			BatchMatrix outputNetInput;
+
+			/* Presentation p of all models, inputs at rows p * input size, targets at rows p * output size. */
+			BatchMatrix inputs;
+			BatchMatrix targets;
+			BatchMatrix presentMask; /**< Row per presentation, 1 where the model has that sample. */
+			BatchVector sampleCounts;
+
+			BatchVector epochError;
+			BatchVector activeMask; /**< 1 while the model trains, 0 once converged. */
+			ErrorVector bestErrors;
+			vector<size_t> epochCounts;
+		};
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+
+namespace NNS
+{
+	namespace Training
+	{
+		/** Flag shared between whoever wants training to stop and the loops that honor it.
+		* Checking it is a single relaxed atomic load, cheap enough for inner optimizer loops.
+		*/
+		class CancellationToken final
+		{
+		public:
+			void Cancel()
+			{
+				isCancelled.store(true, std::memory_order_relaxed);
+			}
+
+			void Reset()
+			{
+				isCancelled.store(false, std::memory_order_relaxed);
+			}
+
+			bool IsCancelled() const
+			{
+				return isCancelled.load(std::memory_order_relaxed);
+			}
+
+		private:
+			std::atomic<bool> isCancelled{ false };
+		};
+	}
+}
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include "Common/IBase.h"
 #include "Models/IFeedforwardNetwork.h"
 #include "Optimization/IWeightOptimizer.h"
+#include "Data/ITrainingDataSource.h"
 
 namespace NNS
 {
@@ -12,6 +14,18 @@ namespace NNS
 	{
 		using NNS::Models::IFeedforwardNetwork;
 		using NNS::Optimization::IWeightOptimizer;
+		using NNS::Data::ITrainingDataSource;
+		using NNS::Types::ErrorUnit;
+
+		/** Snapshot of a running training, reported once per epoch. */
+		struct TrainingProgress final
+		{
+			size_t epoch{ 0 };
+			ErrorUnit error{}; /**< Training error of this epoch. */
+			ErrorUnit bestError{}; /**< Lowest training error so far. */
+		};
+
+		using ProgressCallback = std::function<void(TrainingProgress const&)>;
 
 		class ITrainingAlgorithm : public IBase
 		{
@@ -19,9 +33,13 @@ namespace NNS
 			using Ptr = std::unique_ptr<ITrainingAlgorithm, SDeleter>;
 		public:
 			virtual void Train(IFeedforwardNetwork& network, TrainingDataSet const& trainingData) = 0;
+			virtual void Train(IFeedforwardNetwork& network, ITrainingDataSource& dataSource) = 0;
 			virtual void SetEludingLocalMinimaMethod(IWeightOptimizer* optimizer) = 0; // TODO: more than one?
 			virtual void AbortTraining() = 0;
 			virtual bool IsTrainingAborted() const = 0;
+			/** Clear an earlier AbortTraining(), Train() keeps honoring it until then. */
+			virtual void ResetAbort() = 0;
+			virtual void SetProgressCallback(ProgressCallback callback) = 0;
 		};
 	}
 }
\ No newline at end of file
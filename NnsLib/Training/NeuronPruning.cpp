@@ -0,0 +1,227 @@
+#include "pch.h"
+#include "Training/NeuronPruning.h"
+#include "Training/TrainingErrorState.h"
+#include "Diagnostics/Tracing.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace NNS
+{
+	namespace Training
+	{
+		NeuronPruning::NeuronPruning(NeuronPruningConfig config)
+			: Config{ config }
+		{
+			if (Config.pruneFraction < 0.0 || Config.pruneFraction > 1.0)
+			{
+				throw std::invalid_argument("Prune fraction has to be within <0; 1>");
+			}
+			if (Config.minLayerSize == 0)
+			{
+				throw std::invalid_argument("Minimal layer size has to be positive");
+			}
+		}
+
+		MultilayerPerceptron NeuronPruning::Prune(MultilayerPerceptron& network, TrainingDataSet const& trainingData, ITrainingAlgorithm* fineTuning)
+		{
+			NNS_TRACE_SCOPE("NeuronPruning::Prune");
+
+			const auto networkmap = network.GetNetworkLayerMap();
+			if (trainingData.empty())
+			{
+				throw std::invalid_argument("Training data set is empty");
+			}
+			for (size_t i = 1; i < networkmap.size(); ++i)
+			{
+				if (network.GetConnectivity(static_cast<int>(i)) != nullptr)
+				{
+					throw std::invalid_argument("Pruning of sparse layers is not supported");
+				}
+			}
+
+			ComputeActivationStatistics(network, trainingData);
+			ComputeScores(network, trainingData);
+			const auto keep = SelectNeurons();
+
+			/* Surviving neurons of every layer, input and output layers are kept whole. */
+			vector<vector<size_t>> kept(networkmap.size());
+			NetworkLayerMap prunedmap(networkmap.size());
+			for (size_t i = 0; i < networkmap.size(); ++i)
+			{
+				for (size_t j = 0; j < networkmap[i]; ++j)
+				{
+					if (i == 0 || i + 1 == networkmap.size() || keep[i - 1][j])
+						kept[i].push_back(j);
+				}
+				prunedmap[i] = kept[i].size();
+			}
+
+			MultilayerPerceptron pruned{ prunedmap };
+			const auto& weightMatrix = network.GetWeightMatrix();
+			auto& prunedWeights = pruned.GetWeightMatrix();
+
+			for (size_t i = 1; i < networkmap.size(); ++i) /* For each layer ( minus input layer ). */
+			{
+				for (size_t j = 0; j < kept[i].size(); ++j) /* For each surviving neuron. */
+				{
+					const auto& weightVect = weightMatrix[i - 1][kept[i][j]];
+					auto& prunedVect = prunedWeights[i - 1][j];
+
+					for (size_t k = 0; k < kept[i - 1].size(); ++k) /* For each surviving connection. */
+						prunedVect[k] = weightVect[kept[i - 1][k]];
+
+					auto bias = weightVect[networkmap[i - 1]];
+					if (i > 1)
+					{
+						/* Removed neurons of the previous layer contribute their mean activation through the connection. */
+						for (size_t k = 0; k < networkmap[i - 1]; ++k)
+							if (!keep[i - 2][k])
+								bias += weightVect[k] * means[i - 2][k];
+					}
+					prunedVect.tail(1)[0] = bias;
+				}
+			}
+
+			if (fineTuning != nullptr)
+			{
+				fineTuning->Train(pruned, trainingData);
+			}
+
+			return pruned;
+		}
+
+		vector<vector<SignalUnit>> const& NeuronPruning::GetScores() const
+		{
+			return scores;
+		}
+
+		void NeuronPruning::ComputeActivationStatistics(MultilayerPerceptron& network, TrainingDataSet const& trainingData)
+		{
+			const auto networkmap = network.GetNetworkLayerMap();
+			means.assign(networkmap.size() - 2, {});
+			variances.assign(networkmap.size() - 2, {});
+
+			/* Welford's running mean and sum of squared deviations, a constant activation gets exactly zero variance. */
+			vector<ActivationVector> runningMeans, squaredDeviations;
+			for (size_t i = 1; i + 1 < networkmap.size(); ++i) /* For each hidden layer. */
+			{
+				runningMeans.push_back(ActivationVector::Zero(networkmap[i]));
+				squaredDeviations.push_back(ActivationVector::Zero(networkmap[i]));
+			}
+
+			SignalUnit count{ 0.0 };
+			ActivationVector deviation;
+			for (const auto& sample : trainingData)
+			{
+				network.ComputeOutput(sample.first);
+				count += 1.0;
+				for (size_t i = 1; i + 1 < networkmap.size(); ++i)
+				{
+					const auto& activation = network.GetActivationMatrix()[i];
+					deviation = activation - runningMeans[i - 1];
+					runningMeans[i - 1] += deviation / count;
+					squaredDeviations[i - 1] += deviation.cwiseProduct(activation - runningMeans[i - 1]);
+				}
+			}
+
+			for (size_t i = 0; i < runningMeans.size(); ++i)
+			{
+				means[i].assign(runningMeans[i].data(), runningMeans[i].data() + runningMeans[i].size());
+				variances[i].resize(networkmap[i + 1]);
+				for (size_t j = 0; j < networkmap[i + 1]; ++j)
+					variances[i][j] = squaredDeviations[i][j] / count;
+			}
+		}
+
+		void NeuronPruning::ComputeScores(MultilayerPerceptron& network, TrainingDataSet const& trainingData)
+		{
+			const auto networkmap = network.GetNetworkLayerMap();
+			auto& weightMatrix = network.GetWeightMatrix();
+
+			switch (Config.scoreMethod)
+			{
+			case NeuronScoreMethod::ActivationVariance:
+			{
+				scores = variances;
+				break;
+			}
+			case NeuronScoreMethod::OutgoingWeightMagnitude:
+			{
+				scores = means;
+				for (size_t i = 1; i + 1 < networkmap.size(); ++i) /* For each hidden layer. */
+				{
+					for (size_t j = 0; j < networkmap[i]; ++j)
+					{
+						SignalUnit squaredNorm{ 0.0 };
+						for (const auto& weightVect : weightMatrix[i]) /* Each neuron of the next layer. */
+							squaredNorm += weightVect[j] * weightVect[j];
+						scores[i - 1][j] = sqrt(squaredNorm);
+					}
+				}
+				break;
+			}
+			case NeuronScoreMethod::ErrorIncrease:
+			default:
+			{
+				/* Fold one neuron at a time into the next layer's biases, measure the error and restore the weights. */
+				TrainingErrorState errorState(network, trainingData);
+				const auto baseError = errorState.ComputeEpochError();
+
+				scores = means;
+				vector<WeightUnit> outgoing, biases;
+				for (size_t i = 1; i + 1 < networkmap.size(); ++i) /* For each hidden layer. */
+				{
+					auto& nextLayer = weightMatrix[i];
+					outgoing.resize(nextLayer.size());
+					biases.resize(nextLayer.size());
+
+					for (size_t j = 0; j < networkmap[i]; ++j)
+					{
+						for (size_t k = 0; k < nextLayer.size(); ++k)
+						{
+							outgoing[k] = nextLayer[k][j];
+							biases[k] = nextLayer[k][networkmap[i]];
+							nextLayer[k][networkmap[i]] += outgoing[k] * means[i - 1][j];
+							nextLayer[k][j] = 0.0;
+						}
+
+						scores[i - 1][j] = errorState.ComputeEpochError() - baseError;
+
+						for (size_t k = 0; k < nextLayer.size(); ++k)
+						{
+							nextLayer[k][j] = outgoing[k];
+							nextLayer[k][networkmap[i]] = biases[k];
+						}
+					}
+				}
+				break;
+			}
+			}
+		}
+
+		vector<vector<bool>> NeuronPruning::SelectNeurons() const
+		{
+			vector<vector<bool>> keep(scores.size());
+			vector<size_t> order;
+
+			for (size_t i = 0; i < scores.size(); ++i) /* For each hidden layer. */
+			{
+				const auto size = scores[i].size();
+				keep[i].assign(size, true);
+
+				order.resize(size);
+				std::iota(order.begin(), order.end(), size_t{ 0 });
+				std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return scores[i][a] < scores[i][b]; });
+
+				const auto removable = size > Config.minLayerSize ? size - Config.minLayerSize : 0;
+				const auto target = std::min(removable, static_cast<size_t>(Config.pruneFraction * static_cast<double>(size)));
+				for (size_t n = 0; n < target && scores[i][order[n]] <= Config.maxScore; ++n)
+					keep[i][order[n]] = false;
+			}
+
+			return keep;
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <limits>
+
+#include "Types/Units.h"
+#include "Types/Collections.h"
+#include "Models/MultilayerPerceptron.h"
+#include "Training/ITrainingAlgorithm.h"
+
+namespace NNS
+{
+	namespace Training
+	{
+		using namespace NNS::Types;
+		using NNS::Models::MultilayerPerceptron;
+
+		enum class NeuronScoreMethod : unsigned int
+		{
+			OutgoingWeightMagnitude = 0, // Euclidean norm of the weights leading out of the neuron.
+			ActivationVariance,          // Variance of the neuron's activation over the training data.
+			ErrorIncrease                // Training error increase once the neuron is replaced by its mean activation.
+		};
+
+		struct NeuronPruningConfig final
+		{
+			NeuronScoreMethod scoreMethod{ NeuronScoreMethod::ActivationVariance };
+			// Fraction of every hidden layer's neurons to remove, lowest scores first.
+			double pruneFraction{ 0.25 };
+			// Only neurons scoring at most this much are removed.
+			SignalUnit maxScore{ std::numeric_limits<SignalUnit>::max() };
+			// Hidden layers never shrink below this many neurons, at least one.
+			size_t minLayerSize{ 1 };
+		};
+
+		/** Structured pruning of hidden neurons of a dense MultilayerPerceptron.
+		* Every hidden neuron is scored over the training data and the lowest scoring ones are removed.
+		* A removed neuron's contribution to the next layer is replaced by a constant, its mean activation times the outgoing weight,
+		* which is folded into the next layer's biases. Neurons with constant activation are therefore removed without changing the output.
+		* The result is a smaller dense network, no sparse kernels are needed to benefit from it.
+		*/
+		class NeuronPruning final
+		{
+		public:
+			const NeuronPruningConfig Config;
+
+			explicit NeuronPruning(NeuronPruningConfig config = {});
+
+			/** Build a pruned copy of the network, the network itself is left unchanged.
+			* @param fineTuning optional, trains the pruned network on the same data afterwards.
+			*/
+			MultilayerPerceptron Prune(MultilayerPerceptron& network, TrainingDataSet const& trainingData, ITrainingAlgorithm* fineTuning = nullptr);
+
+			/** Scores of the last Prune(), indexed by hidden layer ( 0 for the first one ) and neuron. */
+			vector<vector<SignalUnit>> const& GetScores() const;
+
+		private:
+			void ComputeActivationStatistics(MultilayerPerceptron& network, TrainingDataSet const& trainingData);
+			void ComputeScores(MultilayerPerceptron& network, TrainingDataSet const& trainingData);
+			vector<vector<bool>> SelectNeurons() const;
+
+			vector<vector<SignalUnit>> means; /**< Mean activation of every hidden neuron. */
+			vector<vector<SignalUnit>> variances;
+			vector<vector<SignalUnit>> scores;
+		};
+	}
+}
@@ -0,0 +1,249 @@
+#include "pch.h"
+#include "Training/SelfOrganizingMapTraining.h"
+#include "Diagnostics/Tracing.h"
+#include "Common/ParallelFor.h"
+
+#include <numeric>
+#include <stdexcept>
+
+namespace NNS
+{
+	namespace Training
+	{
+		namespace
+		{
+			/* Fewer samples than this per thread do not pay for starting it. */
+			constexpr size_t MinSamplesPerThread = 1024;
+		}
+
+		SelfOrganizingMapTraining::NeighborhoodTable::NeighborhoodTable(size_t mapWidth, size_t mapHeight)
+			: width{ mapWidth }, height{ mapHeight }
+		{
+			squaredDistances.resize((2 * width - 1) * (2 * height - 1));
+			for (size_t nx = 0; nx < 2 * width - 1; ++nx)
+			{
+				for (size_t ny = 0; ny < 2 * height - 1; ++ny)
+				{
+					const auto dx = static_cast<SignalUnit>(nx) - static_cast<SignalUnit>(width - 1);
+					const auto dy = static_cast<SignalUnit>(ny) - static_cast<SignalUnit>(height - 1);
+					squaredDistances[nx * (2 * height - 1) + ny] = dx * dx + dy * dy;
+				}
+			}
+			weights.resize(squaredDistances.size());
+		}
+
+		void SelfOrganizingMapTraining::NeighborhoodTable::SetRadius(SignalUnit radius)
+		{
+			/* Beyond three radii the gaussian drops below 1.2 %, such neurons are left alone. */
+			reach = std::min(std::max(width, height), static_cast<size_t>(ceil(3.0 * radius)));
+
+			const auto denominator = 2.0 * radius * radius;
+			for (size_t i = 0; i < squaredDistances.size(); ++i)
+			{
+				weights[i] = exp(-squaredDistances[i] / denominator);
+			}
+		}
+
+		SignalUnit SelfOrganizingMapTraining::NeighborhoodTable::Get(size_t winner, size_t neuron) const
+		{
+			return weights[Offset(winner % width, winner / width, neuron % width, neuron / width)];
+		}
+
+		size_t SelfOrganizingMapTraining::NeighborhoodTable::GetLongerSide() const
+		{
+			return std::max(width, height);
+		}
+
+		size_t SelfOrganizingMapTraining::NeighborhoodTable::Offset(size_t x, size_t y, size_t nx, size_t ny) const
+		{
+			return (nx + width - 1 - x) * (2 * height - 1) + (ny + height - 1 - y);
+		}
+
+		SelfOrganizingMapTraining::SelfOrganizingMapTraining(SelfOrganizingMapConfig config)
+			: Config{ config }
+		{
+			/* Radii and learning rates decay geometrically, a zero end point would turn them into 0 * inf or a gaussian of zero width. */
+			if (!(Config.endRadius > 0.0) || Config.startRadius < 0.0)
+			{
+				throw std::invalid_argument("Neighborhood radius must be positive");
+			}
+			if (Config.mode == SelfOrganizingMapMode::Online && !(Config.startLearningRate > 0.0 && Config.endLearningRate > 0.0))
+			{
+				throw std::invalid_argument("Learning rate must be positive");
+			}
+		}
+
+		void SelfOrganizingMapTraining::Train(KohonenNetwork& network, TrainingDataSet const& trainingData)
+		{
+			const auto input_size = network.GetNetworkLayerMap().front();
+			if (trainingData.empty())
+			{
+				throw std::invalid_argument("Training data set is empty");
+			}
+
+			/* Samples are copied once into a contiguous matrix, winners are then searched block by block. */
+			RowMatrix samples(static_cast<Eigen::Index>(trainingData.size()), static_cast<Eigen::Index>(input_size));
+			for (size_t i = 0; i < trainingData.size(); ++i)
+			{
+				if (static_cast<size_t>(trainingData[i].first.size()) != input_size)
+				{
+					throw std::invalid_argument("Sample size does not match the network input layer");
+				}
+				samples.row(static_cast<Eigen::Index>(i)) = trainingData[i].first.transpose();
+			}
+
+			KohonenCodebook codebook{ network };
+			NeighborhoodTable neighborhood{ network.GetMapWidth(), network.GetMapHeight() };
+
+			if (Config.mode == SelfOrganizingMapMode::Online)
+				TrainOnline(codebook, samples, neighborhood);
+			else
+				TrainBatch(codebook, samples, neighborhood);
+
+			codebook.Store(network);
+
+			const auto thread_count = GetThreadCount(trainingData.size());
+			vector<ErrorUnit> partial_errors(thread_count, 0.0);
+			ParallelFor(thread_count, trainingData.size(), [&](size_t begin, size_t end, size_t thread)
+			{
+				vector<size_t> units;
+				vector<SignalUnit> distances;
+				codebook.FindBestMatchingUnits(samples.middleRows(static_cast<Eigen::Index>(begin), static_cast<Eigen::Index>(end - begin)), units, &distances);
+				partial_errors[thread] = std::accumulate(distances.begin(), distances.end(), ErrorUnit{});
+			});
+			quantizationError = std::accumulate(partial_errors.begin(), partial_errors.end(), ErrorUnit{}) / static_cast<ErrorUnit>(trainingData.size());
+		}
+
+		ErrorUnit SelfOrganizingMapTraining::GetQuantizationError() const
+		{
+			return quantizationError;
+		}
+
+		void SelfOrganizingMapTraining::TrainOnline(KohonenCodebook& codebook, RowMatrix const& samples, NeighborhoodTable& neighborhood)
+		{
+			vector<size_t> order(static_cast<size_t>(samples.rows()));
+			std::iota(order.begin(), order.end(), size_t{ 0 });
+			std::mt19937 rng_engine(Config.seed);
+
+			for (size_t epoch = 0; epoch < Config.epochs; ++epoch)
+			{
+				NNS_TRACE_SCOPE("SelfOrganizingMapTraining online epoch");
+
+				const auto learning_rate = Decay(Config.startLearningRate, Config.endLearningRate, epoch);
+				neighborhood.SetRadius(Decay(GetStartRadius(neighborhood), Config.endRadius, epoch));
+				std::shuffle(order.begin(), order.end(), rng_engine);
+
+				for (const auto i : order) /* Each sample */
+				{
+					const auto sample = samples.row(static_cast<Eigen::Index>(i));
+					const auto winner = codebook.FindBestMatchingUnit(sample.transpose());
+
+					neighborhood.ForEachNeighbor(winner, [&](size_t neuron, SignalUnit weight)
+					{
+						auto neuron_weights = codebook.Neuron(neuron);
+						neuron_weights += (learning_rate * weight) * (sample - neuron_weights);
+						codebook.UpdateNorm(neuron);
+					});
+				}
+			}
+		}
+
+		void SelfOrganizingMapTraining::TrainBatch(KohonenCodebook& codebook, RowMatrix const& samples, NeighborhoodTable& neighborhood)
+		{
+			const auto sample_count = static_cast<size_t>(samples.rows());
+			const auto neuron_count = codebook.GetNeuronCount();
+			const auto input_size = static_cast<Eigen::Index>(codebook.GetInputSize());
+			const auto thread_count = GetThreadCount(sample_count);
+
+			/* Per thread sums and hit counts of samples won by each neuron, allocated once for all epochs. */
+			vector<RowMatrix> sums(thread_count, RowMatrix::Zero(static_cast<Eigen::Index>(neuron_count), input_size));
+			vector<vector<SignalUnit>> hits(thread_count, vector<SignalUnit>(neuron_count));
+			vector<vector<size_t>> winners(thread_count);
+
+			for (size_t epoch = 0; epoch < Config.epochs; ++epoch)
+			{
+				NNS_TRACE_SCOPE("SelfOrganizingMapTraining batch epoch");
+
+				neighborhood.SetRadius(Decay(GetStartRadius(neighborhood), Config.endRadius, epoch));
+
+				/* Find winners and accumulate samples per winner, every thread over its own share of samples. */
+				ParallelFor(thread_count, sample_count, [&](size_t begin, size_t end, size_t thread)
+				{
+					auto& thread_sums = sums[thread];
+					auto& thread_hits = hits[thread];
+					thread_sums.setZero();
+					std::fill(thread_hits.begin(), thread_hits.end(), 0.0);
+
+					const auto block = samples.middleRows(static_cast<Eigen::Index>(begin), static_cast<Eigen::Index>(end - begin));
+					codebook.FindBestMatchingUnits(block, winners[thread]);
+
+					for (size_t i = 0; i < winners[thread].size(); ++i) /* Each sample */
+					{
+						const auto winner = winners[thread][i];
+						thread_sums.row(static_cast<Eigen::Index>(winner)) += block.row(static_cast<Eigen::Index>(i));
+						thread_hits[winner] += 1.0;
+					}
+				});
+
+				/* Reduce into the first thread's buffers, every thread over its own share of neurons.
+				* Partial sums depend on how samples were split, so results match across thread counts only up to rounding. */
+				ParallelFor(thread_count, neuron_count, [&](size_t begin, size_t end, size_t)
+				{
+					for (size_t t = 1; t < thread_count; ++t)
+					{
+						sums.front().middleRows(static_cast<Eigen::Index>(begin), static_cast<Eigen::Index>(end - begin)) += sums[t].middleRows(static_cast<Eigen::Index>(begin), static_cast<Eigen::Index>(end - begin));
+						for (size_t j = begin; j < end; ++j)
+							hits.front()[j] += hits[t][j];
+					}
+				});
+
+				/* Each neuron moves to the neighborhood weighted mean of the samples won by its neighbors. */
+				ParallelFor(thread_count, neuron_count, [&](size_t begin, size_t end, size_t)
+				{
+					WeightVector numerator(input_size);
+					for (size_t j = begin; j < end; ++j) /* Each neuron */
+					{
+						numerator.setZero();
+						SignalUnit denominator{ 0.0 };
+
+						/* The neighborhood is symmetric, neighbors of j are exactly the winners whose neighborhood covers j. */
+						neighborhood.ForEachNeighbor(j, [&](size_t winner, SignalUnit weight)
+						{
+							const auto winner_hits = hits.front()[winner];
+							if (winner_hits > 0.0)
+							{
+								numerator += weight * sums.front().row(static_cast<Eigen::Index>(winner)).transpose();
+								denominator += weight * winner_hits;
+							}
+						});
+
+						if (denominator > 0.0)
+						{
+							codebook.Neuron(j) = (numerator / denominator).transpose();
+						}
+					}
+				});
+
+				codebook.UpdateNorms();
+			}
+		}
+
+		SignalUnit SelfOrganizingMapTraining::Decay(SignalUnit start, SignalUnit end, size_t epoch) const
+		{
+			if (Config.epochs <= 1)
+				return start;
+
+			return start * pow(end / start, static_cast<SignalUnit>(epoch) / static_cast<SignalUnit>(Config.epochs - 1));
+		}
+
+		SignalUnit SelfOrganizingMapTraining::GetStartRadius(NeighborhoodTable const& neighborhood) const
+		{
+			return Config.startRadius > 0.0 ? Config.startRadius : std::max<SignalUnit>(0.5 * static_cast<SignalUnit>(neighborhood.GetLongerSide()), Config.endRadius);
+		}
+
+		size_t SelfOrganizingMapTraining::GetThreadCount(size_t sampleCount) const
+		{
+			return GetWorkerCount(Config.threadCount, sampleCount, MinSamplesPerThread);
+		}
+	}
+}
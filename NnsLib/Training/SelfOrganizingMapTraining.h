@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+
+#include "Types/Units.h"
+#include "Types/Collections.h"
+#include "Models/KohonenNetwork.h"
+#include "Models/KohonenCodebook.h"
+
+namespace NNS
+{
+	namespace Training
+	{
+		using namespace NNS::Types;
+		using NNS::Models::KohonenNetwork;
+		using NNS::Models::KohonenCodebook;
+		using NNS::Models::RowMatrix;
+
+		enum class SelfOrganizingMapMode : unsigned int
+		{
+			Online = 0, // Update winner and its neighbors after every sample.
+			Batch       // Move every neuron to the neighborhood weighted mean of the samples once per epoch.
+		};
+
+		struct SelfOrganizingMapConfig final
+		{
+			SelfOrganizingMapMode mode{ SelfOrganizingMapMode::Batch };
+			// Passes over the training data.
+			size_t epochs{ 100 };
+
+			// Online learning rate, decays exponentially from start to end over all epochs. Batch training does not need one.
+			SignalUnit startLearningRate{ 0.5 };
+			SignalUnit endLearningRate{ 0.01 };
+
+			// Width of the gaussian neighborhood in grid units, decays exponentially from start to end.
+			// Zero start radius means half of the longer map side. End radius must be positive.
+			SignalUnit startRadius{ 0.0 };
+			SignalUnit endRadius{ 0.5 };
+
+			// Batch training threads, each finds winners for its share of samples. Zero means one per hardware thread.
+			// Per-thread sums are added in a different order for a different count, so results only agree up to rounding.
+			size_t threadCount{ 0 };
+			// Online training visits samples in a random order, seeded so that runs are repeatable.
+			unsigned int seed{ 42 };
+		};
+
+		/** Unsupervised competitive training of a KohonenNetwork ( self-organizing map ).
+		* Only input parts of the training samples are used. The map is a 1D or 2D grid given by the network's map width and height.
+		* Squared grid distances are tabulated once per offset between two neurons, the neighborhood function is re-evaluated over that table
+		* once per epoch and only neurons within three radii of the winner are updated.
+		*/
+		class SelfOrganizingMapTraining final
+		{
+		public:
+			const SelfOrganizingMapConfig Config;
+
+			/** @throw std::invalid_argument if end radius is not positive, or online learning rates are not positive. */
+			explicit SelfOrganizingMapTraining(SelfOrganizingMapConfig config = {});
+
+			void Train(KohonenNetwork& network, TrainingDataSet const& trainingData);
+
+			/** Mean squared distance between samples and their best matching units after the last Train(). */
+			ErrorUnit GetQuantizationError() const;
+
+		private:
+			/** Neighborhood weights indexed by grid offset between a winner and a neuron. */
+			class NeighborhoodTable final
+			{
+			public:
+				NeighborhoodTable(size_t mapWidth, size_t mapHeight);
+
+				void SetRadius(SignalUnit radius);
+
+				SignalUnit Get(size_t winner, size_t neuron) const;
+				size_t GetLongerSide() const;
+
+				/** Calls action( neuron, weight ) for every neuron within reach of the winner. */
+				template <typename Action>
+				void ForEachNeighbor(size_t winner, Action action) const
+				{
+					const auto x = winner % width, y = winner / width;
+					const auto x_begin = x > reach ? x - reach : 0, x_end = std::min(width, x + reach + 1);
+					const auto y_begin = y > reach ? y - reach : 0, y_end = std::min(height, y + reach + 1);
+
+					for (auto ny = y_begin; ny < y_end; ++ny)
+						for (auto nx = x_begin; nx < x_end; ++nx)
+							action(ny * width + nx, weights[Offset(x, y, nx, ny)]);
+				}
+
+			private:
+				size_t Offset(size_t x, size_t y, size_t nx, size_t ny) const;
+
+				const size_t width;
+				const size_t height;
+				size_t reach{ 0 };
+				vector<SignalUnit> squaredDistances; /**< Squared grid distance for every ( dx, dy ) offset. */
+				vector<SignalUnit> weights; /**< Neighborhood function over squaredDistances for the current radius. */
+			};
+
+			void TrainOnline(KohonenCodebook& codebook, RowMatrix const& samples, NeighborhoodTable& neighborhood);
+			void TrainBatch(KohonenCodebook& codebook, RowMatrix const& samples, NeighborhoodTable& neighborhood);
+
+			SignalUnit Decay(SignalUnit start, SignalUnit end, size_t epoch) const;
+			SignalUnit GetStartRadius(NeighborhoodTable const& neighborhood) const;
+			size_t GetThreadCount(size_t workItems) const;
+
+			ErrorUnit quantizationError{};
+		};
+	}
+}
@@ -1,5 +1,8 @@
 #include "pch.h"
 #include "Training/SupervisedTraining.h"
+#include "Diagnostics/Tracing.h"
+
+#include <limits>
 
 namespace NNS 
 {
@@ -25,30 +28,101 @@ namespace NNS
 				return;
 			}
 
-			isTrainingAborted = false;
-
 			errorState = std::make_unique<TrainingErrorState>(network, trainingData);
+			RunTraining(network);
+		}
+
+		void SupervisedTraining::Train(IFeedforwardNetwork& network, ITrainingDataSource& dataSource)
+		{
+			errorState = std::make_unique<TrainingErrorState>(network, dataSource);
+			RunTraining(network);
+		}
+
+		void SupervisedTraining::RunTraining(IFeedforwardNetwork& network)
+		{
+			errorState->SetCancellationToken(&abortToken);
+			errorState->SetErrorComputationMethod(errorMethod);
+			errorState->SetInputNormalizer(inputNormalizer);
+			errorState->SetCommunicator(communicator);
+
+			if (communicator != nullptr)
+			{
+				/* Every rank starts from rank 0's weights and optimizer seeds, identical steps then keep them identical. */
+				Distributed::BroadcastWeights(network, *communicator);
+
+				ErrorUnit seeds[2] = { static_cast<ErrorUnit>(trainingAlgorithm.GetSeed()), elmAlgorithm != nullptr ? static_cast<ErrorUnit>(elmAlgorithm->GetSeed()) : 0.0 };
+				communicator->Broadcast(seeds, 2); /* 32-bit seeds are exact in a double. */
+				trainingAlgorithm.SetSeed(static_cast<std::mt19937::result_type>(seeds[0]));
+				if (elmAlgorithm != nullptr)
+				{
+					elmAlgorithm->SetSeed(static_cast<std::mt19937::result_type>(seeds[1]));
+				}
+			}
 
 			trainingAlgorithm.Initialize(network);
+			if (elmAlgorithm != nullptr)
+			{
+				elmAlgorithm->Initialize(network);
+			}
+
+			/* Snapshot buffer is allocated here, improvements inside the loop only copy values. */
+			bestWeights.Initialize(network);
+			bestError = std::numeric_limits<ErrorUnit>::max();
+			epochCount = 0;
+
+			validationMonitor.reset();
+			if (validationData != nullptr)
+			{
+				validationMonitor = std::make_unique<ValidationMonitor>(network, *validationData, earlyStopping, &abortToken, errorMethod, inputNormalizer);
+			}
+			errorState->SetStopRequest(validationMonitor ? &validationMonitor->GetStopRequest() : nullptr);
 
 			bool is_completed = false;
+			bool is_evaluated = false; /* True if the current weights are the ones 'error' was computed for. */
+			ErrorUnit error{};
 			for (size_t i = 0; i < maxIterations; ++i)
 			{
-				const auto error = errorState->ComputeEpochGradient();
-				
-				// TODO: save best error and weight combination
+				NNS_TRACE_SCOPE("SupervisedTraining epoch");
+				++epochCount;
+
+				error = errorState->ComputeEpochGradient();
+				if (errorState->IsCancelled())
+				{
+					/* Epoch was cut short, its error is meaningless. */
+					break;
+				}
+				is_evaluated = true;
+
 				errorState->UpdateErrorVector(error);
-				
 
-				if (error <= errorThreshold || is_completed || isTrainingAborted)
+				if (error < bestError)
+				{
+					/* Save best error and weight combination. */
+					bestError = error;
+					bestWeights.Capture(network);
+				}
+
+				if (progressCallback)
+				{
+					progressCallback(TrainingProgress{ i, error, bestError });
+				}
+
+				if (validationMonitor)
+				{
+					/* Validation of these weights overlaps with the optimization step below. */
+					validationMonitor->Submit(network, i);
+				}
+
+				if (error <= errorThreshold || is_completed || errorState->IsCancelled() || errorState->IsStopRequested())
 				{
 					/* If error is small enought, then we can break learning procedure. */
 					break;
 				}
 
 				is_completed = trainingAlgorithm.OptimizeWeights(network, *errorState);
+				is_evaluated = false;
 
-				if (is_completed || isTrainingAborted)
+				if (is_completed || errorState->IsCancelled())
 				{
 					/* If TrainingProcedure forces us to finish ( either because of failure or just because the algorithm decided to stop */
 					continue;
@@ -60,6 +134,107 @@ namespace NNS
 					elmAlgorithm->OptimizeWeights(network, *errorState);
 				}
 			}
+
+			if (RestoreBestValidationWeights(network))
+			{
+				/* Weights generalizing best win over weights fitting the training set best. */
+				return;
+			}
+
+			if (!bestWeights.IsEmpty())
+			{
+				if (!is_evaluated && errorState->IsCancelled())
+				{
+					/* Aborted before the current weights were fully evaluated, trust the best known ones. */
+					bestWeights.Restore(network);
+					return;
+				}
+
+				if (!is_evaluated)
+				{
+					/* Last optimization step has not been evaluated yet. */
+					error = errorState->ComputeEpochError();
+				}
+
+				if (bestError < error)
+				{
+					/* Network ended worse than an earlier epoch, bring back the best weights. */
+					bestWeights.Restore(network);
+				}
+				else
+				{
+					bestError = error;
+				}
+			}
+		}
+
+		bool SupervisedTraining::RestoreBestValidationWeights(IFeedforwardNetwork& network)
+		{
+			if (validationMonitor)
+			{
+				validationMonitor->Finish();
+			}
+
+			if (communicator == nullptr)
+			{
+				return validationMonitor && validationMonitor->RestoreBestWeights(network);
+			}
+
+			/* Ranks may validate on different data, rank 0 decides and every rank keeps its weights. */
+			ErrorUnit is_restored = validationMonitor && validationMonitor->HasBestWeights() ? 1.0 : 0.0;
+			communicator->Broadcast(&is_restored, 1);
+			if (is_restored == 0.0)
+			{
+				return false;
+			}
+
+			if (communicator->GetRank() == 0)
+			{
+				validationMonitor->RestoreBestWeights(network);
+			}
+			Distributed::BroadcastWeights(network, *communicator);
+			return true;
+		}
+
+		ErrorUnit SupervisedTraining::GetBestError() const
+		{
+			return bestError;
+		}
+
+		ErrorUnit SupervisedTraining::GetBestValidationError() const
+		{
+			return validationMonitor ? validationMonitor->GetBestError() : std::numeric_limits<ErrorUnit>::max();
+		}
+
+		size_t SupervisedTraining::GetEpochCount() const
+		{
+			return epochCount;
+		}
+
+		size_t SupervisedTraining::GetEvaluationCount() const
+		{
+			return errorState ? errorState->GetEvaluationCount() : 0;
+		}
+
+		void SupervisedTraining::SetValidationData(TrainingDataSet const* heldOutData, EarlyStoppingConfig config)
+		{
+			validationData = heldOutData;
+			earlyStopping = config;
+		}
+
+		void SupervisedTraining::SetErrorCalculationMethod(ErrorCalculationMethod method)
+		{
+			errorMethod = method;
+		}
+
+		void SupervisedTraining::SetInputNormalizer(InputNormalizer const* normalizer)
+		{
+			inputNormalizer = normalizer;
+		}
+
+		void SupervisedTraining::SetCommunicator(Communicator* rankCommunicator)
+		{
+			communicator = rankCommunicator;
 		}
 
 		void SupervisedTraining::SetEludingLocalMinimaMethod(IWeightOptimizer* optimizer)
@@ -70,12 +245,22 @@ namespace NNS
 
 		void SupervisedTraining::AbortTraining()
 		{
-			isTrainingAborted = true;
+			abortToken.Cancel();
 		}
 
 		bool SupervisedTraining::IsTrainingAborted() const
 		{
-			return isTrainingAborted;
+			return abortToken.IsCancelled();
+		}
+
+		void SupervisedTraining::ResetAbort()
+		{
+			abortToken.Reset();
+		}
+
+		void SupervisedTraining::SetProgressCallback(ProgressCallback callback)
+		{
+			progressCallback = std::move(callback);
 		}
 	}
 }
\ No newline at end of file
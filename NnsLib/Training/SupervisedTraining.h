@@ -1,8 +1,6 @@
 #pragma once
 
 // Our project's .h files.
-#include <atomic>
-
 #include "Types/Units.h"
 #include "Types/Collections.h"
 #include "Common/ActivationFunctions.h"
@@ -12,6 +10,9 @@
 #include "Optimization/Backpropagation.h"
 #include "Training/TrainingErrorState.h"
 #include "Training/ITrainingAlgorithm.h"
+#include "Training/WeightSnapshot.h"
+#include "Training/ValidationMonitor.h"
+#include "Training/CancellationToken.h"
 
 namespace NNS 
 {
@@ -49,32 +50,109 @@ namespace NNS
 			*/
 			void Train(IFeedforwardNetwork& network, TrainingDataSet const& trainingData) override;
 
+			/** Training procedure over a data source, e.g. Data::StreamingDataSource for data sets larger than memory.
+			* Every epoch is one pass over the source, so optimizers behave exactly as with an in-memory data set.
+			* @throw std::invalid_argument if the first pass yields no samples.
+			*/
+			void Train(IFeedforwardNetwork& network, ITrainingDataSource& dataSource) override;
+
 			/** Adjust method for eluding local minima
 			* @param method target method
 			*/
 			void SetEludingLocalMinimaMethod(IWeightOptimizer* optimizer) override;
 
-			/** Inform algorithm to break as soon as possible.
-			* Calcutation won't be canceled but only not finalized. Algorithm have few check points,
-			* where it can decide if breaking is possible, so executing this method won't terminate the algorithm at exac same time.
+			/** Evaluate held-out data during training and stop once it no longer improves.
+			* Validation error is computed on a background thread against a copy of each epoch's weights, overlapping with the next epoch.
+			* When set, the network is left with the weights of the lowest validation error instead of the lowest training error.
+			* @param heldOutData held-out samples, must outlive training. Pass nullptr to disable validation.
+			* @param config patience and minimal improvement.
+			*/
+			void SetValidationData(TrainingDataSet const* heldOutData, EarlyStoppingConfig config = {});
+
+			/** Objective minimized by the optimizer and reported as epoch error, MeanSquareError by default.
+			* Cross-entropy usually converges much faster on classification, see ErrorCalculationMethod.
+			*/
+			void SetErrorCalculationMethod(ErrorCalculationMethod method);
+
+			/** Train on normalized inputs, training and validation data are normalized on the fly.
+			* The trained network then expects normalized inputs, fold the normalization into it before export, see InputNormalizer::FoldInto().
+			* @param normalizer must outlive training, nullptr ( default ) presents inputs as they are.
+			*/
+			void SetInputNormalizer(InputNormalizer const* normalizer);
+
+			/** Data-parallel training across processes, each rank calls Train() with its own shard of the training data.
+			* Errors and gradients are summed over all ranks, see TrainingErrorState::SetCommunicator(), and training starts
+			* from rank 0's weights and optimizer seeds, see IWeightOptimizer::SetSeed(), so every rank takes the same steps and ends with the same network.
+			* This holds for simulated annealing too, its trials are evaluated on the whole data set. Optimizer settings must match on all ranks.
+			* Early stopping is collective, once validation on any rank requests a stop every rank stops after the same epoch,
+			* and every rank keeps rank 0's validation-best weights. Ranks may validate on the same data, on their own or on none.
+			* @param rankCommunicator must outlive training, nullptr ( default ) trains on the local data alone.
+			*/
+			void SetCommunicator(Communicator* rankCommunicator);
+
+			/** Inform algorithm to break as soon as possible. Safe to call from any thread.
+			* The request reaches epoch error computation and optimizer inner loops, which stop after a few presentations
+			* and leave the network at the best weights evaluated so far. Train() then returns without finalizing.
+			* The request stays in effect until ResetAbort(), so one issued before Train() starts stops it before the first epoch.
 			*/
 			void AbortTraining() override;
+
+			void ResetAbort() override;
 			
 			/** Check if calculation was aborted.
 			* May be still in progress.
 			*/
 			bool IsTrainingAborted() const override;
 
+			/** Called on the training thread after every epoch's error is known.
+			* Keep it short, the next epoch does not start before it returns.
+			*/
+			void SetProgressCallback(ProgressCallback callback) override;
+
+			/** Lowest epoch error seen during the last training.
+			* Train() leaves the network with the weights that produced it, even if later optimization steps made things worse.
+			* With validation data the network ends with the weights of the lowest validation error instead, see GetBestValidationError(),
+			* their training error may be higher than this one.
+			*/
+			ErrorUnit GetBestError() const;
+
+			/** Lowest validation error seen during the last training, see SetValidationData(). */
+			ErrorUnit GetBestValidationError() const;
+
+			/** Epochs started during the last training. */
+			size_t GetEpochCount() const;
+
+			/** Passes over the training data during the last training, including the ones optimizers make inside an epoch. */
+			size_t GetEvaluationCount() const;
+
 		protected:
+			// Epoch loop shared by both Train() overloads, runs on the already created errorState.
+			void RunTraining(IFeedforwardNetwork& network);
+
+			// Finish validation and swap in its best weights, with a communicator rank 0's on every rank. False if there were none.
+			bool RestoreBestValidationWeights(IFeedforwardNetwork& network);
+
 			// Selected optimizer for elusion of local minimum.
 			IWeightOptimizer* elmAlgorithm{ nullptr };
 			IWeightOptimizer& trainingAlgorithm;
 
 			size_t maxIterations;
 			ErrorUnit errorThreshold;
-			std::atomic<bool> isTrainingAborted;
+			ErrorCalculationMethod errorMethod{ ErrorCalculationMethod::MeanSquareError };
+			InputNormalizer const* inputNormalizer{ nullptr };
+			Communicator* communicator{ nullptr };
+			CancellationToken abortToken;
+			ProgressCallback progressCallback;
 
 			TrainingErrorState::Ptr errorState;
+
+			WeightSnapshot bestWeights;
+			ErrorUnit bestError{};
+			size_t epochCount{ 0 };
+
+			TrainingDataSet const* validationData{ nullptr };
+			EarlyStoppingConfig earlyStopping;
+			std::unique_ptr<ValidationMonitor> validationMonitor;
 		};
 	}
 }
\ No newline at end of file
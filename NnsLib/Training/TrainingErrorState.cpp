@@ -1,13 +1,35 @@
 #include "pch.h"
 #include "Training/TrainingErrorState.h"
+#include "Diagnostics/Tracing.h"
+#include "Data/InMemoryDataSource.h"
+#include "Common/InterfaceHelpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
 
 namespace NNS 
 {
 	namespace Training 
 	{
+		/* Presentations between two cancellation checks inside an epoch. */
+		static constexpr size_t CancellationCheckInterval = 64;
+
+		/* Values every allreduce carries ahead of the gradient: error, presentations, cancelled ranks, ranks requesting a stop. */
+		static constexpr size_t CollectiveHeaderSize = 4;
 
 		TrainingErrorState::TrainingErrorState(IFeedforwardNetwork& network, const TrainingDataSet& trainingData)
-			: network{ network }, trainingData{ trainingData }, networkmap{ network.GetNetworkLayerMap() }
+			: network{ network }, ownedDataSource{ new Data::InMemoryDataSource(trainingData) }, dataSource{ *ownedDataSource }, networkmap{ network.GetNetworkLayerMap() }, differentiable{ as<IDifferentiable>(network) }
+		{
+			SetErrorComputationMethod(ErrorCalculationMethod::MeanSquareError);
+			InitializeMatrices();
+		};
+
+		TrainingErrorState::TrainingErrorState(IFeedforwardNetwork& trainedNetwork, ITrainingDataSource& trainingDataSource)
+			: network{ trainedNetwork }, dataSource{ trainingDataSource }, networkmap{ trainedNetwork.GetNetworkLayerMap() }, differentiable{ as<IDifferentiable>(trainedNetwork) }
 		{
 			SetErrorComputationMethod(ErrorCalculationMethod::MeanSquareError);
 			InitializeMatrices();
@@ -38,48 +60,98 @@ namespace NNS
 
 			for (size_t i = 0; i < networkmap.size() - 1; ++i) /* For each layer ( minus input layer ). */
 			{
+				if (differentiable != nullptr) /* Shared weights, gradient has the weight matrix's shape rather than one vector per neuron. */
+				{
+					const auto& weightLayer = network.GetWeightMatrix()[i];
+					errorGradient[i].resize(weightLayer.size());
+					for (size_t j = 0; j < weightLayer.size(); ++j)
+						errorGradient[i][j].resize(static_cast<size_t>(weightLayer[j].size()), 0.0);
+					errorDelta[i].resize(networkmap[i + 1], 0.0);
+					continue;
+				}
+
+				const auto connectivity = network.GetConnectivity(static_cast<int>(i + 1));
 				errorGradient[i].resize(networkmap[i + 1]);
 				errorDelta[i].resize(networkmap[i + 1], 0.0);
 
 				for (size_t j = 0; j < networkmap[i + 1]; ++j) /* For each neuron. */
 				{
-					errorGradient[i][j].resize(networkmap[i] + 1, 0.0); /* Copy connections number. */
+					const size_t connections = connectivity == nullptr ? networkmap[i] : connectivity->outerIndexPtr()[j + 1] - connectivity->outerIndexPtr()[j];
+					errorGradient[i][j].resize(connections + 1, 0.0); /* Copy connections number. */
 																		/* +1 becaue of additional bias */
 				}
 			}
+
+			backwardSum.assign(*std::max_element(networkmap.begin(), networkmap.end()), 0.0);
+
+			if (communicator != nullptr)
+			{
+				SetCommunicator(communicator); /* Reshape the allreduce buffer like the gradient. */
+			}
 		}
 
 		void TrainingErrorState::ZeroErrorGradient()
 		{
-			for (size_t i = 0; i < networkmap.size() - 1; ++i) /* For each layer ( minus input layer ). */
-				for (size_t j = 0; j < networkmap[i + 1]; ++j) /* For each neuron. */
-					for (size_t k = 0; k < networkmap[i] + 1; ++k) /* For each connection + bias. */
-						errorGradient[i][j][k] = 0.0;
+			for (auto& layer : errorGradient) /* For each layer ( minus input layer ). */
+				for (auto& gradient : layer) /* For each neuron. */
+					std::fill(gradient.begin(), gradient.end(), 0.0); /* For each connection + bias. */
 		}
 
 		ErrorUnit TrainingErrorState::ComputeEpochError(bool computeGradient)
 		{
+			NNS_TRACE_SCOPE(computeGradient ? "TrainingErrorState::ComputeEpochGradient" : "TrainingErrorState::ComputeEpochError");
+
 			ErrorUnit error{};
+			size_t presentations{};
+			++evaluationCount;
 
 			if (computeGradient)
 			{
 				ZeroErrorGradient();
 			}
 
-			// For each presentation in epoch.
-			for (const auto& trainingDataStep : trainingData)
+			bool isCancelled = false;
+			dataSource.Rewind();
+			while (!isCancelled)
 			{
-				error += ComputeError(trainingDataStep.first, trainingDataStep.second);
+				const auto chunk = dataSource.NextChunk();
+				if (chunk == nullptr)
+					break;
 
-				if (computeGradient)
+				// For each presentation in epoch.
+				for (const auto& trainingDataStep : *chunk)
 				{
-					ComputeErrorGradient(trainingDataStep.first, trainingDataStep.second);
+					if ((++presentations % CancellationCheckInterval) == 0 && IsCancellationRequested())
+					{
+						/* Partial error, caller is expected to check IsCancelled() and discard it. */
+						isCancelled = true;
+						break;
+					}
+
+					const auto& input = PrepareInput(trainingDataStep.first);
+					error += ComputeError(input, trainingDataStep.second);
+
+					if (computeGradient)
+					{
+						ComputeErrorGradient(input, trainingDataStep.second);
+					}
 				}
 			}
 
-			assert((static_cast<ErrorUnit>(trainingData.size())) != 0);
+			if (communicator != nullptr)
+			{
+				/* Other ranks wait for this one even if it was cancelled, the sum tells them to stop as well.
+				   The token is checked once more, short epochs may not reach a check inside the loop. */
+				error = AllReduce(error, presentations, IsCancellationRequested(), computeGradient);
+			}
+
+			if (presentations == 0)
+			{
+				/* Only a data source can be empty here, in-memory data sets are checked by their users. */
+				throw std::invalid_argument("Training data source yielded no samples");
+			}
 
-			return error / (static_cast<ErrorUnit>(trainingData.size()));
+			return error / (static_cast<ErrorUnit>(presentations));
 		}
 
 		ErrorUnit TrainingErrorState::ComputeEpochGradient()
@@ -87,11 +159,250 @@ namespace NNS
 			return ComputeEpochError(true);
 		}
 
+		size_t TrainingErrorState::GetEvaluationCount() const
+		{
+			return evaluationCount;
+		}
+
+		size_t TrainingErrorState::DrawSubsample(size_t size, std::mt19937& engine)
+		{
+			NNS_TRACE_SCOPE("TrainingErrorState::DrawSubsample");
+
+			if (communicator == nullptr)
+				return DrawLocalSubsample(size, engine);
+
+			if (shardRows.empty())
+			{
+				/* Shards do not change during training, their sizes are exchanged once. */
+				shardRows.assign(static_cast<size_t>(communicator->GetWorldSize()), 0.0);
+				dataSource.Rewind();
+				while (const auto chunk = dataSource.NextChunk())
+					shardRows[static_cast<size_t>(communicator->GetRank())] += static_cast<ErrorUnit>(chunk->size());
+				communicator->AllReduceSum(shardRows.data(), shardRows.size());
+			}
+
+			/* Every rank draws its share of the subsample from its own shard. Engines agree across ranks,
+			   each rank draws one value from it and mixes in its rank, so engines stay in step and shards are sampled independently. */
+			const auto rank = static_cast<std::uint32_t>(communicator->GetRank());
+			std::seed_seq rankSeed{ static_cast<std::uint32_t>(engine()), rank };
+			std::mt19937 rankEngine(rankSeed);
+
+			const auto total = static_cast<size_t>(std::accumulate(shardRows.begin(), shardRows.end(), 0.0));
+			DrawLocalSubsample(GetSubsampleShare(std::min(size, total), rank), rankEngine);
+			return std::min(size, total);
+		}
+
+		size_t TrainingErrorState::GetSubsampleShare(size_t size, size_t rank) const
+		{
+			/* Largest remainder method, shares are proportional to shard sizes and add up to size.
+			   Every rank computes them from the same counts in the same order, so they agree without another collective. */
+			const auto total = std::accumulate(shardRows.begin(), shardRows.end(), 0.0);
+			size_t assigned = 0;
+			for (const auto rows : shardRows)
+				assigned += static_cast<size_t>(std::floor(static_cast<ErrorUnit>(size) * rows / total));
+
+			const auto quota = static_cast<ErrorUnit>(size) * shardRows[rank] / total;
+			const auto remainder = quota - std::floor(quota);
+			size_t outranked = 0; /* Ranks whose remainder gets a leftover row before this rank's. */
+			for (size_t other = 0; other < shardRows.size(); ++other)
+			{
+				const auto otherQuota = static_cast<ErrorUnit>(size) * shardRows[other] / total;
+				const auto otherRemainder = otherQuota - std::floor(otherQuota);
+				if (otherRemainder > remainder || (otherRemainder == remainder && other < rank))
+					++outranked;
+			}
+
+			const auto share = static_cast<size_t>(std::floor(quota)) + (outranked < size - assigned ? 1 : 0);
+			return std::min(share, static_cast<size_t>(shardRows[rank]));
+		}
+
+		size_t TrainingErrorState::DrawLocalSubsample(size_t size, std::mt19937& engine)
+		{
+			/* Reservoir sampling with geometric skips ( Li's algorithm L ), random numbers are drawn only for accepted samples,
+			   so a pass over a large in-memory data set costs O( size * log( rows / size ) ). */
+			const auto random01 = [&engine]() { return 1.0 - std::generate_canonical<double, 53>(engine); }; /* ( 0; 1 > */
+			const auto skip = [&random01](double w)
+			{
+				const auto gap = std::floor(log(random01()) / log(1.0 - w));
+				return gap < static_cast<double>(std::numeric_limits<size_t>::max() / 2) ? static_cast<size_t>(gap) + 1 : std::numeric_limits<size_t>::max() / 2;
+			};
+			std::uniform_int_distribution<size_t> pick(0, size == 0 ? 0 : size - 1);
+
+			subsample.resize(size);
+			if (size == 0)
+				return 0;
+
+			auto w = exp(log(random01()) / static_cast<double>(size));
+			size_t next = size - 1 + skip(w); /* Position of the next sample replacing a random one in the reservoir. */
+			size_t seen = 0;
+
+			dataSource.Rewind();
+			while (const auto chunk = dataSource.NextChunk())
+			{
+				const auto chunkBegin = seen;
+				const auto chunkEnd = seen + chunk->size();
+
+				for (; seen < std::min(size, chunkEnd); ++seen) /* Fill the reservoir first. */
+					subsample[seen] = (*chunk)[seen - chunkBegin];
+
+				for (; next < chunkEnd; next += skip(w))
+				{
+					subsample[pick(engine)] = (*chunk)[next - chunkBegin];
+					w *= exp(log(random01()) / static_cast<double>(size));
+				}
+
+				seen = chunkEnd;
+			}
+
+			if (seen < size)
+				subsample.resize(seen);
+
+			return subsample.size();
+		}
+
+		ErrorUnit TrainingErrorState::ComputeSubsampleError()
+		{
+			NNS_TRACE_SCOPE("TrainingErrorState::ComputeSubsampleError");
+
+			ErrorUnit error{};
+			++subsampleEvaluationCount;
+			assert(!subsample.empty() || communicator != nullptr); /* A rank's share may be empty, the whole subsample is not. */
+
+			size_t evaluated = 0;
+			for (; evaluated < subsample.size(); ++evaluated)
+			{
+				if (((evaluated + 1) % CancellationCheckInterval) == 0 && IsCancellationRequested())
+				{
+					break; /* Partial error, caller is expected to check IsCancelled() and discard it. */
+				}
+
+				error += ComputeError(PrepareInput(subsample[evaluated].first), subsample[evaluated].second);
+			}
+
+			if (communicator != nullptr)
+			{
+				error = AllReduce(error, evaluated, IsCancellationRequested(), false);
+			}
+
+			return error / static_cast<ErrorUnit>(evaluated);
+		}
+
+		TrainingDataSet const& TrainingErrorState::GetSubsample() const
+		{
+			return subsample;
+		}
+
+		size_t TrainingErrorState::GetSubsampleEvaluationCount() const
+		{
+			return subsampleEvaluationCount;
+		}
+
 		ErrorGradientMatrix& TrainingErrorState::GetErrorGradient()
 		{
 			return errorGradient;
 		}
 
+		void TrainingErrorState::SetCancellationToken(CancellationToken const* token)
+		{
+			cancellation = token;
+			isCollectiveCancelled = false;
+		}
+
+		bool TrainingErrorState::IsCancelled() const
+		{
+			if (communicator != nullptr)
+			{
+				return isCollectiveCancelled; /* Changes only inside collectives, so all ranks agree on it. */
+			}
+			return IsCancellationRequested();
+		}
+
+		void TrainingErrorState::SetStopRequest(CancellationToken const* request)
+		{
+			stopRequest = request;
+			isCollectiveStopRequested = false;
+		}
+
+		bool TrainingErrorState::IsStopRequested() const
+		{
+			if (communicator != nullptr)
+			{
+				return isCollectiveStopRequested; /* Changes only inside collectives, so all ranks agree on it. */
+			}
+			return stopRequest != nullptr && stopRequest->IsCancelled();
+		}
+
+		bool TrainingErrorState::IsCancellationRequested() const
+		{
+			return isCollectiveCancelled || (cancellation != nullptr && cancellation->IsCancelled());
+		}
+
+		void TrainingErrorState::SetInputNormalizer(InputNormalizer const* normalizer)
+		{
+			inputNormalizer = normalizer;
+		}
+
+		void TrainingErrorState::SetCommunicator(Communicator* rankCommunicator)
+		{
+			communicator = rankCommunicator;
+			isCollectiveCancelled = false;
+			isCollectiveStopRequested = false;
+			shardRows.clear();
+
+			size_t count = CollectiveHeaderSize;
+			for (const auto& layer : errorGradient) /* For each layer ( minus input layer ). */
+				for (const auto& gradient : layer) /* For each neuron. */
+					count += gradient.size();
+			collectiveBuffer.assign(communicator != nullptr ? count : 0, 0.0);
+		}
+
+		ErrorUnit TrainingErrorState::AllReduce(ErrorUnit error, size_t& presentations, bool isCancelled, bool includeGradient)
+		{
+			auto* buffer = collectiveBuffer.data();
+			buffer[0] = error;
+			buffer[1] = static_cast<ErrorUnit>(presentations);
+			buffer[2] = isCancelled ? 1.0 : 0.0;
+			buffer[3] = isCollectiveStopRequested || (stopRequest != nullptr && stopRequest->IsCancelled()) ? 1.0 : 0.0;
+
+			size_t count = CollectiveHeaderSize;
+			if (includeGradient)
+			{
+				for (const auto& layer : errorGradient) /* For each layer ( minus input layer ). */
+					for (const auto& gradient : layer) /* For each neuron. */
+					{
+						std::copy(gradient.begin(), gradient.end(), buffer + count);
+						count += gradient.size();
+					}
+			}
+
+			communicator->AllReduceSum(buffer, count);
+
+			if (includeGradient)
+			{
+				count = CollectiveHeaderSize;
+				for (auto& layer : errorGradient)
+					for (auto& gradient : layer)
+					{
+						std::copy(buffer + count, buffer + count + gradient.size(), gradient.begin());
+						count += gradient.size();
+					}
+			}
+
+			presentations = static_cast<size_t>(buffer[1]);
+			isCollectiveCancelled = isCollectiveCancelled || buffer[2] != 0.0;
+			isCollectiveStopRequested = buffer[3] != 0.0;
+			return buffer[0];
+		}
+
+		InputLayer const& TrainingErrorState::PrepareInput(InputLayer const& inputLayer)
+		{
+			if (inputNormalizer == nullptr)
+				return inputLayer;
+
+			inputNormalizer->Normalize(inputLayer, normalizedInput);
+			return normalizedInput;
+		}
+
 		ErrorUnit TrainingErrorState::ComputeError(InputLayer const& iutputLayer, OutputLayer const& desiredOutputLayer)
 		{
 			switch (errorMethod)
@@ -100,6 +411,14 @@ namespace NNS
 			{
 				return this->ComputeLogMeanSquareError(iutputLayer, desiredOutputLayer);
 			}
+			case ErrorCalculationMethod::BinaryCrossEntropy:
+			{
+				return this->ComputeBinaryCrossEntropy(iutputLayer, desiredOutputLayer);
+			}
+			case ErrorCalculationMethod::CategoricalCrossEntropy:
+			{
+				return this->ComputeCategoricalCrossEntropy(iutputLayer, desiredOutputLayer);
+			}
 			case ErrorCalculationMethod::MeanSquareError:
 			default:
 			{
@@ -117,11 +436,7 @@ namespace NNS
 				return error;
 			}
 
-			for (size_t i = 0; i < desiredOutputLayer.size(); ++i)
-			{
-				error += pow(desiredOutputLayer[i] - network.GetOutputActivation(i), 2.0);
-			}
-
+			error = (desiredOutputLayer - network.GetActivationMatrix().back()).squaredNorm();
 			error = (error / static_cast<ErrorUnit>(desiredOutputLayer.size()));
 			return error;
 		}
@@ -131,34 +446,135 @@ namespace NNS
 			return log(ComputeMeanSquareError(iutputLayer, desiredOutputLayer));
 		}
 
+		ErrorUnit TrainingErrorState::ComputeBinaryCrossEntropy(InputLayer const& iutputLayer, OutputLayer const& desiredOutputLayer)
+		{
+			if (!network.ComputeOutput(iutputLayer))
+			{
+				return ErrorUnit{};
+			}
+
+			/* -t*log( sigmoid( z ) ) - ( 1 - t )*log( 1 - sigmoid( z ) ) rewritten as log( 1 + exp( z ) ) - t*z, exp() never overflows. */
+			const auto logits = network.GetOutputNetInput().array();
+			const auto desired = desiredOutputLayer.array();
+			return (logits.max(0.0) - desired * logits + (-logits.abs()).exp().log1p()).sum();
+		}
+
+		ErrorUnit TrainingErrorState::ComputeCategoricalCrossEntropy(InputLayer const& iutputLayer, OutputLayer const& desiredOutputLayer)
+		{
+			if (!network.ComputeOutput(iutputLayer))
+			{
+				return ErrorUnit{};
+			}
+
+			/* -sum( t*log( softmax( z ) ) ) = sum( t )*logSumExp( z ) - t.z, shifted by the largest logit. */
+			const auto& logits = network.GetOutputNetInput();
+			const auto maxLogit = logits.maxCoeff();
+			outputProbability = (logits.array() - maxLogit).exp();
+			const auto sum = outputProbability.sum();
+			outputProbability /= sum;
+
+			return desiredOutputLayer.sum() * (maxLogit + log(sum)) - desiredOutputLayer.dot(logits);
+		}
+
+		void TrainingErrorState::ComputeOutputDelta(OutputLayer const& desiredOutputLayer)
+		{
+			const auto outputLayerId = static_cast<int>(networkmap.size() - 1);
+			const auto& output = network.GetActivationMatrix().back();
+			auto& outputDelta = errorDelta.back();
+			Eigen::Map<ActivationVector> delta(outputDelta.data(), static_cast<Eigen::Index>(outputDelta.size()));
+
+			switch (errorMethod)
+			{
+			case ErrorCalculationMethod::BinaryCrossEntropy:
+			{
+				/* Loss and logistic derivatives cancel out, leaving the negative gradient with respect to the logits. */
+				delta = desiredOutputLayer - output;
+				break;
+			}
+			case ErrorCalculationMethod::CategoricalCrossEntropy:
+			{
+				delta = desiredOutputLayer - desiredOutputLayer.sum() * outputProbability;
+				break;
+			}
+			case ErrorCalculationMethod::MeanSquareError:
+			case ErrorCalculationMethod::LogMeanSquareError:
+			default:
+			{
+				for (size_t j = 0; j < outputDelta.size(); ++j) /* For each neuron. */
+					outputDelta[j] = (desiredOutputLayer[j] - output[j]) * network.GetActivationDerivative(outputLayerId, static_cast<int>(j));
+			}
+			}
+		}
+
 		void TrainingErrorState::ComputeErrorGradient(InputLayer const& iutputLayer, OutputLayer const& desiredOutputLayer)
 		{
-			SignalUnit delta, sum;
+			NNS_TRACE_AGGREGATE("TrainingErrorState::ComputeErrorGradient");
+
+			SignalUnit delta;
+			const auto& weightMatrix = network.GetWeightMatrix();
+
+			ComputeOutputDelta(desiredOutputLayer);
+
+			if (differentiable != nullptr)
+			{
+				differentiable->AccumulateGradient(errorDelta.back(), errorGradient);
+				return;
+			}
 
 			for (size_t i = networkmap.size() - 1; i > 0; --i) /* For each layer ( minus input layer ). */
 			{
+				const auto connectivity = network.GetConnectivity(static_cast<int>(i));
+				const auto& prevActivation = network.GetActivationMatrix()[i - 1 /* previus layer */];
+
 				for (size_t j = 0; j < networkmap[i /* current layer */]; ++j) /* For each neuron. */
 				{
-					if (i == networkmap.size() - 1) /* Calculating delta for the output layer */
+					if (i == networkmap.size() - 1) /* Output layer's deltas are already computed */
 					{
-						delta = (desiredOutputLayer[j] - network.GetOutputActivation(j)) * network.GetActivationDerivative(i, j);
+						delta = errorDelta[i - 1][j];
 					}
 					else
-					{ /* Calculating delta for hidden layers */
-						sum = 0.0;
-
-						for (size_t k = 0; k < networkmap[i + 1/* next layer */]; ++k) /* For each neuron from next layer. */
-							sum += errorDelta[i /* next layer */][k] * network.Weight(i + 1 /* next layer */, k /* k'th neuron */, j /* connection to this layer */);
-
-						delta = sum * network.GetActivationDerivative(i, j);
+					{ /* Calculating delta for hidden layers, next layer's deltas were already summed up per neuron of this layer. */
+						delta = backwardSum[j] * network.GetActivationDerivative(i, j);
+						errorDelta[i - 1][j] = delta; /* Save error delta. */
 					}
-					errorDelta[i - 1][j] = delta; /* Save error delta. */
 					
 					/* Calculating partial derivative of the error. */
-					for (size_t k = 0; k < networkmap[i - 1]; ++k)
-						errorGradient[i - 1 /* current layer */][j][k] += delta * network.GetActivation(i - 1 /* previus layer */, k);
+					auto& gradient = errorGradient[i - 1 /* current layer */][j];
+					if (connectivity == nullptr)
+					{
+						for (size_t k = 0; k < networkmap[i - 1]; ++k)
+							gradient[k] += delta * prevActivation[k];
+					}
+					else
+					{
+						const auto* sources = connectivity->innerIndexPtr() + connectivity->outerIndexPtr()[j];
+						for (size_t k = 0; k + 1 < gradient.size(); ++k) /* Each existing connection */
+							gradient[k] += delta * prevActivation[sources[k]];
+					}
 
-					errorGradient[i - 1 /* current layer */][j][networkmap[i - 1]] += delta; /* Bias activation is always equal to 1.*/
+					gradient.back() += delta; /* Bias activation is always equal to 1.*/
+				}
+
+				if (i > 1)
+				{
+					/* Sum this layer's deltas over connections to each previous layer neuron, missing connections contribute nothing. */
+					std::fill(backwardSum.begin(), backwardSum.begin() + networkmap[i - 1], 0.0);
+					for (size_t j = 0; j < networkmap[i]; ++j) /* For each neuron. */
+					{
+						const auto& weightVect = weightMatrix[i - 1][j];
+						const auto neuronDelta = errorDelta[i - 1][j];
+						if (connectivity == nullptr)
+						{
+							for (size_t k = 0; k < networkmap[i - 1]; ++k)
+								backwardSum[k] += neuronDelta * weightVect[k];
+						}
+						else
+						{
+							const auto* sources = connectivity->innerIndexPtr() + connectivity->outerIndexPtr()[j];
+							for (Eigen::Index k = 0; k + 1 < weightVect.size(); ++k) /* Each existing connection */
+								backwardSum[sources[k]] += neuronDelta * weightVect[k];
+						}
+					}
 				}
 			}
 		}
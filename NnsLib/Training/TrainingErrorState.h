@@ -1,10 +1,15 @@
 #pragma once
 
 #include <memory>
+#include <random>
 
 #include "Types/Units.h"
 #include "Types/Collections.h"
 #include "Models/IFeedforwardNetwork.h"
+#include "Data/ITrainingDataSource.h"
+#include "Data/InputNormalizer.h"
+#include "Distributed/Communicator.h"
+#include "Training/CancellationToken.h"
 
 namespace NNS 
 {
@@ -17,11 +22,21 @@ namespace NNS
 
 		using namespace NNS::Types;
 		using namespace NNS::Models;
-
+		using NNS::Data::ITrainingDataSource;
+		using NNS::Data::InputNormalizer;
+		using NNS::Distributed::Communicator;
+
+		/** Cross-entropy methods are computed from the output layer's logits with log-sum-exp, so they stay finite on saturated outputs,
+		* and their output delta is the fused ( target - prediction ) without the activation derivative, which only cancels
+		* for a logistic output layer, i.e. they expect a MultilayerPerceptron or a ConvolutionalNetwork.
+		*/
 		enum class ErrorCalculationMethod : unsigned int
 		{
 			MeanSquareError = 0,
-			LogMeanSquareError
+			LogMeanSquareError,
+			BinaryCrossEntropy, /**< Independent logistic outputs, e.g. multi-label classification. Summed over outputs. */
+			CategoricalCrossEntropy /**< Softmax over the output layer's logits, targets are class probabilities ( usually one-hot ).
+									* Network's outputs stay logistic, their order matches the softmax, so argmax picks the same class. */
 		};
 
 		class TrainingErrorState
@@ -31,6 +46,11 @@ namespace NNS
 
 			TrainingErrorState(IFeedforwardNetwork& network, const TrainingDataSet& trainingData);
 
+			/** Error state over samples that do not have to fit in memory.
+			* Each epoch makes one pass over the data source, so error and gradient equal those of the same samples held in a TrainingDataSet.
+			*/
+			TrainingErrorState(IFeedforwardNetwork& trainedNetwork, ITrainingDataSource& trainingDataSource);
+
 			void SetErrorComputationMethod(ErrorCalculationMethod method);
 			void InitializeMatrices();
 			void ZeroErrorGradient();
@@ -38,30 +58,119 @@ namespace NNS
 			ErrorVector const& GetErrorVector();
 			void UpdateErrorVector(ErrorUnit error);
 
+			/** Mean error over one pass, all ranks' passes with a communicator.
+			* @throw std::invalid_argument if the pass yielded no samples.
+			*/
 			ErrorUnit ComputeEpochError(bool computeGradient = false);
 			ErrorUnit ComputeEpochGradient();
 
+			/** Number of ComputeEpochError() and ComputeEpochGradient() calls, i.e. passes over the training data. */
+			size_t GetEvaluationCount() const;
+
+			/** Draw a uniform random subsample without replacement, kept for ComputeSubsampleError() until the next draw.
+			* Takes one pass over the data source which only reads samples, no outputs are computed.
+			* @return number of samples drawn, less than size only if the data has fewer samples.
+			*/
+			size_t DrawSubsample(size_t size, std::mt19937& engine);
+
+			/** Samples picked by the last DrawSubsample(), this rank's share when distributed. */
+			TrainingDataSet const& GetSubsample() const;
+
+			/** Error over the last drawn subsample, an estimate of ComputeEpochError() at a fraction of its cost. No gradient. */
+			ErrorUnit ComputeSubsampleError();
+
+			/** Number of ComputeSubsampleError() calls, these are not counted by GetEvaluationCount(). */
+			size_t GetSubsampleEvaluationCount() const;
+
 			ErrorGradientMatrix& GetErrorGradient();
 
+			/** Let training be cancelled from another thread.
+			* Once the token is cancelled, ComputeEpochError() stops within a few presentations and its result must be discarded,
+			* optimizers check IsCancelled() after each evaluation and leave the network at the best point they have seen.
+			* @param token must outlive this object, nullptr disables cancellation.
+			*/
+			void SetCancellationToken(CancellationToken const* token);
+			bool IsCancelled() const;
+
+			/** Early stopping request, e.g. ValidationMonitor::GetStopRequest(). Unlike cancellation it never cuts an evaluation short.
+			* @param request must outlive this object, nullptr never requests a stop.
+			*/
+			void SetStopRequest(CancellationToken const* request);
+
+			/** True once the stop request is set. With a communicator, true once it was set on any rank at the end of an evaluation, so ranks agree on it. */
+			bool IsStopRequested() const;
+
+			/** Normalize every input on the fly before it is presented to the network, the data itself stays untouched.
+			* @param normalizer must outlive this object, nullptr presents inputs as they are.
+			*/
+			void SetInputNormalizer(InputNormalizer const* normalizer);
+
+			/** Data-parallel training, this state holds one rank's shard of the data.
+			* Epoch errors, gradients and presentation counts are summed over all ranks at the end of each evaluation, so every rank
+			* sees the error and gradient of the whole data set and optimizers take the same steps everywhere.
+			* Subsamples are split across shards in proportion to their sizes, their errors are combined the same way.
+			* Cancellation and stop requests on any rank are noticed by all of them at the end of the evaluation,
+			* IsCancelled() and IsStopRequested() change only then, so ranks agree on them.
+			* @param rankCommunicator must outlive this object, nullptr trains on the local data alone.
+			*/
+			void SetCommunicator(Communicator* rankCommunicator);
+
 		protected:
 			ErrorUnit ComputeError(InputLayer const& iutputLayer, OutputLayer const& desiredOutputLayer);
 			ErrorUnit ComputeMeanSquareError(InputLayer const& iutputLayer, OutputLayer const& desiredOutputLayer);
 			ErrorUnit ComputeLogMeanSquareError(InputLayer const& iutputLayer, OutputLayer const& desiredOutputLayer);
+			ErrorUnit ComputeBinaryCrossEntropy(InputLayer const& iutputLayer, OutputLayer const& desiredOutputLayer);
+			ErrorUnit ComputeCategoricalCrossEntropy(InputLayer const& iutputLayer, OutputLayer const& desiredOutputLayer);
 
 			// Calculate partial error value as well as objective function gradient.
 			void ComputeErrorGradient(InputLayer const& iutputLayer, OutputLayer const& desiredOutputLayer);
 
 		private:
+			/** Fill output layer's error deltas for the presentation just computed. */
+			void ComputeOutputDelta(OutputLayer const& desiredOutputLayer);
+
+			/** This rank's own view, IsCancelled() is the one all ranks share. */
+			bool IsCancellationRequested() const;
+
+			/** Input to present, the normalized copy if a normalizer is set. */
+			InputLayer const& PrepareInput(InputLayer const& inputLayer);
+
+			/** Reservoir sampling of this rank's data. */
+			size_t DrawLocalSubsample(size_t size, std::mt19937& engine);
+
+			/** Rows of a distributed subsample of the given size that the rank draws from its shard, see shardRows. */
+			size_t GetSubsampleShare(size_t size, size_t rank) const;
+
+			/** Sum error, presentation count, cancellation, stop requests and optionally the gradient over all ranks, returns the summed error. */
+			ErrorUnit AllReduce(ErrorUnit error, size_t& presentations, bool isCancelled, bool includeGradient);
+
 			ErrorGradientMatrix errorGradient;
 			ErrorDeltaMatrix errorDelta; // Matrix with Partial derivative of the error.
+			ErrorVector backwardSum; /**< Next layer's deltas weighted by connections, per neuron of the layer being computed. */
+			OutputLayer outputProbability; /**< Softmax of the output logits, CategoricalCrossEntropy only. */
 
 			IFeedforwardNetwork& network;
-			const TrainingDataSet& trainingData;
+			ITrainingDataSource::Ptr ownedDataSource; /**< Set only when constructed from an in-memory data set. */
+			ITrainingDataSource& dataSource;
 			const NetworkLayerMap networkmap;
+			IDifferentiable* differentiable{ nullptr }; /**< Set when the network backpropagates its own deltas. */
 
 			ErrorCalculationMethod errorMethod;
 			ErrorVector epochErrorVector; /**< Error obtained after computing each presentation. */
 			ErrorVector::iterator epochErrorVectorIter; /**< Iterator for _epochErrorVector. */
+			TrainingDataSet subsample; /**< Copies of the samples picked by DrawSubsample(). */
+
+			CancellationToken const* cancellation{ nullptr };
+			InputNormalizer const* inputNormalizer{ nullptr };
+			InputLayer normalizedInput; /**< Reused for every presentation, see SetInputNormalizer(). */
+			Communicator* communicator{ nullptr };
+			ErrorVector collectiveBuffer; /**< Gradient and counters packed for one allreduce, sized once by SetCommunicator(). */
+			bool isCollectiveCancelled{ false }; /**< Some rank was cancelled during the last evaluation. */
+			ErrorVector shardRows; /**< Row count of every rank's shard, exchanged by the first distributed DrawSubsample(). */
+			CancellationToken const* stopRequest{ nullptr };
+			bool isCollectiveStopRequested{ false }; /**< Some rank requested a stop by the end of the last evaluation. */
+			size_t evaluationCount{ 0 };
+			size_t subsampleEvaluationCount{ 0 };
 		};
 	} 
 }
\ No newline at end of file
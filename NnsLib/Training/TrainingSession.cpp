@@ -0,0 +1,107 @@
+#include "pch.h"
+#include "Training/TrainingSession.h"
+
+namespace NNS
+{
+	namespace Training
+	{
+		TrainingSession::TrainingSession(ITrainingAlgorithm& algorithm, IFeedforwardNetwork& network, TrainingDataSet const& trainingData, ProgressCallback progressCallback)
+			: trainer{ algorithm }, callback{ std::move(progressCallback) }
+		{
+			Start([this, &network, &trainingData] { trainer.Train(network, trainingData); });
+		}
+
+		TrainingSession::TrainingSession(ITrainingAlgorithm& algorithm, IFeedforwardNetwork& network, ITrainingDataSource& dataSource, ProgressCallback progressCallback)
+			: trainer{ algorithm }, callback{ std::move(progressCallback) }
+		{
+			Start([this, &network, &dataSource] { trainer.Train(network, dataSource); });
+		}
+
+		TrainingSession::~TrainingSession()
+		{
+			if (IsRunning())
+			{
+				Cancel();
+			}
+			if (worker.joinable())
+			{
+				worker.join();
+			}
+			trainer.ResetAbort(); /* Abort requests outlive Train(), leave the trainer usable on its own again. */
+		}
+
+		void TrainingSession::Start(std::function<void()> train)
+		{
+			trainer.SetProgressCallback([this](TrainingProgress const& progress) { ReportProgress(progress); });
+			trainer.ResetAbort(); /* Before the worker starts, so a Cancel() right after construction is never lost. */
+
+			worker = std::thread([this, train = std::move(train)]
+			{
+				try
+				{
+					train();
+				}
+				catch (...)
+				{
+					trainingError = std::current_exception();
+				}
+
+				trainer.SetProgressCallback({});
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					isRunning = false;
+				}
+				finished.notify_all();
+			});
+		}
+
+		void TrainingSession::ReportProgress(TrainingProgress const& progress)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				lastProgress = progress;
+			}
+
+			if (callback)
+			{
+				callback(progress);
+			}
+		}
+
+		void TrainingSession::Cancel()
+		{
+			trainer.AbortTraining();
+		}
+
+		bool TrainingSession::IsRunning() const
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return isRunning;
+		}
+
+		bool TrainingSession::WaitFor(std::chrono::milliseconds timeout)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			return finished.wait_for(lock, timeout, [this] { return !isRunning; });
+		}
+
+		void TrainingSession::Wait()
+		{
+			if (worker.joinable())
+			{
+				worker.join();
+			}
+
+			if (trainingError)
+			{
+				std::rethrow_exception(std::exchange(trainingError, nullptr));
+			}
+		}
+
+		TrainingProgress TrainingSession::GetProgress() const
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return lastProgress;
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "Types/Collections.h"
+#include "Models/IFeedforwardNetwork.h"
+#include "Data/ITrainingDataSource.h"
+#include "Training/ITrainingAlgorithm.h"
+
+namespace NNS
+{
+	namespace Training
+	{
+		using namespace NNS::Types;
+		using NNS::Models::IFeedforwardNetwork;
+		using NNS::Data::ITrainingDataSource;
+
+		/** Training running on its own worker thread.
+		* Progress can be polled with GetProgress() or pushed through the callback, which is invoked on the worker thread after every epoch.
+		* Cancel() reaches the optimizer inner loops, so the worker returns within a few presentations instead of after a whole epoch.
+		* The trainer's progress callback is taken over while the session runs.
+		* The trainer, network and training data must outlive the session, and must not be touched until Wait() or WaitFor() says it finished.
+		*/
+		class TrainingSession final
+		{
+		public:
+			/** Start training on a worker thread.
+			* @param progressCallback optional, receives every epoch's progress on the worker thread.
+			*/
+			TrainingSession(ITrainingAlgorithm& algorithm, IFeedforwardNetwork& network, TrainingDataSet const& trainingData, ProgressCallback progressCallback = {});
+			TrainingSession(ITrainingAlgorithm& algorithm, IFeedforwardNetwork& network, ITrainingDataSource& dataSource, ProgressCallback progressCallback = {});
+
+			/** Cancels training still in progress, waits for the worker and clears the trainer's abort request, so it can train again without a session. */
+			~TrainingSession();
+
+			TrainingSession(const TrainingSession&) = delete;
+			TrainingSession& operator=(const TrainingSession&) = delete;
+
+			/** Ask training to stop as soon as possible. Returns immediately, use Wait() to join. */
+			void Cancel();
+
+			bool IsRunning() const;
+
+			/** Wait until training finished or the timeout expired.
+			* @return true if training finished.
+			*/
+			bool WaitFor(std::chrono::milliseconds timeout);
+
+			/** Wait until training finished. Rethrows whatever Train() threw. */
+			void Wait();
+
+			/** Progress of the last completed epoch. Epoch and errors are zero until the first epoch completes. */
+			TrainingProgress GetProgress() const;
+
+		private:
+			void Start(std::function<void()> train);
+			void ReportProgress(TrainingProgress const& progress);
+
+			ITrainingAlgorithm& trainer;
+			ProgressCallback callback;
+
+			mutable std::mutex mutex;
+			std::condition_variable finished;
+			TrainingProgress lastProgress;
+			bool isRunning{ true };
+			std::exception_ptr trainingError;
+
+			std::thread worker;
+		};
+	}
+}
@@ -0,0 +1,138 @@
+#include "pch.h"
+#include "Training/ValidationMonitor.h"
+
+#include <limits>
+
+namespace NNS
+{
+	namespace Training
+	{
+		ValidationMonitor::ValidationMonitor(IFeedforwardNetwork& network, TrainingDataSet const& validationData, EarlyStoppingConfig config, CancellationToken const* cancellation, ErrorCalculationMethod errorMethod, InputNormalizer const* normalizer)
+			: Config{ config }, validationNetwork{ network.Clone() }, errorState{ *validationNetwork, validationData },
+			pendingWeights{ network.GetWeightMatrix() }, bestWeights{ network.GetWeightMatrix() }, bestError{ std::numeric_limits<ErrorUnit>::max() }
+		{
+			assert(validationData.size() > 0);
+			errorState.SetCancellationToken(cancellation);
+			errorState.SetErrorComputationMethod(errorMethod);
+			errorState.SetInputNormalizer(normalizer);
+			evaluator = std::thread(&ValidationMonitor::Evaluate, this);
+		}
+
+		ValidationMonitor::~ValidationMonitor()
+		{
+			Finish();
+		}
+
+		void ValidationMonitor::Submit(IFeedforwardNetwork& network, size_t epoch)
+		{
+			const auto& weightMatrix = network.GetWeightMatrix();
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				pendingChanged.wait(lock, [this] { return !hasPending; });
+
+				for (size_t i = 0; i < weightMatrix.size(); ++i) /* Each layer, except first */
+					for (size_t j = 0; j < weightMatrix[i].size(); ++j) /* Each neuron */
+						pendingWeights[i][j] = weightMatrix[i][j]; /* Same size, so Eigen reuses the storage. */
+
+				pendingEpoch = epoch;
+				hasPending = true;
+			}
+			pendingChanged.notify_all();
+		}
+
+		bool ValidationMonitor::IsStopRequested() const
+		{
+			return stopRequest.IsCancelled();
+		}
+
+		CancellationToken const& ValidationMonitor::GetStopRequest() const
+		{
+			return stopRequest;
+		}
+
+		bool ValidationMonitor::HasBestWeights() const
+		{
+			assert(!evaluator.joinable());
+			return hasBest;
+		}
+
+		void ValidationMonitor::Finish()
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				if (!evaluator.joinable())
+					return;
+
+				pendingChanged.wait(lock, [this] { return !hasPending && !isBusy; });
+				isStopping = true;
+			}
+			pendingChanged.notify_all();
+			evaluator.join();
+		}
+
+		bool ValidationMonitor::RestoreBestWeights(IFeedforwardNetwork& network)
+		{
+			assert(!evaluator.joinable());
+
+			if (!hasBest)
+				return false;
+
+			network.GetWeightMatrix().swap(bestWeights);
+			hasBest = false; /* Buffer now holds the network's previous weights. */
+			return true;
+		}
+
+		ErrorUnit ValidationMonitor::GetBestError() const
+		{
+			return bestError;
+		}
+
+		size_t ValidationMonitor::GetBestEpoch() const
+		{
+			return bestEpoch;
+		}
+
+		void ValidationMonitor::Evaluate()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			while (true)
+			{
+				pendingChanged.wait(lock, [this] { return hasPending || isStopping; });
+				if (!hasPending)
+					return;
+
+				/* Take the pending weights, the validation network's previous buffer becomes the next pending one. */
+				validationNetwork->GetWeightMatrix().swap(pendingWeights);
+				const auto epoch = pendingEpoch;
+				hasPending = false;
+				isBusy = true;
+				lock.unlock();
+				pendingChanged.notify_all();
+
+				const auto error = errorState.ComputeEpochError();
+
+				if (errorState.IsCancelled())
+				{
+					/* Partial error, this epoch does not count. */
+				}
+				else if (error < bestError - Config.minDelta)
+				{
+					bestError = error;
+					bestEpoch = epoch;
+					hasBest = true;
+					evaluationsWithoutImprovement = 0;
+					bestWeights.swap(validationNetwork->GetWeightMatrix());
+				}
+				else if (Config.patience != 0 && ++evaluationsWithoutImprovement >= Config.patience)
+				{
+					stopRequest.Cancel();
+				}
+
+				lock.lock();
+				isBusy = false;
+				pendingChanged.notify_all();
+			}
+		}
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Types/Collections.h"
+#include "Models/IFeedforwardNetwork.h"
+#include "Training/TrainingErrorState.h"
+
+namespace NNS
+{
+	namespace Training
+	{
+		using namespace NNS::Types;
+		using NNS::Models::IFeedforwardNetwork;
+
+		struct EarlyStoppingConfig final
+		{
+			// Request a stop after this many validation evaluations in a row without improvement. Zero disables early stopping.
+			size_t patience{ 10 };
+			// Validation error has to drop by more than this to count as an improvement.
+			ErrorUnit minDelta{ 0.0 };
+		};
+
+		/** Held-out evaluation running on a background thread.
+		* Submit() copies the current weights into a preallocated pending buffer and returns, the background thread
+		* evaluates them on its own clone of the network while the trainer carries on with the next epoch.
+		* Every submitted epoch is evaluated. Submit() only waits when the previous epoch has not even been picked up yet,
+		* i.e. when validation falls more than a whole epoch behind training.
+		* Weight buffers rotate by swapping vectors, nothing is allocated after construction.
+		*/
+		class ValidationMonitor final
+		{
+		public:
+			const EarlyStoppingConfig Config;
+
+			/** Constructor, starts the background thread.
+			* @param cancellation optional, once cancelled an evaluation in progress is cut short and dropped.
+			* @param errorMethod should match the one training minimizes.
+			* @param normalizer should match the one training uses, validation data is normalized on the fly as well.
+			*/
+			ValidationMonitor(IFeedforwardNetwork& network, TrainingDataSet const& validationData, EarlyStoppingConfig config, CancellationToken const* cancellation = nullptr,
+				ErrorCalculationMethod errorMethod = ErrorCalculationMethod::MeanSquareError, InputNormalizer const* normalizer = nullptr);
+			~ValidationMonitor();
+
+			ValidationMonitor(const ValidationMonitor&) = delete;
+			ValidationMonitor& operator=(const ValidationMonitor&) = delete;
+
+			/** Hand over weights of the given epoch for evaluation. Does not wait for a running evaluation. */
+			void Submit(IFeedforwardNetwork& network, size_t epoch);
+
+			/** True once patience is exhausted. */
+			bool IsStopRequested() const;
+
+			/** Flag behind IsStopRequested(), lets data-parallel training agree on it, see TrainingErrorState::SetStopRequest(). */
+			CancellationToken const& GetStopRequest() const;
+
+			/** True if some epoch improved validation error, i.e. RestoreBestWeights() would restore anything. Call after Finish(). */
+			bool HasBestWeights() const;
+
+			/** Evaluate whatever is still pending and stop the background thread. */
+			void Finish();
+
+			/** Swap weights with the lowest validation error into the network. Call after Finish().
+			* @return false if nothing was evaluated.
+			*/
+			bool RestoreBestWeights(IFeedforwardNetwork& network);
+
+			ErrorUnit GetBestError() const;
+			size_t GetBestEpoch() const;
+
+		private:
+			void Evaluate();
+
+			IFeedforwardNetwork::Ptr validationNetwork;
+			TrainingErrorState errorState;
+
+			WeightMatrix pendingWeights;
+			WeightMatrix bestWeights;
+			size_t pendingEpoch{ 0 };
+			bool hasPending{ false };
+			bool isBusy{ false };
+			bool isStopping{ false };
+
+			/* Written by the background thread only, read after Finish(). */
+			ErrorUnit bestError;
+			size_t bestEpoch{ 0 };
+			bool hasBest{ false };
+			size_t evaluationsWithoutImprovement{ 0 };
+
+			CancellationToken stopRequest; /**< Set by the background thread once patience is exhausted. */
+			std::mutex mutex;
+			std::condition_variable pendingChanged;
+			std::thread evaluator;
+		};
+	}
+}
@@ -0,0 +1,57 @@
+#include "pch.h"
+#include "Training/WeightSnapshot.h"
+
+namespace NNS
+{
+	namespace Training
+	{
+		void WeightSnapshot::Initialize(IFeedforwardNetwork& network)
+		{
+			weights = network.GetWeightMatrix();
+			hasSnapshot = false;
+		}
+
+		void WeightSnapshot::Capture(IFeedforwardNetwork& network)
+		{
+			const auto& weightMatrix = network.GetWeightMatrix();
+
+			bool isShaped = weights.size() == weightMatrix.size();
+			for (size_t i = 0; isShaped && i < weightMatrix.size(); ++i)
+				isShaped = weights[i].size() == weightMatrix[i].size();
+			if (!isShaped) /* Initialize() was skipped or the network changed, only this capture allocates. */
+			{
+				weights = weightMatrix;
+				hasSnapshot = true;
+				return;
+			}
+
+			for (size_t i = 0; i < weightMatrix.size(); ++i) /* Each layer, except first */
+				for (size_t j = 0; j < weightMatrix[i].size(); ++j) /* Each neuron */
+					weights[i][j] = weightMatrix[i][j]; /* Same size, so Eigen reuses the storage. */
+
+			hasSnapshot = true;
+		}
+
+		void WeightSnapshot::Restore(IFeedforwardNetwork& network)
+		{
+			if (!hasSnapshot)
+				return;
+
+			auto& weightMatrix = network.GetWeightMatrix();
+			assert(weights.size() == weightMatrix.size());
+
+			weightMatrix.swap(weights);
+			hasSnapshot = false; /* Buffer now holds whatever the network had. */
+		}
+
+		bool WeightSnapshot::IsEmpty() const
+		{
+			return !hasSnapshot;
+		}
+
+		WeightMatrix const& WeightSnapshot::GetWeightMatrix() const
+		{
+			return weights;
+		}
+	}
+}
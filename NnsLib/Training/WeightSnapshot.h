@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Types/Collections.h"
+#include "Models/IFeedforwardNetwork.h"
+
+namespace NNS
+{
+	namespace Training
+	{
+		using namespace NNS::Types;
+		using NNS::Models::IFeedforwardNetwork;
+
+		/** Copy of network weights.
+		* The buffer is shaped like the network once in Initialize(), Capture() then only copies values and allocates nothing.
+		* Without Initialize(), the first Capture() shapes the buffer instead.
+		* Restore() swaps the buffer with the network's own weight matrix, which only exchanges vector pointers,
+		* and leaves the buffer holding the network's previous weights, still shaped for the next Capture().
+		*/
+		class WeightSnapshot final
+		{
+		public:
+			void Initialize(IFeedforwardNetwork& network);
+
+			void Capture(IFeedforwardNetwork& network);
+			void Restore(IFeedforwardNetwork& network);
+
+			bool IsEmpty() const;
+			WeightMatrix const& GetWeightMatrix() const;
+
+		private:
+			WeightMatrix weights;
+			bool hasSnapshot{ false };
+		};
+	}
+}
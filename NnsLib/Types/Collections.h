@@ -1,7 +1,9 @@
 #pragma once
 #include <vector>
 
+#include "Common/EigenSettings.h"
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 #include <unsupported/Eigen/CXX11/Tensor>
 
 using Eigen::Matrix;
@@ -24,11 +26,12 @@ namespace NNS
 		using NetworkLayerMap		= vector<size_t>;
 
 		using WeightVector			= Matrix<SignalUnit, Dynamic, 1>;
-		using WeightMatrix			= vector<vector<WeightVector>>;  // TODO: Eigen::SparseMatrix<>
+		using WeightMatrix			= vector<vector<WeightVector>>;
+		using ConnectivityPattern	= Eigen::SparseMatrix<WeightUnit, Eigen::RowMajor>; // CSR, row per neuron, column per previous layer neuron.
 
 		using ErrorVector			= vector<ErrorUnit>;
 		using TrainingDataSet		= vector<pair<InputLayer, OutputLayer>>;
-		using ErrorGradientMatrix	= vector<vector<vector<ErrorUnit>>>;  // TODO: Eigen::SparseMatrix<>
+		using ErrorGradientMatrix	= vector<vector<vector<ErrorUnit>>>;
 		using ErrorDeltaMatrix		= vector<vector<ErrorUnit>>;
 	} 
 }
\ No newline at end of file
@@ -13,5 +13,6 @@
 #include <random>
 #include <cassert>
 
+#include "Common/EigenSettings.h"
 #include <Eigen/Core>
 